@@ -0,0 +1,120 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        bench_batch.cpp
+ * \brief       批量请求性能测试：启动时的串行请求与一次批量请求的对比。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include <benchmark/benchmark.h>
+
+#include <ixwebsocket/IXHttpClient.h>
+
+#include "kaixin_api.h"
+#include "kaixin_stand_in.h"
+#include "local_https_server.h"
+
+using kaixin::test::local_https_server;
+using kaixin::test::server_options;
+
+
+// 启动时请求的资源
+static const std::pair<std::string, std::string> resources[] = {
+    { ix::HttpClient::kGet, "/lowest-version" },
+    { ix::HttpClient::kGet, "/materials" },
+    { ix::HttpClient::kGet, "/shopee-hosts" },
+    { ix::HttpClient::kPost, "/device-id" },
+    { ix::HttpClient::kGet, "/auth" },
+};
+
+
+static std::shared_ptr<kaixin::Config> make_config(const std::string &base_url)
+{
+    auto config = std::make_shared<kaixin::Config>();
+    config->organization = "kaixin";
+    config->application = "bench";
+    config->app_key = "bench-key";
+    config->app_secret = "bench-secret";
+    config->signing_key = kaixin::hmac_sha256(config->app_secret);
+    config->base_url = base_url;
+    return config;
+}
+
+
+// 参数为服务端每个响应前的延迟（毫秒），模拟网络往返
+static server_options make_options(const benchmark::State &state)
+{
+    server_options options;
+    options.delay = std::chrono::milliseconds(state.range(0));
+    return options;
+}
+
+
+/// 引入批量请求之前的启动过程：每个资源单独签名、单独往返。
+static void BM_serial(benchmark::State &state)
+{
+    local_https_server server(kaixin::test::kaixin_stand_in, make_options(state));
+    const auto config = make_config(server.url());
+    kaixin::config_scope scope(config.get());
+
+    for (auto _ : state)
+    {
+        for (const auto &[verb, path] : resources)
+        {
+            if (kaixin::send_request(verb, path) != 0)
+            {
+                state.SkipWithError("Request failed.");
+                return;
+            }
+        }
+    }
+
+    state.counters["round_trips"] = benchmark::Counter(
+        static_cast<double>(server.stats().requests), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_serial)->Arg(0)->Arg(20)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+
+/// 同样的资源合并为一次批量请求。
+static void BM_batch(benchmark::State &state)
+{
+    local_https_server server(kaixin::test::kaixin_stand_in, make_options(state));
+    const auto config = make_config(server.url());
+    kaixin::config_scope scope(config.get());
+
+    for (auto _ : state)
+    {
+        std::vector<kaixin::sub_request> requests;
+
+        for (const auto &[verb, path] : resources)
+        {
+            kaixin::sub_request req;
+            req.verb = verb;
+            req.path = path;
+            requests.emplace_back(std::move(req));
+        }
+
+        if (kaixin::send_batch_request(requests) != 0)
+        {
+            state.SkipWithError("Batch failed.");
+            return;
+        }
+
+        for (const auto &req : requests)
+        {
+            if (req.result != 0)
+            {
+                state.SkipWithError("Sub-request failed.");
+                return;
+            }
+        }
+    }
+
+    state.counters["round_trips"] = benchmark::Counter(
+        static_cast<double>(server.stats().requests), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_batch)->Arg(0)->Arg(20)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,132 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        bench_codec.cpp
+ * \brief       编解码性能测试：codec 与逐字节参考实现的对比。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+
+#include "codec.h"
+#include "codec_reference.h"
+
+namespace reference = kaixin::test::codec_reference;
+
+
+// 随机二进制数据
+static std::string random_bytes(size_t length)
+{
+    std::mt19937 random(20261017);
+    std::string s(length, '\0');
+
+    for (auto &c : s)
+    {
+        c = static_cast<char>(random());
+    }
+
+    return s;
+}
+
+
+// 与签名中的查询参数相仿的文本：大部分字符不需要编码
+static std::string query_text(size_t length)
+{
+    static const std::string sample = "agent_code=A0001&locale=zh_CN&page=buy&nonce=5f2c9a0e71b3d4a6"
+        "&timestamp=1700000000&website=https://shopee.example.com/path?q=1 2";
+    std::string s;
+
+    while (s.size() < length)
+    {
+        s += sample;
+    }
+
+    s.resize(length);
+    return s;
+}
+
+
+template<typename Encode>
+static void run(benchmark::State &state, const std::string &input, Encode &&encode)
+{
+    std::string out;
+
+    for (auto _ : state)
+    {
+        out.clear();
+        encode(out, input);
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(input.size()));
+}
+
+
+static void BM_hex(benchmark::State &state)
+{
+    run(state, random_bytes(static_cast<size_t>(state.range(0))), [](std::string &out, const std::string &in)
+    {
+        codec::hex_encode(out, reinterpret_cast<const uint8_t *>(in.data()), in.size());
+    });
+    state.SetLabel(codec::implementation());
+}
+BENCHMARK(BM_hex)->RangeMultiplier(4)->Range(16, 4096);
+
+
+static void BM_hex_reference(benchmark::State &state)
+{
+    run(state, random_bytes(static_cast<size_t>(state.range(0))), [](std::string &out, const std::string &in)
+    {
+        out = reference::hex_encode(reinterpret_cast<const uint8_t *>(in.data()), in.size());
+    });
+}
+BENCHMARK(BM_hex_reference)->RangeMultiplier(4)->Range(16, 4096);
+
+
+static void BM_base64url(benchmark::State &state)
+{
+    run(state, random_bytes(static_cast<size_t>(state.range(0))), [](std::string &out, const std::string &in)
+    {
+        codec::base64url_encode(out, reinterpret_cast<const uint8_t *>(in.data()), in.size());
+    });
+    state.SetLabel(codec::implementation());
+}
+BENCHMARK(BM_base64url)->RangeMultiplier(4)->Range(16, 4096);
+
+
+static void BM_base64url_reference(benchmark::State &state)
+{
+    run(state, random_bytes(static_cast<size_t>(state.range(0))), [](std::string &out, const std::string &in)
+    {
+        out = reference::base64url_encode(reinterpret_cast<const uint8_t *>(in.data()), in.size());
+    });
+}
+BENCHMARK(BM_base64url_reference)->RangeMultiplier(4)->Range(16, 4096);
+
+
+static void BM_url_encode(benchmark::State &state)
+{
+    run(state, query_text(static_cast<size_t>(state.range(0))), [](std::string &out, const std::string &in)
+    {
+        codec::url_encode(out, in.data(), in.size());
+    });
+    state.SetLabel(codec::implementation());
+}
+BENCHMARK(BM_url_encode)->RangeMultiplier(4)->Range(16, 4096);
+
+
+static void BM_url_encode_reference(benchmark::State &state)
+{
+    run(state, query_text(static_cast<size_t>(state.range(0))), [](std::string &out, const std::string &in)
+    {
+        out = reference::url_encode(in);
+    });
+}
+BENCHMARK(BM_url_encode_reference)->RangeMultiplier(4)->Range(16, 4096);
@@ -0,0 +1,131 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        bench_compression.cpp
+ * \brief       响应压缩性能测试：gzip 压缩与未压缩响应的传输大小与时间对比。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include <benchmark/benchmark.h>
+
+#include "buffer_pool.h"
+#include "http_transport.h"
+#include "local_https_server.h"
+
+using kaixin::test::http_request;
+using kaixin::test::http_response;
+using kaixin::test::local_https_server;
+
+
+// 与完整的 Shopee 域名表相仿的 JSON 数据
+static const std::string &fixture()
+{
+    static const std::string data = []
+    {
+        std::string json = R"({"code":0,"msg":"","data":{)";
+
+        for (const char *area : { "global", "china" })
+        {
+            if (json.back() != '{')
+            {
+                json += ',';
+            }
+
+            json += std::string("\"") + area + R"(":{)";
+
+            for (const char *sub : { "buyer", "seller", "cdn" })
+            {
+                if (json.back() != '{')
+                {
+                    json += ',';
+                }
+
+                json += std::string("\"") + sub + R"(":{)";
+
+                for (int i = 0; i < 300; i++)
+                {
+                    const auto region = "r" + std::to_string(i);
+                    json += (i == 0) ? "\"" : ",\"";
+                    json += region + R"(":")" + sub + "." + region + ".shopee.example.com\"";
+                }
+
+                json += '}';
+            }
+
+            json += '}';
+        }
+
+        json += "}}";
+        return json;
+    }();
+
+    return data;
+}
+
+
+// 客户端声明支持 gzip 时返回压缩的数据
+static http_response serve_fixture(const http_request &req)
+{
+    static const std::string compressed = local_https_server::gzip(fixture());
+    http_response resp;
+    resp.headers.emplace_back("Content-Type", "application/json");
+    const auto iter = req.headers.find("accept-encoding");
+
+    if (iter != req.headers.end() && iter->second.find("gzip") != std::string::npos)
+    {
+        resp.headers.emplace_back("Content-Encoding", "gzip");
+        resp.body = compressed;
+    }
+    else
+    {
+        resp.body = fixture();
+    }
+
+    return resp;
+}
+
+
+static local_https_server &server()
+{
+    static local_https_server s(serve_fixture);
+    return s;
+}
+
+
+// 参数为是否声明支持压缩
+static void BM_fetch(benchmark::State &state)
+{
+    const auto url = server().url() + "/shopee-hosts";
+    const bool compress = state.range(0) != 0;
+    size_t wire = 0;
+
+    for (auto _ : state)
+    {
+        auto args = std::make_shared<ix::HttpRequestArgs>();
+        args->url = url;
+        args->verb = "GET";
+        args->compress = compress;
+        args->connectTimeout = 5;
+        args->transferTimeout = 5;
+
+        const auto resp = http::request(url, args->verb, std::string(), args);
+
+        if (resp->errorCode != ix::HttpErrorCode::Ok || resp->payload != fixture())
+        {
+            state.SkipWithError("Unexpected response.");
+            break;
+        }
+
+        wire = resp->downloadSize;
+        buffer_pool::instance().release(std::move(resp->payload));
+    }
+
+    state.counters["wire_bytes"] = static_cast<double>(wire);
+    state.counters["body_bytes"] = static_cast<double>(fixture().size());
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * fixture().size()));
+}
+BENCHMARK(BM_fetch)->ArgName("gzip")->Arg(0)->Arg(1)->UseRealTime();
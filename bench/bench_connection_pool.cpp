@@ -0,0 +1,110 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        bench_connection_pool.cpp
+ * \brief       连接池性能测试：长连接复用与每次新建连接的对比。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include <benchmark/benchmark.h>
+
+#include "connection_pool.h"
+#include "http_transport.h"
+#include "local_https_server.h"
+#include "tls_session_cache.h"
+
+using kaixin::test::http_request;
+using kaixin::test::http_response;
+using kaixin::test::local_https_server;
+
+
+static local_https_server &server()
+{
+    static local_https_server s([](const http_request &)
+    {
+        http_response resp;
+        resp.headers.emplace_back("Content-Type", "application/json");
+        resp.body = R"({"code":0,"data":{}})";
+        return resp;
+    });
+    return s;
+}
+
+
+static bool get(benchmark::State &state, const std::string &url)
+{
+    auto args = std::make_shared<ix::HttpRequestArgs>();
+    args->url = url;
+    args->verb = "GET";
+    args->connectTimeout = 5;
+    args->transferTimeout = 5;
+
+    const auto resp = http::request(url, args->verb, std::string(), args);
+
+    if (resp->errorCode != ix::HttpErrorCode::Ok || resp->statusCode != 200)
+    {
+        state.SkipWithError(resp->errorMsg.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+
+/// 复用连接池中的长连接，只有第一次请求建立连接。
+static void BM_pooled(benchmark::State &state)
+{
+    const auto url = server().url() + "/ping";
+    connection_pool::instance().clear();
+
+    if (!get(state, url))
+    {
+        return;
+    }
+
+    const auto before = server().stats().connections;
+
+    for (auto _ : state)
+    {
+        if (!get(state, url))
+        {
+            break;
+        }
+    }
+
+    state.counters["connections"] = benchmark::Counter(
+        static_cast<double>(server().stats().connections - before), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_pooled)->UseRealTime();
+
+
+/// 模拟引入连接池之前的行为：每次请求都做 TCP 连接与完整的 TLS 握手。
+static void BM_per_call(benchmark::State &state)
+{
+    const auto url = server().url() + "/ping";
+    auto &pool = connection_pool::instance();
+    pool.clear();
+    pool.set_limits(0, 0, std::chrono::seconds(30));
+    const auto before = server().stats().connections;
+
+    for (auto _ : state)
+    {
+        tls_session_cache::instance().clear();
+
+        if (!get(state, url))
+        {
+            break;
+        }
+    }
+
+    state.counters["connections"] = benchmark::Counter(
+        static_cast<double>(server().stats().connections - before), benchmark::Counter::kAvgIterations);
+
+    // 恢复默认限制
+    pool.set_limits(4, 16, std::chrono::seconds(30));
+}
+BENCHMARK(BM_per_call)->UseRealTime();
@@ -0,0 +1,94 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        bench_handshake.cpp
+ * \brief       TLS 握手性能测试：完整握手、恢复会话与早期数据（0-RTT）的对比。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include <benchmark/benchmark.h>
+
+#include "buffer_pool.h"
+#include "connection_pool.h"
+#include "http_transport.h"
+#include "local_https_server.h"
+#include "tls_session_cache.h"
+
+using kaixin::test::http_request;
+using kaixin::test::http_response;
+using kaixin::test::local_https_server;
+using kaixin::test::server_options;
+
+
+/// 握手方式。
+enum handshake_mode
+{
+    FULL,                                       ///< 每次完整握手
+    RESUMED,                                    ///< 用上次的会话票据恢复会话
+    EARLY_DATA,                                 ///< 恢复会话并以早期数据发送请求
+};
+
+
+static http_response serve(const http_request &)
+{
+    http_response resp;
+    resp.headers.emplace_back("Content-Type", "application/json");
+    resp.body = R"({"code":0,"msg":"","data":{"major":1,"minor":3,"patch":0}})";
+    return resp;
+}
+
+
+// 每次请求都新建连接，只比较握手的开销
+static void BM_handshake(benchmark::State &state)
+{
+    const auto mode = static_cast<handshake_mode>(state.range(0));
+    server_options options;
+    options.early_data = (mode == EARLY_DATA);
+    local_https_server server(serve, options);
+
+    const auto url = server.url() + "/lowest-version";
+    auto &pool = connection_pool::instance();
+    auto &sessions = tls_session_cache::instance();
+    pool.clear();
+    pool.set_limits(0, 0, std::chrono::seconds(30));
+    sessions.clear();
+
+    for (auto _ : state)
+    {
+        if (mode == FULL)
+        {
+            sessions.clear();
+        }
+
+        auto args = std::make_shared<ix::HttpRequestArgs>();
+        args->url = url;
+        args->verb = "GET";
+        args->connectTimeout = 5;
+        args->transferTimeout = 5;
+
+        const auto resp = http::request(url, args->verb, std::string(), args, nullptr, mode == EARLY_DATA);
+
+        if (resp->errorCode != ix::HttpErrorCode::Ok || resp->statusCode != 200)
+        {
+            state.SkipWithError(resp->errorMsg.c_str());
+            break;
+        }
+
+        buffer_pool::instance().release(std::move(resp->payload));
+    }
+
+    const auto stats = server.stats();
+    state.counters["resumed"] = benchmark::Counter(static_cast<double>(stats.resumed),
+                                                   benchmark::Counter::kAvgIterations);
+    state.counters["early_data"] = benchmark::Counter(static_cast<double>(stats.early_data),
+                                                      benchmark::Counter::kAvgIterations);
+
+    // 恢复默认限制
+    pool.set_limits(4, 16, std::chrono::seconds(30));
+    sessions.clear();
+}
+BENCHMARK(BM_handshake)->ArgName("mode")->Arg(FULL)->Arg(RESUMED)->Arg(EARLY_DATA)->UseRealTime();
@@ -0,0 +1,102 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        bench_http2.cpp
+ * \brief       HTTP/2 性能测试：并发请求在 HTTP/2 单一连接上复用与 HTTP/1.1 多连接的对比。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include <benchmark/benchmark.h>
+
+#include "buffer_pool.h"
+#include "connection_pool.h"
+#include "h2_session.h"
+#include "http_transport.h"
+#include "local_https_server.h"
+
+using kaixin::test::http_request;
+using kaixin::test::http_response;
+using kaixin::test::local_https_server;
+
+
+static http_response serve(const http_request &)
+{
+    http_response resp;
+    resp.headers.emplace_back("Content-Type", "application/json");
+    resp.body = R"({"code":0,"msg":"","data":"https://localhost/web"})";
+    return resp;
+}
+
+
+// 每个响应延迟 10 毫秒，模拟网络往返
+static local_https_server &server()
+{
+    static local_https_server s(serve, []
+    {
+        kaixin::test::server_options options;
+        options.http2 = true;
+        options.delay = std::chrono::milliseconds(10);
+        return options;
+    }());
+    return s;
+}
+
+
+// 与 API 请求相仿：长的签名查询字符串与重复的 Authorization 头。每轮测试从没有连接开始
+static void run(benchmark::State &state, bool http2)
+{
+    if (state.thread_index() == 0)
+    {
+        http::h2_session::set_enabled(http2);
+        http::h2_session::clear();
+        connection_pool::instance().clear();
+    }
+
+    const auto url = server().url() + "/web-url?a=" + std::string(300, 'a') + "&k=bench&s=" + std::string(64, 's');
+    const auto before = server().stats();
+
+    for (auto _ : state)
+    {
+        auto args = std::make_shared<ix::HttpRequestArgs>();
+        args->url = url;
+        args->verb = "GET";
+        args->connectTimeout = 5;
+        args->transferTimeout = 5;
+        args->extraHeaders.emplace("Authorization", "Bearer " + std::string(800, 't'));
+
+        const auto resp = http::request(url, args->verb, std::string(), args);
+
+        if (resp->errorCode != ix::HttpErrorCode::Ok || resp->statusCode != 200)
+        {
+            state.SkipWithError(resp->errorMsg.c_str());
+            break;
+        }
+
+        buffer_pool::instance().release(std::move(resp->payload));
+    }
+
+    const auto after = server().stats();
+    state.SetItemsProcessed(state.iterations());
+    state.counters["connections"] = benchmark::Counter(static_cast<double>(after.connections - before.connections),
+                                                       benchmark::Counter::kAvgThreads);
+    state.counters["http2"] = benchmark::Counter(static_cast<double>(after.http2 - before.http2),
+                                                 benchmark::Counter::kAvgThreads);
+}
+
+
+static void BM_http1(benchmark::State &state)
+{
+    run(state, false);
+}
+BENCHMARK(BM_http1)->ThreadRange(1, 32)->UseRealTime();
+
+
+static void BM_http2(benchmark::State &state)
+{
+    run(state, true);
+}
+BENCHMARK(BM_http2)->ThreadRange(1, 32)->UseRealTime();
@@ -0,0 +1,169 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        bench_json.cpp
+ * \brief       JSON 解析性能测试：每次新建的 rapidjson::Document 与线程局部 json_arena 的对比。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+#include "json_arena.h"
+
+
+// rapidjson 的 CrtAllocator 直接调用 malloc，统计堆分配需要截获 malloc 本身。
+// glibc 允许程序提供自己的 malloc，这里计数后转交 glibc 的实现；其它平台不统计。
+#ifdef __GLIBC__
+static std::atomic<int64_t> g_allocations{ 0 };
+
+extern "C" {
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+}       // extern "C"
+
+#define KAIXIN_COUNT_ALLOCATIONS 1
+#endif
+
+
+// 与登录响应相仿的 JSON 数据：外层信封，内含用户信息与令牌
+static const std::string &response_fixture()
+{
+    static const std::string data = []
+    {
+        std::string json = R"({"code":0,"msg":"","data":{"token":"eyJhbGciOiJIUzI1NiJ9.payload.signature",)"
+            R"("profile":{"username":"tester","nickname":"Tester","email":"tester@example.com",)"
+            R"("expires_at":1924992000,"permissions":[)";
+
+        for (int i = 0; i < 40; i++)
+        {
+            json += (i == 0) ? "" : ",";
+            json += R"({"name":"permission-)" + std::to_string(i) + R"(","granted":true,"level":)"
+                + std::to_string(i % 4) + "}";
+        }
+
+        json += "]}}}";
+        return json;
+    }();
+
+    return data;
+}
+
+
+// 令牌载荷，处理响应时再解析一层
+static const std::string &payload_fixture()
+{
+    static const std::string data = R"({"sub":"tester","agent_code":"A0001","iat":1700000000,)"
+        R"("exp":1924992000,"scope":["user","shop","notify"]})";
+    return data;
+}
+
+
+// 把数据复制到预留了容量的缓冲区中原地解析，复制本身不分配
+static char *refill(std::string &buffer, const std::string &data)
+{
+    buffer.assign(data);
+    return buffer.data();
+}
+
+
+template<typename Parse>
+static void run(benchmark::State &state, Parse &&parse)
+{
+    std::string response;
+    std::string payload;
+    response.reserve(response_fixture().size());
+    payload.reserve(payload_fixture().size());
+
+#ifdef KAIXIN_COUNT_ALLOCATIONS
+    const auto before = g_allocations.load();
+#endif
+
+    for (auto _ : state)
+    {
+        if (!parse(refill(response, response_fixture()), refill(payload, payload_fixture())))
+        {
+            state.SkipWithError("Parse failed.");
+            return;
+        }
+    }
+
+#ifdef KAIXIN_COUNT_ALLOCATIONS
+    state.counters["allocations"] = benchmark::Counter(
+        static_cast<double>(g_allocations.load() - before), benchmark::Counter::kAvgIterations);
+#endif
+}
+
+
+/// 引入 json_arena 之前：每次解析都新建文档，分配器的块与解析栈各自从堆上分配。
+static void BM_document(benchmark::State &state)
+{
+    run(state, [](char *response, char *payload)
+    {
+        rapidjson::Document doc;
+        doc.ParseInsitu(response);
+
+        if (doc.HasParseError() || !doc["data"].IsObject())
+        {
+            return false;
+        }
+
+        rapidjson::Document inner;
+        inner.ParseInsitu(payload);
+        benchmark::DoNotOptimize(doc["data"]["profile"]["permissions"].Size());
+        return !inner.HasParseError() && inner.IsObject();
+    });
+}
+BENCHMARK(BM_document);
+
+
+/// 线程局部内存池：重置而不释放，嵌套解析使用更深一层。
+static void BM_arena(benchmark::State &state)
+{
+    run(state, [](char *response, char *payload)
+    {
+        json_arena arena;
+        auto &doc = arena.document();
+        doc.ParseInsitu(response);
+
+        if (doc.HasParseError() || !doc["data"].IsObject())
+        {
+            return false;
+        }
+
+        json_arena inner_arena;
+        auto &inner = inner_arena.document();
+        inner.ParseInsitu(payload);
+        benchmark::DoNotOptimize(doc["data"]["profile"]["permissions"].Size());
+        return !inner.HasParseError() && inner.IsObject();
+    });
+}
+BENCHMARK(BM_arena);
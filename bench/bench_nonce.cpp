@@ -0,0 +1,58 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        bench_nonce.cpp
+ * \brief       请求随机数性能测试：多线程同时生成时，逐次 RAND_bytes 与线程局部 nonce_pool 的对比。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include <benchmark/benchmark.h>
+
+#include <openssl/rand.h>
+
+#include "codec.h"
+#include "nonce_pool.h"
+
+using kaixin::nonce_pool;
+
+
+/// 引入 nonce_pool 之前：每个随机数单独调用 OpenSSL 的全局 DRBG，并分配十六进制字符串。
+static void BM_rand_bytes(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        uint8_t bytes[nonce_pool::NONCE_BYTES];
+
+        if (RAND_bytes(bytes, sizeof(bytes)) != 1)
+        {
+            state.SkipWithError("RAND_bytes failed.");
+            return;
+        }
+
+        benchmark::DoNotOptimize(codec::to_hex(bytes, sizeof(bytes)));
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_rand_bytes)->ThreadRange(1, 32)->UseRealTime();
+
+
+/// 线程局部缓存批量取出的随机字节，生成时不加锁、不分配内存。
+static void BM_nonce_pool(benchmark::State &state)
+{
+    auto &pool = nonce_pool::local();
+
+    for (auto _ : state)
+    {
+        char nonce[nonce_pool::NONCE_LENGTH];
+        pool.generate(nonce);
+        benchmark::DoNotOptimize(nonce);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_nonce_pool)->ThreadRange(1, 32)->UseRealTime();
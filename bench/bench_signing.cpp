@@ -0,0 +1,128 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        bench_signing.cpp
+ * \brief       请求签名性能测试：拼接签名字符串后一次性 HMAC() 与复制已设置密钥的上下文逐段签名的对比。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include <benchmark/benchmark.h>
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+#include "codec.h"
+#include "hmac_sha256.h"
+#include "kaixin_api.h"
+
+using kaixin::hmac_sha256;
+
+
+static const std::string APP_SECRET = "bench-secret-0123456789abcdef";
+
+
+// 与一般请求相仿的参数：公共参数与业务参数
+static const kaixin::string_map &queries()
+{
+    static const kaixin::string_map q{
+        { "app_key", "bench-key" },
+        { "agent_code", "A0001" },
+        { "device_id", "0f8e7d6c5b4a39281706f5e4d3c2b1a0" },
+        { "locale", "zh_CN" },
+        { "nonce", "5f2c9a0e71b3d4a6" },
+        { "page", "buy" },
+        { "timestamp", "1700000000" },
+        { "token", std::string(600, 't') },
+    };
+    return q;
+}
+
+
+// 每线程每秒的签名数。线程数不超过 CPU 核数时即单核吞吐
+static void report(benchmark::State &state)
+{
+    state.counters["signatures_per_thread"] = benchmark::Counter(
+        static_cast<double>(state.iterations()), benchmark::Counter::kIsRate | benchmark::Counter::kAvgThreads);
+}
+
+
+/// 引入 hmac_sha256 之前：拼接完整的签名字符串，每次由 HMAC() 重新处理密钥。
+static void BM_one_shot(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        std::string sts = "GET";
+        sts += "/web-url";
+
+        for (const auto &[key, value] : queries())
+        {
+            sts += key;
+            sts += value;
+        }
+
+        uint8_t digest[EVP_MAX_MD_SIZE];
+        unsigned int length = sizeof(digest);
+        HMAC(EVP_sha256(), APP_SECRET.data(), static_cast<int>(APP_SECRET.size()),
+             reinterpret_cast<const uint8_t *>(sts.data()), sts.size(), digest, &length);
+        benchmark::DoNotOptimize(codec::to_hex(digest, length));
+    }
+
+    report(state);
+}
+BENCHMARK(BM_one_shot)->ThreadRange(1, 8)->UseRealTime();
+
+
+/// 复制已设置密钥的上下文，参数逐段送入，摘要编码到栈上，不分配内存。
+static void BM_cached_key(benchmark::State &state)
+{
+    static const hmac_sha256 keyed(APP_SECRET);
+
+    for (auto _ : state)
+    {
+        auto signer = keyed;
+        signer.update("GET");
+        signer.update("/web-url");
+
+        for (const auto &[key, value] : queries())
+        {
+            signer.update(key);
+            signer.update(value);
+        }
+
+        uint8_t digest[hmac_sha256::DIGEST_LENGTH];
+        signer.final(digest);
+        char hex[hmac_sha256::DIGEST_LENGTH * 2];
+        codec::hex_encode(hex, digest, sizeof(digest));
+        benchmark::DoNotOptimize(hex);
+    }
+
+    report(state);
+}
+BENCHMARK(BM_cached_key)->ThreadRange(1, 8)->UseRealTime();
+
+
+/// SDK 的签名函数：同时生成查询字符串与表单，包含返回签名字符串的开销。
+static void BM_sign(benchmark::State &state)
+{
+    static const auto config = []
+    {
+        auto c = std::make_shared<kaixin::Config>();
+        c->app_secret = APP_SECRET;
+        c->signing_key = hmac_sha256(APP_SECRET);
+        return c;
+    }();
+
+    kaixin::config_scope scope(config.get());
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kaixin::sign("GET", "/web-url", queries(), {}));
+    }
+
+    report(state);
+}
+BENCHMARK(BM_sign)->ThreadRange(1, 8)->UseRealTime();
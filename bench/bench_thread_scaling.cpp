@@ -0,0 +1,136 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        bench_thread_scaling.cpp
+ * \brief       多线程性能测试：读取凭据快照并签名、发送请求的吞吐随线程数的变化。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include <benchmark/benchmark.h>
+
+#include <ctime>
+
+#include <ixwebsocket/IXHttpClient.h>
+
+#include "kaixin_api.h"
+#include "kaixin_stand_in.h"
+#include "local_https_server.h"
+
+using kaixin::test::local_https_server;
+
+
+// 服务端每个响应延迟 10 毫秒，模拟网络往返
+static local_https_server &server()
+{
+    static local_https_server s(kaixin::test::kaixin_stand_in, []
+    {
+        kaixin::test::server_options options;
+        options.delay = std::chrono::milliseconds(10);
+        return options;
+    }());
+    return s;
+}
+
+
+// 已登录的配置，所有线程共享
+static kaixin::Config *config()
+{
+    static const auto c = []
+    {
+        auto config = std::make_shared<kaixin::Config>();
+        config->organization = "kaixin";
+        config->application = "bench";
+        config->app_key = "bench-key";
+        config->app_secret = "bench-secret";
+        config->signing_key = kaixin::hmac_sha256(config->app_secret);
+        config->base_url = server().url();
+
+        kaixin::config_scope scope(config.get());
+        auto creds = std::make_shared<kaixin::credentials>();
+        creds->access_token = std::string(800, 'a');
+        creds->username = "tester";
+        creds->agent_code = "A0001";
+        creds->access_token_expires_at = time(nullptr) + 3600;
+        kaixin::publish_credentials(std::move(creds), kaixin::sign_out_epoch(), nullptr);
+        return config;
+    }();
+
+    return c.get();
+}
+
+
+// 与一般请求相同：取凭据快照，用其中的令牌与代理编号签名
+static void sign_with_credentials()
+{
+    const auto creds = kaixin::current_credentials();
+    const kaixin::string_map queries{
+        { "agent_code", creds->agent_code },
+        { "locale", "zh_CN" },
+        { "page", "buy" },
+        { "token", creds->access_token },
+    };
+    benchmark::DoNotOptimize(kaixin::sign(ix::HttpClient::kGet, "/web-url", queries, {}));
+}
+
+
+/// 只有读取者：快照原子读取，不加锁，吞吐随线程数线性增长。
+static void BM_sign(benchmark::State &state)
+{
+    kaixin::config_scope scope(config());
+
+    for (auto _ : state)
+    {
+        sign_with_credentials();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_sign)->ThreadRange(1, 32)->UseRealTime();
+
+
+/// 第一个线程同时不断发布新凭据，模拟后台更新令牌；读取者继续使用各自取得的快照。
+static void BM_sign_while_refreshing(benchmark::State &state)
+{
+    kaixin::config_scope scope(config());
+    int64_t n = 0;
+
+    for (auto _ : state)
+    {
+        if (state.thread_index() == 0 && (++n % 64) == 0)
+        {
+            kaixin::update_credentials([](kaixin::credentials &creds)
+            {
+                creds.access_token_expires_at++;
+                return true;
+            });
+        }
+
+        sign_with_credentials();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_sign_while_refreshing)->ThreadRange(1, 32)->UseRealTime();
+
+
+/// 完整的请求：签名、连接池、收发与解析。没有全局锁，吞吐随并发的请求数增长。
+static void BM_send_request(benchmark::State &state)
+{
+    kaixin::config_scope scope(config());
+
+    for (auto _ : state)
+    {
+        if (kaixin::send_request(ix::HttpClient::kGet, "/lowest-version") != 0)
+        {
+            state.SkipWithError("Request failed.");
+            return;
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_send_request)->ThreadRange(1, 16)->UseRealTime();
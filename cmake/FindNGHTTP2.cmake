@@ -0,0 +1,21 @@
+# 查询 nghttp2 库
+find_path(NGHTTP2_INCLUDE_DIR "nghttp2/nghttp2.h")
+find_library(NGHTTP2_LIBRARY "nghttp2")
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(NGHTTP2 DEFAULT_MSG
+    NGHTTP2_LIBRARY
+    NGHTTP2_INCLUDE_DIR
+)
+mark_as_advanced(
+    NGHTTP2_LIBRARY
+    NGHTTP2_INCLUDE_DIR
+)
+
+if(NGHTTP2_FOUND AND NOT TARGET NGHTTP2)
+    add_library(NGHTTP2 UNKNOWN IMPORTED)
+    set_target_properties(NGHTTP2 PROPERTIES
+        INTERFACE_INCLUDE_DIRECTORIES "${NGHTTP2_INCLUDE_DIR}"
+        IMPORTED_LOCATION "${NGHTTP2_LIBRARY}"
+    )
+endif()
@@ -0,0 +1,216 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        body_sink.cpp
+ * \brief       响应体接收类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "body_sink.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#include <zlib.h>
+
+
+namespace http {
+
+
+/// 每次为解压输出预留的最小空间。
+static constexpr size_t INFLATE_CHUNK = 16 * 1024;
+/// 预估的 JSON 压缩比。
+static constexpr size_t EXPECTED_RATIO = 4;
+
+
+/*!
+ * \brief       流式解压 gzip/deflate 响应体。
+ */
+class inflate_sink : public body_sink
+{
+public:
+    inflate_sink(std::string &out, bool gzip, size_t size_hint)
+        : out_(out)
+        , gzip_(gzip)
+        , initialized_(false)
+        , done_(false)
+    {
+        memset(&zs_, 0, sizeof(zs_));
+
+        if (size_hint > 0)
+        {
+            out_.reserve(out_.size() + size_hint * EXPECTED_RATIO);
+        }
+    }
+
+    ~inflate_sink() override
+    {
+        if (initialized_)
+        {
+            inflateEnd(&zs_);
+        }
+    }
+
+    bool write(const char *data, size_t length) override
+    {
+        if (done_ || length == 0)
+        {
+            // 忽略压缩流之后的多余数据
+            return true;
+        }
+
+        if (!initialized_ && !init(data, length))
+        {
+            return false;
+        }
+
+        zs_.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+        zs_.avail_in = static_cast<uInt>(length);
+
+        while (zs_.avail_in > 0)
+        {
+            // 直接解压到输出字符串的尾部空间；预留空间由构造时的 reserve 提供，避免反复扩容
+            const auto used = out_.size();
+            const auto room = INFLATE_CHUNK;
+            out_.resize(used + room);
+            zs_.next_out = reinterpret_cast<Bytef *>(&out_[used]);
+            zs_.avail_out = static_cast<uInt>(room);
+
+            const auto ret = inflate(&zs_, Z_NO_FLUSH);
+            out_.resize(used + room - zs_.avail_out);
+
+            if (ret == Z_STREAM_END)
+            {
+                done_ = true;
+                break;
+            }
+
+            if (ret != Z_OK)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool finish() override
+    {
+        return done_;
+    }
+
+private:
+    bool init(const char *data, size_t length)
+    {
+        int window_bits = 15 + 16;
+
+        if (!gzip_)
+        {
+            // deflate 编码按规范应带 zlib 头，但也有服务端发送裸 deflate 数据
+            const auto cmf = static_cast<unsigned char>(data[0]);
+            const auto flg = (length > 1) ? static_cast<unsigned char>(data[1]) : 0;
+            const bool zlib_header = (cmf & 0x0f) == 8 && ((cmf << 8) | flg) % 31 == 0;
+            window_bits = zlib_header ? 15 : -15;
+        }
+
+        initialized_ = (inflateInit2(&zs_, window_bits) == Z_OK);
+        return initialized_;
+    }
+
+private:
+    z_stream zs_;
+    std::string &out_;
+    bool gzip_;
+    bool initialized_;
+    bool done_;
+};
+
+
+/*!
+ * \brief       把解码后的数据逐段交给回调函数，不在响应体中保留。
+ */
+class chunk_sink : public body_sink
+{
+public:
+    chunk_sink(std::unique_ptr<body_sink> inner, std::string &out, const chunk_callback &on_chunk)
+        : inner_(std::move(inner))
+        , out_(out)
+        , on_chunk_(on_chunk)
+    {
+    }
+
+    bool write(const char *data, size_t length) override
+    {
+        if (!inner_->write(data, length))
+        {
+            return false;
+        }
+
+        flush();
+        return true;
+    }
+
+    bool finish() override
+    {
+        const bool ok = inner_->finish();
+        flush();
+        return ok;
+    }
+
+private:
+    void flush()
+    {
+        if (!out_.empty())
+        {
+            on_chunk_(out_);
+            out_.clear();
+        }
+    }
+
+private:
+    std::unique_ptr<body_sink> inner_;
+    std::string &out_;
+    chunk_callback on_chunk_;
+};
+
+
+std::unique_ptr<body_sink> make_body_sink(const std::string &encoding, std::string &out,
+                                          size_t size_hint, const chunk_callback &on_chunk)
+{
+    if (on_chunk)
+    {
+        // 数据不在 out 中累积，不需要按响应体长度预留空间
+        auto inner = make_body_sink(encoding, out, 0);
+        return inner ? std::make_unique<chunk_sink>(std::move(inner), out, on_chunk) : nullptr;
+    }
+
+    auto value = encoding;
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (value.empty() || value == "identity")
+    {
+        out.reserve(out.size() + size_hint);
+        return std::make_unique<string_sink>(out);
+    }
+
+    if (value == "gzip" || value == "x-gzip")
+    {
+        return std::make_unique<inflate_sink>(out, true, size_hint);
+    }
+
+    if (value == "deflate")
+    {
+        return std::make_unique<inflate_sink>(out, false, size_hint);
+    }
+
+    return {};
+}
+
+
+}       // namespace http
@@ -0,0 +1,91 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        body_sink.h
+ * \brief       响应体接收类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+
+
+namespace http {
+
+
+/// 响应体数据回调函数，与 `ix::OnChunkCallback` 相同。
+using chunk_callback = std::function<void(const std::string &)>;
+
+
+/*!
+ * \brief       响应体接收接口。传输层每收到一段响应体数据就调用一次 `write`。
+ */
+class body_sink : private noncopyable
+{
+public:
+    virtual ~body_sink() = default;
+
+    /*!
+     * \brief       写入一段数据。
+     *
+     * \param[in]   data        数据
+     * \param[in]   length      数据长度
+     *
+     * \return      如果成功，则返回 `true`；否则返回 `false`，传输层停止读取。
+     */
+    virtual bool write(const char *data, size_t length) = 0;
+
+    /*!
+     * \brief       响应体已接收完毕。
+     *
+     * \return      如果数据完整，则返回 `true`；否则返回 `false`。
+     */
+    virtual bool finish() { return true; }
+};
+
+
+/*!
+ * \brief       将响应体原样追加到字符串。
+ */
+class string_sink : public body_sink
+{
+public:
+    explicit string_sink(std::string &out) : out_(out) { }
+
+    bool write(const char *data, size_t length) override
+    {
+        out_.append(data, length);
+        return true;
+    }
+
+private:
+    std::string &out_;
+};
+
+
+/*!
+ * \brief       根据 Content-Encoding 创建接收对象。
+ *
+ * gzip 与 deflate 编码的响应体在到达时即被流式解压，直接写入 `out`，不保留压缩数据的完整副本。
+ * 指定了 `on_chunk` 时，解码后的数据逐段交给回调函数，`out` 只作为临时缓冲区，最终为空。
+ *
+ * \param[in]   encoding        Content-Encoding 的值，可以为空
+ * \param[out]  out             解码后的响应体
+ * \param[in]   size_hint       压缩数据的长度，未知时为零
+ * \param[in]   on_chunk        数据回调函数，可以为空
+ *
+ * \return      接收对象；如果不支持该编码，则返回空指针。
+ */
+std::unique_ptr<body_sink> make_body_sink(const std::string &encoding, std::string &out,
+                                          size_t size_hint, const chunk_callback &on_chunk = nullptr);
+
+
+}       // namespace http
@@ -0,0 +1,77 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        buffer_pool.cpp
+ * \brief       buffer_pool 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "buffer_pool.h"
+
+
+/// 新缓冲区的初始容量。
+static constexpr size_t INITIAL_CAPACITY = 16 * 1024;
+/// 值得保留的最小容量。
+static constexpr size_t MIN_CAPACITY = 1024;
+/// 保留的最大容量，更大的缓冲区归还时释放，避免一次大响应长期占用内存。
+static constexpr size_t MAX_CAPACITY = 1024 * 1024;
+/// 池中最多保留的缓冲区数。
+static constexpr size_t MAX_BUFFERS = 16;
+
+
+buffer_pool &buffer_pool::instance()
+{
+    static buffer_pool pool;
+    return pool;
+}
+
+
+std::string buffer_pool::acquire()
+{
+    {
+        std::lock_guard lock(mutex_);
+
+        if (!buffers_.empty())
+        {
+            auto buffer = std::move(buffers_.back());
+            buffers_.pop_back();
+            return buffer;
+        }
+    }
+
+    std::string buffer;
+    buffer.reserve(INITIAL_CAPACITY);
+    return buffer;
+}
+
+
+void buffer_pool::release(std::string &&buffer)
+{
+    const auto capacity = buffer.capacity();
+
+    if (capacity >= MIN_CAPACITY && capacity <= MAX_CAPACITY)
+    {
+        buffer.clear();
+        std::lock_guard lock(mutex_);
+
+        if (buffers_.size() < MAX_BUFFERS)
+        {
+            buffers_.push_back(std::move(buffer));
+            return;
+        }
+    }
+
+    std::string().swap(buffer);
+}
+
+
+void buffer_pool::clear()
+{
+    std::lock_guard lock(mutex_);
+    buffers_.clear();
+    buffers_.shrink_to_fit();
+}
@@ -0,0 +1,70 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        buffer_pool.h
+ * \brief       buffer_pool 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+/*!
+ * \brief       接收缓冲区池。
+ *
+ * 响应体接收到池中取出的字符串里，由 `rapidjson::Document::ParseInsitu` 原地解析，处理完毕后
+ * 归还，保留已分配的容量供下一个请求使用。稳定状态下接收与解析响应不再分配缓冲区。
+ */
+class buffer_pool : private noncopyable
+{
+public:
+    /// 获取全局缓冲池。
+    static buffer_pool &instance();
+
+    /*!
+     * \brief       取出一个空的缓冲区。
+     *
+     * \return      缓冲区；池为空时返回预留了初始容量的新字符串。
+     */
+    std::string acquire();
+
+    /*!
+     * \brief       归还缓冲区。容量过小或过大的缓冲区、超出数量限制的缓冲区直接释放。
+     *
+     * \param[in]   buffer      缓冲区
+     */
+    void release(std::string &&buffer);
+
+    /// 释放池中的所有缓冲区。
+    void clear();
+
+private:
+    buffer_pool() = default;
+
+private:
+    std::mutex mutex_;
+    std::vector<std::string> buffers_;
+};
+
+
+/*!
+ * \brief       作用域结束时把字符串的存储归还缓冲池。
+ */
+class buffer_recycler : private noncopyable
+{
+public:
+    explicit buffer_recycler(std::string &buffer) : buffer_(buffer) { }
+    ~buffer_recycler() { buffer_pool::instance().release(std::move(buffer_)); }
+
+private:
+    std::string &buffer_;
+};
@@ -0,0 +1,166 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        call_context.cpp
+ * \brief       调用上下文源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "call_context.h"
+
+#include <algorithm>
+#include <thread>
+
+
+namespace kaixin {
+
+
+/// 默认超时，毫秒。
+static std::atomic_int g_default_timeout_ms = 60000;
+/// 当前线程的调用选项。
+static thread_local call_options t_options;
+
+
+void cancel_state::cancel()
+{
+    std::map<int, std::function<void()>> callbacks;
+
+    {
+        std::lock_guard lock(mutex_);
+
+        if (cancelled_.exchange(true))
+        {
+            return;
+        }
+
+        callbacks.swap(callbacks_);
+    }
+
+    cond_.notify_all();
+
+    for (auto &[id, callback] : callbacks)
+    {
+        callback();
+    }
+}
+
+
+int cancel_state::subscribe(std::function<void()> callback)
+{
+    {
+        std::lock_guard lock(mutex_);
+
+        if (!cancelled_)
+        {
+            auto id = next_id_++;
+            callbacks_.emplace(id, std::move(callback));
+            return id;
+        }
+    }
+
+    callback();
+    return -1;
+}
+
+
+void cancel_state::unsubscribe(int id)
+{
+    std::lock_guard lock(mutex_);
+    callbacks_.erase(id);
+}
+
+
+bool cancel_state::wait_until(std::chrono::steady_clock::time_point until)
+{
+    std::unique_lock lock(mutex_);
+    return cond_.wait_until(lock, until, [this] { return cancelled_.load(); });
+}
+
+
+call_context call_context::current()
+{
+    return make((t_options.timeout_ms < 0) ? g_default_timeout_ms.load() : t_options.timeout_ms);
+}
+
+
+call_context call_context::current_explicit()
+{
+    return make(t_options.timeout_ms);
+}
+
+
+call_context call_context::make(int timeout_ms)
+{
+    call_context ctx;
+    ctx.cancel_ = t_options.cancel;
+    ctx.deadline_ = t_options.deadline;
+    ctx.anonymous_ = t_options.anonymous;
+
+    if (timeout_ms > 0)
+    {
+        ctx.deadline_ = std::min(ctx.deadline_, clock::now() + std::chrono::milliseconds(timeout_ms));
+    }
+
+    return ctx;
+}
+
+
+int call_context::default_timeout_ms()
+{
+    return g_default_timeout_ms;
+}
+
+
+void call_context::set_default_timeout_ms(int timeout_ms)
+{
+    g_default_timeout_ms = timeout_ms;
+}
+
+
+call_options call_context::thread_options()
+{
+    return t_options;
+}
+
+
+void call_context::set_thread_options(const call_options &options)
+{
+    t_options = options;
+}
+
+
+bool call_context::sleep_for(std::chrono::milliseconds delay) const
+{
+    const auto now = clock::now();
+    const auto until = (deadline_ - now > delay) ? now + delay : deadline_;
+
+    if (cancel_)
+    {
+        if (cancel_->wait_until(until))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        std::this_thread::sleep_until(until);
+    }
+
+    return until < deadline_;
+}
+
+
+ix::CancellationRequest call_context::make_cancellation_request() const
+{
+    return [deadline = deadline_, cancel = cancel_]
+    {
+        return (cancel && cancel->is_cancelled()) || clock::now() >= deadline;
+    };
+}
+
+
+}       // namespace kaixin
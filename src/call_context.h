@@ -0,0 +1,187 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        call_context.h
+ * \brief       调用上下文头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <ixwebsocket/IXCancellationRequest.h>
+
+
+namespace kaixin {
+
+
+/*!
+ * \brief       取消状态，由取消令牌与使用该令牌的调用共享。
+ */
+class cancel_state : private noncopyable
+{
+public:
+    cancel_state() = default;
+
+    /// 取消。唤醒所有等待者，并调用所有订阅的回调函数。
+    void cancel();
+
+    /// 是否已取消。
+    bool is_cancelled() const { return cancelled_.load(); }
+
+    /*!
+     * \brief       订阅取消事件。
+     *
+     * \param[in]   callback    取消时调用的函数，在调用 `cancel` 的线程中执行
+     *
+     * \return      订阅编号，用于取消订阅；如果已经取消，则立即调用 `callback` 并返回 -1。
+     */
+    int subscribe(std::function<void()> callback);
+
+    /*!
+     * \brief       取消订阅。
+     *
+     * \param[in]   id          订阅编号
+     */
+    void unsubscribe(int id);
+
+    /*!
+     * \brief       等待取消，直到指定时间。
+     *
+     * \param[in]   until       截止时间
+     *
+     * \return      如果已取消，则返回 `true`；如果超时，则返回 `false`。
+     */
+    bool wait_until(std::chrono::steady_clock::time_point until);
+
+private:
+    std::atomic_bool cancelled_ = false;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::map<int, std::function<void()>> callbacks_;
+    int next_id_ = 0;
+};
+
+
+/// 线程调用选项。
+struct call_options
+{
+    using clock = std::chrono::steady_clock;
+
+    int timeout_ms = -1;                        ///< 超时，毫秒；负数表示使用默认超时，零表示不限制
+    clock::time_point deadline = clock::time_point::max();     ///< 绝对截止时间
+    std::shared_ptr<cancel_state> cancel;       ///< 取消令牌，可以为空
+    bool anonymous = false;                     ///< 匿名调用，请求不附带访问令牌与身份令牌
+};
+
+
+/*!
+ * \brief       调用上下文：一次 API 调用的截止时间、取消令牌与是否匿名。
+ *
+ * 在调用开始时由 `current` 根据当前线程的调用选项与默认超时生成，之后随请求传递给重试、
+ * 连接、TLS 握手、发送与接收各个阶段。
+ */
+class call_context
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    /// 根据当前线程的调用选项生成上下文。
+    static call_context current();
+
+    /*!
+     * \brief       根据当前线程的调用选项生成上下文，不使用默认超时。
+     *
+     * 只有调用者为本次调用明确设置的超时、截止时间与取消令牌有效，用于在调用返回后仍在后台
+     * 继续的工作，例如下行通知的注册：默认超时不应在调用返回很久之后使其停止。
+     */
+    static call_context current_explicit();
+
+    /// 获取默认超时，毫秒；零表示不限制。
+    static int default_timeout_ms();
+
+    /// 设置默认超时，毫秒；零表示不限制。
+    static void set_default_timeout_ms(int timeout_ms);
+
+    /// 获取当前线程的调用选项。
+    static call_options thread_options();
+
+    /// 设置当前线程的调用选项。
+    static void set_thread_options(const call_options &options);
+
+    /// 截止时间。
+    clock::time_point deadline() const { return deadline_; }
+
+    /// 取消状态，可以为空。
+    const std::shared_ptr<cancel_state> &cancel() const { return cancel_; }
+
+    /// 是否匿名调用。匿名调用的请求不附带访问令牌与身份令牌。
+    bool anonymous() const { return anonymous_; }
+
+    /// 是否已取消。
+    bool is_cancelled() const { return cancel_ && cancel_->is_cancelled(); }
+
+    /// 是否已超时。
+    bool is_expired() const { return clock::now() >= deadline_; }
+
+    /// 是否已取消或超时。
+    bool is_done() const { return is_cancelled() || is_expired(); }
+
+    /*!
+     * \brief       等待一段时间，取消或超时时提前返回。
+     *
+     * \param[in]   delay       等待时长
+     *
+     * \return      如果等待完整个时长，则返回 `true`；如果被取消或超时，则返回 `false`。
+     */
+    bool sleep_for(std::chrono::milliseconds delay) const;
+
+    /// 生成供 ixwebsocket 连接、读写使用的取消请求。
+    ix::CancellationRequest make_cancellation_request() const;
+
+private:
+    // 根据当前线程的调用选项与给定的超时生成上下文
+    static call_context make(int timeout_ms);
+
+private:
+    clock::time_point deadline_ = clock::time_point::max();
+    std::shared_ptr<cancel_state> cancel_;
+    bool anonymous_ = false;
+};
+
+
+/*!
+ * \brief       在作用域内替换当前线程的调用选项，离开作用域时恢复。
+ */
+class call_options_scope : private noncopyable
+{
+public:
+    explicit call_options_scope(const call_options &options)
+        : saved_(call_context::thread_options())
+    {
+        call_context::set_thread_options(options);
+    }
+
+    ~call_options_scope()
+    {
+        call_context::set_thread_options(saved_);
+    }
+
+private:
+    call_options saved_;
+};
+
+
+}       // namespace kaixin
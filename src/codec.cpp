@@ -0,0 +1,615 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        codec.cpp
+ * \brief       编解码函数源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "codec.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CODEC_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CODEC_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(CODEC_X86) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define CODEC_SSE2 1
+#endif
+
+#if defined(CODEC_X86) && (defined(_MSC_VER) || defined(__GNUC__))
+#define CODEC_AVX2 1
+#endif
+
+// GCC 与 Clang 需要为单个函数启用 AVX2 指令；MSVC 可以直接使用
+#if defined(CODEC_AVX2) && defined(__GNUC__)
+#define CODEC_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CODEC_TARGET_AVX2
+#endif
+
+
+namespace codec {
+
+
+static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+static constexpr char HEX_DIGITS_UPPER[] = "0123456789ABCDEF";
+static constexpr char BASE64URL_ALPHABET[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+
+// 一组编码实现。每个函数处理尽可能多的完整数据块，返回已处理的输入长度，剩余部分由标量代码处理。
+struct kernels
+{
+    const char *name;
+    size_t (*hex)(const uint8_t *in, size_t length, char *out);
+    size_t (*base64url)(const uint8_t *in, size_t length, char *out);
+    size_t (*unreserved)(const char *in, size_t length);        // 开头连续的不需要 URL 编码的字符数
+};
+
+
+// 不需要 URL 编码的字符
+static inline bool is_unreserved(unsigned char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+        || c == '-' || c == '_' || c == '.' || c == '~';
+}
+
+
+static inline unsigned count_trailing_zeros(uint32_t x)
+{
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward(&index, x);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(x));
+#endif
+}
+
+
+/*
+ * 标量实现：不处理任何数据块，全部交给标量代码
+ */
+#if !defined(CODEC_SSE2) && !defined(CODEC_NEON)
+static size_t hex_scalar(const uint8_t *, size_t, char *)
+{
+    return 0;
+}
+
+
+static size_t unreserved_scalar(const char *, size_t)
+{
+    return 0;
+}
+#endif
+
+#ifndef CODEC_NEON
+static size_t base64url_scalar(const uint8_t *, size_t, char *)
+{
+    return 0;
+}
+#endif
+
+
+/*
+ * SSE2 实现
+ */
+#ifdef CODEC_SSE2
+// 把 0～15 转换为十六进制数字
+static inline __m128i hex_digits_sse2(__m128i nibbles)
+{
+    const auto letters = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9));
+    const auto offset = _mm_and_si128(letters, _mm_set1_epi8('a' - '0' - 10));
+    return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), offset);
+}
+
+
+static size_t hex_sse2(const uint8_t *in, size_t length, char *out)
+{
+    const auto mask = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+
+    for (; i + 16 <= length; i += 16)
+    {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        const auto hi = hex_digits_sse2(_mm_and_si128(_mm_srli_epi16(v, 4), mask));
+        const auto lo = hex_digits_sse2(_mm_and_si128(v, mask));
+        auto *dst = reinterpret_cast<__m128i *>(out + i * 2);
+        _mm_storeu_si128(dst, _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(dst + 1, _mm_unpackhi_epi8(hi, lo));
+    }
+
+    return i;
+}
+
+
+// 判断 c 是否在 [lo, hi] 范围内。大于 0x7f 的字节按有符号数比较为负数，不在任何范围内。
+static inline __m128i in_range_sse2(__m128i c, char lo, char hi)
+{
+    return _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8(static_cast<char>(lo - 1))),
+                         _mm_cmplt_epi8(c, _mm_set1_epi8(static_cast<char>(hi + 1))));
+}
+
+
+static size_t unreserved_sse2(const char *in, size_t length)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= length; i += 16)
+    {
+        const auto c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        // 字母统一转换为小写后判断
+        auto ok = in_range_sse2(_mm_or_si128(c, _mm_set1_epi8(0x20)), 'a', 'z');
+        ok = _mm_or_si128(ok, in_range_sse2(c, '0', '9'));
+        ok = _mm_or_si128(ok, _mm_cmpeq_epi8(c, _mm_set1_epi8('-')));
+        ok = _mm_or_si128(ok, _mm_cmpeq_epi8(c, _mm_set1_epi8('_')));
+        ok = _mm_or_si128(ok, _mm_cmpeq_epi8(c, _mm_set1_epi8('.')));
+        ok = _mm_or_si128(ok, _mm_cmpeq_epi8(c, _mm_set1_epi8('~')));
+        const auto bits = static_cast<uint32_t>(_mm_movemask_epi8(ok));
+
+        if (bits != 0xffff)
+        {
+            return i + count_trailing_zeros(~bits);
+        }
+    }
+
+    return i;
+}
+#endif
+
+
+/*
+ * AVX2 实现
+ */
+#ifdef CODEC_AVX2
+CODEC_TARGET_AVX2 static inline __m256i hex_digits_avx2(__m256i nibbles)
+{
+    const auto letters = _mm256_cmpgt_epi8(nibbles, _mm256_set1_epi8(9));
+    const auto offset = _mm256_and_si256(letters, _mm256_set1_epi8('a' - '0' - 10));
+    return _mm256_add_epi8(_mm256_add_epi8(nibbles, _mm256_set1_epi8('0')), offset);
+}
+
+
+CODEC_TARGET_AVX2 static size_t hex_avx2(const uint8_t *in, size_t length, char *out)
+{
+    const auto mask = _mm256_set1_epi8(0x0f);
+    size_t i = 0;
+
+    for (; i + 32 <= length; i += 32)
+    {
+        const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+        const auto hi = hex_digits_avx2(_mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+        const auto lo = hex_digits_avx2(_mm256_and_si256(v, mask));
+        // unpack 在每个 128 位通道内进行，需要再交换通道恢复顺序
+        const auto a = _mm256_unpacklo_epi8(hi, lo);
+        const auto b = _mm256_unpackhi_epi8(hi, lo);
+        auto *dst = reinterpret_cast<__m256i *>(out + i * 2);
+        _mm256_storeu_si256(dst, _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256(dst + 1, _mm256_permute2x128_si256(a, b, 0x31));
+    }
+
+    return i;
+}
+
+
+// 每次把 24 字节编码为 32 个字符，方法见 Wojciech Muła 的“Base64 encoding with SIMD instructions”。
+CODEC_TARGET_AVX2 static size_t base64url_avx2(const uint8_t *in, size_t length, char *out)
+{
+    // 每个通道内把 3 字节一组重排为 4 个 16 位的 [b1, b0, b2, b1]
+    const auto shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                          1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    // 按索引所在区间查找到字符的偏移
+    const auto offsets = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '-' - 62,
+                                          '_' - 63, 'A', 0, 0,
+                                          'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '-' - 62,
+                                          '_' - 63, 'A', 0, 0);
+    size_t i = 0;
+    size_t o = 0;
+
+    // 高通道从第 12 字节开始读 16 字节，因此至少需要 28 字节
+    for (; i + 28 <= length; i += 24, o += 32)
+    {
+        const auto lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        const auto hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 12));
+        auto v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        v = _mm256_shuffle_epi8(v, shuffle);
+
+        // 拆分出 4 个 6 位索引
+        const auto t0 = _mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00));
+        const auto t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        const auto t2 = _mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0));
+        const auto t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        const auto indices = _mm256_or_si256(t1, t3);
+
+        // 0～25 映射为 13，26～51 映射为 0，52～63 映射为 1～12
+        auto ranges = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        const auto upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        ranges = _mm256_or_si256(ranges, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+        const auto chars = _mm256_add_epi8(indices, _mm256_shuffle_epi8(offsets, ranges));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + o), chars);
+    }
+
+    return i;
+}
+
+
+CODEC_TARGET_AVX2 static inline __m256i in_range_avx2(__m256i c, char lo, char hi)
+{
+    return _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8(static_cast<char>(lo - 1))),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi + 1)), c));
+}
+
+
+CODEC_TARGET_AVX2 static size_t unreserved_avx2(const char *in, size_t length)
+{
+    size_t i = 0;
+
+    for (; i + 32 <= length; i += 32)
+    {
+        const auto c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+        auto ok = in_range_avx2(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), 'a', 'z');
+        ok = _mm256_or_si256(ok, in_range_avx2(c, '0', '9'));
+        ok = _mm256_or_si256(ok, _mm256_cmpeq_epi8(c, _mm256_set1_epi8('-')));
+        ok = _mm256_or_si256(ok, _mm256_cmpeq_epi8(c, _mm256_set1_epi8('_')));
+        ok = _mm256_or_si256(ok, _mm256_cmpeq_epi8(c, _mm256_set1_epi8('.')));
+        ok = _mm256_or_si256(ok, _mm256_cmpeq_epi8(c, _mm256_set1_epi8('~')));
+        const auto bits = static_cast<uint32_t>(_mm256_movemask_epi8(ok));
+
+        if (bits != 0xffffffffu)
+        {
+            return i + count_trailing_zeros(~bits);
+        }
+    }
+
+    return i;
+}
+
+
+// 检测 CPU 与操作系统是否支持 AVX2
+static bool has_avx2()
+{
+#ifdef _MSC_VER
+    int info[4] = { 0 };
+    __cpuid(info, 0);
+
+    if (info[0] < 7)
+    {
+        return false;
+    }
+
+    // 操作系统需要保存 YMM 寄存器
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+    {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif
+
+
+/*
+ * NEON 实现
+ */
+#ifdef CODEC_NEON
+static size_t hex_neon(const uint8_t *in, size_t length, char *out)
+{
+    const auto table = vld1q_u8(reinterpret_cast<const uint8_t *>(HEX_DIGITS));
+    size_t i = 0;
+
+    for (; i + 16 <= length; i += 16)
+    {
+        const auto v = vld1q_u8(in + i);
+        uint8x16x2_t digits;
+        digits.val[0] = vqtbl1q_u8(table, vshrq_n_u8(v, 4));
+        digits.val[1] = vqtbl1q_u8(table, vandq_u8(v, vdupq_n_u8(0x0f)));
+        // 交错存储高低半字节
+        vst2q_u8(reinterpret_cast<uint8_t *>(out + i * 2), digits);
+    }
+
+    return i;
+}
+
+
+// 每次把 48 字节编码为 64 个字符
+static size_t base64url_neon(const uint8_t *in, size_t length, char *out)
+{
+    const auto *alphabet = reinterpret_cast<const uint8_t *>(BASE64URL_ALPHABET);
+    uint8x16x4_t table;
+    table.val[0] = vld1q_u8(alphabet);
+    table.val[1] = vld1q_u8(alphabet + 16);
+    table.val[2] = vld1q_u8(alphabet + 32);
+    table.val[3] = vld1q_u8(alphabet + 48);
+
+    size_t i = 0;
+    size_t o = 0;
+
+    for (; i + 48 <= length; i += 48, o += 64)
+    {
+        // 按 3 字节一组解交错读取
+        const auto v = vld3q_u8(in + i);
+        uint8x16x4_t indices;
+        indices.val[0] = vshrq_n_u8(v.val[0], 2);
+        indices.val[1] = vorrq_u8(vshlq_n_u8(vandq_u8(v.val[0], vdupq_n_u8(0x03)), 4),
+                                  vshrq_n_u8(v.val[1], 4));
+        indices.val[2] = vorrq_u8(vshlq_n_u8(vandq_u8(v.val[1], vdupq_n_u8(0x0f)), 2),
+                                  vshrq_n_u8(v.val[2], 6));
+        indices.val[3] = vandq_u8(v.val[2], vdupq_n_u8(0x3f));
+
+        uint8x16x4_t chars;
+        chars.val[0] = vqtbl4q_u8(table, indices.val[0]);
+        chars.val[1] = vqtbl4q_u8(table, indices.val[1]);
+        chars.val[2] = vqtbl4q_u8(table, indices.val[2]);
+        chars.val[3] = vqtbl4q_u8(table, indices.val[3]);
+        vst4q_u8(reinterpret_cast<uint8_t *>(out + o), chars);
+    }
+
+    return i;
+}
+
+
+static inline uint8x16_t in_range_neon(uint8x16_t c, uint8_t lo, uint8_t hi)
+{
+    return vandq_u8(vcgeq_u8(c, vdupq_n_u8(lo)), vcleq_u8(c, vdupq_n_u8(hi)));
+}
+
+
+static size_t unreserved_neon(const char *in, size_t length)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= length; i += 16)
+    {
+        const auto c = vld1q_u8(reinterpret_cast<const uint8_t *>(in + i));
+        auto ok = in_range_neon(vorrq_u8(c, vdupq_n_u8(0x20)), 'a', 'z');
+        ok = vorrq_u8(ok, in_range_neon(c, '0', '9'));
+        ok = vorrq_u8(ok, vceqq_u8(c, vdupq_n_u8('-')));
+        ok = vorrq_u8(ok, vceqq_u8(c, vdupq_n_u8('_')));
+        ok = vorrq_u8(ok, vceqq_u8(c, vdupq_n_u8('.')));
+        ok = vorrq_u8(ok, vceqq_u8(c, vdupq_n_u8('~')));
+
+        if (vminvq_u8(ok) != 0xff)
+        {
+            // 本块中有需要编码的字符，由标量代码定位
+            return i;
+        }
+    }
+
+    return i;
+}
+#endif
+
+
+// 根据 CPU 特性选择实现
+static kernels select_kernels()
+{
+#ifdef CODEC_AVX2
+    if (has_avx2())
+    {
+        return { "avx2", hex_avx2, base64url_avx2, unreserved_avx2 };
+    }
+#endif
+
+#if defined(CODEC_SSE2)
+    // SSE2 没有字节查表指令，Base64Url 使用标量实现
+    return { "sse2", hex_sse2, base64url_scalar, unreserved_sse2 };
+#elif defined(CODEC_NEON)
+    return { "neon", hex_neon, base64url_neon, unreserved_neon };
+#else
+    return { "scalar", hex_scalar, base64url_scalar, unreserved_scalar };
+#endif
+}
+
+
+static const kernels &active()
+{
+    static const kernels k = select_kernels();
+    return k;
+}
+
+
+// Base64Url 字符到 6 位值的映射，非法字符为 0xff
+struct base64url_table
+{
+    base64url_table()
+    {
+        for (auto &v : values)
+        {
+            v = 0xff;
+        }
+
+        for (uint8_t i = 0; i < 64; i++)
+        {
+            values[static_cast<unsigned char>(BASE64URL_ALPHABET[i])] = i;
+        }
+    }
+
+    uint8_t values[256];
+};
+
+
+void hex_encode(char *out, const uint8_t *data, size_t length)
+{
+    auto i = active().hex(data, length, out);
+
+    for (; i < length; i++)
+    {
+        out[i * 2] = HEX_DIGITS[data[i] >> 4];
+        out[i * 2 + 1] = HEX_DIGITS[data[i] & 0x0f];
+    }
+}
+
+
+void hex_encode(std::string &out, const uint8_t *data, size_t length)
+{
+    const auto start = out.size();
+    out.resize(start + length * 2);
+    hex_encode(&out[start], data, length);
+}
+
+
+std::string to_hex(const uint8_t *data, size_t length)
+{
+    std::string out;
+    hex_encode(out, data, length);
+    return out;
+}
+
+
+void base64url_encode(std::string &out, const uint8_t *data, size_t length)
+{
+    const auto start = out.size();
+    out.resize(start + (length * 4 + 2) / 3);
+    auto *dst = &out[start];
+
+    auto i = active().base64url(data, length, dst);
+    dst += i / 3 * 4;
+
+    for (; i + 3 <= length; i += 3)
+    {
+        const uint32_t n = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        *dst++ = BASE64URL_ALPHABET[(n >> 18) & 0x3f];
+        *dst++ = BASE64URL_ALPHABET[(n >> 12) & 0x3f];
+        *dst++ = BASE64URL_ALPHABET[(n >> 6) & 0x3f];
+        *dst++ = BASE64URL_ALPHABET[n & 0x3f];
+    }
+
+    // 剩余 1 或 2 字节，不补“=”
+    if (i + 1 == length)
+    {
+        const uint32_t n = data[i] << 16;
+        *dst++ = BASE64URL_ALPHABET[(n >> 18) & 0x3f];
+        *dst++ = BASE64URL_ALPHABET[(n >> 12) & 0x3f];
+    }
+    else if (i + 2 == length)
+    {
+        const uint32_t n = (data[i] << 16) | (data[i + 1] << 8);
+        *dst++ = BASE64URL_ALPHABET[(n >> 18) & 0x3f];
+        *dst++ = BASE64URL_ALPHABET[(n >> 12) & 0x3f];
+        *dst++ = BASE64URL_ALPHABET[(n >> 6) & 0x3f];
+    }
+}
+
+
+std::string base64url_encode(const std::string &s)
+{
+    std::string out;
+    base64url_encode(out, reinterpret_cast<const uint8_t *>(s.data()), s.size());
+    return out;
+}
+
+
+size_t base64url_decode(const char *data, size_t length, uint8_t *out)
+{
+    static const base64url_table table;
+    const auto *in = reinterpret_cast<const unsigned char *>(data);
+
+    if (length % 4 == 1)
+    {
+        return npos;
+    }
+
+    auto *dst = out;
+    size_t i = 0;
+
+    for (; i + 4 <= length; i += 4)
+    {
+        const uint32_t a = table.values[in[i]];
+        const uint32_t b = table.values[in[i + 1]];
+        const uint32_t c = table.values[in[i + 2]];
+        const uint32_t d = table.values[in[i + 3]];
+
+        if (((a | b | c | d) & 0x80) != 0)
+        {
+            return npos;
+        }
+
+        const auto n = (a << 18) | (b << 12) | (c << 6) | d;
+        *dst++ = static_cast<uint8_t>(n >> 16);
+        *dst++ = static_cast<uint8_t>(n >> 8);
+        *dst++ = static_cast<uint8_t>(n);
+    }
+
+    if (i < length)
+    {
+        // 剩余 2 或 3 个字符
+        const uint32_t a = table.values[in[i]];
+        const uint32_t b = table.values[in[i + 1]];
+        const uint32_t c = (i + 2 < length) ? table.values[in[i + 2]] : 0;
+
+        if (((a | b | c) & 0x80) != 0)
+        {
+            return npos;
+        }
+
+        const auto n = (a << 18) | (b << 12) | (c << 6);
+        *dst++ = static_cast<uint8_t>(n >> 16);
+
+        if (i + 2 < length)
+        {
+            *dst++ = static_cast<uint8_t>(n >> 8);
+        }
+    }
+
+    return static_cast<size_t>(dst - out);
+}
+
+
+void url_encode(std::string &out, const char *data, size_t length)
+{
+    const auto &k = active();
+    size_t i = 0;
+
+    while (i < length)
+    {
+        // 成段复制不需要编码的字符
+        auto run = k.unreserved(data + i, length - i);
+
+        while (i + run < length && is_unreserved(static_cast<unsigned char>(data[i + run])))
+        {
+            run++;
+        }
+
+        out.append(data + i, run);
+        i += run;
+
+        if (i < length)
+        {
+            const auto c = static_cast<unsigned char>(data[i++]);
+            out += '%';
+            out += HEX_DIGITS_UPPER[c >> 4];
+            out += HEX_DIGITS_UPPER[c & 0x0f];
+        }
+    }
+}
+
+
+const char *implementation()
+{
+    return active().name;
+}
+
+
+}       // namespace codec
@@ -0,0 +1,143 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        codec.h
+ * \brief       编解码函数头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+/*!
+ * \brief       十六进制、Base64Url 与 URL 编解码。
+ *
+ * 内部按运行时检测到的 CPU 特性选择 AVX2、SSE2 或 NEON 实现，不支持时使用标量实现；
+ * 各实现的输出完全相同。所有函数都是线程安全的。
+ */
+namespace codec {
+
+
+/// `base64url_decode` 失败时的返回值。
+constexpr size_t npos = static_cast<size_t>(-1);
+
+
+/*!
+ * \brief       十六进制编码（小写）。
+ *
+ * \param[out]  out         输出缓冲区，至少 `length * 2` 字节，不添加结尾的 '\0'
+ * \param[in]   data        二进制数据
+ * \param[in]   length      数据长度，以字节为单位
+ */
+void hex_encode(char *out, const uint8_t *data, size_t length);
+
+
+/*!
+ * \brief       十六进制编码（小写），追加到字符串末尾。
+ *
+ * \param[in,out] out       输出字符串
+ * \param[in]   data        二进制数据
+ * \param[in]   length      数据长度，以字节为单位
+ */
+void hex_encode(std::string &out, const uint8_t *data, size_t length);
+
+
+/*!
+ * \brief       十六进制编码（小写）。
+ *
+ * \param[in]   data        二进制数据
+ * \param[in]   length      数据长度，以字节为单位
+ *
+ * \return      十六进制字符串，长度为 `length * 2`。
+ */
+std::string to_hex(const uint8_t *data, size_t length);
+
+
+/*!
+ * \brief       Base64Url 编码（不补“=”），追加到字符串末尾。
+ *
+ * \param[in,out] out       输出字符串
+ * \param[in]   data        二进制数据
+ * \param[in]   length      数据长度，以字节为单位
+ */
+void base64url_encode(std::string &out, const uint8_t *data, size_t length);
+
+
+/*!
+ * \brief       Base64Url 编码（不补“=”）。
+ *
+ * \param[in]   s           二进制数据
+ *
+ * \return      编码后的字符串。
+ */
+std::string base64url_encode(const std::string &s);
+
+
+/*!
+ * \brief       Base64Url 解码（不补“=”）。
+ *
+ * \param[in]   data        编码后的字符串
+ * \param[in]   length      字符串长度
+ * \param[out]  out         输出缓冲区，至少 `length / 4 * 3 + 2` 字节
+ *
+ * \return      解码后的长度；如果含有非法字符或长度不正确，则返回 `npos`。
+ */
+size_t base64url_decode(const char *data, size_t length, uint8_t *out);
+
+
+/*!
+ * \brief       Base64Url 解码（不补“=”）。
+ *
+ * \tparam      Result      结果类型，`std::string` 或 `std::vector<uint8_t>`
+ *
+ * \param[in]   encoded     编码后的字符串
+ * \param[out]  out         解码后的数据；失败时为空
+ *
+ * \return      如果成功，则返回 `true`；否则返回 `false`。
+ */
+template<typename Result>
+bool base64url_decode(const std::string &encoded, Result &out)
+{
+    out.resize(encoded.size() / 4 * 3 + 2);
+    const auto length = base64url_decode(encoded.data(), encoded.size(),
+                                         reinterpret_cast<uint8_t *>(&out[0]));
+
+    if (length == npos)
+    {
+        out.clear();
+        return false;
+    }
+
+    out.resize(length);
+    return true;
+}
+
+
+/*!
+ * \brief       URL 编码，追加到字符串末尾。
+ *
+ * 字母、数字与“-_.~”保持不变，其它字节编码为“%XX”（大写），与 `ix::HttpClient::urlEncode` 相同。
+ *
+ * \param[in,out] out       输出字符串
+ * \param[in]   data        要编码的字符串
+ * \param[in]   length      字符串长度
+ */
+void url_encode(std::string &out, const char *data, size_t length);
+
+
+/*!
+ * \brief       获取当前使用的实现名称，用于诊断。
+ *
+ * \return      “avx2”、“sse2”、“neon”或“scalar”。
+ */
+const char *implementation();
+
+
+}       // namespace codec
@@ -0,0 +1,488 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        connection_pool.cpp
+ * \brief       connection_pool 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "connection_pool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <ixwebsocket/IXSocket.h>
+#include <ixwebsocket/IXUrlParser.h>
+
+#include "dns_cache.h"
+#include "io_waiter.h"
+#include "logger.h"
+#include "tls_socket.h"
+#include "utils.h"
+
+#ifdef KAIXIN_OS_WINDOWS
+#define NOMINMAX
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#else
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+
+
+/// 并行连接时，启动下一个地址前等待的时间（RFC 8305 建议 250 毫秒）。
+static constexpr auto CONNECTION_ATTEMPT_DELAY = std::chrono::milliseconds(250);
+
+
+// 开始非阻塞连接。返回套接字；出错时返回 -1。`done` 表示连接已立即完成。
+static int start_connect(const dns_address &address, int port, bool &done)
+{
+    done = false;
+    sockaddr_storage storage;
+    memset(&storage, 0, sizeof(storage));
+    socklen_t length = 0;
+
+    if (address.family == AF_INET6)
+    {
+        auto *sa = reinterpret_cast<sockaddr_in6 *>(&storage);
+        sa->sin6_family = AF_INET6;
+        sa->sin6_port = htons(static_cast<uint16_t>(port));
+        memcpy(&sa->sin6_addr, address.bytes, 16);
+        length = sizeof(sockaddr_in6);
+    }
+    else
+    {
+        auto *sa = reinterpret_cast<sockaddr_in *>(&storage);
+        sa->sin_family = AF_INET;
+        sa->sin_port = htons(static_cast<uint16_t>(port));
+        memcpy(&sa->sin_addr, address.bytes, 4);
+        length = sizeof(sockaddr_in);
+    }
+
+    auto fd = static_cast<int>(socket(address.family, SOCK_STREAM, IPPROTO_TCP));
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    // 与 ixwebsocket 创建的套接字一样：非阻塞，禁用 Nagle 算法
+    int nodelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char *>(&nodelay), sizeof(nodelay));
+
+#ifdef KAIXIN_OS_WINDOWS
+    u_long nonblocking = 1;
+    ioctlsocket(fd, FIONBIO, &nonblocking);
+#else
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+    if (::connect(fd, reinterpret_cast<const sockaddr *>(&storage), length) == 0)
+    {
+        done = true;
+        return fd;
+    }
+
+#ifdef KAIXIN_OS_WINDOWS
+    const bool in_progress = (WSAGetLastError() == WSAEWOULDBLOCK);
+#else
+    const bool in_progress = (errno == EINPROGRESS);
+#endif
+
+    if (!in_progress)
+    {
+        ix::Socket::closeSocket(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+
+// 并行连接多个地址（Happy Eyeballs，RFC 8305）：每隔一段时间启动下一个地址的连接，
+// 使用最先完成的连接，关闭其它连接。连接完成由事件循环检测。返回套接字；出错时返回 -1。
+static int race_connect(const std::vector<dns_address> &addresses, int port, std::string &error,
+                        const ix::CancellationRequest &cancelled)
+{
+    using clock = std::chrono::steady_clock;
+    kaixin::io_waiter waiter;
+    std::vector<int> pending;
+    size_t next = 0;
+    auto next_start = clock::now();
+
+    // 先注销再关闭，否则描述符可能已被其它连接重用
+    const auto close_all = [&pending, &waiter](int except)
+    {
+        for (auto fd : pending)
+        {
+            waiter.unwatch(fd);
+
+            if (fd != except)
+            {
+                ix::Socket::closeSocket(fd);
+            }
+        }
+    };
+
+    while (true)
+    {
+        if (cancelled && cancelled())
+        {
+            close_all(-1);
+            error = "Cancelled while connecting";
+            return -1;
+        }
+
+        auto now = clock::now();
+
+        if (next < addresses.size() && (pending.empty() || now >= next_start))
+        {
+            bool done = false;
+            auto fd = start_connect(addresses[next++], port, done);
+            next_start = now + CONNECTION_ATTEMPT_DELAY;
+
+            if (done)
+            {
+                close_all(-1);
+                return fd;
+            }
+
+            if (fd >= 0)
+            {
+                if (waiter.watch(fd, kaixin::event_loop::WRITABLE))
+                {
+                    pending.push_back(fd);
+                }
+                else
+                {
+                    ix::Socket::closeSocket(fd);
+                }
+            }
+
+            continue;
+        }
+
+        if (pending.empty())
+        {
+            error = "Cannot connect to any address";
+            return -1;
+        }
+
+        // 等待任一连接完成，或到达启动下一个地址的时间
+        const auto until = (next < addresses.size()) ? next_start : clock::time_point::max();
+
+        for (const auto &ready : waiter.wait(until, cancelled))
+        {
+            int so_error = 0;
+            socklen_t length = sizeof(so_error);
+            getsockopt(ready.fd, SOL_SOCKET, SO_ERROR, reinterpret_cast<char *>(&so_error), &length);
+
+            if (so_error == 0 && (ready.events & kaixin::event_loop::WRITABLE))
+            {
+                close_all(ready.fd);
+                return ready.fd;
+            }
+
+            // 该地址连接失败，立即尝试下一个地址
+            waiter.unwatch(ready.fd);
+            ix::Socket::closeSocket(ready.fd);
+            pending.erase(std::find(pending.begin(), pending.end(), ready.fd));
+            next_start = clock::now();
+        }
+    }
+}
+
+
+connection_pool &connection_pool::instance()
+{
+    static connection_pool pool;
+    return pool;
+}
+
+
+connection_pool::connection_pool()
+    : idle_count_(0)
+    , max_idle_per_host_(4)
+    , max_idle_(16)
+    , idle_timeout_(30)
+{
+}
+
+
+connection_pool::~connection_pool()
+{
+    clear();
+}
+
+
+std::string connection_pool::make_key(const std::string &host, int port, bool tls)
+{
+    std::string key(tls ? "https://" : "http://");
+    key += host;
+    key += ':';
+    key += std::to_string(port);
+    return key;
+}
+
+
+// 新建连接：地址来自 DNS 缓存，多个地址并行连接
+int connection_pool::open_connection(const std::string &host, int port, std::string &error,
+                                     const ix::CancellationRequest &cancelled)
+{
+    std::vector<dns_address> addresses;
+
+    if (!dns_cache::instance().resolve(host, addresses, error, cancelled))
+    {
+        return -1;
+    }
+
+    return race_connect(addresses, port, error, cancelled);
+}
+
+
+std::unique_ptr<tcp_socket> connection_pool::acquire(const std::string &host, int port, bool tls,
+                                                     bool allow_reuse, bool &reused, std::string &error,
+                                                     const ix::CancellationRequest &cancelled,
+                                                     const std::string &early_data,
+                                                     bool &early_data_accepted)
+{
+    reused = false;
+    early_data_accepted = false;
+
+    if (allow_reuse)
+    {
+        std::lock_guard lock(mutex_);
+        evict(clock::now());
+
+        auto iter = idle_.find(make_key(host, port, tls));
+
+        if (iter != idle_.end())
+        {
+            auto &conns = iter->second;
+
+            // 优先使用最近归还的连接，它被服务端关闭的可能性最小
+            while (!conns.empty())
+            {
+                auto socket = std::move(conns.back().socket);
+                conns.pop_back();
+                idle_count_--;
+
+                // 空闲连接上不应有可读数据；可读意味着对端已关闭或出错
+                if (socket->isReadyToRead(0) == ix::PollResultType::Timeout)
+                {
+                    reused = true;
+                    return socket;
+                }
+
+                socket->close();
+            }
+
+            idle_.erase(iter);
+        }
+    }
+
+    const auto fd = open_connection(host, port, error, cancelled);
+
+    if (fd < 0)
+    {
+        return {};
+    }
+
+    if (!tls)
+    {
+        auto socket = std::make_unique<tcp_socket>(fd);
+
+        if (!socket->init(error))
+        {
+            socket->close();
+            return {};
+        }
+
+        return socket;
+    }
+
+    auto socket = std::make_unique<tls_socket>(fd);
+
+    if (!socket->init(error) || !socket->handshake(host, error, cancelled, early_data))
+    {
+        socket->close();
+        return {};
+    }
+
+    early_data_accepted = socket->early_data_accepted();
+    return socket;
+}
+
+
+std::unique_ptr<tls_socket> connection_pool::connect_tls(const std::string &host, int port, bool http2,
+                                                         std::string &error,
+                                                         const ix::CancellationRequest &cancelled)
+{
+    const auto fd = open_connection(host, port, error, cancelled);
+
+    if (fd < 0)
+    {
+        return {};
+    }
+
+    auto socket = std::make_unique<tls_socket>(fd, http2);
+
+    if (!socket->init(error) || !socket->handshake(host, error, cancelled))
+    {
+        socket->close();
+        return {};
+    }
+
+    return socket;
+}
+
+
+void connection_pool::release(const std::string &host, int port, bool tls,
+                              std::unique_ptr<tcp_socket> socket)
+{
+    if (!socket)
+    {
+        return;
+    }
+
+    std::lock_guard lock(mutex_);
+    const auto now = clock::now();
+    evict(now);
+
+    auto &conns = idle_[make_key(host, port, tls)];
+
+    if (conns.size() >= max_idle_per_host_ || idle_count_ >= max_idle_)
+    {
+        // 超出限制，直接关闭
+        socket->close();
+
+        if (conns.empty())
+        {
+            idle_.erase(make_key(host, port, tls));
+        }
+
+        return;
+    }
+
+    conns.push_back({ std::move(socket), now });
+    idle_count_++;
+}
+
+
+bool connection_pool::preconnect(const std::string &url, int timeout)
+{
+    std::string protocol;
+    std::string host;
+    std::string path;
+    std::string query;
+    int port = 0;
+
+    if (!ix::UrlParser::parse(url, protocol, host, path, query, port))
+    {
+        LE() << "Invalid URL:" << url;
+        return false;
+    }
+
+    const bool tls = (protocol == "https");
+    std::atomic_bool stop(false);
+    auto cancelled = ix::makeCancellationRequestWithTimeout(timeout, stop);
+    bool reused = false;
+    bool early_data_accepted = false;
+    std::string error;
+    auto socket = acquire(host, port, tls, true, reused, error, cancelled, {}, early_data_accepted);
+
+    if (!socket)
+    {
+        LW() << "Failed to preconnect to" << host << ":" << error;
+        return false;
+    }
+
+    release(host, port, tls, std::move(socket));
+    return true;
+}
+
+
+void connection_pool::set_limits(size_t max_idle_per_host, size_t max_idle,
+                                 std::chrono::seconds idle_timeout)
+{
+    std::lock_guard lock(mutex_);
+    max_idle_per_host_ = max_idle_per_host;
+    max_idle_ = max_idle;
+    idle_timeout_ = idle_timeout;
+    evict(clock::now());
+}
+
+
+void connection_pool::clear()
+{
+    std::lock_guard lock(mutex_);
+
+    for (auto &[key, conns] : idle_)
+    {
+        for (auto &conn : conns)
+        {
+            conn.socket->close();
+        }
+    }
+
+    idle_.clear();
+    idle_count_ = 0;
+}
+
+
+// 淘汰超时的空闲连接，以及超出数量限制的最旧连接。调用者须持有锁。
+void connection_pool::evict(clock::time_point now)
+{
+    for (auto iter = idle_.begin(); iter != idle_.end();)
+    {
+        auto &conns = iter->second;
+
+        while (!conns.empty()
+               && (now - conns.front().since >= idle_timeout_ || conns.size() > max_idle_per_host_))
+        {
+            conns.front().socket->close();
+            conns.pop_front();
+            idle_count_--;
+        }
+
+        if (conns.empty())
+        {
+            iter = idle_.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+
+    // 总数仍超限时，淘汰各主机中最旧的连接
+    while (idle_count_ > max_idle_)
+    {
+        auto oldest = idle_.end();
+
+        for (auto iter = idle_.begin(); iter != idle_.end(); ++iter)
+        {
+            if (oldest == idle_.end() || iter->second.front().since < oldest->second.front().since)
+            {
+                oldest = iter;
+            }
+        }
+
+        oldest->second.front().socket->close();
+        oldest->second.pop_front();
+        idle_count_--;
+
+        if (oldest->second.empty())
+        {
+            idle_.erase(oldest);
+        }
+    }
+}
@@ -0,0 +1,133 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        connection_pool.h
+ * \brief       connection_pool 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <ixwebsocket/IXCancellationRequest.h>
+
+class tcp_socket;
+class tls_socket;
+
+
+/*!
+ * \brief       进程级 HTTP 长连接池。
+ *
+ * 以“协议 + 主机 + 端口”为键缓存空闲连接，使后续请求可以跳过 DNS、TCP 与 TLS 握手。
+ * 空闲连接超过 `idle_timeout` 后在下次访问连接池时被淘汰。
+ */
+class connection_pool : private noncopyable
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    /// 获取全局连接池。
+    static connection_pool &instance();
+
+    /*!
+     * \brief       获取连接。允许复用时优先复用空闲连接，没有可用的空闲连接时新建连接。
+     *
+     * \param[in]   host        主机名
+     * \param[in]   port        端口
+     * \param[in]   tls         是否使用 TLS
+     * \param[in]   allow_reuse 是否允许复用空闲连接。只交出没有可读数据（对端尚未关闭）的连接，
+     *                          但之后仍可能被服务端关闭，调用者应处理发送或接收失败
+     * \param[out]  reused      是否为复用的连接
+     * \param[out]  error       出错时的错误信息
+     * \param[in]   cancelled   取消请求
+     * \param[in]   early_data  新建 TLS 连接恢复会话时随握手发送的请求，可以为空
+     * \param[out]  early_data_accepted     `early_data` 是否已被服务端接受
+     *
+     * \return      连接；如果出错，则返回空指针。
+     */
+    std::unique_ptr<tcp_socket> acquire(const std::string &host, int port, bool tls, bool allow_reuse,
+                                        bool &reused, std::string &error,
+                                        const ix::CancellationRequest &cancelled,
+                                        const std::string &early_data, bool &early_data_accepted);
+
+    /*!
+     * \brief       新建 TLS 连接，不经过连接池。
+     *
+     * \param[in]   host        主机名
+     * \param[in]   port        端口
+     * \param[in]   http2       是否通过 ALPN 优先协商 HTTP/2
+     * \param[out]  error       出错时的错误信息
+     * \param[in]   cancelled   取消请求
+     *
+     * \return      连接；如果出错，则返回空指针。
+     */
+    std::unique_ptr<tls_socket> connect_tls(const std::string &host, int port, bool http2,
+                                            std::string &error, const ix::CancellationRequest &cancelled);
+
+    /*!
+     * \brief       归还可以继续使用的连接。超出数量限制时直接关闭。
+     *
+     * \param[in]   host        主机名
+     * \param[in]   port        端口
+     * \param[in]   tls         是否使用 TLS
+     * \param[in]   socket      要归还的连接
+     */
+    void release(const std::string &host, int port, bool tls, std::unique_ptr<tcp_socket> socket);
+
+    /*!
+     * \brief       预先建立到指定 URL 所在主机的连接，并放入连接池。
+     *
+     * \param[in]   url         URL
+     * \param[in]   timeout     连接超时，以秒为单位
+     *
+     * \return      如果成功，则返回 `true`；否则返回 `false`。
+     */
+    bool preconnect(const std::string &url, int timeout);
+
+    /*!
+     * \brief       设置连接池限制。
+     *
+     * \param[in]   max_idle_per_host   每个主机最多保留的空闲连接数
+     * \param[in]   max_idle            最多保留的空闲连接总数
+     * \param[in]   idle_timeout        空闲连接最长保留时间
+     */
+    void set_limits(size_t max_idle_per_host, size_t max_idle, std::chrono::seconds idle_timeout);
+
+    /// 关闭所有空闲连接。
+    void clear();
+
+private:
+    connection_pool();
+    ~connection_pool();
+
+    static std::string make_key(const std::string &host, int port, bool tls);
+    static int open_connection(const std::string &host, int port, std::string &error,
+                               const ix::CancellationRequest &cancelled);
+    void evict(clock::time_point now);
+
+private:
+    /// 空闲连接。
+    struct idle_connection
+    {
+        std::unique_ptr<tcp_socket> socket;     ///< 连接
+        clock::time_point since;                ///< 开始空闲的时间
+    };
+
+    std::mutex mutex_;
+    std::map<std::string, std::deque<idle_connection>> idle_;
+    size_t idle_count_;
+    size_t max_idle_per_host_;
+    size_t max_idle_;
+    std::chrono::seconds idle_timeout_;
+};
@@ -0,0 +1,456 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        dns_cache.cpp
+ * \brief       dns_cache 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "dns_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "logger.h"
+#include "utils.h"
+
+#ifdef KAIXIN_OS_WINDOWS
+#define NOMINMAX
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#include <WinDNS.h>
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+
+/// getaddrinfo 不提供 TTL 时使用的有效期。
+static constexpr std::chrono::seconds DEFAULT_TTL(60);
+/// 最短有效期，避免 TTL 为零的记录每次都重新解析。
+static constexpr std::chrono::seconds MIN_TTL(5);
+/// 最长有效期。
+static constexpr std::chrono::seconds MAX_TTL(3600);
+/// 等待解析时检查取消请求的间隔。
+static constexpr std::chrono::milliseconds POLL_INTERVAL(10);
+/// 最多同时运行的解析线程数。
+static constexpr size_t MAX_RESOLVER_THREADS = 2;
+
+
+/// 正在进行的解析。
+struct dns_cache::lookup
+{
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool done = false;
+};
+
+
+// IPv6 与 IPv4 地址交替排列，首选第一个地址的地址族（RFC 8305 第 4 节）
+static std::vector<dns_address> interleave(const std::vector<dns_address> &addresses)
+{
+    if (addresses.empty())
+    {
+        return {};
+    }
+
+    const auto first = addresses.front().family;
+    std::vector<dns_address> primary;
+    std::vector<dns_address> secondary;
+
+    for (const auto &a : addresses)
+    {
+        (a.family == first ? primary : secondary).push_back(a);
+    }
+
+    std::vector<dns_address> result;
+    result.reserve(addresses.size());
+
+    for (size_t i = 0; i < std::max(primary.size(), secondary.size()); i++)
+    {
+        if (i < primary.size())
+        {
+            result.push_back(primary[i]);
+        }
+
+        if (i < secondary.size())
+        {
+            result.push_back(secondary[i]);
+        }
+    }
+
+    return result;
+}
+
+
+// 如果是 IP 地址，则直接转换
+static bool parse_literal(const std::string &host, dns_address &address)
+{
+    if (inet_pton(AF_INET6, host.c_str(), address.bytes) == 1)
+    {
+        address.family = AF_INET6;
+        return true;
+    }
+
+    if (inet_pton(AF_INET, host.c_str(), address.bytes) == 1)
+    {
+        address.family = AF_INET;
+        return true;
+    }
+
+    return false;
+}
+
+
+#ifdef KAIXIN_OS_WINDOWS
+// 使用 DnsQuery 解析指定类型的记录，返回最小的 TTL
+static void dns_query(const std::string &host, WORD type, std::vector<dns_address> &addresses,
+                      DWORD &ttl)
+{
+    PDNS_RECORD records = nullptr;
+
+    if (DnsQuery_UTF8(host.c_str(), type, DNS_QUERY_STANDARD, nullptr, &records, nullptr) != 0)
+    {
+        return;
+    }
+
+    for (auto *r = records; r != nullptr; r = r->pNext)
+    {
+        if (r->wType != type || r->Flags.S.Section != DnsSectionAnswer)
+        {
+            // 忽略 CNAME 等其它记录
+            continue;
+        }
+
+        dns_address a;
+
+        if (type == DNS_TYPE_A)
+        {
+            a.family = AF_INET;
+            memcpy(a.bytes, &r->Data.A.IpAddress, 4);
+        }
+        else
+        {
+            a.family = AF_INET6;
+            memcpy(a.bytes, &r->Data.AAAA.Ip6Address, 16);
+        }
+
+        addresses.push_back(a);
+        ttl = std::min(ttl, r->dwTtl);
+    }
+
+    DnsRecordListFree(records, DnsFreeRecordList);
+}
+#endif
+
+
+dns_cache &dns_cache::instance()
+{
+    static dns_cache cache;
+    return cache;
+}
+
+
+dns_cache::dns_cache()
+    : resolver_(system_resolve)
+    , generation_(0)
+    , idle_threads_(0)
+    , stopping_(false)
+{
+}
+
+
+dns_cache::~dns_cache()
+{
+    stop();
+}
+
+
+bool dns_cache::system_resolve(const std::string &host, std::vector<dns_address> &addresses,
+                               std::chrono::seconds &ttl)
+{
+    addresses.clear();
+    dns_address literal;
+
+    if (parse_literal(host, literal))
+    {
+        addresses.push_back(literal);
+        ttl = MAX_TTL;
+        return true;
+    }
+
+#ifdef KAIXIN_OS_WINDOWS
+    DWORD min_ttl = MAXDWORD;
+    dns_query(host, DNS_TYPE_AAAA, addresses, min_ttl);
+    dns_query(host, DNS_TYPE_A, addresses, min_ttl);
+
+    if (!addresses.empty())
+    {
+        ttl = std::chrono::seconds(min_ttl);
+        return true;
+    }
+#endif
+
+    // 回退到 getaddrinfo，它不提供 TTL
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_ADDRCONFIG;
+
+    addrinfo *res = nullptr;
+
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &res) != 0)
+    {
+        return false;
+    }
+
+    for (auto *p = res; p != nullptr; p = p->ai_next)
+    {
+        dns_address a;
+        a.family = p->ai_family;
+
+        if (p->ai_family == AF_INET6)
+        {
+            memcpy(a.bytes, &reinterpret_cast<sockaddr_in6 *>(p->ai_addr)->sin6_addr, 16);
+        }
+        else if (p->ai_family == AF_INET)
+        {
+            memcpy(a.bytes, &reinterpret_cast<sockaddr_in *>(p->ai_addr)->sin_addr, 4);
+        }
+        else
+        {
+            continue;
+        }
+
+        addresses.push_back(a);
+    }
+
+    freeaddrinfo(res);
+    ttl = DEFAULT_TTL;
+    return !addresses.empty();
+}
+
+
+bool dns_cache::resolve(const std::string &host, std::vector<dns_address> &addresses,
+                        std::string &error, const ix::CancellationRequest &cancelled)
+{
+    std::shared_ptr<lookup> l;
+
+    {
+        std::lock_guard lock(mutex_);
+        const auto now = clock::now();
+        auto iter = entries_.find(host);
+
+        if (iter != entries_.end() && !iter->second.addresses.empty() && now < iter->second.expires_at)
+        {
+            stats_.hits++;
+            addresses = iter->second.addresses;
+
+            if (now >= iter->second.refresh_at && !iter->second.pending)
+            {
+                // 即将过期，后台刷新
+                stats_.refreshes++;
+                start_lookup(host, true);
+            }
+
+            return true;
+        }
+
+        stats_.misses++;
+        l = start_lookup(host, false);
+    }
+
+    // 等待解析完成
+    {
+        std::unique_lock lock(l->mutex);
+
+        while (!l->done)
+        {
+            if (cancelled && cancelled())
+            {
+                error = "Cancelled while resolving " + host;
+                return false;
+            }
+
+            l->cond.wait_for(lock, POLL_INTERVAL);
+        }
+    }
+
+    std::lock_guard lock(mutex_);
+    auto iter = entries_.find(host);
+
+    if (iter == entries_.end() || iter->second.addresses.empty())
+    {
+        error = "Cannot resolve " + host;
+        return false;
+    }
+
+    // 解析失败时，这里是过期的结果
+    addresses = iter->second.addresses;
+    return true;
+}
+
+
+std::shared_ptr<dns_cache::lookup> dns_cache::start_lookup(const std::string &host, bool refresh)
+{
+    // 调用者已加锁
+    auto &e = entries_[host];
+
+    if (e.pending)
+    {
+        // 相同主机的解析正在进行
+        return e.pending;
+    }
+
+    auto l = std::make_shared<lookup>();
+    e.pending = l;
+    jobs_.push_back({ host, l, resolver_, generation_, refresh });
+
+    // 空闲线程不够时启动新的解析线程，停止期间不启动，由 stop 结束剩余的解析
+    if (!stopping_ && jobs_.size() > idle_threads_ && threads_.size() < MAX_RESOLVER_THREADS)
+    {
+        threads_.emplace_back(&dns_cache::resolver_proc, this);
+    }
+    else
+    {
+        cond_.notify_one();
+    }
+
+    return l;
+}
+
+
+void dns_cache::resolver_proc()
+{
+    std::unique_lock lock(mutex_);
+
+    while (true)
+    {
+        idle_threads_++;
+        cond_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+        idle_threads_--;
+
+        if (stopping_)
+        {
+            break;
+        }
+
+        auto j = std::move(jobs_.front());
+        jobs_.pop_front();
+        lock.unlock();
+
+        std::vector<dns_address> addresses;
+        std::chrono::seconds ttl(0);
+        const auto ok = j.r(j.host, addresses, ttl);
+
+        if (!ok)
+        {
+            LW() << (j.refresh ? "Failed to refresh" : "Failed to resolve") << j.host;
+        }
+
+        finish_lookup(j.host, j.l, j.generation, ok, interleave(addresses), ttl);
+        lock.lock();
+    }
+}
+
+
+void dns_cache::finish_lookup(const std::string &host, const std::shared_ptr<lookup> &l,
+                              uint64_t generation, bool ok, std::vector<dns_address> addresses,
+                              std::chrono::seconds ttl)
+{
+    {
+        std::lock_guard lock(mutex_);
+
+        if (generation == generation_)
+        {
+            auto &e = entries_[host];
+            e.pending.reset();
+
+            if (ok && !addresses.empty())
+            {
+                ttl = std::clamp(ttl, MIN_TTL, MAX_TTL);
+                const auto now = clock::now();
+                e.addresses = std::move(addresses);
+                e.expires_at = now + ttl;
+                e.refresh_at = now + ttl * 4 / 5;
+            }
+            else
+            {
+                // 保留过期的结果作为后备
+                stats_.failures++;
+            }
+        }
+    }
+
+    {
+        std::lock_guard lock(l->mutex);
+        l->done = true;
+    }
+
+    l->cond.notify_all();
+}
+
+
+void dns_cache::set_resolver(resolver r)
+{
+    std::lock_guard lock(mutex_);
+    resolver_ = r ? std::move(r) : resolver(system_resolve);
+    entries_.clear();
+    generation_++;
+}
+
+
+dns_cache::statistics dns_cache::stats() const
+{
+    std::lock_guard lock(mutex_);
+    return stats_;
+}
+
+
+void dns_cache::clear()
+{
+    std::lock_guard lock(mutex_);
+    entries_.clear();
+    generation_++;
+}
+
+
+void dns_cache::stop()
+{
+    std::vector<std::thread> threads;
+
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+        threads.swap(threads_);
+    }
+
+    cond_.notify_all();
+
+    // 正在进行的系统解析不能中断，等待其返回
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+
+    std::deque<job> jobs;
+
+    {
+        std::lock_guard lock(mutex_);
+        jobs.swap(jobs_);
+        stopping_ = false;
+    }
+
+    // 唤醒等待尚未开始的解析的调用者
+    for (auto &j : jobs)
+    {
+        finish_lookup(j.host, j.l, j.generation, false, {}, std::chrono::seconds(0));
+    }
+}
@@ -0,0 +1,156 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        dns_cache.h
+ * \brief       dns_cache 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ixwebsocket/IXCancellationRequest.h>
+
+
+/// 解析得到的地址。
+struct dns_address
+{
+    int family = 0;                             ///< 地址族，AF_INET 或 AF_INET6
+    uint8_t bytes[16] = { 0 };                  ///< 网络字节序的地址，IPv4 只使用前 4 字节
+};
+
+
+/*!
+ * \brief       进程级 DNS 缓存。
+ *
+ * 按主机名缓存解析结果，并遵循记录的 TTL。缓存项剩余寿命不足 TTL 的五分之一时，在后台提前
+ * 刷新，调用者继续使用旧结果；过期后同步解析，解析失败时继续使用过期的结果。
+ *
+ * 解析在缓存自有的少量解析线程中进行，使等待者可以随时取消；线程在第一次解析时启动，
+ * 由 `stop` 停止并等待结束。解析函数可以替换，便于在没有网络的环境中测试。
+ */
+class dns_cache : private noncopyable
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    /*!
+     * \brief       解析函数类型。
+     *
+     * \param[in]   host        主机名
+     * \param[out]  addresses   解析得到的地址
+     * \param[out]  ttl         结果的有效期
+     *
+     * \return      如果成功，则返回 `true`；否则返回 `false`。
+     */
+    using resolver = std::function<bool(const std::string &host, std::vector<dns_address> &addresses,
+                                        std::chrono::seconds &ttl)>;
+
+    /// 统计数据。
+    struct statistics
+    {
+        uint64_t hits = 0;                      ///< 命中缓存的次数
+        uint64_t misses = 0;                    ///< 需要等待解析的次数
+        uint64_t refreshes = 0;                 ///< 后台刷新的次数
+        uint64_t failures = 0;                  ///< 解析失败的次数
+    };
+
+    /// 获取全局 DNS 缓存。
+    static dns_cache &instance();
+
+    /*!
+     * \brief       解析主机名。
+     *
+     * \param[in]   host        主机名或 IP 地址
+     * \param[out]  addresses   地址，IPv6 与 IPv4 交替排列
+     * \param[out]  error       出错时的错误信息
+     * \param[in]   cancelled   取消请求；取消后不再等待，解析在后台继续并写入缓存
+     *
+     * \return      如果成功，则返回 `true`；否则返回 `false`。
+     */
+    bool resolve(const std::string &host, std::vector<dns_address> &addresses, std::string &error,
+                 const ix::CancellationRequest &cancelled);
+
+    /*!
+     * \brief       替换解析函数，同时清空缓存。
+     *
+     * \param[in]   r           新的解析函数；为空时恢复系统解析函数
+     */
+    void set_resolver(resolver r);
+
+    /// 获取统计数据。
+    statistics stats() const;
+
+    /// 清空缓存。
+    void clear();
+
+    /*!
+     * \brief       停止解析线程并等待其结束。尚未开始的解析以失败结束；之后的解析重新启动线程。
+     *              不能在解析函数中调用。
+     */
+    void stop();
+
+    /*!
+     * \brief       系统解析函数。Windows 上使用 DnsQuery 获取 TTL，失败时回退到 getaddrinfo。
+     */
+    static bool system_resolve(const std::string &host, std::vector<dns_address> &addresses,
+                               std::chrono::seconds &ttl);
+
+private:
+    dns_cache();
+    ~dns_cache();
+
+    struct lookup;
+    std::shared_ptr<lookup> start_lookup(const std::string &host, bool refresh);
+    void finish_lookup(const std::string &host, const std::shared_ptr<lookup> &l, uint64_t generation,
+                       bool ok, std::vector<dns_address> addresses, std::chrono::seconds ttl);
+    void resolver_proc();
+
+private:
+    /// 等待解析线程执行的解析。
+    struct job
+    {
+        std::string host;                       ///< 主机名
+        std::shared_ptr<lookup> l;              ///< 解析状态
+        resolver r;                             ///< 解析函数
+        uint64_t generation;                    ///< 开始解析时的缓存代数
+        bool refresh;                           ///< 是否为后台刷新
+    };
+
+    /// 缓存项。
+    struct entry
+    {
+        std::vector<dns_address> addresses;     ///< 地址
+        clock::time_point refresh_at;           ///< 开始后台刷新的时间
+        clock::time_point expires_at;           ///< 过期时间
+        std::shared_ptr<lookup> pending;        ///< 正在进行的解析
+    };
+
+    mutable std::mutex mutex_;
+    std::map<std::string, entry> entries_;
+    resolver resolver_;
+    uint64_t generation_;
+    statistics stats_;
+    std::condition_variable cond_;              ///< 有新的解析或停止时通知解析线程
+    std::deque<job> jobs_;
+    std::vector<std::thread> threads_;
+    size_t idle_threads_;                       ///< 正在等待解析的线程数
+    bool stopping_;
+};
@@ -0,0 +1,597 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        event_loop.cpp
+ * \brief       event_loop 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "event_loop.h"
+
+#include <algorithm>
+#include <climits>
+
+#include "logger.h"
+#include "utils.h"
+
+#ifdef KAIXIN_OS_WINDOWS
+#define NOMINMAX
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#elif defined(__linux__)
+#define KAIXIN_HAS_EPOLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+
+namespace kaixin {
+
+
+#ifdef KAIXIN_HAS_EPOLL
+/// 每次等待最多取出的事件数。
+static constexpr int MAX_EVENTS = 64;
+
+
+// 关心的事件转换为 epoll 事件
+static uint32_t to_epoll(uint32_t events)
+{
+    uint32_t result = 0;
+
+    if (events & event_loop::READABLE)
+    {
+        result |= EPOLLIN;
+    }
+
+    if (events & event_loop::WRITABLE)
+    {
+        result |= EPOLLOUT;
+    }
+
+    if (events & event_loop::ONESHOT)
+    {
+        result |= EPOLLONESHOT;
+    }
+
+    return result;
+}
+#endif
+
+
+event_loop &event_loop::instance()
+{
+    static event_loop loop;
+    return loop;
+}
+
+
+event_loop::event_loop()
+    : timers_(nullptr, [this]
+    {
+        // 循环线程中添加的定时器在本轮等待前就会被计入
+        if (!in_loop_thread())
+        {
+            {
+                std::lock_guard lock(mutex_);
+                start_locked();
+            }
+
+            wake();
+        }
+    })
+{
+}
+
+
+event_loop::~event_loop()
+{
+    stop();
+    close_backend();
+}
+
+
+event_loop::watch_id event_loop::add(int fd, uint32_t events, io_handler handler)
+{
+    watch_id id;
+
+    {
+        std::lock_guard lock(mutex_);
+        start_locked();
+        id = next_id_++;
+
+#ifdef KAIXIN_HAS_EPOLL
+        epoll_event ev = {};
+        ev.events = to_epoll(events);
+        ev.data.u64 = id;
+
+        if (epoll_ctl(backend_fd_, EPOLL_CTL_ADD, fd, &ev) != 0)
+        {
+            LE() << "Failed to watch socket:" << errno;
+            return 0;
+        }
+#endif
+
+        watches_.emplace(id, watch{ fd, events, std::make_shared<io_handler>(std::move(handler)) });
+    }
+
+#ifndef KAIXIN_HAS_EPOLL
+    // poll 每轮重新生成描述符表
+    wake();
+#endif
+    return id;
+}
+
+
+void event_loop::modify(watch_id id, uint32_t events)
+{
+    {
+        std::lock_guard lock(mutex_);
+        auto iter = watches_.find(id);
+
+        if (iter == watches_.end() || iter->second.events == events)
+        {
+            return;
+        }
+
+        iter->second.events = events;
+
+#ifdef KAIXIN_HAS_EPOLL
+        epoll_event ev = {};
+        ev.events = to_epoll(events);
+        ev.data.u64 = id;
+        epoll_ctl(backend_fd_, EPOLL_CTL_MOD, iter->second.fd, &ev);
+#endif
+    }
+
+#ifndef KAIXIN_HAS_EPOLL
+    wake();
+#endif
+}
+
+
+void event_loop::remove(watch_id id)
+{
+    if (id == 0)
+    {
+        return;
+    }
+
+    std::unique_lock lock(mutex_);
+    auto iter = watches_.find(id);
+
+    if (iter != watches_.end())
+    {
+#ifdef KAIXIN_HAS_EPOLL
+        epoll_ctl(backend_fd_, EPOLL_CTL_DEL, iter->second.fd, nullptr);
+#endif
+        watches_.erase(iter);
+    }
+
+    // 等待正在执行的回调返回；在回调自身中注销时不等待
+    done_.wait(lock, [this, id] { return running_ != id || in_loop_thread(); });
+}
+
+
+void event_loop::post(task t)
+{
+    {
+        std::lock_guard lock(mutex_);
+        start_locked();
+        tasks_.emplace_back(std::move(t));
+    }
+
+    if (!in_loop_thread())
+    {
+        wake();
+    }
+}
+
+
+void event_loop::stop()
+{
+    std::thread thread;
+
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+        thread.swap(thread_);
+    }
+
+    if (thread.joinable())
+    {
+        wake();
+        thread.join();
+    }
+
+    timers_.clear();
+
+    std::lock_guard lock(mutex_);
+    tasks_.clear();
+    stopping_ = false;
+}
+
+
+void event_loop::start_locked()
+{
+    if (thread_.joinable() || stopping_)
+    {
+        return;
+    }
+
+    if (!open_backend())
+    {
+        LE() << "Failed to create the event loop.";
+        return;
+    }
+
+    thread_ = std::thread(&event_loop::run, this);
+}
+
+
+void event_loop::run()
+{
+    loop_thread_ = std::this_thread::get_id();
+    ready_list ready;
+
+    while (true)
+    {
+        std::deque<task> tasks;
+
+        {
+            std::lock_guard lock(mutex_);
+
+            if (stopping_)
+            {
+                break;
+            }
+
+            tasks.swap(tasks_);
+        }
+
+        for (auto &t : tasks)
+        {
+            t();
+        }
+
+        timers_.poll();
+
+        ready.clear();
+        wait(timeout_ms(), ready);
+
+        for (const auto &[id, events] : ready)
+        {
+            dispatch(id, events);
+        }
+    }
+
+    loop_thread_ = std::thread::id();
+}
+
+
+int event_loop::timeout_ms()
+{
+    {
+        std::lock_guard lock(mutex_);
+
+        if (!tasks_.empty() || stopping_)
+        {
+            return 0;
+        }
+    }
+
+    const auto next = timers_.next_expiry();
+
+    if (next == timer_wheel::clock::time_point::max())
+    {
+        return -1;
+    }
+
+    const auto delay = std::chrono::ceil<std::chrono::milliseconds>(next - timer_wheel::clock::now()).count();
+    return static_cast<int>(std::clamp<decltype(delay)>(delay, 0, INT_MAX));
+}
+
+
+void event_loop::dispatch(watch_id id, uint32_t events)
+{
+    std::shared_ptr<io_handler> handler;
+
+    {
+        std::lock_guard lock(mutex_);
+        auto iter = watches_.find(id);
+
+        if (iter == watches_.end())
+        {
+            // 在本轮前面的回调中被注销
+            return;
+        }
+
+        handler = iter->second.handler;
+        running_ = id;
+
+        if (iter->second.events & ONESHOT)
+        {
+            // epoll 已自动停止关心；poll 在下一轮等待时跳过，再次 `modify` 时重新关心
+            iter->second.events = 0;
+        }
+    }
+
+    (*handler)(events);
+
+    {
+        std::lock_guard lock(mutex_);
+        running_ = 0;
+    }
+
+    done_.notify_all();
+}
+
+
+#ifdef KAIXIN_HAS_EPOLL
+
+bool event_loop::open_backend()
+{
+    if (backend_fd_ >= 0)
+    {
+        return true;
+    }
+
+    backend_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_read_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    wake_write_ = wake_read_;
+
+    // 唤醒描述符的注册 ID 为零
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.u64 = 0;
+
+    if (backend_fd_ < 0 || wake_read_ < 0 || epoll_ctl(backend_fd_, EPOLL_CTL_ADD, wake_read_, &ev) != 0)
+    {
+        close_backend();
+        return false;
+    }
+
+    return true;
+}
+
+
+void event_loop::close_backend()
+{
+    if (wake_read_ >= 0)
+    {
+        ::close(wake_read_);
+    }
+
+    if (backend_fd_ >= 0)
+    {
+        ::close(backend_fd_);
+    }
+
+    backend_fd_ = wake_read_ = wake_write_ = -1;
+}
+
+
+void event_loop::wait(int timeout_ms, ready_list &ready)
+{
+    epoll_event events[MAX_EVENTS];
+    const auto n = epoll_wait(backend_fd_, events, MAX_EVENTS, timeout_ms);
+
+    for (int i = 0; i < n; i++)
+    {
+        const auto &ev = events[i];
+
+        if (ev.data.u64 == 0)
+        {
+            drain();
+            continue;
+        }
+
+        uint32_t flags = 0;
+        flags |= (ev.events & EPOLLIN) ? READABLE : 0;
+        flags |= (ev.events & EPOLLOUT) ? WRITABLE : 0;
+        flags |= (ev.events & (EPOLLERR | EPOLLHUP)) ? FAILED : 0;
+        ready.emplace_back(ev.data.u64, flags);
+    }
+}
+
+
+void event_loop::wake()
+{
+    const uint64_t one = 1;
+    [[maybe_unused]] const auto n = ::write(wake_write_, &one, sizeof(one));
+}
+
+
+void event_loop::drain()
+{
+    uint64_t count;
+    [[maybe_unused]] const auto n = ::read(wake_read_, &count, sizeof(count));
+}
+
+#else
+
+#ifdef KAIXIN_OS_WINDOWS
+using poll_fd = WSAPOLLFD;
+using native_socket = SOCKET;
+static constexpr short POLL_READ = POLLRDNORM;
+static constexpr short POLL_WRITE = POLLWRNORM;
+
+static int poll_sockets(poll_fd *fds, size_t count, int timeout_ms)
+{
+    return WSAPoll(fds, static_cast<ULONG>(count), timeout_ms);
+}
+#else
+using poll_fd = pollfd;
+using native_socket = int;
+static constexpr short POLL_READ = POLLIN;
+static constexpr short POLL_WRITE = POLLOUT;
+
+static int poll_sockets(poll_fd *fds, size_t count, int timeout_ms)
+{
+    return ::poll(fds, static_cast<nfds_t>(count), timeout_ms);
+}
+#endif
+
+
+bool event_loop::open_backend()
+{
+    if (wake_read_ >= 0)
+    {
+        return true;
+    }
+
+#ifdef KAIXIN_OS_WINDOWS
+    // WSAPoll 只支持套接字：用连接到自身的 UDP 套接字唤醒
+    auto s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int length = sizeof(addr);
+
+    if (s == INVALID_SOCKET
+        || bind(s, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0
+        || getsockname(s, reinterpret_cast<sockaddr *>(&addr), &length) != 0
+        || connect(s, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+    {
+        if (s != INVALID_SOCKET)
+        {
+            closesocket(s);
+        }
+
+        return false;
+    }
+
+    u_long nonblocking = 1;
+    ioctlsocket(s, FIONBIO, &nonblocking);
+    wake_read_ = wake_write_ = static_cast<int>(s);
+#else
+    int fds[2];
+
+    if (pipe(fds) != 0)
+    {
+        return false;
+    }
+
+    for (auto fd : fds)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+
+    wake_read_ = fds[0];
+    wake_write_ = fds[1];
+#endif
+
+    return true;
+}
+
+
+void event_loop::close_backend()
+{
+#ifdef KAIXIN_OS_WINDOWS
+    if (wake_read_ >= 0)
+    {
+        closesocket(static_cast<SOCKET>(wake_read_));
+    }
+#else
+    if (wake_read_ >= 0)
+    {
+        ::close(wake_read_);
+        ::close(wake_write_);
+    }
+#endif
+
+    wake_read_ = wake_write_ = -1;
+}
+
+
+void event_loop::wait(int timeout_ms, ready_list &ready)
+{
+    // 每轮重新生成描述符表；第一项为唤醒描述符
+    std::vector<poll_fd> fds;
+    std::vector<watch_id> ids;
+
+    {
+        std::lock_guard lock(mutex_);
+        fds.reserve(watches_.size() + 1);
+        ids.reserve(watches_.size() + 1);
+        fds.push_back({ static_cast<native_socket>(wake_read_), POLL_READ, 0 });
+        ids.push_back(0);
+
+        for (const auto &[id, w] : watches_)
+        {
+            // 不关心任何事件的套接字不参与等待，否则出错时会不停地返回
+            if (w.events != 0)
+            {
+                const short events = ((w.events & READABLE) ? POLL_READ : 0) | ((w.events & WRITABLE) ? POLL_WRITE : 0);
+                fds.push_back({ static_cast<native_socket>(w.fd), events, 0 });
+                ids.push_back(id);
+            }
+        }
+    }
+
+    if (poll_sockets(fds.data(), fds.size(), timeout_ms) <= 0)
+    {
+        return;
+    }
+
+    if (fds.front().revents != 0)
+    {
+        drain();
+    }
+
+    for (size_t i = 1; i < fds.size(); i++)
+    {
+        const auto revents = fds[i].revents;
+
+        if (revents == 0)
+        {
+            continue;
+        }
+
+        uint32_t flags = 0;
+        flags |= (revents & POLL_READ) ? READABLE : 0;
+        flags |= (revents & POLL_WRITE) ? WRITABLE : 0;
+        flags |= (revents & (POLLERR | POLLHUP | POLLNVAL)) ? FAILED : 0;
+        ready.emplace_back(ids[i], flags);
+    }
+}
+
+
+void event_loop::wake()
+{
+    const char one = 1;
+#ifdef KAIXIN_OS_WINDOWS
+    send(static_cast<SOCKET>(wake_write_), &one, 1, 0);
+#else
+    [[maybe_unused]] const auto n = ::write(wake_write_, &one, 1);
+#endif
+}
+
+
+void event_loop::drain()
+{
+    char buffer[64];
+#ifdef KAIXIN_OS_WINDOWS
+    while (recv(static_cast<SOCKET>(wake_read_), buffer, sizeof(buffer), 0) > 0)
+    {
+    }
+#else
+    while (::read(wake_read_, buffer, sizeof(buffer)) > 0)
+    {
+    }
+#endif
+}
+
+#endif
+
+
+}       // namespace kaixin
@@ -0,0 +1,157 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        event_loop.h
+ * \brief       event_loop 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "timer_wheel.h"
+
+
+namespace kaixin {
+
+
+/*!
+ * \brief       SDK 的事件循环。
+ *
+ * 一个线程同时驱动套接字 I/O、投递的任务与定时器：Linux 上使用 epoll，Windows 上使用 WSAPoll，
+ * 其它平台使用 poll；其它线程注册套接字、投递任务或添加定时器时，通过唤醒描述符
+ * （Linux 上为 eventfd）打断等待。等待时间取最近的定时器，没有事件时线程不被唤醒。
+ *
+ * HTTP/2 会话的收发与所有 SDK 定时器都在此线程中执行，连接数增加时线程数不变。
+ * 回调在循环线程中执行，不能阻塞；耗时的工作投递到 `worker_pool`。
+ *
+ * HTTP/1.1 请求的连接、TLS 握手与收发仍由调用线程执行，但需要等待时通过 `io_waiter` 把套接字
+ * 注册到此线程，由它检测就绪，调用线程不再轮询套接字。下行通知的连接
+ * （`websocket_connection`）握手后注册在此线程中收发。只有 DNS 解析在 `dns_cache` 的解析线程中
+ * 进行。
+ */
+class event_loop : private noncopyable
+{
+public:
+    /// 套接字可读。
+    static constexpr uint32_t READABLE = 1;
+    /// 套接字可写。
+    static constexpr uint32_t WRITABLE = 2;
+    /// 套接字出错或对端关闭，只出现在回调参数中。
+    static constexpr uint32_t FAILED = 4;
+    /// 报告一次事件后不再关心任何事件，直到再次 `modify`。只用于 `add` 与 `modify` 的参数。
+    static constexpr uint32_t ONESHOT = 8;
+
+    using watch_id = uint64_t;
+    using io_handler = std::function<void(uint32_t events)>;
+    using task = std::function<void()>;
+
+    /// 获取全局事件循环，首次使用时启动线程。
+    static event_loop &instance();
+
+    /*!
+     * \brief       注册套接字。
+     *
+     * \param[in]   fd          非阻塞套接字，注销前不能关闭
+     * \param[in]   events      关心的事件，`READABLE` 与 `WRITABLE` 的组合
+     * \param[in]   handler     事件回调函数，在循环线程中调用
+     *
+     * \return      注册 ID，非零；如果失败，则返回零。
+     */
+    watch_id add(int fd, uint32_t events, io_handler handler);
+
+    /// 修改关心的事件。可以在任意线程中调用，不等待。
+    void modify(watch_id id, uint32_t events);
+
+    /*!
+     * \brief       注销套接字。
+     *
+     * 如果回调正在循环线程中执行，则等待其返回；在回调中注销时不等待。因此调用者不能在持有
+     * 回调所需的锁时从其它线程注销，此时应投递到循环线程中注销。
+     *
+     * \param[in]   id          注册 ID；已注销的 ID 被忽略
+     */
+    void remove(watch_id id);
+
+    /// 投递任务，在循环线程中执行。
+    void post(task t);
+
+    /// 循环驱动的定时器。
+    timer_wheel &timers() { return timers_; }
+
+    /// 当前线程是否为循环线程。
+    bool in_loop_thread() const { return loop_thread_.load() == std::this_thread::get_id(); }
+
+    /*!
+     * \brief       取消所有定时器与任务，停止线程。之后使用时重新启动。不能在循环线程中调用。
+     *
+     * 调用前应注销所有套接字。
+     */
+    void stop();
+
+private:
+    /// 已注册的套接字。
+    struct watch
+    {
+        int fd;                                 ///< 套接字
+        uint32_t events;                        ///< 关心的事件
+        std::shared_ptr<io_handler> handler;    ///< 回调函数
+    };
+
+    using ready_list = std::vector<std::pair<watch_id, uint32_t>>;
+
+    event_loop();
+    ~event_loop();
+
+    // 启动线程，调用者持有锁
+    void start_locked();
+
+    // 线程函数
+    void run();
+
+    // 距下一个定时器的毫秒数；有待执行的任务时为零，没有定时器时为 -1
+    int timeout_ms();
+
+    // 执行套接字的回调
+    void dispatch(watch_id id, uint32_t events);
+
+    // 平台相关：创建与关闭等待与唤醒描述符，等待事件，唤醒循环线程
+    bool open_backend();
+    void close_backend();
+    void wait(int timeout_ms, ready_list &ready);
+    void wake();
+    void drain();
+
+private:
+    std::mutex mutex_;
+    std::condition_variable done_;              ///< 回调执行完毕
+    std::map<watch_id, watch> watches_;
+    std::deque<task> tasks_;
+    std::thread thread_;
+    std::atomic<std::thread::id> loop_thread_;  ///< 循环线程的 ID
+    watch_id next_id_ = 1;
+    watch_id running_ = 0;                      ///< 正在执行回调的注册 ID
+    bool stopping_ = false;
+    int backend_fd_ = -1;                       ///< epoll 描述符，其它平台不用
+    int wake_read_ = -1;                        ///< 唤醒描述符的读端
+    int wake_write_ = -1;                       ///< 唤醒描述符的写端
+    timer_wheel timers_;
+};
+
+
+}       // namespace kaixin
@@ -16,16 +16,14 @@
 #include <sstream>
 
 #include <openssl/evp.h>
-#include <cppcodec/base64_url_unpadded.hpp>
 #include <rapidjson/ostreamwrapper.h>
 #include <rapidjson/writer.h>
 
+#include "codec.h"
 #include "utils.h"
 
 #ifdef _WIN32
 #include "wmi_client.h"
-#else
-#error "Unsupported platform."
 #endif
 
 namespace fp {
@@ -71,7 +69,7 @@ static std::string md5(std::string &s)
             break;
         }
 
-        hexed = utils::to_hex(digest, len);
+        hexed = codec::to_hex(digest, len);
     } while (false);
 
     EVP_MD_CTX_free(ctx);
@@ -122,7 +120,7 @@ std::string generate_simple_fingerprint()
     writer.EndObject();
 
     auto s = oss.str();
-    return cppcodec::base64_url_unpadded::encode(s);
+    return codec::base64url_encode(s);
 }
 
 
@@ -0,0 +1,708 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        h2_session.cpp
+ * \brief       h2_session 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "h2_session.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include <ixwebsocket/IXHttpClient.h>
+#include <nghttp2/nghttp2.h>
+
+#include "body_sink.h"
+#include "connection_pool.h"
+#include "logger.h"
+#include "tls_socket.h"
+
+
+namespace http {
+
+
+/// 等待流结束与连接建立的轮询间隔。
+static constexpr auto POLL_INTERVAL = std::chrono::milliseconds(10);
+/// 没有活动流的会话保留的时间。
+static constexpr auto IDLE_TIMEOUT = std::chrono::milliseconds(60000);
+/// 允许服务端同时推送的流数；客户端不接受推送。
+static constexpr uint32_t MAX_CONCURRENT_STREAMS = 100;
+/// 流的初始接收窗口。
+static constexpr uint32_t INITIAL_WINDOW_SIZE = 1024 * 1024;
+
+
+/// 流的状态，由发起请求的线程持有，回调函数通过流的用户数据访问。
+struct h2_session::stream
+{
+    ix::HttpResponse &resp;                     ///< 响应
+    const std::string &body;                    ///< 请求体
+    const ix::OnChunkCallback &on_chunk;        ///< 响应体数据回调函数
+    size_t offset = 0;                          ///< 已发送的请求体长度
+    std::unique_ptr<body_sink> sink;            ///< 响应体接收对象
+    ix::HttpErrorCode code = ix::HttpErrorCode::Ok;     ///< 错误码
+    uint32_t error_code = 0;                    ///< 流关闭时的 HTTP/2 错误码
+    bool informational = false;                 ///< 当前响应头是否为 1xx 临时响应
+    bool closed = false;                        ///< 流是否已结束
+
+    stream(ix::HttpResponse &r, const std::string &b, const ix::OnChunkCallback &c)
+        : resp(r), body(b), on_chunk(c) { }
+};
+
+
+// 会话注册表
+struct h2_registry
+{
+    // 会话析构时从事件循环注销。先构造事件循环，进程退出时它在注册表之后析构
+    h2_registry() { kaixin::event_loop::instance(); }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::map<std::string, std::shared_ptr<h2_session>> sessions;    ///< 主机:端口 → 会话
+    std::set<std::string> connecting;                               ///< 正在建立连接的主机
+    std::set<std::string> http1_only;                               ///< 不支持 HTTP/2 的主机
+    std::atomic_bool enabled{ true };
+};
+
+
+static h2_registry &registry()
+{
+    static h2_registry r;
+    return r;
+}
+
+
+static inline nghttp2_nv make_nv(const std::string &name, const std::string &value)
+{
+    nghttp2_nv nv;
+    nv.name = reinterpret_cast<uint8_t *>(const_cast<char *>(name.data()));
+    nv.namelen = name.length();
+    nv.value = reinterpret_cast<uint8_t *>(const_cast<char *>(value.data()));
+    nv.valuelen = value.length();
+    nv.flags = NGHTTP2_NV_FLAG_NONE;
+    return nv;
+}
+
+
+// nghttp2 回调函数，都在持有会话锁时调用
+struct h2_callbacks
+{
+    using stream = h2_session::stream;
+
+    static stream *get(nghttp2_session *session, int32_t stream_id)
+    {
+        return static_cast<stream *>(nghttp2_session_get_stream_user_data(session, stream_id));
+    }
+
+    static ssize_t send(nghttp2_session *, const uint8_t *data, size_t length, int, void *user_data)
+    {
+        auto *self = static_cast<h2_session *>(user_data);
+        const auto ret = self->socket_->send(reinterpret_cast<char *>(const_cast<uint8_t *>(data)), length);
+
+        if (ret > 0)
+        {
+            self->write_blocked_ = false;
+            return ret;
+        }
+
+        if (ret < 0 && ix::Socket::isWaitNeeded())
+        {
+            self->write_blocked_ = true;
+            return NGHTTP2_ERR_WOULDBLOCK;
+        }
+
+        return NGHTTP2_ERR_CALLBACK_FAILURE;
+    }
+
+    static int on_header(nghttp2_session *session, const nghttp2_frame *frame, const uint8_t *name,
+                         size_t namelen, const uint8_t *value, size_t valuelen, uint8_t, void *)
+    {
+        auto *s = (frame->hd.type == NGHTTP2_HEADERS) ? get(session, frame->hd.stream_id) : nullptr;
+
+        if (s == nullptr)
+        {
+            return 0;
+        }
+
+        std::string key(reinterpret_cast<const char *>(name), namelen);
+        std::string val(reinterpret_cast<const char *>(value), valuelen);
+
+        if (key == ":status")
+        {
+            s->resp.statusCode = std::atoi(val.c_str());
+            s->informational = (s->resp.statusCode / 100 == 1);
+            s->resp.headers.clear();
+        }
+        else if (!s->informational && !key.empty() && key.front() != ':')
+        {
+            // 响应头名称为小写，ix::WebSocketHttpHeaders 不区分大小写
+            s->resp.headers[key] = std::move(val);
+        }
+
+        return 0;
+    }
+
+    static int on_data_chunk(nghttp2_session *session, uint8_t, int32_t stream_id, const uint8_t *data,
+                             size_t length, void *)
+    {
+        auto *s = get(session, stream_id);
+
+        if (s == nullptr || s->code != ix::HttpErrorCode::Ok)
+        {
+            return 0;
+        }
+
+        s->resp.downloadSize += length;
+
+        if (!s->sink)
+        {
+            // 压缩的响应体边接收边解压
+            auto iter = s->resp.headers.find("Content-Encoding");
+            auto length_iter = s->resp.headers.find("Content-Length");
+            const auto size_hint = (length_iter == s->resp.headers.end())
+                ? 0 : std::strtoull(length_iter->second.c_str(), nullptr, 10);
+            s->sink = make_body_sink(iter == s->resp.headers.end() ? std::string() : iter->second,
+                                     s->resp.payload, static_cast<size_t>(size_hint), s->on_chunk);
+        }
+
+        if (!s->sink || !s->sink->write(reinterpret_cast<const char *>(data), length))
+        {
+            s->code = ix::HttpErrorCode::Gzip;
+            nghttp2_submit_rst_stream(session, NGHTTP2_FLAG_NONE, stream_id, NGHTTP2_INTERNAL_ERROR);
+        }
+
+        return 0;
+    }
+
+    static int on_stream_close(nghttp2_session *session, int32_t stream_id, uint32_t error_code,
+                               void *user_data)
+    {
+        auto *self = static_cast<h2_session *>(user_data);
+        auto *s = get(session, stream_id);
+
+        if (s == nullptr)
+        {
+            return 0;
+        }
+
+        s->closed = true;
+        s->error_code = error_code;
+
+        if (s->code == ix::HttpErrorCode::Ok && error_code == NGHTTP2_NO_ERROR && s->sink && !s->sink->finish())
+        {
+            s->code = ix::HttpErrorCode::Gzip;
+        }
+
+        self->streams_.erase(s);
+
+        if (self->streams_.empty())
+        {
+            self->idle_since_ = h2_session::clock::now();
+        }
+
+        self->cv_.notify_all();
+        return 0;
+    }
+
+    static ssize_t read_body(nghttp2_session *session, int32_t stream_id, uint8_t *buffer, size_t length,
+                             uint32_t *data_flags, nghttp2_data_source *, void *)
+    {
+        auto *s = get(session, stream_id);
+
+        if (s == nullptr)
+        {
+            // 发起请求的线程已放弃该流
+            return NGHTTP2_ERR_TEMPORAL_CALLBACK_FAILURE;
+        }
+
+        const auto n = std::min(length, s->body.length() - s->offset);
+        memcpy(buffer, s->body.data() + s->offset, n);
+        s->offset += n;
+
+        if (s->offset == s->body.length())
+        {
+            *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+        }
+
+        return static_cast<ssize_t>(n);
+    }
+};
+
+
+h2_session::h2_session(std::unique_ptr<tls_socket> socket)
+    : socket_(std::move(socket))
+    , session_(nullptr)
+    , watch_(0)
+    , idle_timer_(0)
+    , idle_since_(clock::now())
+    , alive_(false)
+    , write_blocked_(false)
+    , want_write_(false)
+{
+}
+
+
+h2_session::~h2_session()
+{
+    // 不持有锁：取消与注销时等待正在执行的回调返回，而回调要加锁
+    auto &loop = kaixin::event_loop::instance();
+    loop.timers().cancel(idle_timer_);
+    loop.remove(watch_);
+
+    if (session_ != nullptr)
+    {
+        nghttp2_session_del(session_);
+    }
+
+    socket_->close();
+}
+
+
+bool h2_session::enabled()
+{
+    return registry().enabled;
+}
+
+
+void h2_session::set_enabled(bool enabled)
+{
+    registry().enabled = enabled;
+
+    if (!enabled)
+    {
+        clear();
+    }
+}
+
+
+std::shared_ptr<h2_session> h2_session::get(const std::string &host, int port, std::string &error,
+                                            const ix::CancellationRequest &cancelled)
+{
+    auto &r = registry();
+    const auto key = host + ':' + std::to_string(port);
+    std::unique_lock lock(r.mutex);
+
+    // 同一主机只建立一个连接，其它调用者等待
+    while (true)
+    {
+        if (r.http1_only.count(key) > 0)
+        {
+            return {};
+        }
+
+        auto iter = r.sessions.find(key);
+
+        if (iter != r.sessions.end() && iter->second->alive_)
+        {
+            return iter->second;
+        }
+
+        if (r.connecting.count(key) == 0)
+        {
+            break;
+        }
+
+        if (cancelled && cancelled())
+        {
+            error = "Cancelled while connecting";
+            return {};
+        }
+
+        r.cv.wait_for(lock, POLL_INTERVAL);
+    }
+
+    r.sessions.erase(key);
+    r.connecting.insert(key);
+    lock.unlock();
+
+    auto &pool = connection_pool::instance();
+    std::shared_ptr<h2_session> session;
+    auto socket = pool.connect_tls(host, port, true, error, cancelled);
+    bool http1_only = false;
+
+    if (socket && socket->alpn_protocol() != "h2")
+    {
+        // 服务端不支持 HTTP/2，连接留给 HTTP/1.1 请求使用
+        LI() << host << "does not support HTTP/2.";
+        pool.release(host, port, true, std::move(socket));
+        http1_only = true;
+    }
+    else if (socket)
+    {
+        session.reset(new h2_session(std::move(socket)));
+
+        if (!session->start())
+        {
+            error = "Cannot start HTTP/2 session";
+            session.reset();
+        }
+    }
+
+    lock.lock();
+    r.connecting.erase(key);
+
+    if (session)
+    {
+        r.sessions[key] = session;
+    }
+
+    if (http1_only)
+    {
+        r.http1_only.insert(key);
+    }
+
+    r.cv.notify_all();
+    return session;
+}
+
+
+void h2_session::clear()
+{
+    auto &r = registry();
+    std::map<std::string, std::shared_ptr<h2_session>> sessions;
+
+    {
+        std::lock_guard lock(r.mutex);
+        sessions.swap(r.sessions);
+        r.http1_only.clear();
+    }
+
+    // 在锁外关闭会话，等待事件循环中正在执行的回调返回
+    sessions.clear();
+}
+
+
+ix::HttpErrorCode h2_session::request(const std::string &verb, const std::string &host,
+                                      const std::string &path, const std::string &body,
+                                      const ix::HttpRequestArgs &args, ix::HttpResponse &resp,
+                                      const ix::CancellationRequest &cancelled, bool &refused)
+{
+    refused = false;
+
+    // 伪头在前；HTTP/2 的头名称必须为小写，且不能包含 Connection 等逐跳头
+    std::vector<std::pair<std::string, std::string>> headers{
+        { ":method", verb },
+        { ":scheme", "https" },
+        { ":authority", host },
+        { ":path", path },
+    };
+
+    if (args.extraHeaders.count("Accept") == 0)
+    {
+        headers.emplace_back("accept", "*/*");
+    }
+
+    if (args.compress && args.extraHeaders.count("Accept-Encoding") == 0)
+    {
+        headers.emplace_back("accept-encoding", "gzip, deflate");
+    }
+
+    for (const auto &[key, value] : args.extraHeaders)
+    {
+        auto name = key;
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        headers.emplace_back(std::move(name), value);
+    }
+
+    const bool has_body = (verb == ix::HttpClient::kPost || verb == ix::HttpClient::kPut
+                           || verb == ix::HttpClient::kPatch);
+
+    if (has_body)
+    {
+        if (args.extraHeaders.count("Content-Type") == 0)
+        {
+            headers.emplace_back("content-type", "application/x-www-form-urlencoded");
+        }
+
+        headers.emplace_back("content-length", std::to_string(body.length()));
+    }
+
+    std::vector<nghttp2_nv> nva;
+    nva.reserve(headers.size());
+
+    for (const auto &[name, value] : headers)
+    {
+        nva.push_back(make_nv(name, value));
+    }
+
+    if (args.verbose && args.logger)
+    {
+        args.logger(verb + " " + path + " HTTP/2");
+    }
+
+    resp.uploadSize = body.length();
+    stream s(resp, body, args.onChunkCallback);
+    nghttp2_data_provider provider;
+    provider.source.ptr = nullptr;
+    provider.read_callback = h2_callbacks::read_body;
+
+    std::unique_lock lock(mutex_);
+
+    if (!alive_)
+    {
+        refused = true;
+        return ix::HttpErrorCode::CannotConnect;
+    }
+
+    const auto stream_id = nghttp2_submit_request(session_, nullptr, nva.data(), nva.size(),
+                                                  has_body ? &provider : nullptr, &s);
+
+    if (stream_id < 0)
+    {
+        // 会话已收到 GOAWAY 或流 ID 已用尽，不再接受新的流
+        refused = true;
+        return ix::HttpErrorCode::CannotConnect;
+    }
+
+    streams_.insert(&s);
+
+    if (!flush())
+    {
+        shutdown();
+    }
+
+    while (!s.closed)
+    {
+        if (cancelled && cancelled())
+        {
+            // 放弃该流，回调函数不再访问它
+            if (alive_)
+            {
+                nghttp2_session_set_stream_user_data(session_, stream_id, nullptr);
+                nghttp2_submit_rst_stream(session_, NGHTTP2_FLAG_NONE, stream_id, NGHTTP2_CANCEL);
+
+                if (!flush())
+                {
+                    shutdown();
+                }
+            }
+
+            streams_.erase(&s);
+            return ix::HttpErrorCode::Cancelled;
+        }
+
+        cv_.wait_for(lock, POLL_INTERVAL);
+    }
+
+    if (s.error_code == NGHTTP2_REFUSED_STREAM)
+    {
+        refused = true;
+        return ix::HttpErrorCode::CannotConnect;
+    }
+
+    if (s.code != ix::HttpErrorCode::Ok)
+    {
+        return s.code;
+    }
+
+    if (s.error_code != NGHTTP2_NO_ERROR || resp.statusCode == 0)
+    {
+        return ix::HttpErrorCode::CannotReadBody;
+    }
+
+    return ix::HttpErrorCode::Ok;
+}
+
+
+bool h2_session::start()
+{
+    nghttp2_session_callbacks *callbacks = nullptr;
+
+    if (nghttp2_session_callbacks_new(&callbacks) != 0)
+    {
+        return false;
+    }
+
+    nghttp2_session_callbacks_set_send_callback(callbacks, h2_callbacks::send);
+    nghttp2_session_callbacks_set_on_header_callback(callbacks, h2_callbacks::on_header);
+    nghttp2_session_callbacks_set_on_data_chunk_recv_callback(callbacks, h2_callbacks::on_data_chunk);
+    nghttp2_session_callbacks_set_on_stream_close_callback(callbacks, h2_callbacks::on_stream_close);
+
+    const auto ret = nghttp2_session_client_new(&session_, callbacks, this);
+    nghttp2_session_callbacks_del(callbacks);
+
+    if (ret != 0)
+    {
+        session_ = nullptr;
+        return false;
+    }
+
+    const nghttp2_settings_entry settings[] = {
+        { NGHTTP2_SETTINGS_ENABLE_PUSH, 0 },
+        { NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, MAX_CONCURRENT_STREAMS },
+        { NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, INITIAL_WINDOW_SIZE },
+    };
+
+    if (nghttp2_submit_settings(session_, NGHTTP2_FLAG_NONE, settings, std::size(settings)) != 0)
+    {
+        return false;
+    }
+
+    alive_ = true;
+
+    // 套接字注册到事件循环中；回调只持有弱引用，会话可以随时销毁
+    std::weak_ptr<h2_session> weak = shared_from_this();
+    std::lock_guard lock(mutex_);
+    auto &loop = kaixin::event_loop::instance();
+    watch_ = loop.add(socket_->fd(), kaixin::event_loop::READABLE, [weak](uint32_t events)
+    {
+        if (auto self = weak.lock())
+        {
+            self->on_io(events);
+        }
+    });
+
+    // 发送连接前言与 SETTINGS
+    if (watch_ == 0 || !flush())
+    {
+        alive_ = false;
+        return false;
+    }
+
+    arm_idle_timer(IDLE_TIMEOUT);
+    return true;
+}
+
+
+void h2_session::on_io(uint32_t events)
+{
+    std::array<uint8_t, 16 * 1024> buffer;
+    std::lock_guard lock(mutex_);
+
+    if (!alive_)
+    {
+        return;
+    }
+
+    // 读取所有可读的数据；写阻塞时也要读，避免双方都等待对方的流量控制窗口
+    bool failed = false;
+
+    if (events & (kaixin::event_loop::READABLE | kaixin::event_loop::FAILED))
+    {
+        while (true)
+        {
+            const auto n = socket_->recv(buffer.data(), buffer.size());
+
+            if (n > 0)
+            {
+                if (nghttp2_session_mem_recv(session_, buffer.data(), static_cast<size_t>(n)) < 0)
+                {
+                    failed = true;
+                    break;
+                }
+
+                continue;
+            }
+
+            failed = (n == 0 || !ix::Socket::isWaitNeeded());
+            break;
+        }
+    }
+
+    // 发送确认、窗口更新与写阻塞时未发完的帧
+    if (failed || !flush())
+    {
+        shutdown();
+    }
+}
+
+
+void h2_session::on_idle_timer()
+{
+    std::lock_guard lock(mutex_);
+    idle_timer_ = 0;
+
+    if (!alive_)
+    {
+        return;
+    }
+
+    const auto idle = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - idle_since_);
+
+    if (!streams_.empty() || idle < IDLE_TIMEOUT)
+    {
+        arm_idle_timer(streams_.empty() ? IDLE_TIMEOUT - idle : IDLE_TIMEOUT);
+        return;
+    }
+
+    nghttp2_session_terminate_session(session_, NGHTTP2_NO_ERROR);
+    nghttp2_session_send(session_);
+    shutdown();
+}
+
+
+void h2_session::arm_idle_timer(std::chrono::milliseconds delay)
+{
+    std::weak_ptr<h2_session> weak = shared_from_this();
+    idle_timer_ = kaixin::event_loop::instance().timers().schedule(delay, [weak]
+    {
+        if (auto self = weak.lock())
+        {
+            self->on_idle_timer();
+        }
+    });
+}
+
+
+bool h2_session::flush()
+{
+    if (nghttp2_session_send(session_) != 0)
+    {
+        return false;
+    }
+
+    if (!nghttp2_session_want_read(session_) && !nghttp2_session_want_write(session_))
+    {
+        // 双方都已发送 GOAWAY
+        return false;
+    }
+
+    if (write_blocked_ != want_write_)
+    {
+        // 写阻塞时等待可写，之后在事件循环中继续发送
+        want_write_ = write_blocked_;
+        const auto events = kaixin::event_loop::READABLE | (want_write_ ? kaixin::event_loop::WRITABLE : 0);
+        kaixin::event_loop::instance().modify(watch_, events);
+    }
+
+    return true;
+}
+
+
+void h2_session::shutdown()
+{
+    alive_ = false;
+
+    // 连接已断开，尚未结束的流都失败
+    for (auto *s : streams_)
+    {
+        s->closed = true;
+
+        if (s->code == ix::HttpErrorCode::Ok)
+        {
+            s->code = ix::HttpErrorCode::CannotReadBody;
+        }
+    }
+
+    streams_.clear();
+    cv_.notify_all();
+
+    // 在事件循环线程中注销：其它线程持有会话锁时注销，可能与等待该锁的回调互相等待。
+    // 套接字在会话销毁时才关闭，注销前描述符不会被复用
+    auto &loop = kaixin::event_loop::instance();
+    loop.post([&loop, watch = watch_] { loop.remove(watch); });
+}
+
+
+}       // namespace http
@@ -0,0 +1,135 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        h2_session.h
+ * \brief       h2_session 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include <ixwebsocket/IXCancellationRequest.h>
+#include <ixwebsocket/IXHttp.h>
+
+#include "event_loop.h"
+
+typedef struct nghttp2_session nghttp2_session;
+class tls_socket;
+
+
+namespace http {
+
+
+/*!
+ * \brief       HTTP/2 客户端会话。
+ *
+ * 每个主机一个连接，所有并发请求作为独立的流在该连接上复用；重复的请求头（例如
+ * `Authorization`）经 HPACK 压缩后只在首次发送全文。所有会话的套接字注册在 `kaixin::event_loop`
+ * 中，由事件循环线程接收；发起请求的线程提交请求后直接发送，然后等待流结束。会话锁串行化
+ * 两个线程对 TLS 连接的访问。空闲超时由事件循环的定时器检查。
+ *
+ * 服务端 ALPN 不选择 h2 时，记住该主机只支持 HTTP/1.1，握手得到的连接交给 `connection_pool`。
+ */
+class h2_session : private noncopyable, public std::enable_shared_from_this<h2_session>
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    ~h2_session();
+
+    /// 是否启用 HTTP/2。
+    static bool enabled();
+
+    /// 启用或禁用 HTTP/2。禁用时关闭所有会话。
+    static void set_enabled(bool enabled);
+
+    /*!
+     * \brief       获取到主机的会话，没有可用的会话时新建连接。
+     *
+     * \param[in]   host        主机名
+     * \param[in]   port        端口
+     * \param[out]  error       出错时的错误信息
+     * \param[in]   cancelled   取消请求
+     *
+     * \return      会话；如果出错，则返回空指针，`error` 不为空；如果主机不支持 HTTP/2，
+     *              则返回空指针，`error` 为空。
+     */
+    static std::shared_ptr<h2_session> get(const std::string &host, int port, std::string &error,
+                                           const ix::CancellationRequest &cancelled);
+
+    /// 关闭所有会话，并忘记不支持 HTTP/2 的主机。
+    static void clear();
+
+    /*!
+     * \brief       在新的流上发送请求，并等待响应。
+     *
+     * \param[in]   verb        请求方法，全大写
+     * \param[in]   host        主机名
+     * \param[in]   path        路径与查询
+     * \param[in]   body        请求体
+     * \param[in]   args        请求参数
+     * \param[out]  resp        响应
+     * \param[in]   cancelled   取消请求
+     * \param[out]  refused     服务端是否确定未处理该请求，可以换一个连接重试
+     *
+     * \return      错误码。
+     */
+    ix::HttpErrorCode request(const std::string &verb, const std::string &host, const std::string &path,
+                              const std::string &body, const ix::HttpRequestArgs &args,
+                              ix::HttpResponse &resp, const ix::CancellationRequest &cancelled,
+                              bool &refused);
+
+private:
+    struct stream;
+
+    explicit h2_session(std::unique_ptr<tls_socket> socket);
+
+    bool start();
+
+    // 事件循环回调：接收数据并发送待发送的帧
+    void on_io(uint32_t events);
+
+    // 空闲检查定时器回调
+    void on_idle_timer();
+
+    // 安排空闲检查，调用者持有锁
+    void arm_idle_timer(std::chrono::milliseconds delay);
+
+    // 发送待发送的帧，并按是否写阻塞更新关心的事件；调用者持有锁。连接不再可用时返回 `false`
+    bool flush();
+
+    // 连接断开，尚未结束的流都失败；调用者持有锁
+    void shutdown();
+
+    friend struct h2_callbacks;
+
+private:
+    std::unique_ptr<tls_socket> socket_;
+    nghttp2_session *session_;
+    kaixin::event_loop::watch_id watch_;
+    kaixin::timer_wheel::timer_id idle_timer_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::set<stream *> streams_;
+    clock::time_point idle_since_;
+    std::atomic_bool alive_;
+    bool write_blocked_;
+    bool want_write_;                           ///< 是否已在事件循环中关心可写
+};
+
+
+}       // namespace http
@@ -0,0 +1,84 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        hmac_sha256.cpp
+ * \brief       hmac_sha256 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+// OpenSSL 3.0 起 SHA256_Init 等底层函数已不推荐使用，但只有它们的上下文可以直接复制、不分配内存
+#define OPENSSL_SUPPRESS_DEPRECATED
+#include "hmac_sha256.h"
+
+#include <cstring>
+
+#include <openssl/crypto.h>
+
+
+namespace kaixin {
+
+
+hmac_sha256::hmac_sha256()
+    : hmac_sha256(std::string())
+{
+}
+
+
+hmac_sha256::hmac_sha256(const std::string &key)
+{
+    // RFC 2104：长于块大小的密钥先做摘要，短的补零
+    uint8_t block[SHA256_CBLOCK] = { 0 };
+
+    if (key.size() > sizeof(block))
+    {
+        SHA256(reinterpret_cast<const uint8_t *>(key.data()), key.size(), block);
+    }
+    else
+    {
+        memcpy(block, key.data(), key.size());
+    }
+
+    uint8_t pad[SHA256_CBLOCK];
+
+    for (size_t i = 0; i < sizeof(pad); i++)
+    {
+        pad[i] = block[i] ^ 0x36;
+    }
+
+    SHA256_Init(&inner_);
+    SHA256_Update(&inner_, pad, sizeof(pad));
+
+    for (size_t i = 0; i < sizeof(pad); i++)
+    {
+        pad[i] = block[i] ^ 0x5c;
+    }
+
+    SHA256_Init(&outer_);
+    SHA256_Update(&outer_, pad, sizeof(pad));
+
+    OPENSSL_cleanse(block, sizeof(block));
+    OPENSSL_cleanse(pad, sizeof(pad));
+}
+
+
+void hmac_sha256::update(const void *data, size_t length)
+{
+    SHA256_Update(&inner_, data, length);
+}
+
+
+void hmac_sha256::final(uint8_t (&digest)[DIGEST_LENGTH])
+{
+    // 外层摘要 = SHA256(key ^ opad || SHA256(key ^ ipad || message))
+    uint8_t inner_digest[DIGEST_LENGTH];
+    SHA256_Final(inner_digest, &inner_);
+    SHA256_Update(&outer_, inner_digest, sizeof(inner_digest));
+    SHA256_Final(digest, &outer_);
+}
+
+
+}       // namespace kaixin
@@ -0,0 +1,62 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        hmac_sha256.h
+ * \brief       hmac_sha256 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <openssl/sha.h>
+
+
+namespace kaixin {
+
+
+/*!
+ * \brief       HMAC-SHA256 计算。
+ *
+ * 构造时把密钥与 ipad、opad 异或后的块分别送入内外两个 SHA256 上下文，此后的对象只包含这两个
+ * 上下文，可以直接复制。因此密钥只需处理一次：每次签名复制一份已设置密钥的对象，再逐段
+ * `update` 消息即可，整个过程不分配内存。
+ */
+class hmac_sha256
+{
+public:
+    /// 摘要长度，以字节为单位。
+    static constexpr size_t DIGEST_LENGTH = SHA256_DIGEST_LENGTH;
+
+    hmac_sha256();
+    explicit hmac_sha256(const std::string &key);
+
+    /*!
+     * \brief       追加消息。
+     *
+     * \param[in]   data        数据
+     * \param[in]   length      数据长度
+     */
+    void update(const void *data, size_t length);
+    void update(const std::string &s) { update(s.data(), s.size()); }
+
+    /*!
+     * \brief       完成计算。之后对象不能再使用。
+     *
+     * \param[out]  digest      摘要
+     */
+    void final(uint8_t (&digest)[DIGEST_LENGTH]);
+
+private:
+    SHA256_CTX inner_;      ///< 已送入 key ^ ipad 的内层上下文
+    SHA256_CTX outer_;      ///< 已送入 key ^ opad 的外层上下文
+};
+
+
+}       // namespace kaixin
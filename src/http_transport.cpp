@@ -0,0 +1,653 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        http_transport.cpp
+ * \brief       HTTP 传输函数源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "http_transport.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+#include <ixwebsocket/IXHttpClient.h>
+#include <ixwebsocket/IXSocket.h>
+#include <ixwebsocket/IXUrlParser.h>
+
+#include "body_sink.h"
+#include "buffer_pool.h"
+#include "connection_pool.h"
+#include "event_loop.h"
+#include "tcp_socket.h"
+
+#ifdef KAIXIN_HAS_HTTP2
+#include "h2_session.h"
+#endif
+
+
+namespace http {
+
+
+/// 响应行的最大长度。
+static constexpr size_t MAX_LINE_LENGTH = 64 * 1024;
+/// 连接失效时最多重试的次数。
+static constexpr int MAX_ATTEMPTS = 5;
+/// 每次从套接字接收的最大长度。
+static constexpr size_t RECV_CHUNK = 16 * 1024;
+
+
+// 带缓冲的响应读取器。没有数据时由事件循环检测套接字可读，调用线程不轮询
+class response_reader
+{
+public:
+    response_reader(tcp_socket &socket, const ix::CancellationRequest &cancelled)
+        : socket_(socket)
+        , cancelled_(cancelled)
+        , buffer_(buffer_pool::instance().acquire())
+        , pos_(0)
+        , received_(0)
+    {
+    }
+
+    ~response_reader()
+    {
+        buffer_pool::instance().release(std::move(buffer_));
+    }
+
+    // 已接收的字节数
+    size_t received() const { return received_; }
+
+    // 读取一行，不包括行尾的 CRLF
+    bool read_line(std::string &line)
+    {
+        while (true)
+        {
+            auto end = buffer_.find('\n', pos_);
+
+            if (end != std::string::npos)
+            {
+                auto length = end - pos_;
+
+                if (length > 0 && buffer_[end - 1] == '\r')
+                {
+                    length--;
+                }
+
+                line.assign(buffer_, pos_, length);
+                pos_ = end + 1;
+                return true;
+            }
+
+            if (buffer_.length() - pos_ > MAX_LINE_LENGTH || !fill())
+            {
+                return false;
+            }
+        }
+    }
+
+    // 读取指定长度的数据，写入 sink
+    bool read(size_t length, body_sink &sink)
+    {
+        while (length > 0)
+        {
+            if (pos_ == buffer_.length() && !fill())
+            {
+                return false;
+            }
+
+            auto n = std::min(length, buffer_.length() - pos_);
+
+            if (!sink.write(buffer_.data() + pos_, n))
+            {
+                return false;
+            }
+
+            pos_ += n;
+            length -= n;
+        }
+
+        return true;
+    }
+
+    // 读取到连接关闭为止。只有对端正常关闭（TLS 连接收到 close_notify）才算读取完整，
+    // 连接出错或 TLS 连接被直接关闭时响应体可能被截断
+    bool read_to_end(body_sink &sink)
+    {
+        do
+        {
+            if (!sink.write(buffer_.data() + pos_, buffer_.length() - pos_))
+            {
+                return false;
+            }
+
+            pos_ = buffer_.length();
+        } while (fill());
+
+        return eof_;
+    }
+
+private:
+    // 从套接字接收更多数据
+    bool fill()
+    {
+        // 丢弃已消费的数据
+        buffer_.erase(0, pos_);
+        pos_ = 0;
+
+        while (!cancelled_())
+        {
+            // 直接接收到缓冲区尾部，缓冲区来自缓冲池，容量足够时不再分配
+            const auto used = buffer_.length();
+            buffer_.resize(used + RECV_CHUNK);
+            auto ret = socket_.recv(&buffer_[used], RECV_CHUNK);
+            buffer_.resize(used + static_cast<size_t>(std::max<ssize_t>(ret, 0)));
+
+            if (ret > 0)
+            {
+                received_ += static_cast<size_t>(ret);
+                return true;
+            }
+
+            if (ret == 0)
+            {
+                // 对端关闭
+                eof_ = true;
+                return false;
+            }
+
+            if (!ix::Socket::isWaitNeeded() || !socket_.wait(kaixin::event_loop::READABLE, cancelled_))
+            {
+                return false;
+            }
+        }
+
+        return false;
+    }
+
+private:
+    tcp_socket &socket_;
+    const ix::CancellationRequest &cancelled_;
+    std::string buffer_;
+    size_t pos_;
+    size_t received_;
+    bool eof_ = false;
+};
+
+
+static inline std::string trim(const std::string &s)
+{
+    auto begin = s.find_first_not_of(" \t");
+
+    if (begin == std::string::npos)
+    {
+        return {};
+    }
+
+    auto end = s.find_last_not_of(" \t");
+    return s.substr(begin, end - begin + 1);
+}
+
+
+static inline bool contains_token(const ix::WebSocketHttpHeaders &headers, const char *name,
+                                  const char *token)
+{
+    auto iter = headers.find(name);
+
+    if (iter == headers.end())
+    {
+        return false;
+    }
+
+    auto value = iter->second;
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value.find(token) != std::string::npos;
+}
+
+
+// 读取分块编码的响应体
+static bool read_chunked_body(response_reader &reader, body_sink &sink)
+{
+    std::string line;
+
+    while (true)
+    {
+        if (!reader.read_line(line))
+        {
+            return false;
+        }
+
+        auto size = std::strtoull(line.c_str(), nullptr, 16);
+
+        if (size == 0)
+        {
+            // 跳过尾部头，直到空行
+            do
+            {
+                if (!reader.read_line(line))
+                {
+                    return false;
+                }
+            } while (!line.empty());
+
+            return true;
+        }
+
+        if (!reader.read(static_cast<size_t>(size), sink) || !reader.read_line(line))
+        {
+            return false;
+        }
+    }
+}
+
+
+// 读取响应
+static ix::HttpErrorCode read_response(response_reader &reader, const std::string &verb,
+                                       const ix::OnChunkCallback &on_chunk, ix::HttpResponse &resp,
+                                       bool &keep_alive)
+{
+    std::string line;
+    std::string version;
+
+    // 跳过 1xx 临时响应
+    do
+    {
+        if (!reader.read_line(line))
+        {
+            return ix::HttpErrorCode::CannotReadStatusLine;
+        }
+
+        // HTTP/1.1 200 OK
+        auto sp = line.find(' ');
+
+        if (sp == std::string::npos || line.compare(0, 5, "HTTP/") != 0)
+        {
+            return ix::HttpErrorCode::MissingStatus;
+        }
+
+        version = line.substr(0, sp);
+        resp.statusCode = std::atoi(line.c_str() + sp + 1);
+        sp = line.find(' ', sp + 1);
+        resp.description = (sp == std::string::npos) ? std::string() : line.substr(sp + 1);
+        resp.headers.clear();
+
+        // 响应头
+        while (true)
+        {
+            if (!reader.read_line(line))
+            {
+                return ix::HttpErrorCode::HeaderParsingError;
+            }
+
+            if (line.empty())
+            {
+                break;
+            }
+
+            auto colon = line.find(':');
+
+            if (colon == std::string::npos)
+            {
+                return ix::HttpErrorCode::HeaderParsingError;
+            }
+
+            resp.headers[trim(line.substr(0, colon))] = trim(line.substr(colon + 1));
+        }
+    } while (resp.statusCode / 100 == 1);
+
+    if (version == "HTTP/1.0")
+    {
+        keep_alive = contains_token(resp.headers, "Connection", "keep-alive");
+    }
+    else
+    {
+        keep_alive = !contains_token(resp.headers, "Connection", "close");
+    }
+
+    // 没有响应体的情况
+    if (verb == ix::HttpClient::kHead || resp.statusCode == 204 || resp.statusCode == 304)
+    {
+        return ix::HttpErrorCode::Ok;
+    }
+
+    const bool chunked = contains_token(resp.headers, "Transfer-Encoding", "chunked");
+    auto iter = resp.headers.find("Content-Length");
+    const bool has_length = !chunked && iter != resp.headers.end();
+    const auto length = has_length ? std::strtoull(iter->second.c_str(), nullptr, 10) : 0;
+
+    // 压缩的响应体边接收边解压
+    iter = resp.headers.find("Content-Encoding");
+    auto sink = make_body_sink(iter == resp.headers.end() ? std::string() : iter->second,
+                               resp.payload, static_cast<size_t>(length), on_chunk);
+
+    if (!sink)
+    {
+        return ix::HttpErrorCode::Gzip;
+    }
+
+    ix::HttpErrorCode code = ix::HttpErrorCode::Ok;
+
+    if (chunked)
+    {
+        if (!read_chunked_body(reader, *sink))
+        {
+            code = ix::HttpErrorCode::ChunkReadError;
+        }
+    }
+    else if (has_length)
+    {
+        if (!reader.read(static_cast<size_t>(length), *sink))
+        {
+            code = ix::HttpErrorCode::CannotReadBody;
+        }
+    }
+    else
+    {
+        // 没有长度信息，读取到连接关闭为止
+        keep_alive = false;
+
+        if (!reader.read_to_end(*sink))
+        {
+            code = ix::HttpErrorCode::CannotReadBody;
+        }
+    }
+
+    if (code == ix::HttpErrorCode::Ok && !sink->finish())
+    {
+        code = ix::HttpErrorCode::Gzip;
+    }
+
+    return code;
+}
+
+
+// 构造请求头
+static std::string make_head(const std::string &verb, const std::string &host, const std::string &path,
+                             const std::string &body, const ix::HttpRequestArgs &args)
+{
+    std::string head;
+    head.reserve(256 + path.length() + body.length());
+    head += verb;
+    head += ' ';
+    head += path;
+    head += " HTTP/1.1\r\nHost: ";
+    head += host;
+    head += "\r\nConnection: keep-alive\r\n";
+
+    if (args.extraHeaders.count("Accept") == 0)
+    {
+        head += "Accept: */*\r\n";
+    }
+
+    if (args.compress && args.extraHeaders.count("Accept-Encoding") == 0)
+    {
+        head += "Accept-Encoding: gzip, deflate\r\n";
+    }
+
+    for (const auto &[key, value] : args.extraHeaders)
+    {
+        head += key;
+        head += ": ";
+        head += value;
+        head += "\r\n";
+    }
+
+    if (verb == ix::HttpClient::kPost || verb == ix::HttpClient::kPut || verb == ix::HttpClient::kPatch)
+    {
+        if (args.extraHeaders.count("Content-Type") == 0)
+        {
+            head += "Content-Type: application/x-www-form-urlencoded\r\n";
+        }
+
+        head += "Content-Length: ";
+        head += std::to_string(body.length());
+        head += "\r\n";
+    }
+
+    head += "\r\n";
+    return head;
+}
+
+
+// 创建响应，响应体接收到缓冲池中的缓冲区
+static ix::HttpResponsePtr make_response()
+{
+    auto resp = std::make_shared<ix::HttpResponse>();
+    resp->payload = buffer_pool::instance().acquire();
+    return resp;
+}
+
+
+static inline ix::HttpResponsePtr fail(ix::HttpResponsePtr resp, ix::HttpErrorCode code,
+                                       const std::string &msg)
+{
+    resp->statusCode = 0;
+    resp->errorCode = code;
+    resp->errorMsg = msg;
+    return resp;
+}
+
+
+// 合并调用者的取消请求与超时
+static ix::CancellationRequest combine(const ix::CancellationRequest &cancelled,
+                                      ix::CancellationRequest timeout)
+{
+    if (!cancelled)
+    {
+        return timeout;
+    }
+
+    return [cancelled, timeout = std::move(timeout)] { return cancelled() || timeout(); };
+}
+
+
+bool is_idempotent(const std::string &verb)
+{
+    return verb == "GET" || verb == "HEAD" || verb == "PUT" || verb == "DELETE" || verb == "OPTIONS";
+}
+
+
+#ifdef KAIXIN_HAS_HTTP2
+// 通过 HTTP/2 会话发送请求。主机不支持 HTTP/2 时返回空指针，由调用者改用 HTTP/1.1。
+static ix::HttpResponsePtr request_h2(const std::string &host, int port, const std::string &path,
+                                      const std::string &verb, const std::string &body,
+                                      const ix::HttpRequestArgsPtr &args,
+                                      const ix::CancellationRequest &cancelled)
+{
+    const auto aborted = [&cancelled] { return cancelled && cancelled(); };
+    auto resp = make_response();
+
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++)
+    {
+        if (aborted())
+        {
+            return fail(resp, ix::HttpErrorCode::Cancelled, "Request cancelled");
+        }
+
+        auto connect_cancelled = combine(cancelled,
+            ix::makeCancellationRequestWithTimeout(args->connectTimeout, args->cancel));
+        std::string error;
+        auto session = h2_session::get(host, port, error, connect_cancelled);
+
+        if (!session)
+        {
+            if (error.empty())
+            {
+                return {};
+            }
+
+            return fail(resp, aborted() ? ix::HttpErrorCode::Cancelled : ix::HttpErrorCode::CannotConnect,
+                        error);
+        }
+
+        auto transfer_cancelled = combine(cancelled,
+            ix::makeCancellationRequestWithTimeout(args->transferTimeout, args->cancel));
+        bool refused = false;
+        auto code = session->request(verb, host, path, body, *args, *resp, transfer_cancelled, refused);
+
+        if (refused)
+        {
+            // 服务端未处理该流（连接已关闭或收到 GOAWAY），换一个连接重试
+            buffer_pool::instance().release(std::move(resp->payload));
+            resp = make_response();
+            continue;
+        }
+
+        if (code == ix::HttpErrorCode::Ok)
+        {
+            return resp;
+        }
+
+        if (aborted())
+        {
+            return fail(resp, ix::HttpErrorCode::Cancelled, "Request cancelled");
+        }
+
+        return fail(resp, transfer_cancelled() ? ix::HttpErrorCode::Timeout : code, "Cannot read response");
+    }
+
+    return fail(resp, ix::HttpErrorCode::CannotConnect, "Too many refused streams");
+}
+#endif
+
+
+ix::HttpResponsePtr request(const std::string &url, const std::string &verb, const std::string &body,
+                            const ix::HttpRequestArgsPtr &args, const ix::CancellationRequest &cancelled,
+                            bool early_data)
+{
+    const auto aborted = [&cancelled] { return cancelled && cancelled(); };
+    auto resp = make_response();
+    std::string protocol;
+    std::string host;
+    std::string path;
+    std::string query;
+    int port = 0;
+
+    if (!ix::UrlParser::parse(url, protocol, host, path, query, port))
+    {
+        return fail(resp, ix::HttpErrorCode::UrlMalformed, "Cannot parse url: " + url);
+    }
+
+    const bool tls = (protocol == "https");
+
+#ifdef KAIXIN_HAS_HTTP2
+    // 所有并发请求复用同一个 HTTP/2 连接
+    if (tls && h2_session::enabled())
+    {
+        auto h2_resp = request_h2(host, port, path, verb, body, args, cancelled);
+
+        if (h2_resp)
+        {
+            return h2_resp;
+        }
+    }
+#endif
+
+    auto req = make_head(verb, host, path, body, *args);
+
+    if (args->verbose && args->logger)
+    {
+        args->logger(req);
+    }
+
+    req += body;
+    resp->uploadSize = req.length();
+    auto &pool = connection_pool::instance();
+    const std::string no_early_data;
+
+    // 所有请求都复用空闲连接，连接池只交出对端尚未关闭的连接。复用的连接仍可能在响应返回前
+    // 被关闭，此时无法确定服务端是否已处理请求：只有幂等请求换一个连接重发，其它请求返回错误
+    const bool replayable = is_idempotent(verb);
+
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++)
+    {
+        if (aborted())
+        {
+            return fail(resp, ix::HttpErrorCode::Cancelled, "Request cancelled");
+        }
+
+        auto connect_cancelled = combine(cancelled,
+            ix::makeCancellationRequestWithTimeout(args->connectTimeout, args->cancel));
+        bool reused = false;
+        bool early_data_accepted = false;
+        std::string error;
+        auto socket = pool.acquire(host, port, tls, true, reused, error, connect_cancelled,
+                                   (tls && early_data) ? req : no_early_data, early_data_accepted);
+
+        if (!socket)
+        {
+            return fail(resp, aborted() ? ix::HttpErrorCode::Cancelled : ix::HttpErrorCode::CannotConnect,
+                        error);
+        }
+
+        auto transfer_cancelled = combine(cancelled,
+            ix::makeCancellationRequestWithTimeout(args->transferTimeout, args->cancel));
+
+        // 早期数据被拒绝时，握手后重新发送
+        if (!early_data_accepted && !socket->write_all(req, transfer_cancelled))
+        {
+            if (aborted())
+            {
+                socket->close();
+                return fail(resp, ix::HttpErrorCode::Cancelled, "Request cancelled");
+            }
+
+            if (reused && replayable)
+            {
+                // 复用的连接已被服务端关闭，换一个连接重试
+                continue;
+            }
+
+            return fail(resp, ix::HttpErrorCode::SendError, "Cannot send request");
+        }
+
+        response_reader reader(*socket, transfer_cancelled);
+        bool keep_alive = false;
+        auto code = read_response(reader, verb, args->onChunkCallback, *resp, keep_alive);
+        resp->downloadSize = reader.received();
+
+        if (code != ix::HttpErrorCode::Ok)
+        {
+            if (reused && replayable && reader.received() == 0 && !transfer_cancelled())
+            {
+                // 复用的连接在响应前被关闭，请求未被处理，换一个连接重试
+                buffer_pool::instance().release(std::move(resp->payload));
+                resp = make_response();
+                resp->uploadSize = req.length();
+                continue;
+            }
+
+            socket->close();
+
+            if (aborted())
+            {
+                return fail(resp, ix::HttpErrorCode::Cancelled, "Request cancelled");
+            }
+
+            return fail(resp, transfer_cancelled() ? ix::HttpErrorCode::Timeout : code,
+                        "Cannot read response");
+        }
+
+        if (keep_alive)
+        {
+            pool.release(host, port, tls, std::move(socket));
+        }
+        else
+        {
+            socket->close();
+        }
+
+        return resp;
+    }
+
+    return fail(resp, ix::HttpErrorCode::CannotConnect, "Too many stale connections");
+}
+
+
+}       // namespace http
@@ -0,0 +1,61 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        http_transport.h
+ * \brief       HTTP 传输函数头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include <string>
+
+#include <ixwebsocket/IXCancellationRequest.h>
+#include <ixwebsocket/IXHttp.h>
+
+
+namespace http {
+
+
+/*!
+ * \brief       判断请求方法是否幂等。幂等的请求被服务端处理后重发不会产生额外的副作用。
+ *
+ * \param[in]   verb        请求方法，全大写
+ *
+ * \return      如果幂等，则返回 `true`；否则返回 `false`。
+ */
+bool is_idempotent(const std::string &verb);
+
+
+/*!
+ * \brief       同步发送 HTTP/1.1 请求。连接从 `connection_pool` 获取，响应读取完毕后归还以便复用。
+ *
+ * 启用 HTTP/2 时，HTTPS 请求优先通过 `h2_session` 在每个主机的单一连接上复用；服务端不支持
+ * HTTP/2 时使用 HTTP/1.1。
+ *
+ * 所有请求都复用对端尚未关闭的空闲连接。复用的连接在收到响应之前被关闭时，无法确定服务端是否
+ * 已处理请求：幂等请求换一个连接重发；POST、PATCH 等非幂等请求返回错误，不会被重复发送。
+ *
+ * 与 `ix::HttpClient::request` 用法相同：`args` 中的附加头、超时、日志设置均有效，但不处理重定向。
+ * 设置了 `args->onChunkCallback` 时，解码后的响应体在到达时逐段交给回调函数，`payload` 为空。
+ *
+ * \param[in]   url         完整 URL
+ * \param[in]   verb        请求方法，全大写
+ * \param[in]   body        请求体
+ * \param[in]   args        请求参数
+ * \param[in]   cancelled   调用者的取消请求，可以为空。连接、TLS 握手、发送、接收期间都会检查，
+ *                          返回 `true` 时尽快中止并返回 `ix::HttpErrorCode::Cancelled`
+ * \param[in]   early_data  是否允许在新建的 TLS 连接恢复会话时以早期数据（0-RTT）发送请求。
+ *                          早期数据可能被重放，只能用于没有副作用的请求
+ *
+ * \return      响应。出错时 `errorCode` 不为 `ix::HttpErrorCode::Ok`。
+ */
+ix::HttpResponsePtr request(const std::string &url, const std::string &verb, const std::string &body,
+                            const ix::HttpRequestArgsPtr &args,
+                            const ix::CancellationRequest &cancelled = nullptr, bool early_data = false);
+
+
+}       // namespace http
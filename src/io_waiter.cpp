@@ -0,0 +1,127 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        io_waiter.cpp
+ * \brief       io_waiter 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "io_waiter.h"
+
+#include <algorithm>
+#include <cassert>
+
+
+namespace kaixin {
+
+
+io_waiter::io_waiter(event_loop &loop)
+    : loop_(loop)
+    , state_(std::make_shared<shared_state>())
+{
+}
+
+
+io_waiter::~io_waiter()
+{
+    for (const auto &[fd, id] : watches_)
+    {
+        loop_.remove(id);
+    }
+}
+
+
+bool io_waiter::watch(int fd, uint32_t events)
+{
+    const auto flags = events | event_loop::ONESHOT;
+    auto iter = watches_.find(fd);
+
+    if (iter != watches_.end())
+    {
+        loop_.modify(iter->second, flags);
+        return true;
+    }
+
+    // 回调只记录就绪的事件并唤醒等待者，不能阻塞循环线程
+    const auto id = loop_.add(fd, flags, [state = state_, fd](uint32_t ready)
+    {
+        {
+            std::lock_guard lock(state->mutex);
+            state->ready.push_back({ fd, ready });
+        }
+
+        state->cond.notify_all();
+    });
+
+    if (id == 0)
+    {
+        return false;
+    }
+
+    watches_.emplace(fd, id);
+    return true;
+}
+
+
+void io_waiter::unwatch(int fd)
+{
+    auto iter = watches_.find(fd);
+
+    if (iter == watches_.end())
+    {
+        return;
+    }
+
+    // 不持有状态锁：注销时等待正在执行的回调，而回调要加锁
+    loop_.remove(iter->second);
+    watches_.erase(iter);
+
+    std::lock_guard lock(state_->mutex);
+    auto &ready = state_->ready;
+    ready.erase(std::remove_if(ready.begin(), ready.end(), [fd](const ready_socket &r) { return r.fd == fd; }),
+                ready.end());
+}
+
+
+std::vector<io_waiter::ready_socket> io_waiter::wait(clock::time_point until, const cancellation &cancelled)
+{
+    assert(!loop_.in_loop_thread());
+    std::vector<ready_socket> result;
+    std::unique_lock lock(state_->mutex);
+
+    while (state_->ready.empty())
+    {
+        const auto now = clock::now();
+
+        if (now >= until || (cancelled && cancelled()))
+        {
+            return result;
+        }
+
+        state_->cond.wait_until(lock, std::min(until, now + CANCEL_CHECK_INTERVAL));
+    }
+
+    result.swap(state_->ready);
+    return result;
+}
+
+
+uint32_t io_waiter::wait_one(int fd, uint32_t events, const cancellation &cancelled)
+{
+    io_waiter waiter;
+
+    if (!waiter.watch(fd, events))
+    {
+        return 0;
+    }
+
+    const auto ready = waiter.wait(clock::time_point::max(), cancelled);
+    return ready.empty() ? 0 : ready.front().events;
+}
+
+
+}       // namespace kaixin
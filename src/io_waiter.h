@@ -0,0 +1,111 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        io_waiter.h
+ * \brief       io_waiter 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "event_loop.h"
+
+
+namespace kaixin {
+
+
+/*!
+ * \brief       在调用线程中等待套接字就绪，就绪由事件循环检测。
+ *
+ * HTTP/1.1 请求、TLS 握手、并行连接与下行通知的握手在调用线程中收发。需要等待时，把套接字以
+ * `event_loop::ONESHOT` 方式注册到事件循环，由循环线程检测就绪并唤醒调用线程；调用线程不再
+ * 各自轮询套接字。取消请求只能主动查询，等待期间每隔 `CANCEL_CHECK_INTERVAL` 检查一次，
+ * 与 `http::h2_session` 相同。
+ *
+ * 一个套接字同时只能由一个等待者等待，也不能同时由其它回调注册在事件循环中。不能在循环线程中使用。
+ */
+class io_waiter : private noncopyable
+{
+public:
+    using clock = std::chrono::steady_clock;
+    using cancellation = std::function<bool()>;
+
+    /// 等待期间检查取消请求的间隔。
+    static constexpr auto CANCEL_CHECK_INTERVAL = std::chrono::milliseconds(10);
+
+    /// 就绪的套接字。
+    struct ready_socket
+    {
+        int fd;                                 ///< 套接字
+        uint32_t events;                        ///< 就绪的事件，可能包括 `event_loop::FAILED`
+    };
+
+    explicit io_waiter(event_loop &loop = event_loop::instance());
+
+    /// 析构函数。注销所有套接字。
+    ~io_waiter();
+
+    /*!
+     * \brief       开始等待套接字的事件。已在等待时改为新的事件。
+     *
+     * \param[in]   fd          非阻塞套接字，`unwatch` 或析构前不能关闭
+     * \param[in]   events      `event_loop::READABLE` 与 `event_loop::WRITABLE` 的组合
+     *
+     * \return      如果成功，则返回 `true`；否则返回 `false`。
+     */
+    bool watch(int fd, uint32_t events);
+
+    /// 不再等待套接字，之后可以关闭。
+    void unwatch(int fd);
+
+    /*!
+     * \brief       等待任一套接字就绪。就绪的套接字不再等待，需要时再次 `watch`。
+     *
+     * \param[in]   until       最晚等到的时间
+     * \param[in]   cancelled   取消请求，可以为空
+     *
+     * \return      就绪的套接字；超时或被取消时为空。
+     */
+    std::vector<ready_socket> wait(clock::time_point until, const cancellation &cancelled);
+
+    /*!
+     * \brief       等待单个套接字就绪，直到被取消。
+     *
+     * \param[in]   fd          非阻塞套接字
+     * \param[in]   events      `event_loop::READABLE` 或 `event_loop::WRITABLE`
+     * \param[in]   cancelled   取消请求，可以为空
+     *
+     * \return      就绪的事件；被取消或注册失败时返回零。
+     */
+    static uint32_t wait_one(int fd, uint32_t events, const cancellation &cancelled);
+
+private:
+    /// 与循环线程中的回调共享的状态。
+    struct shared_state
+    {
+        std::mutex mutex;
+        std::condition_variable cond;           ///< 有套接字就绪
+        std::vector<ready_socket> ready;        ///< 尚未取走的就绪套接字
+    };
+
+    event_loop &loop_;
+    std::shared_ptr<shared_state> state_;
+    std::map<int, event_loop::watch_id> watches_;
+};
+
+
+}       // namespace kaixin
@@ -0,0 +1,93 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        json_arena.cpp
+ * \brief       json_arena 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "json_arena.h"
+
+#include <cstddef>
+#include <optional>
+
+
+/// 每层节点缓冲区的大小。
+static constexpr size_t VALUE_BUFFER_SIZE = 32 * 1024;
+/// 每层解析栈缓冲区的大小。
+static constexpr size_t STACK_BUFFER_SIZE = 8 * 1024;
+/// 解析栈的初始容量，一次分配到位，避免解析过程中反复扩容。
+static constexpr size_t STACK_CAPACITY = 4 * 1024;
+
+
+/// 一层内存池。
+struct json_arena::level
+{
+    level()
+        : value_allocator(value_buffer, sizeof(value_buffer))
+        , stack_allocator(stack_buffer, sizeof(stack_buffer))
+    {
+    }
+
+    alignas(std::max_align_t) char value_buffer[VALUE_BUFFER_SIZE];     ///< 节点缓冲区
+    alignas(std::max_align_t) char stack_buffer[STACK_BUFFER_SIZE];     ///< 解析栈缓冲区
+    rapidjson::MemoryPoolAllocator<> value_allocator;                   ///< 节点分配器
+    rapidjson::MemoryPoolAllocator<> stack_allocator;                   ///< 解析栈分配器
+    std::optional<arena_document> doc;                                  ///< 本层的文档
+};
+
+
+std::vector<std::unique_ptr<json_arena::level>> &json_arena::levels()
+{
+    thread_local std::vector<std::unique_ptr<level>> l;
+    return l;
+}
+
+
+size_t &json_arena::depth()
+{
+    thread_local size_t d = 0;
+    return d;
+}
+
+
+// 取用当前线程的下一层，第一次用到该层时创建
+json_arena::level &json_arena::acquire()
+{
+    auto &l = levels();
+    auto &d = depth();
+
+    if (d == l.size())
+    {
+        l.push_back(std::make_unique<level>());
+    }
+
+    return *l[d++];
+}
+
+
+json_arena::json_arena()
+    : level_(acquire())
+{
+    // 重置上次使用留下的数据，保留初始缓冲区
+    level_.value_allocator.Clear();
+    level_.stack_allocator.Clear();
+    level_.doc.emplace(&level_.value_allocator, STACK_CAPACITY, &level_.stack_allocator);
+}
+
+
+json_arena::~json_arena()
+{
+    level_.doc.reset();
+    depth()--;
+}
+
+
+arena_document &json_arena::document()
+{
+    return *level_.doc;
+}
@@ -0,0 +1,60 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        json_arena.h
+ * \brief       json_arena 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <memory>
+#include <vector>
+
+#include <rapidjson/document.h>
+
+
+/// 节点与解析栈都分配在 `json_arena` 内存池中的文档类型，值类型与 `rapidjson::Document` 相同。
+using arena_document = rapidjson::GenericDocument<rapidjson::UTF8<>, rapidjson::MemoryPoolAllocator<>,
+                                                  rapidjson::MemoryPoolAllocator<>>;
+
+
+/*!
+ * \brief       线程局部的 rapidjson 内存池。
+ *
+ * 每个线程按嵌套深度保留若干层内存池，每层有固定大小的初始缓冲区用于节点，另一块用于解析栈。
+ * 构造时取用当前线程的下一层并重置（不释放初始缓冲区），析构时归还。响应处理函数中再解析
+ * JSON（例如解析 JWT）时使用更深一层，不影响外层文档。超出初始缓冲区的部分由内存池另行分配，
+ * 在下次重置时释放。
+ *
+ * 用法：
+ * \code
+ * json_arena arena;
+ * auto &doc = arena.document();
+ * doc.ParseInsitu(buffer);
+ * \endcode
+ */
+class json_arena : private noncopyable
+{
+public:
+    json_arena();
+    ~json_arena();
+
+    /// 获取本层的文档。文档在 `json_arena` 析构时销毁。
+    arena_document &document();
+
+private:
+    struct level;
+
+    static std::vector<std::unique_ptr<level>> &levels();
+    static size_t &depth();
+    static level &acquire();
+
+private:
+    level &level_;
+};
@@ -0,0 +1,171 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        json_stream_parser.cpp
+ * \brief       json_stream_parser 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "json_stream_parser.h"
+
+#include <rapidjson/memorystream.h>
+
+
+namespace kaixin {
+
+
+// 根值解析完毕即停止，之后的数据由 `parse` 检查
+static constexpr unsigned PARSE_FLAGS = rapidjson::kParseDefaultFlags | rapidjson::kParseStopWhenDoneFlag;
+
+
+json_stream_parser::json_stream_parser()
+    : in_string_(false)
+    , escaped_(false)
+    , failed_(false)
+{
+    reader_.IterativeParseInit();
+}
+
+
+json_stream_parser::~json_stream_parser()
+{
+}
+
+
+void json_stream_parser::feed(const std::string &chunk)
+{
+    if (chunk.empty() || failed_)
+    {
+        return;
+    }
+
+    // 没有遗留数据时直接在传输层的缓冲区上解析
+    const auto carried = pending_.length();
+
+    if (carried != 0)
+    {
+        pending_ += chunk;
+    }
+
+    const char *data = (carried != 0) ? pending_.data() : chunk.data();
+    const auto length = carried + chunk.length();
+    auto safe = scan(chunk.data(), chunk.length());
+    safe = (safe != 0) ? carried + safe : 0;
+
+    const auto consumed = parse(data, length, safe);
+
+    if (carried != 0)
+    {
+        pending_.erase(0, consumed);
+    }
+    else
+    {
+        pending_.assign(data + consumed, length - consumed);
+    }
+}
+
+
+bool json_stream_parser::finish()
+{
+    if (!failed_ && !reader_.IterativeParseComplete())
+    {
+        // 数据已全部到达，剩余的记号都是完整的
+        parse(pending_.data(), pending_.length(), pending_.length());
+        failed_ = failed_ || !reader_.IterativeParseComplete();
+    }
+
+    pending_.clear();
+
+    // 文档的解析栈上只剩根值，将其移入文档；失败时清空解析栈
+    auto populate = [this](rapidjson::Document &) { return !failed_; };
+    doc_.Populate(populate);
+
+    return !failed_;
+}
+
+
+// 扫描新到达的数据，返回最后一个字符串外的结构字符之后的位置；没有时返回 0。
+// 这个位置之前开始的记号都已完整到达。
+size_t json_stream_parser::scan(const char *data, size_t length)
+{
+    size_t safe = 0;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        const auto c = data[i];
+
+        if (in_string_)
+        {
+            if (escaped_)
+            {
+                escaped_ = false;
+            }
+            else if (c == '\\')
+            {
+                escaped_ = true;
+            }
+            else if (c == '"')
+            {
+                in_string_ = false;
+            }
+        }
+        else if (c == '"')
+        {
+            in_string_ = true;
+        }
+        else if (c == '{' || c == '}' || c == '[' || c == ']' || c == ',' || c == ':')
+        {
+            safe = i + 1;
+        }
+    }
+
+    return safe;
+}
+
+
+// 解析 `data` 中位于 `safe` 之前的记号，返回已处理的字节数。
+size_t json_stream_parser::parse(const char *data, size_t length, size_t safe)
+{
+    rapidjson::MemoryStream in(data, length);
+
+    while (!reader_.IterativeParseComplete() && in.Tell() < safe)
+    {
+        // 文档本身就是构造文档的 SAX 处理器，值压在它的解析栈上
+        if (!reader_.IterativeParseNext<PARSE_FLAGS>(in, doc_))
+        {
+            break;
+        }
+    }
+
+    if (reader_.HasParseError())
+    {
+        failed_ = true;
+        return length;
+    }
+
+    if (!reader_.IterativeParseComplete())
+    {
+        return in.Tell();
+    }
+
+    // 根值之后只允许有空白
+    for (auto i = in.Tell(); i < length; i++)
+    {
+        const auto c = data[i];
+
+        if (c != ' ' && c != '\t' && c != '\r' && c != '\n')
+        {
+            failed_ = true;
+            break;
+        }
+    }
+
+    return length;
+}
+
+
+}       // namespace kaixin
@@ -0,0 +1,75 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        json_stream_parser.h
+ * \brief       json_stream_parser 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <string>
+
+#include <rapidjson/document.h>
+#include <rapidjson/reader.h>
+
+
+namespace kaixin {
+
+
+/*!
+ * \brief       边接收边解析 JSON。
+ *
+ * 传输层每收到一段解码后的响应体就在接收线程上调用 `feed`，用 rapidjson 的迭代解析器处理
+ * 其中已完整到达的记号，构造文档；被分段截断的记号留到下一段到达时再解析。响应体接收完毕时
+ * 解析也基本完成，解析时间不再叠加在网络时间之后。适用于较大的响应体。
+ *
+ * 不另起线程，也不复制整段数据：只有段末尚未完整的记号会拷贝到内部缓冲区。`feed` 与 `finish`
+ * 不能并发调用。
+ */
+class json_stream_parser : private noncopyable
+{
+public:
+    /// 构造函数。
+    json_stream_parser();
+
+    /// 析构函数。
+    ~json_stream_parser();
+
+    /*!
+     * \brief       提供一段数据。可以作为 `ix::HttpRequestArgs::onChunkCallback` 调用。
+     *
+     * \param[in]   chunk       数据
+     */
+    void feed(const std::string &chunk);
+
+    /*!
+     * \brief       数据已全部提供，解析剩余部分。
+     *
+     * \return      如果是合法的 JSON，则返回 `true`；否则返回 `false`。
+     */
+    bool finish();
+
+    /// 获取解析结果，只能在 `finish` 返回 `true` 之后访问。
+    rapidjson::Document &document() { return doc_; }
+
+private:
+    size_t scan(const char *data, size_t length);
+    size_t parse(const char *data, size_t length, size_t safe);
+
+private:
+    rapidjson::Reader reader_;
+    rapidjson::Document doc_;
+    std::string pending_;       ///< 上一段末尾尚未解析的数据
+    bool in_string_;            ///< 已扫描的数据是否停在字符串内
+    bool escaped_;              ///< 已扫描的数据是否停在字符串的转义符之后
+    bool failed_;
+};
+
+
+}       // namespace kaixin
@@ -17,8 +17,9 @@
 #include <openssl/bio.h>
 #include <openssl/evp.h>
 #include <openssl/pem.h>
-#include <cppcodec/base64_url_unpadded.hpp>
 
+#include "codec.h"
+#include "json_arena.h"
 #include "rapidjsonhelpers.h"
 #include "utils.h"
 
@@ -37,11 +38,13 @@ xQIDAQAB
 -----END PUBLIC KEY-----)";
 
 
-// Base64Url 解码
+// Base64Url 解码，失败时返回空
 template<typename Result = std::string>
 inline Result base64_decode(const std::string &encoded)
 {
-    return cppcodec::base64_url_unpadded::decode<Result>(encoded);
+    Result decoded;
+    codec::base64url_decode(encoded, decoded);
+    return decoded;
 }
 
 
@@ -49,7 +52,8 @@ inline Result base64_decode(const std::string &encoded)
 static bool is_header_valid(std::string &header)
 {
     using rapidjson::get;
-    rapidjson::Document doc;
+    json_arena arena;
+    auto &doc = arena.document();
     doc.ParseInsitu(header.data());
 
     if (doc.HasParseError())
@@ -112,7 +116,8 @@ std::string payload(const std::string &id_token, const std::string &app_key)
         pload = base64_decode(pload);
 
         using rapidjson::get;
-        rapidjson::Document doc;
+        json_arena arena;
+        auto &doc = arena.document();
         doc.Parse(pload);
 
         if (doc.HasParseError())
@@ -12,18 +12,34 @@
  **************************************************************************************************/
 #include "kaixin.h"
 
+#include <atomic>
+#include <condition_variable>
+
 #include <ixwebsocket/IXNetSystem.h>
 #include <rapidjson/ostreamwrapper.h>
 #include <rapidjson/writer.h>
 
-#include "authorization_disabler.h"
+#include "buffer_pool.h"
+#include "call_context.h"
+#include "connection_pool.h"
+#include "dns_cache.h"
+#include "event_loop.h"
 #include "fingerprint.h"
+#include "json_arena.h"
 #include "jwt.h"
 #include "kaixin_api.h"
 #include "kaixin_version.h"
 #include "logger.h"
 #include "rapidjsonhelpers.h"
+#include "response_cache.h"
+#include "retry_policy.h"
+#include "tls_session_cache.h"
 #include "utils.h"
+#include "worker_pool.h"
+
+#ifdef KAIXIN_HAS_HTTP2
+#include "h2_session.h"
+#endif
 
  // 纠正 EINVAL 被重定义为 WSAEINVAL 的问题。
 #ifdef KAIXIN_OS_WINDOWS
@@ -39,54 +55,107 @@
 #endif
 
 
-kaixin_profile_t *g_profile = nullptr;
-
-
 // 加载更新令牌
-static bool load_refresh_token()
+static bool load_refresh_token(std::string &token)
 {
+    const auto *config = kaixin::current_config();
+
+    if (config == nullptr || !config->persistent)
+    {
+        return false;
+    }
+
 #ifdef KAIXIN_OS_WINDOWS
     auto expires_at = utils::get_reg_type_value<int64_t>("kaixin::expires_at");
     auto binary = utils::get_reg_type_value<std::vector<uint8_t>>("kaixin::token");
-#endif
 
-    if (g_config == nullptr || binary.empty() || expires_at < utils::get_timestamp())
+    if (binary.empty() || expires_at < kaixin_get_current_time())
     {
         return false;
     }
 
-    g_config->refresh_token = utils::unprotect_data(binary);
-    return !g_config->refresh_token.empty();
+    token = utils::unprotect_data(binary);
+    return !token.empty();
+#else
+    // 其它平台不在本地保存更新令牌
+    (void)token;
+    return false;
+#endif
 }
 
 // 保存更新令牌
-static void save_refresh_token()
+static void save_refresh_token(const kaixin::credentials &creds)
 {
-    if (g_config != nullptr && !g_config->refresh_token.empty()
-        && g_config->refresh_token_expires_at > utils::get_timestamp())
+    if (kaixin::current_config()->persistent && !creds.refresh_token.empty()
+        && creds.refresh_token_expires_at > kaixin_get_current_time())
     {
-        auto binary = utils::protect_data(g_config->refresh_token);
 #ifdef KAIXIN_OS_WINDOWS
+        auto binary = utils::protect_data(creds.refresh_token);
         utils::set_reg_value("kaixin::token", binary);
-        utils::set_reg_value("kaixin::expires_at", g_config->refresh_token_expires_at);
+        utils::set_reg_value("kaixin::expires_at", creds.refresh_token_expires_at);
 #endif
     }
 }
 
-static void refresh_token();
+// 是否保留 TLS 会话
+static std::atomic_bool g_persist_tls_sessions(true);
 
-// 处理登录
-static int sign_in_handler(const rapidjson::Value &data)
+// 加载上次保存的 TLS 会话
+static void load_tls_sessions()
 {
-    using rapidjson::get;
-    auto now = utils::get_timestamp();
-    get(g_config->access_token, data, "access_token");
-    get(g_config->refresh_token, data, "refresh_token");
-    get(g_config->id_token, data, "id_token");
-    g_config->access_token_expires_at = now + get<int>(data, "expires_in");
-    g_config->refresh_token_expires_at = now + get<int>(data, "refresh_token_expires_in");
+#ifdef KAIXIN_OS_WINDOWS
+    if (g_persist_tls_sessions)
+    {
+        auto binary = utils::get_reg_type_value<std::vector<uint8_t>>("kaixin::tls_session");
+
+        if (!binary.empty())
+        {
+            auto data = utils::unprotect_data(binary);
+            tls_session_cache::instance().deserialize({ data.begin(), data.end() });
+        }
+    }
+#endif
+}
+
+// 保存 TLS 会话
+static void save_tls_sessions()
+{
+#ifdef KAIXIN_OS_WINDOWS
+    if (!g_persist_tls_sessions)
+    {
+        utils::delete_reg_value("kaixin::tls_session");
+        return;
+    }
+
+    auto data = tls_session_cache::instance().serialize();
+    auto binary = utils::protect_data({ data.begin(), data.end() });
+
+    if (!binary.empty())
+    {
+        utils::set_reg_value("kaixin::tls_session", binary);
+    }
+#endif
+}
+
+static int refresh_token(const std::string &token);
 
-    auto payload = jwt::payload(g_config->id_token, g_config->app_key);
+// 处理登录。`epoch` 为发出请求前的注销次数，期间已注销时丢弃结果。
+static int sign_in_handler(const rapidjson::Value &data, unsigned epoch)
+{
+    auto *config = kaixin::current_config();
+
+    using rapidjson::get;
+    // 在新快照中填好所有字段后一次发布，其它线程不会看到不完整的凭据
+    auto creds = std::make_shared<kaixin::credentials>();
+    // 过期时间与 id_token 的 exp 一样以服务端时间为准
+    auto now = kaixin_get_current_time();
+    get(creds->access_token, data, "access_token");
+    get(creds->refresh_token, data, "refresh_token");
+    get(creds->id_token, data, "id_token");
+    creds->access_token_expires_at = now + get<int>(data, "expires_in");
+    creds->refresh_token_expires_at = now + get<int>(data, "refresh_token_expires_in");
+
+    auto payload = jwt::payload(creds->id_token, config->app_key);
 
     if (payload.empty())
     {
@@ -95,69 +164,257 @@ static int sign_in_handler(const rapidjson::Value &data)
     }
 
     using rapidjson::get;
-    rapidjson::Document doc;
+    json_arena arena;
+    auto &doc = arena.document();
     doc.ParseInsitu(payload.data());
-    get(g_config->username, doc, "name");
-    get(g_config->email, doc, "email");
-    get(g_config->agent_code, doc, "agent_code");
-    get(g_config->secret, doc, "secret");
-    get(g_config->id_token_expires_at, doc, "exp");
-
+    get(creds->username, doc, "name");
+    get(creds->email, doc, "email");
+    get(creds->agent_code, doc, "agent_code");
+    get(creds->secret, doc, "secret");
+    get(creds->id_token_expires_at, doc, "exp");
+    get(creds->status, doc, "status");
     // 如果代理编号变了，则清空素材。
-    if (g_config->agent_code != utils::get_local_agent_code())
-    {
-        g_config->materials.clear();
-    }
-
-    delete g_profile;
-    g_profile = new kaixin_profile_t;
-    memset(g_profile, 0, sizeof(kaixin_profile_t));
-    g_profile->access_token = g_config->access_token.c_str();
-    g_profile->refresh_token = g_config->refresh_token.c_str();
-    g_profile->id_token = g_config->id_token.c_str();
-    g_profile->username = g_config->username.c_str();
-    g_profile->email = g_config->email.c_str();
-    g_profile->invitation_code = g_config->agent_code.c_str();
-    g_profile->secret = g_config->secret.c_str();
-    g_profile->access_token_expires_at = g_config->access_token_expires_at;
-    g_profile->refresh_token_expires_at = g_config->refresh_token_expires_at;
-    g_profile->id_token_expires_at = g_config->id_token_expires_at;
-    get(g_profile->status, doc, "status");
-    LI() << "Signed in" << g_config->email;
-    LI() << "I-code:" << g_config->agent_code;
+    const bool agent_changed = (creds->agent_code != utils::get_local_agent_code());
+    const auto access_expires_at = creds->access_token_expires_at;
+    const auto refresh_expires_at = creds->refresh_token_expires_at;
+    const std::shared_ptr<const kaixin::credentials> saved = creds;
+
+    // 发布后再调度，后台更新使用的是新的刷新令牌；释放配置时调度器已先行销毁。
+    // 调度与发布在同一把锁内，注销取消调度后不会再被安排
+    const bool published = kaixin::publish_credentials(std::move(creds), epoch, [&]
+    {
+        if (config->refresher)
+        {
+            config->refresher->schedule(now, access_expires_at, refresh_expires_at);
+        }
+    });
+
+    if (!published)
+    {
+        // 请求发出后已注销，丢弃登录结果
+        LW() << "Signed out while signing in; discarding the new tokens.";
+        return ECANCELED;
+    }
+
+    LI() << "Signed in" << saved->email;
+    LI() << "I-code:" << saved->agent_code;
 
     // 保存令牌
-    save_refresh_token();
+    save_refresh_token(*saved);
 
-    if (!g_config->token_refresher)
+    if (agent_changed)
     {
-        // 自动更新令牌
-        g_config->token_refresher = std::make_unique<simple_timer>();
-        g_config->token_refresher->set_timeout_callback(refresh_token);
-
-        auto refresh_in = get<int>(data, "expires_in") * 3000 / 4;
-        g_config->token_refresher->start(refresh_in);
+        std::lock_guard lock(config->data_mutex);
+        config->materials.clear();
     }
 
     return 0;
 }
 
 // 更新令牌
-static void refresh_token()
+static int refresh_token(const std::string &token)
 {
-    if (g_config == nullptr)
+    auto *config = kaixin::current_config();
+
+    if (config == nullptr)
     {
-        return;
+        return EINVAL;
     }
 
     LI() << "Refreshing tokens.";
     kaixin::string_map form{
-        { "refresh_token", g_config->refresh_token }
+        { "refresh_token", token }
     };
 
-    g_config->access_token_expires_at = 0;
-    g_config->id_token_expires_at = 0;
-    kaixin::send_request(ix::HttpClient::kPatch, "/session", form, sign_in_handler);
+    // 更新请求不附带旧令牌；只影响本次调用，其它线程的请求照常授权
+    auto options = kaixin::call_context::thread_options();
+    options.anonymous = true;
+    kaixin::call_options_scope scope(options);
+    return kaixin::send_request(ix::HttpClient::kPatch, "/session", form,
+                                [epoch = kaixin::sign_out_epoch()](const rapidjson::Value &data)
+    {
+        return sign_in_handler(data, epoch);
+    });
+}
+
+
+// Shopee 域名
+static std::map<std::string, std::string> to_shopee_hosts_sub_domain(const rapidjson::Value &data)
+{
+    std::map<std::string, std::string> hosts;
+
+    for (auto iter = data.MemberBegin(); iter != data.MemberEnd(); ++iter)
+    {
+        hosts.emplace(iter->name.GetString(), iter->value.GetString());
+    }
+
+    return hosts;
+}
+
+static std::map<kaixin_shopee_hosts_by_sub_domain_t, std::map<std::string, std::string>>
+to_shopee_hosts(const rapidjson::Value &data)
+{
+    std::map<kaixin_shopee_hosts_by_sub_domain_t, std::map<std::string, std::string>> hosts;
+
+    hosts.emplace(KAIXIN_SHOPEE_HOSTS_BUYER, to_shopee_hosts_sub_domain(data["buyer"]));
+    hosts.emplace(KAIXIN_SHOPEE_HOSTS_SELLER, to_shopee_hosts_sub_domain(data["seller"]));
+    hosts.emplace(KAIXIN_SHOPEE_HOSTS_CDN, to_shopee_hosts_sub_domain(data["cdn"]));
+
+    return hosts;
+}
+
+static int shopee_hosts_handler(const rapidjson::Value &data)
+{
+    auto *config = kaixin::current_config();
+
+    decltype(config->shopee_hosts) hosts;
+    hosts.emplace(KAIXIN_SHOPEE_HOSTS_GLOBAL, to_shopee_hosts(data["global"]));
+    hosts.emplace(KAIXIN_SHOPEE_HOSTS_CHINA, to_shopee_hosts(data["china"]));
+
+    // 内容不变时保留原有字符串，之前返回的指针仍然有效
+    std::lock_guard lock(config->data_mutex);
+
+    if (config->shopee_hosts != hosts)
+    {
+        config->shopee_hosts = std::move(hosts);
+    }
+
+    return 0;
+}
+
+
+// 素材
+static kaixin::string_map material_queries()
+{
+    kaixin::string_map queries{
+        { "locale", utils::get_current_locale() },
+    };
+
+    if (auto creds = kaixin::current_credentials())
+    {
+        queries.emplace("agent_code", creds->agent_code);
+    }
+    else
+    {
+        queries.emplace("agent_code", utils::get_local_agent_code());
+    }
+
+    return queries;
+}
+
+static int materials_handler(const rapidjson::Value &data)
+{
+    auto *config = kaixin::current_config();
+
+    using rapidjson::get;
+    std::map<std::string, std::string> materials;
+
+    for (const auto &e : data.GetArray())
+    {
+        auto type = get<std::string>(e, "type");
+        auto text = get<std::string>(e, "text");
+        materials.emplace(type, text);
+    }
+
+    // 只更新有变化的素材，内容不变的素材之前返回的指针仍然有效
+    std::lock_guard lock(config->data_mutex);
+    auto &current = config->materials;
+
+    for (auto iter = current.begin(); iter != current.end();)
+    {
+        iter = (materials.count(iter->first) == 0) ? current.erase(iter) : std::next(iter);
+    }
+
+    for (auto &[type, text] : materials)
+    {
+        auto &value = current[type];
+
+        if (value != text)
+        {
+            value = std::move(text);
+        }
+    }
+
+    return 0;
+}
+
+
+// 设备 ID
+static kaixin::string_map device_id_form()
+{
+    return {
+        { "fp", fp::generate_simple_fingerprint() },
+    };
+}
+
+static int device_id_handler(const rapidjson::Value &data)
+{
+    auto *config = kaixin::current_config();
+
+    // 设备 ID 只设置一次，之前返回的指针一直有效
+    std::lock_guard lock(config->data_mutex);
+
+    if (config->device_id.empty())
+    {
+        config->device_id = data.GetString();
+    }
+
+    return 0;
+}
+
+
+// 授权
+static int auth_handler(kaixin_auth_t *&auth, const rapidjson::Value &data)
+{
+    using rapidjson::get;
+    auto *prev = auth;
+    auto secret = get<std::string>(data, "secret");
+
+    // 密钥变化时发布新凭据
+    kaixin::update_credentials([&secret](kaixin::credentials &creds)
+    {
+        if (creds.secret == secret)
+        {
+            return false;
+        }
+
+        creds.secret = std::move(secret);
+        return true;
+    });
+
+    for (const auto &a : data["auth"].GetArray())
+    {
+        auto *p = new kaixin_auth_t;
+        p->next = nullptr;
+        p->module_name = strdup(get<const char *>(a, "module"));
+        get(p->edition, a, "edition");
+        get(p->count, a, "count");
+        get(p->time, a, "time");
+
+        if (auth == nullptr)
+        {
+            auth = p;
+        }
+        else
+        {
+            prev->next = p;
+        }
+
+        prev = p;
+    }
+
+    return 0;
+}
+
+
+// 最低版本号
+static int lowest_version_handler(kaixin_version_t &lowest, const rapidjson::Value &data)
+{
+    using rapidjson::get;
+    get(lowest.major, data, "major");
+    get(lowest.minor, data, "minor");
+    get(lowest.patch, data, "patch");
+    return 0;
 }
 
 
@@ -174,17 +431,18 @@ kaixin_log_output_t kaixin_set_log_output(kaixin_log_output_t output)
 }
 
 
-// 初始化
-int kaixin_initialize(const char *organization, const char *application, const char *app_key,
-                      const char *app_secret, const char *base_url)
-{
-    if (g_config != nullptr)
-    {
-        // 已经初始化过了
-        LE() << "Kaixin SDK is already initialized.";
-        return EPERM;
-    }
+// 进程级资源（网络、连接池、DNS 与 TLS 会话缓存、工作线程）的引用计数，
+// 默认上下文与每个 kaixin_context_t 各占一个
+static std::mutex g_process_mutex;
+static std::condition_variable g_process_released;     ///< 最后一个上下文清理完毕
+static int g_process_refs = 0;
+static bool g_process_releasing = false;                ///< 最后一个上下文正在清理，不持有进程锁
 
+// 检查应用参数并创建配置
+static int create_config(const char *organization, const char *application, const char *app_key,
+                         const char *app_secret, const char *base_url,
+                         std::shared_ptr<kaixin::Config> &config)
+{
     if (utils::is_empty(organization) || utils::is_empty(application)
         || utils::is_empty(app_key) || utils::is_empty(app_secret))
     {
@@ -200,39 +458,148 @@ int kaixin_initialize(const char *organization, const char *application, const c
         return EINVAL;
     }
 
-    LI() << "Initializing kaixin native SDK " KAIXIN_VERSION_STRING ".";
-    g_config = new kaixin::Config;
-    _ASSERT(g_config != nullptr);
-    g_config->organization = organization;
-    g_config->application = application;
-    g_config->app_key = app_key;
-    g_config->app_secret = app_secret;
+    config = std::make_shared<kaixin::Config>();
+
+    // 后台更新与请求被拒绝后的更新合并为一次请求。调度器由配置持有，在工作线程中指定配置
+    config->refresh_session = refresh_token;
+    config->refresher = std::make_unique<kaixin::token_refresher>([raw = config.get()]
+    {
+        kaixin::config_scope scope(raw);
+        return kaixin::refresh_credentials(kaixin::call_context::current(), kaixin::current_credentials());
+    });
+
+    config->organization = organization;
+    config->application = application;
+    config->app_key = app_key;
+    config->app_secret = app_secret;
+    config->signing_key = kaixin::hmac_sha256(config->app_secret);
 
     if (utils::is_empty(base_url))
     {
         // 默认设置生产环境 URL
-        g_config->base_url = "https://api.ubesthelp.com";
+        config->base_url = "https://api.ubesthelp.com";
     }
     else
     {
-        g_config->base_url = base_url;
+        config->base_url = base_url;
 
-        if (g_config->base_url.at(g_config->base_url.length() - 1) == '/')
+        if (config->base_url.at(config->base_url.length() - 1) == '/')
         {
             // 删除结尾处的“/”
-            g_config->base_url.erase(g_config->base_url.length() - 1, 1);
+            config->base_url.erase(config->base_url.length() - 1, 1);
         }
     }
 
+    return 0;
+}
+
+// 获取进程级资源。第一个上下文初始化网络并加载 TLS 会话。
+static void acquire_process()
+{
+    std::unique_lock lock(g_process_mutex);
+
+    // 等待上一个最后的上下文清理完毕，再重新初始化
+    g_process_released.wait(lock, [] { return !g_process_releasing; });
+
+    if (g_process_refs++ == 0)
+    {
+        ix::initNetSystem();
+        load_tls_sessions();
+        worker_pool::instance().start();
+    }
+}
+
+// 释放上下文的配置与进程级资源，按依赖的逆序清理。最后一个上下文依次停止时间轮、等待已投递的
+// 异步请求完成，保存 TLS 会话并清理；否则配置在持有它的异步请求完成后销毁。
+// 清理期间不持有进程锁：异步请求可能创建或释放其它上下文。
+static void release_config(std::shared_ptr<kaixin::Config> config)
+{
+    // 下行通知与后台更新的计时器向工作线程池投递任务，先销毁它们：取消计时器，
+    // 并等待已投递的心跳、重连与更新请求结束，之后才能停止工作线程、清理共享的连接
+    config->notify.reset();
+    config->refresher.reset();
+
+    {
+        std::lock_guard lock(g_process_mutex);
+
+        if (--g_process_refs > 0)
+        {
+            return;
+        }
+
+        g_process_releasing = true;
+    }
+
+    // 剩下的计时器（如 HTTP/2 空闲连接）不再需要，停止后才等待工作线程
+    kaixin::event_loop::instance().timers().clear();
+    worker_pool::instance().stop();
+
+    {
+        // 保存会话需要配置中的组织名与应用名
+        kaixin::config_scope scope(config.get());
+        save_tls_sessions();
+    }
+
+    config.reset();
+
+#ifdef KAIXIN_HAS_HTTP2
+    http::h2_session::clear();
+#endif
+    // 会话已注销其套接字，最后停止事件循环
+    kaixin::event_loop::instance().stop();
+    connection_pool::instance().clear();
+    dns_cache::instance().stop();
+    dns_cache::instance().clear();
+    tls_session_cache::instance().clear();
+    buffer_pool::instance().clear();
+    kaixin::retry_policy::instance().clear();
+    ix::uninitNetSystem();
+
+    std::lock_guard lock(g_process_mutex);
+    g_process_releasing = false;
+    g_process_released.notify_all();
+}
+
+
+// 初始化
+int kaixin_initialize(const char *organization, const char *application, const char *app_key,
+                      const char *app_secret, const char *base_url)
+{
+    if (kaixin::g_default_config)
+    {
+        // 已经初始化过了
+        LE() << "Kaixin SDK is already initialized.";
+        return EPERM;
+    }
+
+    std::shared_ptr<kaixin::Config> config;
+
+    if (auto r = create_config(organization, application, app_key, app_secret, base_url, config); r != 0)
+    {
+        return r;
+    }
+
+    LI() << "Initializing kaixin native SDK " KAIXIN_VERSION_STRING ".";
+    // 只有默认上下文在本地保存更新令牌
+    config->persistent = true;
+    kaixin::g_default_config = config;
+
     LI() << "Locale:" << utils::get_current_locale();
     LI() << "Local i-code:" << utils::get_local_agent_code();
-    ix::initNetSystem();
+    acquire_process();
 
     // 加载上次保存的更新令牌
-    if (load_refresh_token())
+    std::string token;
+
+    if (load_refresh_token(token))
     {
         LI() << "Loaded token from last session.";
-        refresh_token();
+        refresh_token(token);
+    }
+    else
+    {
+        // 预先建立到服务端的连接，省去首个请求的握手时间
+        connection_pool::instance().preconnect(config->base_url, 10);
     }
 
     return 0;
@@ -242,21 +609,57 @@ int kaixin_initialize(const char *organization, const char *application, const c
 // 反初始化
 void kaixin_uninitialize()
 {
+    if (!kaixin::g_default_config)
+    {
+        return;
+    }
+
     LI() << "Uninitializing kaixin native SDK.";
-    delete g_profile;
-    g_profile = nullptr;
+    release_config(std::move(kaixin::g_default_config));
+}
 
-    delete g_config;
-    g_config = nullptr;
 
-    ix::uninitNetSystem();
+// 创建上下文
+kaixin_context_t *kaixin_context_create(const char *organization, const char *application,
+                                        const char *app_key, const char *app_secret,
+                                        const char *base_url)
+{
+    std::shared_ptr<kaixin::Config> config;
+
+    if (create_config(organization, application, app_key, app_secret, base_url, config) != 0)
+    {
+        return nullptr;
+    }
+
+    LI() << "Creating kaixin context for" << config->organization + "/" + config->application;
+
+    {
+        // 加载 TLS 会话需要配置中的组织名与应用名
+        kaixin::config_scope scope(config.get());
+        acquire_process();
+    }
+
+    return new kaixin_context_t{ std::move(config) };
+}
+
+
+// 释放上下文
+void kaixin_context_free(kaixin_context_t *ctx)
+{
+    if (ctx != nullptr)
+    {
+        release_config(std::move(ctx->config));
+        delete ctx;
+    }
 }
 
 
 // 登录
 int kaixin_sign_in(const char *username, const char *password)
 {
-    if (g_config == nullptr)
+    auto *config = kaixin::current_config();
+
+    if (config == nullptr)
     {
         return EINVAL;
     }
@@ -269,27 +672,48 @@ int kaixin_sign_in(const char *username, const char *password)
 
     // 登录前删除已有 token
 #ifdef KAIXIN_OS_WINDOWS
-    utils::delete_reg_value("kaixin::token");
+    if (config->persistent)
+    {
+        utils::delete_reg_value("kaixin::token");
+    }
 #endif
 
-    return kaixin::send_request(ix::HttpClient::kPost, "/session", form, sign_in_handler);
+    return kaixin::send_request(ix::HttpClient::kPost, "/session", form,
+                                [epoch = kaixin::sign_out_epoch()](const rapidjson::Value &data)
+    {
+        return sign_in_handler(data, epoch);
+    });
 }
 
 
 // 注销
 int kaixin_sign_out()
 {
-    if (g_config == nullptr)
+    auto *config = kaixin::current_config();
+
+    if (config == nullptr)
     {
         return EINVAL;
     }
 
     LI() << "Signing out.";
-    g_config->notify.reset();
+
+    // 先使进行中的登录与更新失效，再取消后台更新并等待其结束
+    kaixin::begin_sign_out();
+
+    if (config->refresher)
+    {
+        config->refresher->cancel();
+    }
+
+    config->notify.reset();
 
 #ifdef KAIXIN_OS_WINDOWS
-    utils::delete_reg_value("kaixin::token");
-    utils::delete_reg_value("kaixin::expires_at");
+    if (config->persistent)
+    {
+        utils::delete_reg_value("kaixin::token");
+        utils::delete_reg_value("kaixin::expires_at");
+    }
 #endif
 
     return kaixin::send_request("DELETE", "/session");
@@ -299,74 +723,62 @@ int kaixin_sign_out()
 // 获取用户配置
 const kaixin_profile_t *kaixin_get_profile()
 {
-    return g_profile;
+    // 每个线程持有最近一次返回的快照，令牌更新与注销都不会释放它，直到本线程再次调用
+    thread_local std::shared_ptr<const kaixin::credentials> t_profile;
+
+    if (kaixin::current_config() == nullptr)
+    {
+        t_profile.reset();
+        return nullptr;
+    }
+
+    t_profile = kaixin::current_credentials();
+    return t_profile ? &t_profile->profile : nullptr;
 }
 
 
 // 获取设备 ID
 const char *kaixin_get_device_id()
 {
-    if (g_config == nullptr)
+    auto *config = kaixin::current_config();
+
+    if (config == nullptr)
     {
         return nullptr;
     }
 
-    if (!g_config->device_id.empty())
     {
-        return g_config->device_id.c_str();
+        std::lock_guard lock(config->data_mutex);
+
+        if (!config->device_id.empty())
+        {
+            return config->device_id.c_str();
+        }
     }
 
     LI() << "Getting device ID.";
-    kaixin::string_map form{
-        { "fp", fp::generate_simple_fingerprint() },
-    };
+    kaixin::send_request(ix::HttpClient::kPost, "/device-id", device_id_form(), device_id_handler);
 
-    kaixin::send_request(ix::HttpClient::kPost, "/device-id", form, [](const rapidjson::Value &data)
-    {
-        g_config->device_id = data.GetString();
-        return 0;
-    });
-
-    LI() << "Device ID:" << g_config->device_id;
-    return g_config->device_id.c_str();
+    std::lock_guard lock(config->data_mutex);
+    LI() << "Device ID:" << config->device_id;
+    return config->device_id.c_str();
 }
 
 
 // 获取授权
 const kaixin_auth_t *kaixin_get_auth()
 {
+    if (kaixin::current_config() == nullptr)
+    {
+        return nullptr;
+    }
+
     LI() << "Getting auth.";
     kaixin_auth_t *auth = nullptr;
 
     kaixin::send_request(ix::HttpClient::kGet, "/auth", [&auth](const rapidjson::Value &data)
     {
-        using rapidjson::get;
-        auto *prev = auth;
-        get(g_config->secret, data, "secret");
-        g_profile->secret = g_config->secret.c_str();
-
-        for (const auto &a : data["auth"].GetArray())
-        {
-            auto *p = new kaixin_auth_t;
-            p->next = nullptr;
-            p->module_name = strdup(get<const char *>(a, "module"));
-            get(p->edition, a, "edition");
-            get(p->count, a, "count");
-            get(p->time, a, "time");
-
-            if (auth == nullptr)
-            {
-                auth = p;
-            }
-            else
-            {
-                prev->next = p;
-            }
-
-            prev = p;
-        }
-
-        return 0;
+        return auth_handler(auth, data);
     });
 
     return auth;
@@ -391,74 +803,67 @@ void kaixin_free_auth(const kaixin_auth_t *auth)
 // 获取应用最低版本号
 kaixin_version_t kaixin_get_lowest_version()
 {
-    kaixin_version_t lowest = { 0, 0, 0 };
+    auto *config = kaixin::current_config();
 
-    kaixin::authorization_disabler atd;
-    kaixin::send_request(ix::HttpClient::kGet, "/lowest-version", [&lowest](const rapidjson::Value &data)
+    if (config == nullptr)
     {
-        get(lowest.major, data, "major");
-        get(lowest.minor, data, "minor");
-        get(lowest.patch, data, "patch");
-        return 0;
+        return { 0, 0, 0 };
+    }
+
+    bool have_data = false;
+
+    {
+        std::lock_guard lock(config->data_mutex);
+        const auto &lowest = config->lowest_version;
+        have_data = (lowest.major != 0 || lowest.minor != 0 || lowest.patch != 0);
+    }
+
+    // 最低版本号与用户无关，匿名获取
+    auto options = kaixin::call_context::thread_options();
+    options.anonymous = true;
+    kaixin::call_options_scope scope(options);
+    kaixin::send_cached_request("/lowest-version", {}, have_data, [config](const rapidjson::Value &data)
+    {
+        kaixin_version_t lowest = { 0, 0, 0 };
+        const int result = lowest_version_handler(lowest, data);
+        std::lock_guard lock(config->data_mutex);
+        config->lowest_version = lowest;
+        return result;
     });
 
-    return lowest;
+    std::lock_guard lock(config->data_mutex);
+    return config->lowest_version;
 }
 
 
 // 获取素材
 const char *kaixin_get_material(const char *type)
 {
-    if (g_config == nullptr)
-    {
-        return nullptr;
-    }
+    auto *config = kaixin::current_config();
 
-    if (!g_config->materials.empty())
+    if (config == nullptr)
     {
-        // 素材已经获取过了，直接查找返回
-        auto iter = g_config->materials.find(type);
-
-        if (iter == g_config->materials.end())
-        {
-            return nullptr;
-        }
-
-        return iter->second.c_str();
+        return nullptr;
     }
 
-    // 获取素材
-    LI() << "Getting material" << type;
-    kaixin::string_map queries{
-        { "locale", utils::get_current_locale() },
-    };
+    bool have_data = false;
 
-    if (g_profile != nullptr)
     {
-        queries.emplace("agent_code", g_profile->invitation_code);
-    }
-    else
-    {
-        queries.emplace("agent_code", utils::get_local_agent_code());
+        std::lock_guard lock(config->data_mutex);
+        have_data = !config->materials.empty();
     }
 
-    kaixin::send_request(ix::HttpClient::kGet, "/materials", queries, {}, [](const rapidjson::Value &data)
+    if (!have_data || !config->cache.is_fresh("/materials", true))
     {
-        using rapidjson::get;
-
-        for (const auto &e : data.GetArray())
-        {
-            auto type = get<std::string>(e, "type");
-            auto text = get<std::string>(e, "text");
-            g_config->materials.emplace(type, text);
-        }
-
-        return 0;
-    });
+        // 获取素材；已有素材时发送条件请求。并发的相同请求只发送一次
+        LI() << "Getting material" << type;
+        kaixin::send_cached_request("/materials", material_queries(), have_data, materials_handler);
+    }
 
-    auto iter = g_config->materials.find(type);
+    std::lock_guard lock(config->data_mutex);
+    auto iter = config->materials.find(type);
 
-    if (iter == g_config->materials.end())
+    if (iter == config->materials.end())
     {
         return nullptr;
     }
@@ -470,65 +875,48 @@ const char *kaixin_get_material(const char *type)
 // 下行通知
 int kaixin_set_notification_callback(kaixin_notification_callback_t func, void *user_data)
 {
-    if (g_config == nullptr || g_config->notify)
+    auto *config = kaixin::current_config();
+
+    if (config == nullptr || config->notify)
     {
         return EINVAL;
     }
 
-    g_config->notify = std::make_unique<websocket_client>(func, user_data);
+    config->notify = std::make_unique<websocket_client>(func, user_data);
     return 0;
 }
 
 
-// Shopee 域名
-static std::map<std::string, std::string> to_shopee_hosts_sub_domain(const rapidjson::Value &data)
+const char *kaixin_get_shopee_host(const char *website, kaixin_shopee_hosts_t hosts,
+                                   kaixin_shopee_hosts_by_sub_domain_t sub)
 {
-    std::map<std::string, std::string> hosts;
+    auto *config = kaixin::current_config();
 
-    for (auto iter = data.MemberBegin(); iter != data.MemberEnd(); ++iter)
+    if (config == nullptr || website == nullptr)
     {
-        hosts.emplace(iter->name.GetString(), iter->value.GetString());
+        return nullptr;
     }
 
-    return hosts;
-}
-
-static std::map<kaixin_shopee_hosts_by_sub_domain_t, std::map<std::string, std::string>>
-to_shopee_hosts(const rapidjson::Value &data)
-{
-    std::map<kaixin_shopee_hosts_by_sub_domain_t, std::map<std::string, std::string>> hosts;
-
-    hosts.emplace(KAIXIN_SHOPEE_HOSTS_BUYER, to_shopee_hosts_sub_domain(data["buyer"]));
-    hosts.emplace(KAIXIN_SHOPEE_HOSTS_SELLER, to_shopee_hosts_sub_domain(data["seller"]));
-    hosts.emplace(KAIXIN_SHOPEE_HOSTS_CDN, to_shopee_hosts_sub_domain(data["cdn"]));
-
-    return hosts;
-}
+    bool have_data = false;
 
-const char *kaixin_get_shopee_host(const char *website, kaixin_shopee_hosts_t hosts,
-                                   kaixin_shopee_hosts_by_sub_domain_t sub)
-{
-    if (g_config == nullptr || website == nullptr)
     {
-        return nullptr;
+        std::lock_guard lock(config->data_mutex);
+        have_data = !config->shopee_hosts.empty();
     }
 
-    if (g_config->shopee_hosts.empty())
+    if (!have_data || !config->cache.is_fresh("/shopee-hosts", true))
     {
-        kaixin::send_request(ix::HttpClient::kGet, "/shopee-hosts", [](const rapidjson::Value &data)
-        {
-            g_config->shopee_hosts.emplace(KAIXIN_SHOPEE_HOSTS_GLOBAL, to_shopee_hosts(data["global"]));
-            g_config->shopee_hosts.emplace(KAIXIN_SHOPEE_HOSTS_CHINA, to_shopee_hosts(data["china"]));
-            return 0;
-        });
+        kaixin::send_cached_request("/shopee-hosts", {}, have_data, shopee_hosts_handler);
     }
 
-    if (g_config->shopee_hosts.count(hosts) == 0)
+    std::lock_guard lock(config->data_mutex);
+
+    if (config->shopee_hosts.count(hosts) == 0)
     {
         return nullptr;
     }
 
-    const auto &hs = g_config->shopee_hosts.at(hosts);
+    const auto &hs = config->shopee_hosts.at(hosts);
 
     if (hs.count(sub) == 0)
     {
@@ -548,14 +936,25 @@ const char *kaixin_get_shopee_host(const char *website, kaixin_shopee_hosts_t ho
 
 const char *kaixin_get_shopee_websites()
 {
-    if (g_config == nullptr)
+    auto *config = kaixin::current_config();
+
+    if (config == nullptr)
     {
         return nullptr;
     }
 
     kaixin_get_shopee_host("tw", KAIXIN_SHOPEE_HOSTS_GLOBAL, KAIXIN_SHOPEE_HOSTS_BUYER);
 
-    const auto &subs = g_config->shopee_hosts.at(KAIXIN_SHOPEE_HOSTS_GLOBAL).at(KAIXIN_SHOPEE_HOSTS_BUYER);
+    std::lock_guard lock(config->data_mutex);
+    auto iter = config->shopee_hosts.find(KAIXIN_SHOPEE_HOSTS_GLOBAL);
+
+    if (iter == config->shopee_hosts.end() || iter->second.count(KAIXIN_SHOPEE_HOSTS_BUYER) == 0)
+    {
+        // 获取 Shopee 域名失败
+        return nullptr;
+    }
+
+    const auto &subs = iter->second.at(KAIXIN_SHOPEE_HOSTS_BUYER);
     std::string websites;
 
     for (const auto &sub : subs)
@@ -573,7 +972,9 @@ const char *kaixin_get_shopee_websites()
 // 获取页面地址
 const char *kaixin_get_web_url(kaixin_web_page_t page)
 {
-    if (g_config == nullptr)
+    auto *config = kaixin::current_config();
+
+    if (config == nullptr)
     {
         return nullptr;
     }
@@ -583,9 +984,9 @@ const char *kaixin_get_web_url(kaixin_web_page_t page)
        { "locale", utils::get_current_locale() },
     };
 
-    if (g_profile != nullptr)
+    if (auto creds = kaixin::current_credentials())
     {
-        queries.emplace("agent_code", g_profile->invitation_code);
+        queries.emplace("agent_code", creds->agent_code);
     }
     else
     {
@@ -638,8 +1039,345 @@ void kaixin_free_string(const char *s)
 
 void kaixin_log(const char *msg)
 {
+    if (kaixin::current_config() == nullptr || msg == nullptr)
+    {
+        return;
+    }
+
     kaixin::string_map form{
        { "msg", msg },
     };
     kaixin::send_request(ix::HttpClient::kPost, "/log", form);
 }
+
+
+// 设置重试策略
+int kaixin_set_retry_policy(const kaixin_retry_policy_t *policy)
+{
+    kaixin::retry_options options;
+
+    if (policy != nullptr)
+    {
+        if (policy->max_attempts < 1 || policy->base_delay_ms < 0
+            || policy->max_delay_ms < policy->base_delay_ms
+            || policy->failure_threshold < 0 || policy->open_ms < 0)
+        {
+            LE() << "Invalid retry policy.";
+            return EINVAL;
+        }
+
+        options.max_attempts = policy->max_attempts;
+        options.base_delay_ms = policy->base_delay_ms;
+        options.max_delay_ms = policy->max_delay_ms;
+        options.failure_threshold = policy->failure_threshold;
+        options.open_ms = policy->open_ms;
+    }
+
+    kaixin::retry_policy::instance().set_options(options);
+    return 0;
+}
+
+
+// 获取重试策略
+kaixin_retry_policy_t kaixin_get_retry_policy()
+{
+    const auto options = kaixin::retry_policy::instance().options();
+    kaixin_retry_policy_t policy;
+    policy.max_attempts = options.max_attempts;
+    policy.base_delay_ms = options.base_delay_ms;
+    policy.max_delay_ms = options.max_delay_ms;
+    policy.failure_threshold = options.failure_threshold;
+    policy.open_ms = options.open_ms;
+    return policy;
+}
+
+
+// 设置令牌更新策略
+int kaixin_set_token_refresh_policy(const kaixin_token_refresh_policy_t *policy)
+{
+    kaixin::refresh_options options;
+
+    if (policy != nullptr)
+    {
+        if (policy->window_s < 0 || policy->jitter_s < 0 || policy->base_delay_ms < 0
+            || policy->max_delay_ms < policy->base_delay_ms)
+        {
+            LE() << "Invalid token refresh policy.";
+            return EINVAL;
+        }
+
+        options.window_s = policy->window_s;
+        options.jitter_s = policy->jitter_s;
+        options.base_delay_ms = policy->base_delay_ms;
+        options.max_delay_ms = policy->max_delay_ms;
+    }
+
+    kaixin::token_refresher::set_options(options);
+    return 0;
+}
+
+
+// 获取令牌更新策略
+kaixin_token_refresh_policy_t kaixin_get_token_refresh_policy()
+{
+    const auto options = kaixin::token_refresher::options();
+    kaixin_token_refresh_policy_t policy;
+    policy.window_s = options.window_s;
+    policy.jitter_s = options.jitter_s;
+    policy.base_delay_ms = options.base_delay_ms;
+    policy.max_delay_ms = options.max_delay_ms;
+    return policy;
+}
+
+
+// 设置默认超时
+int kaixin_set_default_timeout(int timeout_ms)
+{
+    if (timeout_ms < 0)
+    {
+        return EINVAL;
+    }
+
+    kaixin::call_context::set_default_timeout_ms(timeout_ms);
+    return 0;
+}
+
+
+// 取消令牌
+struct kaixin_cancel_token_s
+{
+    std::shared_ptr<kaixin::cancel_state> state;            ///< 与调用共享的取消状态
+};
+
+
+// 设置当前线程的调用选项
+void kaixin_set_call_options(int timeout_ms, kaixin_cancel_token_t *token)
+{
+    kaixin::call_options options;
+    options.timeout_ms = timeout_ms;
+
+    if (token != nullptr)
+    {
+        options.cancel = token->state;
+    }
+
+    kaixin::call_context::set_thread_options(options);
+}
+
+
+kaixin_cancel_token_t *kaixin_cancel_token_create()
+{
+    auto *token = new kaixin_cancel_token_t;
+    token->state = std::make_shared<kaixin::cancel_state>();
+    return token;
+}
+
+
+void kaixin_cancel_token_cancel(kaixin_cancel_token_t *token)
+{
+    if (token != nullptr)
+    {
+        token->state->cancel();
+    }
+}
+
+
+int kaixin_cancel_token_is_cancelled(const kaixin_cancel_token_t *token)
+{
+    return (token != nullptr && token->state->is_cancelled()) ? 1 : 0;
+}
+
+
+void kaixin_cancel_token_free(kaixin_cancel_token_t *token)
+{
+    delete token;
+}
+
+
+kaixin_dns_stats_t kaixin_get_dns_stats()
+{
+    const auto s = dns_cache::instance().stats();
+    kaixin_dns_stats_t stats;
+    stats.hits = s.hits;
+    stats.misses = s.misses;
+    stats.refreshes = s.refreshes;
+    stats.failures = s.failures;
+    return stats;
+}
+
+
+// 设置是否保留 TLS 会话
+void kaixin_set_tls_session_persistence(int enabled)
+{
+    g_persist_tls_sessions = (enabled != 0);
+}
+
+
+// 启用或禁用 HTTP/2
+int kaixin_set_http2_enabled(int enabled)
+{
+#ifdef KAIXIN_HAS_HTTP2
+    http::h2_session::set_enabled(enabled != 0);
+    return 0;
+#else
+    (void)enabled;
+    return ENOTSUP;
+#endif
+}
+
+
+// 批量请求
+struct kaixin_batch_s
+{
+    std::shared_ptr<kaixin::Config> config;                 ///< 创建批量请求时的上下文
+    std::vector<kaixin_batch_item_t> items;                 ///< 子请求
+    std::map<kaixin_batch_item_t, int> results;             ///< 子请求结果
+    kaixin_version_t lowest_version = { 0, 0, 0 };          ///< 最低版本号
+    kaixin_auth_t *auth = nullptr;                          ///< 授权
+};
+
+
+kaixin_batch_t *kaixin_batch_begin()
+{
+    auto *config = kaixin::current_config();
+
+    if (config == nullptr)
+    {
+        return nullptr;
+    }
+
+    auto *batch = new kaixin_batch_t;
+    batch->config = config->shared_from_this();
+    return batch;
+}
+
+
+int kaixin_batch_add(kaixin_batch_t *batch, kaixin_batch_item_t item)
+{
+    if (batch == nullptr || item < KAIXIN_BATCH_LOWEST_VERSION || item > KAIXIN_BATCH_AUTH)
+    {
+        return EINVAL;
+    }
+
+    if (std::find(batch->items.begin(), batch->items.end(), item) == batch->items.end())
+    {
+        batch->items.push_back(item);
+    }
+
+    return 0;
+}
+
+
+int kaixin_batch_commit(kaixin_batch_t *batch)
+{
+    if (batch == nullptr)
+    {
+        return EINVAL;
+    }
+
+    kaixin::config_scope scope(batch->config.get());
+    LI() << "Sending batch of" << batch->items.size() << "requests.";
+    std::vector<kaixin::sub_request> requests;
+    requests.reserve(batch->items.size());
+
+    for (auto item : batch->items)
+    {
+        kaixin::sub_request req;
+
+        switch (item)
+        {
+        case KAIXIN_BATCH_LOWEST_VERSION:
+            req.verb = ix::HttpClient::kGet;
+            req.path = "/lowest-version";
+            req.handler = [batch](const rapidjson::Value &data)
+            {
+                return lowest_version_handler(batch->lowest_version, data);
+            };
+            break;
+        case KAIXIN_BATCH_MATERIALS:
+            req.verb = ix::HttpClient::kGet;
+            req.path = "/materials";
+            req.queries = material_queries();
+            req.handler = materials_handler;
+            break;
+        case KAIXIN_BATCH_SHOPEE_HOSTS:
+            req.verb = ix::HttpClient::kGet;
+            req.path = "/shopee-hosts";
+            req.handler = shopee_hosts_handler;
+            break;
+        case KAIXIN_BATCH_DEVICE_ID:
+            req.verb = ix::HttpClient::kPost;
+            req.path = "/device-id";
+            req.form = device_id_form();
+            req.handler = device_id_handler;
+            break;
+        case KAIXIN_BATCH_AUTH:
+            req.verb = ix::HttpClient::kGet;
+            req.path = "/auth";
+            kaixin_free_auth(batch->auth);
+            batch->auth = nullptr;
+            req.handler = [batch](const rapidjson::Value &data)
+            {
+                return auth_handler(batch->auth, data);
+            };
+            break;
+        }
+
+        requests.emplace_back(std::move(req));
+    }
+
+    auto r = kaixin::send_batch_request(requests);
+
+    for (size_t i = 0; i < requests.size(); i++)
+    {
+        batch->results[batch->items.at(i)] = (r == 0) ? requests.at(i).result : r;
+    }
+
+    return r;
+}
+
+
+int kaixin_batch_get_result(const kaixin_batch_t *batch, kaixin_batch_item_t item)
+{
+    if (batch == nullptr)
+    {
+        return EINVAL;
+    }
+
+    auto iter = batch->results.find(item);
+    return (iter == batch->results.end()) ? EINVAL : iter->second;
+}
+
+
+kaixin_version_t kaixin_batch_get_lowest_version(const kaixin_batch_t *batch)
+{
+    if (batch == nullptr)
+    {
+        return { 0, 0, 0 };
+    }
+
+    return batch->lowest_version;
+}
+
+
+const kaixin_auth_t *kaixin_batch_get_auth(kaixin_batch_t *batch)
+{
+    if (batch == nullptr)
+    {
+        return nullptr;
+    }
+
+    auto *auth = batch->auth;
+    batch->auth = nullptr;
+    return auth;
+}
+
+
+void kaixin_batch_free(kaixin_batch_t *batch)
+{
+    if (batch != nullptr)
+    {
+        kaixin_free_auth(batch->auth);
+        delete batch;
+    }
+}
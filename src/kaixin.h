@@ -151,12 +151,78 @@ typedef enum kaixin_shopee_hosts_e
 } kaixin_shopee_hosts_t;
 
 
+/// \brief      批量请求中可包含的子请求。
+typedef enum kaixin_batch_item_e
+{
+    KAIXIN_BATCH_LOWEST_VERSION,                ///< 应用最低版本号，使用 `kaixin_batch_get_lowest_version` 获取
+    KAIXIN_BATCH_MATERIALS,                     ///< 素材，之后 `kaixin_get_material` 直接返回
+    KAIXIN_BATCH_SHOPEE_HOSTS,                  ///< Shopee 域名，之后 `kaixin_get_shopee_host` 直接返回
+    KAIXIN_BATCH_DEVICE_ID,                     ///< 设备 ID，之后 `kaixin_get_device_id` 直接返回
+    KAIXIN_BATCH_AUTH,                          ///< 应用授权，使用 `kaixin_batch_get_auth` 获取
+} kaixin_batch_item_t;
+
+
+/// \brief      批量请求。
+typedef struct kaixin_batch_s kaixin_batch_t;
+
+
+/// \brief      SDK 上下文。每个上下文有独立的应用参数、登录凭据、缓存与下行通知。
+typedef struct kaixin_context_s kaixin_context_t;
+
+
+/// \brief      DNS 缓存统计数据。
+typedef struct kaixin_dns_stats_s
+{
+    uint64_t hits;                              ///< 命中缓存的次数
+    uint64_t misses;                            ///< 需要等待解析的次数
+    uint64_t refreshes;                         ///< 过期前在后台刷新的次数
+    uint64_t failures;                          ///< 解析失败的次数
+} kaixin_dns_stats_t;
+
+
+/// \brief      取消令牌。
+typedef struct kaixin_cancel_token_s kaixin_cancel_token_t;
+
+
+/// \brief      请求重试与熔断策略。
+typedef struct kaixin_retry_policy_s
+{
+    int max_attempts;                           ///< 最多尝试次数（包括首次请求），1 表示不重试
+    int base_delay_ms;                          ///< 指数退避的基础时长，毫秒
+    int max_delay_ms;                           ///< 单次退避的最长时长，毫秒；Retry-After 超过此值时不再重试
+    int failure_threshold;                      ///< 同一接口（请求方法与路径）连续失败多少次后熔断，0 表示不熔断
+    int open_ms;                                ///< 熔断持续时长，毫秒
+} kaixin_retry_policy_t;
+
+
+/// \brief      后台令牌更新策略。
+typedef struct kaixin_token_refresh_policy_s
+{
+    int window_s;                               ///< 在访问令牌过期前多少秒更新，0 表示令牌有效期的四分之一
+    int jitter_s;                               ///< 在此基础上随机再提前的最长秒数
+    int base_delay_ms;                          ///< 更新失败后指数退避的基础时长，毫秒
+    int max_delay_ms;                           ///< 更新失败后单次退避的最长时长，毫秒
+} kaixin_token_refresh_policy_t;
+
+
 /// 下行通知回调函数
 typedef void(*kaixin_notification_callback_t)(const kaixin_notification_arguments_t *args, void *user_data);
 
 /// 日志输出函数
 typedef void(*kaixin_log_output_t)(const char *msg, kaixin_log_severity_t severity);
 
+/// 异步操作完成回调函数，`result` 为零表示成功
+typedef void(*kaixin_result_callback_t)(int result, void *user_data);
+
+/// 异步获取字符串完成回调函数，失败时 `s` 为 `NULL`
+typedef void(*kaixin_string_callback_t)(const char *s, void *user_data);
+
+/// 异步获取授权完成回调函数
+typedef void(*kaixin_auth_callback_t)(const kaixin_auth_t *auth, void *user_data);
+
+/// 异步获取版本号完成回调函数
+typedef void(*kaixin_version_callback_t)(kaixin_version_t version, void *user_data);
+
 
 /*!
  * \brief       获取开心 C SDK 版本号。
@@ -220,6 +286,10 @@ KAIXIN_EXPORT int kaixin_sign_out();
 /*!
  * \brief       获取用户配置。
  *
+ * 令牌更新后返回新的用户配置。返回的用户配置由调用线程持有，令牌更新、注销与反初始化都不会
+ * 释放它；同一线程再次调用本函数或 `kaixin_context_get_profile` 后失效，线程退出时释放。
+ * 需要在调用之间保留或交给其它线程时，应复制其中的字段。
+ *
  * \return      如果登录成功，则返回用户配置文件；否则返回 `NULL`。
  */
 KAIXIN_EXPORT const kaixin_profile_t *kaixin_get_profile();
@@ -285,6 +355,10 @@ KAIXIN_EXPORT const char *kaixin_get_material(const char *type);
 /*!
  * \brief       设置下行通知回调函数。
  *
+ * 函数立即返回，下行通知在后台注册，连接断开时自动重连。默认超时不限制注册过程；
+ * 调用前通过 `kaixin_set_call_options` 明确设置的超时或取消令牌可以中止注册，此后不再重连。
+ * `func` 在 SDK 的工作线程中按通知到达的顺序依次调用，可以阻塞，也可以在其中退出登录。
+ *
  * \param[in]   func        下行通知到达时要调用的函数
  * \param[in]   user_data   用户数据，用于 `func` 最后一个参数
  *
@@ -353,10 +427,522 @@ KAIXIN_EXPORT void kaixin_log(const char *msg);
 
 /*!
  * \brief       获取当前时间，UNIX Epoch。
+ *
+ * 根据每个响应的 Date 头校正为服务端时间；尚未收到响应时为本机时间。
  */
 KAIXIN_EXPORT time_t kaixin_get_current_time();
 
 
+/*!
+ * \brief       获取当前时间，UNIX Epoch 毫秒数。
+ *
+ * 与 `kaixin_get_current_time` 相同，但精度为毫秒。
+ */
+KAIXIN_EXPORT int64_t kaixin_get_current_time_ms();
+
+
+/*!
+ * \brief       设置请求重试与熔断策略，可以在初始化前调用。
+ *
+ * 幂等请求（GET、PUT、DELETE 等）在网络错误或服务端暂时不可用时重试；非幂等请求仅在确定未被
+ * 服务端处理时重试。重试间隔为带随机抖动的指数退避，服务端返回 Retry-After 时以其为准。
+ * 同一接口（请求方法与路径）连续失败达到阈值后熔断，熔断期间的请求直接返回 `EAGAIN`；
+ * 调用者取消的请求不计为成功或失败。
+ *
+ * 默认策略：最多尝试 3 次，退避 200～5000 毫秒，连续失败 5 次后熔断 30 秒。
+ *
+ * \param[in]   policy      新策略；如果为 `NULL`，则恢复默认策略
+ *
+ * \return      如果成功，则返回零；如果参数无效，则返回 `EINVAL`。
+ */
+KAIXIN_EXPORT int kaixin_set_retry_policy(const kaixin_retry_policy_t *policy);
+
+
+/*!
+ * \brief       获取当前的请求重试与熔断策略。
+ */
+KAIXIN_EXPORT kaixin_retry_policy_t kaixin_get_retry_policy();
+
+
+/*!
+ * \brief       设置后台令牌更新策略，可以在初始化前调用。
+ *
+ * 登录后，SDK 在后台线程中于访问令牌过期前的提前窗口内更新令牌，并随机再提前一段时间，
+ * 避免大量客户端同时更新。更新期间其它请求继续使用当前令牌，不会等待。更新失败时按带抖动的
+ * 指数退避重试，直到更新令牌过期；服务端拒绝更新令牌（401、403）时不再重试。
+ *
+ * 默认策略：在令牌有效期的最后四分之一内更新，随机提前最多 60 秒，退避 1000～60000 毫秒。
+ * 新策略从下次调度起生效。
+ *
+ * \param[in]   policy      新策略；如果为 `NULL`，则恢复默认策略
+ *
+ * \return      如果成功，则返回零；如果参数无效，则返回 `EINVAL`。
+ */
+KAIXIN_EXPORT int kaixin_set_token_refresh_policy(const kaixin_token_refresh_policy_t *policy);
+
+
+/*!
+ * \brief       获取当前的后台令牌更新策略。
+ */
+KAIXIN_EXPORT kaixin_token_refresh_policy_t kaixin_get_token_refresh_policy();
+
+
+/*!
+ * \brief       设置默认超时，可以在初始化前调用。
+ *
+ * 超时限制一次 API 调用的总时长，包括连接、TLS 握手、发送、接收与重试等待。超时的调用返回
+ * `ETIMEDOUT`（返回字符串或指针的函数返回 `NULL`）。默认超时为 60 秒。
+ *
+ * \param[in]   timeout_ms      超时，毫秒；零表示不限制
+ *
+ * \return      如果成功，则返回零；如果参数无效，则返回 `EINVAL`。
+ */
+KAIXIN_EXPORT int kaixin_set_default_timeout(int timeout_ms);
+
+
+/*!
+ * \brief       设置当前线程的调用选项，对之后在该线程中发起的 API 调用（包括异步调用）有效，
+ *              直到再次设置为止。
+ *
+ * 例如，要限制一次 `kaixin_get_auth` 的时长并能从其它线程取消：
+ *
+ * \code
+ * kaixin_cancel_token_t *token = kaixin_cancel_token_create();
+ * kaixin_set_call_options(5000, token);
+ * const kaixin_auth_t *auth = kaixin_get_auth();
+ * kaixin_set_call_options(-1, NULL);
+ * kaixin_cancel_token_free(token);
+ * \endcode
+ *
+ * \param[in]   timeout_ms      超时，毫秒；负数表示使用默认超时，零表示不限制
+ * \param[in]   token           取消令牌，可以为 `NULL`；调用期间令牌被取消时返回 `ECANCELED`
+ */
+KAIXIN_EXPORT void kaixin_set_call_options(int timeout_ms, kaixin_cancel_token_t *token);
+
+
+/*!
+ * \brief       创建取消令牌。
+ *
+ * \return      取消令牌，不再使用时须调用 `kaixin_cancel_token_free` 释放。
+ */
+KAIXIN_EXPORT kaixin_cancel_token_t *kaixin_cancel_token_create();
+
+
+/*!
+ * \brief       取消令牌，可以在任意线程中调用。使用该令牌的调用尽快中止，包括正在进行的连接、
+ *              TLS 握手、发送、接收与重试等待，以及下行通知的注册过程。
+ *
+ * \param[in]   token           取消令牌
+ */
+KAIXIN_EXPORT void kaixin_cancel_token_cancel(kaixin_cancel_token_t *token);
+
+
+/*!
+ * \brief       判断令牌是否已取消。
+ *
+ * \param[in]   token           取消令牌
+ *
+ * \return      如果已取消，则返回非零；否则返回零。
+ */
+KAIXIN_EXPORT int kaixin_cancel_token_is_cancelled(const kaixin_cancel_token_t *token);
+
+
+/*!
+ * \brief       释放取消令牌。正在使用该令牌的调用不受影响。
+ *
+ * \param[in]   token           取消令牌
+ */
+KAIXIN_EXPORT void kaixin_cancel_token_free(kaixin_cancel_token_t *token);
+
+
+/*!
+ * \brief       获取 DNS 缓存统计数据。
+ *
+ * SDK 缓存服务端域名的解析结果，遵循 TTL 并在过期前后台刷新；有多个地址时并行连接 IPv6 与 IPv4。
+ */
+KAIXIN_EXPORT kaixin_dns_stats_t kaixin_get_dns_stats();
+
+
+/*!
+ * \brief       设置是否在进程退出后保留 TLS 会话，应在初始化前调用。
+ *
+ * SDK 按主机缓存 TLS 会话，新连接通过会话恢复省去完整握手；启用保留时，反初始化时会话票据经
+ * 加密后与更新令牌一起保存，下次初始化时加载。默认启用。
+ *
+ * \param[in]   enabled     非零表示启用，零表示禁用
+ */
+KAIXIN_EXPORT void kaixin_set_tls_session_persistence(int enabled);
+
+
+/*!
+ * \brief       启用或禁用 HTTP/2。
+ *
+ * 启用时，并发的请求作为独立的流复用到每个主机的单一连接上，重复的请求头经 HPACK 压缩；
+ * 服务端不支持 HTTP/2 时自动使用 HTTP/1.1。编译时启用了 HTTP/2 支持时默认启用。
+ *
+ * \param[in]   enabled     非零表示启用，零表示禁用
+ *
+ * \return      如果成功，则返回零；如果编译时未启用 HTTP/2 支持，则返回 `ENOTSUP`。
+ */
+KAIXIN_EXPORT int kaixin_set_http2_enabled(int enabled);
+
+
+/*!
+ * \brief       开始批量请求。批量请求把多个子请求合并为一次网络往返，适合在启动时使用。
+ *
+ * \return      批量请求，不再使用时须调用 `kaixin_batch_free` 释放；如果 SDK 未初始化，则返回 `NULL`。
+ */
+KAIXIN_EXPORT kaixin_batch_t *kaixin_batch_begin();
+
+
+/*!
+ * \brief       向批量请求中添加子请求。同一子请求重复添加时只发送一次。
+ *
+ * \param[in]   batch       批量请求
+ * \param[in]   item        子请求
+ *
+ * \return      如果成功，则返回零；否则返回非零。
+ */
+KAIXIN_EXPORT int kaixin_batch_add(kaixin_batch_t *batch, kaixin_batch_item_t item);
+
+
+/*!
+ * \brief       发送批量请求，并处理各子请求的结果。
+ *
+ * \param[in]   batch       批量请求
+ *
+ * \return      如果批量请求本身成功，则返回零；否则返回非零。各子请求的结果使用
+ *              `kaixin_batch_get_result` 获取。
+ */
+KAIXIN_EXPORT int kaixin_batch_commit(kaixin_batch_t *batch);
+
+
+/*!
+ * \brief       获取子请求的结果。
+ *
+ * \param[in]   batch       批量请求
+ * \param[in]   item        子请求
+ *
+ * \return      如果子请求成功，则返回零；否则返回非零。
+ */
+KAIXIN_EXPORT int kaixin_batch_get_result(const kaixin_batch_t *batch, kaixin_batch_item_t item);
+
+
+/*!
+ * \brief       获取批量请求中的应用最低版本号。
+ *
+ * \param[in]   batch       批量请求
+ *
+ * \return      应用最低版本号。
+ */
+KAIXIN_EXPORT kaixin_version_t kaixin_batch_get_lowest_version(const kaixin_batch_t *batch);
+
+
+/*!
+ * \brief       获取批量请求中的应用授权。
+ *
+ * \param[in]   batch       批量请求
+ *
+ * \return      应用授权；如果没有授权，则返回 `NULL`。返回的指针归调用者所有，需要调用
+ *              `kaixin_free_auth` 函数释放；再次调用时返回 `NULL`。
+ */
+KAIXIN_EXPORT const kaixin_auth_t *kaixin_batch_get_auth(kaixin_batch_t *batch);
+
+
+/*!
+ * \brief       释放批量请求。
+ *
+ * \param[in]   batch       要释放的批量请求
+ */
+KAIXIN_EXPORT void kaixin_batch_free(kaixin_batch_t *batch);
+
+
+/*
+ * 异步 API
+ *
+ * 以下函数立即返回，请求在 SDK 工作线程中执行，完成后在工作线程中调用回调函数。
+ * 回调函数中不能调用 `kaixin_uninitialize`。返回值表示请求是否已成功投递：
+ * 如果 SDK 未初始化或参数无效，则返回非零；如果 SDK 正在反初始化，则返回 `ECANCELED`；
+ * 这两种情况都不会调用回调函数。
+ *
+ * 调用选项（`kaixin_set_call_options`）随请求投递：超时从请求在工作线程中开始执行时计算，
+ * 排队等待的时间不计入超时；取消令牌在排队期间同样有效。
+ */
+
+
+/*!
+ * \brief       设置异步 API 的最大并发数，即执行异步请求的工作线程数，可以在初始化前调用。
+ *
+ * 超出并发数的请求排队，按投递的顺序执行。立即生效：减少时正在执行的请求不受影响。
+ * 默认为 4。
+ *
+ * \param[in]   concurrency     最大并发数，1 到 64
+ *
+ * \return      如果成功，则返回零；如果参数无效，则返回 `EINVAL`。
+ */
+KAIXIN_EXPORT int kaixin_set_async_concurrency(int concurrency);
+
+
+/*!
+ * \brief       异步登录。
+ *
+ * \param[in]   username        用户名
+ * \param[in]   password        密码，明文
+ * \param[in]   callback        完成回调函数，参数同 `kaixin_sign_in` 的返回值
+ * \param[in]   user_data       用户数据，用于 `callback` 最后一个参数
+ *
+ * \return      如果成功投递，则返回零；否则返回非零。
+ * \sa          `kaixin_sign_in`
+ */
+KAIXIN_EXPORT int kaixin_sign_in_async(const char *username, const char *password,
+                                       kaixin_result_callback_t callback, void *user_data);
+
+
+/*!
+ * \brief       异步注销。
+ *
+ * \param[in]   callback        完成回调函数，参数同 `kaixin_sign_out` 的返回值，可以为 `NULL`
+ * \param[in]   user_data       用户数据，用于 `callback` 最后一个参数
+ *
+ * \return      如果成功投递，则返回零；否则返回非零。
+ * \sa          `kaixin_sign_out`
+ */
+KAIXIN_EXPORT int kaixin_sign_out_async(kaixin_result_callback_t callback, void *user_data);
+
+
+/*!
+ * \brief       异步获取设备 ID。回调函数收到的字符串不需要释放。
+ *
+ * \param[in]   callback        完成回调函数
+ * \param[in]   user_data       用户数据，用于 `callback` 最后一个参数
+ *
+ * \return      如果成功投递，则返回零；否则返回非零。
+ * \sa          `kaixin_get_device_id`
+ */
+KAIXIN_EXPORT int kaixin_get_device_id_async(kaixin_string_callback_t callback, void *user_data);
+
+
+/*!
+ * \brief       异步获取应用授权。回调函数收到的授权需要调用 `kaixin_free_auth` 函数释放。
+ *
+ * \param[in]   callback        完成回调函数
+ * \param[in]   user_data       用户数据，用于 `callback` 最后一个参数
+ *
+ * \return      如果成功投递，则返回零；否则返回非零。
+ * \sa          `kaixin_get_auth`
+ */
+KAIXIN_EXPORT int kaixin_get_auth_async(kaixin_auth_callback_t callback, void *user_data);
+
+
+/*!
+ * \brief       异步获取应用最低版本号。
+ *
+ * \param[in]   callback        完成回调函数
+ * \param[in]   user_data       用户数据，用于 `callback` 最后一个参数
+ *
+ * \return      如果成功投递，则返回零；否则返回非零。
+ * \sa          `kaixin_get_lowest_version`
+ */
+KAIXIN_EXPORT int kaixin_get_lowest_version_async(kaixin_version_callback_t callback, void *user_data);
+
+
+/*!
+ * \brief       异步获取素材。回调函数收到的字符串不需要释放。
+ *
+ * \param[in]   type            素材类型
+ * \param[in]   callback        完成回调函数
+ * \param[in]   user_data       用户数据，用于 `callback` 最后一个参数
+ *
+ * \return      如果成功投递，则返回零；否则返回非零。
+ * \sa          `kaixin_get_material`
+ */
+KAIXIN_EXPORT int kaixin_get_material_async(const char *type, kaixin_string_callback_t callback,
+                                            void *user_data);
+
+
+/*!
+ * \brief       异步获取 Shopee 域名。回调函数收到的字符串不需要释放。
+ *
+ * \param[in]   website         站点，2 小写字母
+ * \param[in]   hosts           全球/中国
+ * \param[in]   sub             子域名
+ * \param[in]   callback        完成回调函数
+ * \param[in]   user_data       用户数据，用于 `callback` 最后一个参数
+ *
+ * \return      如果成功投递，则返回零；否则返回非零。
+ * \sa          `kaixin_get_shopee_host`
+ */
+KAIXIN_EXPORT int kaixin_get_shopee_host_async(const char *website, kaixin_shopee_hosts_t hosts,
+                                               kaixin_shopee_hosts_by_sub_domain_t sub,
+                                               kaixin_string_callback_t callback, void *user_data);
+
+
+/*!
+ * \brief       异步获取 Shopee 站点列表。回调函数收到的字符串需要调用 `kaixin_free_string` 释放。
+ *
+ * \param[in]   callback        完成回调函数
+ * \param[in]   user_data       用户数据，用于 `callback` 最后一个参数
+ *
+ * \return      如果成功投递，则返回零；否则返回非零。
+ * \sa          `kaixin_get_shopee_websites`
+ */
+KAIXIN_EXPORT int kaixin_get_shopee_websites_async(kaixin_string_callback_t callback, void *user_data);
+
+
+/*!
+ * \brief       异步获取功能页面地址。回调函数收到的字符串需要调用 `kaixin_free_string` 释放。
+ *
+ * \param[in]   page            要获取地址的页面
+ * \param[in]   callback        完成回调函数
+ * \param[in]   user_data       用户数据，用于 `callback` 最后一个参数
+ *
+ * \return      如果成功投递，则返回零；否则返回非零。
+ * \sa          `kaixin_get_web_url`
+ */
+KAIXIN_EXPORT int kaixin_get_web_url_async(kaixin_web_page_t page, kaixin_string_callback_t callback,
+                                           void *user_data);
+
+
+/*!
+ * \brief       异步向服务端记录日志。
+ *
+ * \param[in]   msg             要记录的字符串
+ * \param[in]   callback        完成回调函数，可以为 `NULL`
+ * \param[in]   user_data       用户数据，用于 `callback` 最后一个参数
+ *
+ * \return      如果成功投递，则返回零；否则返回非零。
+ * \sa          `kaixin_log`
+ */
+KAIXIN_EXPORT int kaixin_log_async(const char *msg, kaixin_result_callback_t callback, void *user_data);
+
+
+/*
+ * 上下文 API
+ *
+ * 一个进程中可以同时使用多个上下文，例如分别登录多个账号。每个上下文有独立的应用参数、
+ * 登录凭据、缓存与下行通知；连接池、DNS 缓存、TLS 会话与工作线程由所有上下文共享。
+ * `kaixin_initialize` 创建的是默认上下文，不带 `ctx` 参数的函数使用默认上下文。
+ *
+ * 以下函数与对应的不带 `context` 的函数相同，只是在 `ctx` 指定的上下文中执行；
+ * `ctx` 为 `NULL` 时与 SDK 未初始化时的结果相同。只有默认上下文在本地保存更新令牌。
+ */
+
+
+/*!
+ * \brief       创建上下文。不需要先调用 `kaixin_initialize`。
+ *
+ * \param[in]   organization    组织名，用于读写配置文件
+ * \param[in]   application     应用名，用于读写配置文件
+ * \param[in]   app_key         APP KEY
+ * \param[in]   app_secret      APP SECRET
+ * \param[in]   base_url        基础 URL。如果设置为 NULL，则使用默认设置（生产环境）
+ *
+ * \return      如果成功，则返回上下文，不再使用时须调用 `kaixin_context_free` 释放；否则返回 `NULL`。
+ */
+KAIXIN_EXPORT kaixin_context_t *kaixin_context_create(const char *organization, const char *application,
+                                                      const char *app_key, const char *app_secret,
+                                                      const char *base_url);
+
+
+/*!
+ * \brief       释放上下文。已投递的异步请求仍会完成并调用回调函数。
+ *
+ * 与 `kaixin_uninitialize` 一样，不能在回调函数中释放最后一个上下文（包括默认上下文）。
+ *
+ * \param[in]   ctx             要释放的上下文
+ */
+KAIXIN_EXPORT void kaixin_context_free(kaixin_context_t *ctx);
+
+
+/// \sa         `kaixin_sign_in`
+KAIXIN_EXPORT int kaixin_context_sign_in(kaixin_context_t *ctx, const char *username, const char *password);
+
+/// \sa         `kaixin_sign_out`
+KAIXIN_EXPORT int kaixin_context_sign_out(kaixin_context_t *ctx);
+
+/// \sa         `kaixin_get_profile`
+KAIXIN_EXPORT const kaixin_profile_t *kaixin_context_get_profile(kaixin_context_t *ctx);
+
+/// \sa         `kaixin_get_device_id`
+KAIXIN_EXPORT const char *kaixin_context_get_device_id(kaixin_context_t *ctx);
+
+/// \sa         `kaixin_get_auth`
+KAIXIN_EXPORT const kaixin_auth_t *kaixin_context_get_auth(kaixin_context_t *ctx);
+
+/// \sa         `kaixin_get_lowest_version`
+KAIXIN_EXPORT kaixin_version_t kaixin_context_get_lowest_version(kaixin_context_t *ctx);
+
+/// \sa         `kaixin_get_material`
+KAIXIN_EXPORT const char *kaixin_context_get_material(kaixin_context_t *ctx, const char *type);
+
+/// \sa         `kaixin_set_notification_callback`
+KAIXIN_EXPORT int kaixin_context_set_notification_callback(kaixin_context_t *ctx,
+                                                           kaixin_notification_callback_t func,
+                                                           void *user_data);
+
+/// \sa         `kaixin_get_shopee_host`
+KAIXIN_EXPORT const char *kaixin_context_get_shopee_host(kaixin_context_t *ctx, const char *website,
+                                                         kaixin_shopee_hosts_t hosts,
+                                                         kaixin_shopee_hosts_by_sub_domain_t sub);
+
+/// \sa         `kaixin_get_shopee_websites`
+KAIXIN_EXPORT const char *kaixin_context_get_shopee_websites(kaixin_context_t *ctx);
+
+/// \sa         `kaixin_get_web_url`
+KAIXIN_EXPORT const char *kaixin_context_get_web_url(kaixin_context_t *ctx, kaixin_web_page_t page);
+
+/// \sa         `kaixin_log`
+KAIXIN_EXPORT void kaixin_context_log(kaixin_context_t *ctx, const char *msg);
+
+/// \sa         `kaixin_batch_begin`。批量请求在创建它的上下文中发送。
+KAIXIN_EXPORT kaixin_batch_t *kaixin_context_batch_begin(kaixin_context_t *ctx);
+
+/// \sa         `kaixin_sign_in_async`
+KAIXIN_EXPORT int kaixin_context_sign_in_async(kaixin_context_t *ctx, const char *username,
+                                               const char *password, kaixin_result_callback_t callback,
+                                               void *user_data);
+
+/// \sa         `kaixin_sign_out_async`
+KAIXIN_EXPORT int kaixin_context_sign_out_async(kaixin_context_t *ctx, kaixin_result_callback_t callback,
+                                                void *user_data);
+
+/// \sa         `kaixin_get_device_id_async`
+KAIXIN_EXPORT int kaixin_context_get_device_id_async(kaixin_context_t *ctx, kaixin_string_callback_t callback,
+                                                     void *user_data);
+
+/// \sa         `kaixin_get_auth_async`
+KAIXIN_EXPORT int kaixin_context_get_auth_async(kaixin_context_t *ctx, kaixin_auth_callback_t callback,
+                                                void *user_data);
+
+/// \sa         `kaixin_get_lowest_version_async`
+KAIXIN_EXPORT int kaixin_context_get_lowest_version_async(kaixin_context_t *ctx,
+                                                          kaixin_version_callback_t callback,
+                                                          void *user_data);
+
+/// \sa         `kaixin_get_material_async`
+KAIXIN_EXPORT int kaixin_context_get_material_async(kaixin_context_t *ctx, const char *type,
+                                                    kaixin_string_callback_t callback, void *user_data);
+
+/// \sa         `kaixin_get_shopee_host_async`
+KAIXIN_EXPORT int kaixin_context_get_shopee_host_async(kaixin_context_t *ctx, const char *website,
+                                                       kaixin_shopee_hosts_t hosts,
+                                                       kaixin_shopee_hosts_by_sub_domain_t sub,
+                                                       kaixin_string_callback_t callback, void *user_data);
+
+/// \sa         `kaixin_get_shopee_websites_async`
+KAIXIN_EXPORT int kaixin_context_get_shopee_websites_async(kaixin_context_t *ctx,
+                                                           kaixin_string_callback_t callback,
+                                                           void *user_data);
+
+/// \sa         `kaixin_get_web_url_async`
+KAIXIN_EXPORT int kaixin_context_get_web_url_async(kaixin_context_t *ctx, kaixin_web_page_t page,
+                                                   kaixin_string_callback_t callback, void *user_data);
+
+/// \sa         `kaixin_log_async`
+KAIXIN_EXPORT int kaixin_context_log_async(kaixin_context_t *ctx, const char *msg,
+                                           kaixin_result_callback_t callback, void *user_data);
+
+
 #ifdef __cplusplus
 }       // extern "C"
 #endif
@@ -12,98 +12,340 @@
  **************************************************************************************************/
 #include "kaixin_api.h"
 
-#include <openssl/hmac.h>
 #include <ixwebsocket/IXHttpClient.h>
 
+#include <cerrno>
 #include <chrono>
-#include <iomanip>
-
+#include <set>
+#include <sstream>
+
+#include <rapidjson/ostreamwrapper.h>
+#include <rapidjson/writer.h>
+
+#include "buffer_pool.h"
+#include "call_context.h"
+#include "codec.h"
+#include "http_transport.h"
+#include "json_arena.h"
+#include "json_stream_parser.h"
 #include "kaixin_version.h"
 #include "logger.h"
+#include "nonce_pool.h"
 #include "rapidjsonhelpers.h"
+#include "response_cache.h"
+#include "retry_policy.h"
+#include "server_clock.h"
+#include "single_flight.h"
 #include "utils.h"
 
+// 纠正 EAGAIN 被重定义为 WSATRY_AGAIN 的问题。
+#ifdef KAIXIN_OS_WINDOWS
+#undef EAGAIN
+#define EAGAIN 11
+#endif
+
+
+time_t kaixin_get_current_time()
+{
+    return static_cast<time_t>(kaixin::server_clock::instance().now_ms() / 1000);
+}
 
-kaixin::Config *g_config = nullptr;
 
-static time_t g_serverTime = 0;
-static std::chrono::steady_clock::time_point g_timestamp;
+int64_t kaixin_get_current_time_ms()
+{
+    return kaixin::server_clock::instance().now_ms();
+}
 
 
-time_t kaixin_get_current_time()
+namespace kaixin {
+
+
+std::shared_ptr<Config> g_default_config;
+
+/// 当前线程在 `config_scope` 内指定的配置。
+static thread_local Config *t_config = nullptr;
+/// 当前线程是否在 `config_scope` 内。
+static thread_local bool t_config_active = false;
+
+
+Config *current_config()
+{
+    return t_config_active ? t_config : g_default_config.get();
+}
+
+
+config_scope::config_scope(Config *config)
+    : saved_(t_config)
+    , saved_active_(t_config_active)
 {
-    if (g_serverTime == 0)
+    t_config = config;
+    t_config_active = true;
+}
+
+
+config_scope::~config_scope()
+{
+    t_config = saved_;
+    t_config_active = saved_active_;
+}
+
+
+std::shared_ptr<const credentials> current_credentials()
+{
+    return std::atomic_load(&current_config()->creds);
+}
+
+
+// 设置用户配置并发布。调用者持有 `credentials_mutex`。
+static void publish_locked(Config *config, std::shared_ptr<credentials> creds)
+{
+    if (creds)
     {
-        return time(nullptr);
+        auto &p = creds->profile;
+        p.access_token = creds->access_token.c_str();
+        p.refresh_token = creds->refresh_token.c_str();
+        p.id_token = creds->id_token.c_str();
+        p.username = creds->username.c_str();
+        p.email = creds->email.c_str();
+        p.invitation_code = creds->agent_code.c_str();
+        p.secret = creds->secret.c_str();
+        p.access_token_expires_at = creds->access_token_expires_at;
+        p.refresh_token_expires_at = creds->refresh_token_expires_at;
+        p.id_token_expires_at = creds->id_token_expires_at;
+        p.status = creds->status;
     }
 
-    const auto elapsed = std::chrono::steady_clock::now() - g_timestamp;
-    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(elapsed);
-    return g_serverTime + seconds.count();
+    std::shared_ptr<const credentials> published = std::move(creds);
+    std::atomic_store(&config->creds, published);
 }
 
 
-namespace kaixin {
+unsigned sign_out_epoch()
+{
+    auto *config = current_config();
+    std::lock_guard lock(config->credentials_mutex);
+    return config->sign_out_epoch;
+}
 
 
-// 计算签名
-std::string sign(const std::string &verb, const std::string &path, const string_map &queries,
-                 const string_map &form)
+void begin_sign_out()
 {
-    // 签名字符串：请求方法 + 路径
-    std::string sts = verb + path;
+    auto *config = current_config();
+    std::lock_guard lock(config->credentials_mutex);
+    config->sign_out_epoch++;
+}
 
-    // 所有请求参数（查询 + 表单）合并排序
-    string_map params = queries;
-    params.insert(form.begin(), form.end());
 
-    // + 参数名称 + 参数值
-    for (const auto &[key, value] : params)
+bool publish_credentials(std::shared_ptr<credentials> creds, unsigned epoch, const std::function<void()> &published)
+{
+    auto *config = current_config();
+    std::lock_guard lock(config->credentials_mutex);
+
+    if (epoch != config->sign_out_epoch)
     {
-        sts += key + value;
+        // 请求发出后已注销
+        return false;
     }
 
-    // 计算 HMAC SHA256
-    auto *input = reinterpret_cast<const uint8_t *>(sts.c_str());
-    auto *key = reinterpret_cast<const uint8_t *>(g_config->app_secret.c_str());
-    uint8_t output[EVP_MAX_MD_SIZE] = { 0 };
-    unsigned int output_length = EVP_MAX_MD_SIZE;
-    auto *p = HMAC(EVP_sha256(), key, static_cast<int>(g_config->app_secret.length()), input,
-                   sts.length(), output, &output_length);
+    publish_locked(config, std::move(creds));
 
-    if (p == nullptr)
+    if (published)
     {
-        // 计算出错
-        return {};
+        published();
     }
 
-    return utils::to_hex(output, output_length);
+    return true;
 }
 
 
-std::string url_encode(const std::string &s)
+bool update_credentials(const std::function<bool(credentials &)> &modify)
+{
+    auto *config = current_config();
+    std::lock_guard lock(config->credentials_mutex);
+    auto current = std::atomic_load(&config->creds);
+
+    if (!current)
+    {
+        return false;
+    }
+
+    auto creds = std::make_shared<credentials>(*current);
+
+    if (!modify(*creds))
+    {
+        return false;
+    }
+
+    publish_locked(config, std::move(creds));
+    return true;
+}
+
+
+void url_encode(std::string &out, const std::string &s)
 {
-    static ix::HttpClient http;
-    return http.urlEncode(s);
+    codec::url_encode(out, s.data(), s.size());
 }
 
 
-std::string make_form(const string_map &queries)
+// 追加一个“参数名=参数值”
+static void append_pair(std::string &out, const std::string &key, const std::string &value)
+{
+    if (!out.empty())
+    {
+        out += '&';
+    }
+
+    url_encode(out, key);
+    out += '=';
+    url_encode(out, value);
+}
+
+
+// 参数名与参数值的总长度
+static size_t total_length(const string_map &params)
 {
-    if (queries.empty())
+    size_t length = 0;
+
+    for (const auto &[key, value] : params)
     {
-        return {};
+        length += key.size() + value.size();
     }
 
-    std::vector<std::string> form;
-    form.reserve(queries.size());
+    return length;
+}
+
+
+void encode_request(const std::string &verb, const std::string &path, const string_map &common,
+                    const string_map &queries, const string_map &form, hmac_sha256 &signer,
+                    encoded_request &out)
+{
+    // 参数大多不需要编码，按原始长度加上分隔符预留空间
+    out.query.clear();
+    // 查询字符串另外预留签名参数：“s=” + 64 位十六进制 + 分隔符
+    out.query.reserve(total_length(common) + total_length(queries) + (common.size() + queries.size()) * 2 + 68);
+    out.form.clear();
+    out.form.reserve(total_length(form) + form.size() * 2);
+    out.signature_pos = std::string::npos;
+
+    // 签名字符串：请求方法 + 路径
+    signer.update(verb);
+    signer.update(path);
+
+    // 按优先级排列的参数表，参数名相同时只取第一个
+    const string_map *sources[] = { &queries, &common, &form };
+    string_map::const_iterator iters[] = { queries.begin(), common.begin(), form.begin() };
+    bool signature_placed = false;
+
+    for (;;)
+    {
+        // 找出参数名最小的参数表
+        int first = -1;
+
+        for (int i = 0; i < 3; i++)
+        {
+            if (iters[i] != sources[i]->end()
+                && (first < 0 || string_map::less(iters[i]->first, iters[first]->first)))
+            {
+                first = i;
+            }
+        }
+
+        if (first < 0)
+        {
+            break;
+        }
+
+        const auto &[key, value] = *iters[first];
+
+        if (first != 2 && !signature_placed && !string_map::less(key, "s"))
+        {
+            // 签名参数排在这个参数之前；已有同名参数时不再添加
+            signature_placed = true;
+
+            if (string_map::less("s", key))
+            {
+                out.signature_pos = out.query.empty() ? 0 : out.query.size() + 1;
+            }
+        }
+
+        // + 参数名称 + 参数值
+        signer.update(key);
+        signer.update(value);
+
+        for (int i = first; i < 3; i++)
+        {
+            if (iters[i] == sources[i]->end() || string_map::less(key, iters[i]->first))
+            {
+                continue;
+            }
+
+            // 被覆盖的同名参数跳过，但表单中的参数仍然全部写入表单字符串
+            if (i == 2)
+            {
+                append_pair(out.form, iters[i]->first, iters[i]->second);
+            }
+            else if (i == first)
+            {
+                append_pair(out.query, key, value);
+            }
+
+            ++iters[i];
+        }
+    }
+
+    if (!signature_placed)
+    {
+        out.signature_pos = out.query.size();
+    }
+}
+
+
+// 签名的十六进制长度
+static constexpr size_t SIGNATURE_LENGTH = hmac_sha256::DIGEST_LENGTH * 2;
+
+
+// 完成签名，输出十六进制字符串（不以 '\0' 结尾）
+static void finish_signature(hmac_sha256 &signer, char *hex)
+{
+    uint8_t digest[hmac_sha256::DIGEST_LENGTH];
+    signer.final(digest);
+    codec::hex_encode(hex, digest, sizeof(digest));
+}
+
+
+std::string sign(const std::string &verb, const std::string &path, const string_map &queries,
+                 const string_map &form)
+{
+    auto signer = current_config()->signing_key;
+    encoded_request encoded;
+    encode_request(verb, path, {}, queries, form, signer, encoded);
+
+    char hex[SIGNATURE_LENGTH];
+    finish_signature(signer, hex);
+    return std::string(hex, sizeof(hex));
+}
+
+
+std::string url_encode(const std::string &s)
+{
+    std::string out;
+    out.reserve(s.size());
+    url_encode(out, s);
+    return out;
+}
+
+
+std::string make_form(const string_map &queries)
+{
+    std::string form;
+    form.reserve(total_length(queries) + queries.size() * 2);
 
     for (const auto &[key, value] : queries)
     {
-        form.emplace_back(url_encode(key) + '=' + url_encode(value));
+        append_pair(form, key, value);
     }
 
-    return utils::join(form, "&");
+    return form;
 }
 
 
@@ -113,59 +355,125 @@ std::string make_url(const std::string &base_url, const std::string &path, const
 
     if (!queries.empty())
     {
-        url += '?' + make_form(queries);
+        url += '?';
+        url += make_form(queries);
     }
 
     return url;
 }
 
 
-int send_request(const std::string &verb, const std::string &path, const string_map &queries,
-                 const string_map &form, const response_data_handler &handler)
+// 可以以 TLS 早期数据发送的请求：只读且重放无副作用
+static bool is_replay_safe(const std::string &verb, const std::string &path)
 {
-    assert(!verb.empty() && !path.empty() && path.at(0) == '/');
+    static const std::set<std::string> paths{
+        "/lowest-version", "/materials", "/shopee-hosts", "/web-url"
+    };
+
+    return verb == ix::HttpClient::kGet && paths.count(path) > 0;
+}
+
+
+// 响应体较大、边接收边解析的请求
+static bool is_streamed(const std::string &path)
+{
+    static const std::set<std::string> paths{ "/auth", "/shopee-hosts" };
+    return paths.count(path) > 0;
+}
+
 
-    // 设置公共参数：k、t、z
-    auto now = utils::get_timestamp_ms();
-    string_map params = queries;
-    params.emplace("k", g_config->app_key);
-    params.emplace("t", std::to_string(now));
-    params.emplace("z", utils::generate_random_hex_string(16));
+// 签名并发送请求。指定了 `parser` 时，响应体在到达时交给它解析。`creds` 为发送时使用的凭据快照。
+static ix::HttpResponsePtr perform(const call_context &ctx, const std::string &verb,
+                                   const std::string &path, const string_map &queries,
+                                   const string_map &form, const ix::WebSocketHttpHeaders &headers,
+                                   json_stream_parser *parser, std::shared_ptr<const credentials> &creds)
+{
+    assert(!verb.empty() && !path.empty() && path.at(0) == '/');
 
-    // 如果有访问令牌，则设置 a 参数
+    // 设置公共参数：k、t、z。时间使用校正后的服务端时间，本机时钟不准时签名也不会过期
+    const auto *config = current_config();
+    auto &server_time = server_clock::instance();
+    auto now = server_time.now_ms();
+    string_map common{
+        { "k", config->app_key },
+        { "t", std::to_string(now) },
+        { "z", nonce_pool::local().generate() },
+    };
+
+    // 如果有访问令牌，则设置 a 参数。每次发送取一次凭据快照，重试时使用更新后的令牌
     now /= 1000;
+    creds = ctx.anonymous() ? nullptr : current_credentials();
 
-    if (!g_config->access_token.empty() && g_config->access_token_expires_at >= now)
+    if (creds && !creds->access_token.empty() && creds->access_token_expires_at >= now)
     {
-        params.emplace("a", g_config->access_token);
+        common.emplace("a", creds->access_token);
     }
 
-    // 签名
-    params.emplace("s", sign(verb, path, params, form));
+    // 一次生成查询字符串与请求体，并签名。签名上下文复制自预先设置了密钥的上下文。
+    auto signer = config->signing_key;
+    encoded_request encoded;
+    encode_request(verb, path, common, queries, form, signer, encoded);
 
-    // 构造 URL
-    auto url = make_url(g_config->base_url, path, params);
+    if (encoded.signature_pos != std::string::npos)
+    {
+        // “s=” + 签名 + 分隔符，写入已预留的空间，不分配内存
+        char param[2 + SIGNATURE_LENGTH + 1] = { 's', '=' };
+        finish_signature(signer, param + 2);
+        auto &query = encoded.query;
+
+        if (encoded.signature_pos < query.size())
+        {
+            param[sizeof(param) - 1] = '&';
+            query.insert(encoded.signature_pos, param, sizeof(param));
+        }
+        else
+        {
+            if (!query.empty())
+            {
+                query += '&';
+            }
 
-    ix::HttpClient http;
-    auto args = http.createRequest();
+            query.append(param, sizeof(param) - 1);
+        }
+    }
+
+    // 构造 URL
+    std::string url;
+    url.reserve(config->base_url.size() + path.size() + 1 + encoded.query.size());
+    url += config->base_url;
+    url += path;
+    url += '?';
+    url += encoded.query;
+
+    auto args = std::make_shared<ix::HttpRequestArgs>();
+    args->url = url;
+    args->verb = verb;
     args->logger = [](const std::string &msg) { logger::debug(msg.c_str()); };
+    args->extraHeaders = headers;
 
-#ifndef NDEBUG
+    if (parser != nullptr)
+    {
+        args->onChunkCallback = [parser](const std::string &chunk) { parser->feed(chunk); };
+    }
+
+#if !defined(NDEBUG) && defined(KAIXIN_OS_WINDOWS)
     args->verbose = (utils::get_reg_type_value<uint32_t>("kaixin::verbose") != 0);
 #endif
 
-    if (!g_config->id_token.empty() && g_config->id_token_expires_at >= now)
+    if (creds && !creds->id_token.empty() && creds->id_token_expires_at >= now)
     {
         // 设置认证头
-        args->extraHeaders.emplace("Authorization", "Bearer " + g_config->id_token);
+        args->extraHeaders.emplace("Authorization", "Bearer " + creds->id_token);
     }
 
     // User agent
     //args->extraHeaders.emplace("User-Agent", "kaixin-native/" KAIXIN_VERSION_STRING);
 
-    // 构造请求体，并发送请求
-    auto body = make_form(form);
-    auto resp = http.request(url, verb, body, args);
+    // 发送请求
+    const auto sent = server_clock::clock::now();
+    auto resp = http::request(url, verb, encoded.form, args, ctx.make_cancellation_request(),
+                              is_replay_safe(verb, path));
+    const auto received = server_clock::clock::now();
 
 #ifndef NDEBUG
     if (args->verbose)
@@ -180,63 +488,209 @@ int send_request(const std::string &verb, const std::string &path, const string_
     }
 #endif
 
-    // 分析服务器时间
-    if (g_serverTime == 0)
+    // 用每个响应的 Date 校正服务端时间
+    if (resp->errorCode == ix::HttpErrorCode::Ok)
     {
-        g_timestamp = std::chrono::steady_clock::now();
         const auto iter = resp->headers.find("Date");
 
-        if (iter != resp->headers.end())
+        if (iter == resp->headers.end())
         {
-            std::istringstream input(iter->second);
-            input.imbue(std::locale(setlocale(LC_ALL, nullptr)));
+            LW() << "No Date in headers.";
+        }
+        else if (!server_time.sample(iter->second, sent, received))
+        {
+            LW() << "Failed to parse date: " << iter->second;
+        }
+    }
 
-            tm t = { 0 };
-            // https://developer.mozilla.org/zh-CN/docs/Web/HTTP/Headers/Date
-            input >> std::get_time(&t, "%a, %d %b %Y %T GMT");
+    return resp;
+}
 
-            if (input.fail())
-            {
-                LW() << "Failed to parse date: " << iter->second;
-            }
-            else
-            {
-                g_serverTime = _mkgmtime(&t);
-            }
+
+// 按重试策略发送请求。路径处于熔断期、调用被取消或超时时返回最后一次的响应；
+// 一次都没有发送时返回空指针。边接收边解析的请求，`parser` 为最后一次响应的解析器，
+// `creds` 为最后一次发送时使用的凭据快照。
+static ix::HttpResponsePtr perform_with_retry(const call_context &ctx, const std::string &verb,
+                                              const std::string &path, const string_map &queries,
+                                              const string_map &form,
+                                              const ix::WebSocketHttpHeaders &headers,
+                                              std::unique_ptr<json_stream_parser> &parser,
+                                              std::shared_ptr<const credentials> &creds)
+{
+    auto &policy = retry_policy::instance();
+    ix::HttpResponsePtr resp;
+
+    for (int attempt = 1; ; attempt++)
+    {
+        if (ctx.is_done())
+        {
+            return resp;
         }
-        else
+
+        if (!policy.allow(verb, path))
         {
-            LW() << "No Date in headers.";
+            LW() << "Circuit open:" << verb << path;
+            return resp;
+        }
+
+        if (resp)
+        {
+            // 上一次的响应体不再需要
+            buffer_pool::instance().release(std::move(resp->payload));
+        }
+
+        if (is_streamed(path))
+        {
+            parser = std::make_unique<json_stream_parser>();
+        }
+
+        // 每次尝试重新签名，时间戳与随机数不能重复使用
+        resp = perform(ctx, verb, path, queries, form, headers, parser.get(), creds);
+        policy.record(verb, path, *resp);
+
+        std::chrono::milliseconds delay;
+
+        if (!policy.next_delay(verb, *resp, attempt, delay))
+        {
+            return resp;
+        }
+
+        LW() << "Retrying" << verb << path << "in" << delay.count() << "ms.";
+
+        if (!ctx.sleep_for(delay))
+        {
+            return resp;
         }
     }
+}
+
+
+int refresh_credentials(const call_context &ctx, const std::shared_ptr<const credentials> &stale)
+{
+    auto *config = current_config();
 
-    if (resp->payload.empty())
+    // 同一时刻只发送一次更新请求，其它调用者等待并共享结果
+    return config->flights.run("PATCH /session", ctx, [config, &stale]
     {
-        // 响应为空
-        LW() << "Empty body.";
+        const auto current = current_credentials();
+
+        if (current != stale)
+        {
+            // 在等待期间已被其它调用者更新
+            return 0;
+        }
+
+        if (!current || current->refresh_token.empty() || !config->refresh_session)
+        {
+            return EPERM;
+        }
+
+        return config->refresh_session(current->refresh_token);
+    });
+}
+
+
+// 发送请求；服务端以 401 拒绝所附带的令牌时，更新令牌后重新签名并重发一次。
+// 并发的 401 只触发一次更新，其它请求等待更新完成后重发。
+static ix::HttpResponsePtr perform_authorized(const call_context &ctx, const std::string &verb,
+                                              const std::string &path, const string_map &queries,
+                                              const string_map &form,
+                                              const ix::WebSocketHttpHeaders &headers,
+                                              std::unique_ptr<json_stream_parser> &parser)
+{
+    std::shared_ptr<const credentials> used;
+    auto resp = perform_with_retry(ctx, verb, path, queries, form, headers, parser, used);
+
+    // 登录、更新与注销请求的 401 是其本身的结果，不能以更新令牌来重发
+    if (!resp || resp->errorCode != ix::HttpErrorCode::Ok || resp->statusCode != 401
+        || !used || path == "/session")
+    {
+        return resp;
+    }
+
+    LW() << "Unauthorized, refreshing tokens:" << verb << path;
+
+    if (refresh_credentials(ctx, used) != 0 || current_credentials() == used || ctx.is_done())
+    {
+        // 更新失败，返回原来的错误
+        return resp;
+    }
+
+    // 被拒绝的响应体不再需要
+    buffer_pool::instance().release(std::move(resp->payload));
+    LI() << "Replaying" << verb << path;
+    return perform_with_retry(ctx, verb, path, queries, form, headers, parser, used);
+}
+
+
+// 调用被取消或超时时的返回值；否则返回零
+static int interrupted_result(const call_context &ctx, const ix::HttpResponsePtr &resp)
+{
+    if ((!resp || resp->errorCode != ix::HttpErrorCode::Ok) && ctx.is_done())
+    {
+        LW() << (ctx.is_cancelled() ? "Request cancelled." : "Request timed out.");
+        return ctx.is_cancelled() ? ECANCELED : ETIMEDOUT;
+    }
+
+    return 0;
+}
+
+
+// 处理响应。`parser` 不为空时，响应体已由它边接收边解析。
+static int handle_response(const std::string &verb, const std::string &path, ix::HttpResponse &resp,
+                           const response_data_handler &handler, json_stream_parser *parser)
+{
+    // 文档与字符串指向响应体，处理函数返回后才能归还缓冲区
+    buffer_recycler recycler(resp.payload);
+
+    if (resp.errorCode != ix::HttpErrorCode::Ok)
+    {
+        // 网络错误
+        LE() << "Failed to" << verb << path << ":" << resp.errorMsg;
         return -1;
     }
 
     using rapidjson::get;
-    rapidjson::Document doc;
-    doc.ParseInsitu(resp->payload.data());
+    json_arena arena;
+    auto &parsed = arena.document();
+    bool valid = false;
+
+    if (parser != nullptr)
+    {
+        // 解析最后一段数据中剩余的记号
+        valid = parser->finish();
+    }
+    else if (!resp.payload.empty())
+    {
+        parsed.ParseInsitu(resp.payload.data());
+        valid = !parsed.HasParseError();
+    }
+    else
+    {
+        // 响应为空
+        LW() << "Empty body.";
+        return -1;
+    }
 
-    if (doc.HasParseError())
+    if (!valid)
     {
         // 响应内容不是合法 JSON
         LE() << "Not a JSON string.";
         return -1;
     }
 
+    const rapidjson::Value &doc = (parser != nullptr)
+        ? static_cast<const rapidjson::Value &>(parser->document()) : parsed;
+
     // 服务端错误代码
     auto code = get<int>(doc, "code");
 
-    if ((resp->statusCode / 100) != 2 || code != 0 || !doc.HasMember("data"))
+    if ((resp.statusCode / 100) != 2 || code != 0 || !doc.HasMember("data"))
     {
         // 服务端返回错误
         auto msg = get<std::string>(doc, "msg");
-        LE() << "Failed to" << verb << path << ":" << resp->statusCode << code << msg;
-        return utils::make_int(resp->statusCode, code);
+        LE() << "Failed to" << verb << path << ":" << resp.statusCode << code << msg;
+        return utils::make_int(resp.statusCode, code);
     }
 
     // 如果指定了响应处理函数，则调用；否则直接返回 0
@@ -249,4 +703,169 @@ int send_request(const std::string &verb, const std::string &path, const string_
 }
 
 
+int send_request(const std::string &verb, const std::string &path, const string_map &queries,
+                 const string_map &form, const response_data_handler &handler)
+{
+    const auto ctx = call_context::current();
+    std::unique_ptr<json_stream_parser> parser;
+    auto resp = perform_authorized(ctx, verb, path, queries, form, {}, parser);
+
+    if (auto r = interrupted_result(ctx, resp); r != 0)
+    {
+        return r;
+    }
+
+    if (!resp)
+    {
+        // 熔断期间直接失败
+        return EAGAIN;
+    }
+
+    return handle_response(verb, path, *resp, handler, parser.get());
+}
+
+
+// 发送可缓存的 GET 请求
+static int fetch_cached(const call_context &ctx, const std::string &key, const std::string &path,
+                        const string_map &queries, bool have_data, const response_data_handler &handler)
+{
+    auto &cache = current_config()->cache;
+    const auto &verb = ix::HttpClient::kGet;
+    ix::WebSocketHttpHeaders headers;
+
+    if (have_data && cache.lookup(key, headers))
+    {
+        // 新鲜期内，直接使用已有数据
+        return 0;
+    }
+
+    std::unique_ptr<json_stream_parser> parser;
+    auto resp = perform_authorized(ctx, verb, path, queries, {}, headers, parser);
+
+    if (auto r = interrupted_result(ctx, resp); r != 0)
+    {
+        return r;
+    }
+
+    if (!resp)
+    {
+        return EAGAIN;
+    }
+
+    if (have_data && resp->errorCode == ix::HttpErrorCode::Ok && resp->statusCode == 304)
+    {
+        // 未修改，沿用已解析的数据，不再调用响应处理函数
+        LD() << "Not modified:" << path;
+        cache.store(key, path, resp->headers, true);
+        buffer_pool::instance().release(std::move(resp->payload));
+        return 0;
+    }
+
+    auto r = handle_response(verb, path, *resp, handler, parser.get());
+
+    if (r == 0)
+    {
+        cache.store(key, path, resp->headers, false);
+    }
+
+    return r;
+}
+
+
+int send_cached_request(const std::string &path, const string_map &queries, bool have_data,
+                        const response_data_handler &handler)
+{
+    const auto key = response_cache::make_key(ix::HttpClient::kGet, path, queries);
+    const auto ctx = call_context::current();
+
+    // 相同的请求正在进行时，等待其完成并共享结果，不再重复发送
+    return current_config()->flights.run(key, ctx, [&]
+    {
+        return fetch_cached(ctx, key, path, queries, have_data, handler);
+    });
+}
+
+
+template<typename W>
+static void write_map(W &w, const char *key, const string_map &map)
+{
+    w.Key(key);
+    w.StartObject();
+
+    for (const auto &[k, v] : map)
+    {
+        w.Key(k);
+        w.String(v);
+    }
+
+    w.EndObject();
+}
+
+
+int send_batch_request(std::vector<sub_request> &requests)
+{
+    if (requests.empty())
+    {
+        return 0;
+    }
+
+    // 子请求数组
+    std::ostringstream oss;
+    rapidjson::OStreamWrapper buffer(oss);
+    rapidjson::Writer<rapidjson::OStreamWrapper> w(buffer);
+    w.StartArray();
+
+    for (const auto &req : requests)
+    {
+        w.StartObject();
+        w.Key("method");
+        w.String(req.verb);
+        w.Key("path");
+        w.String(req.path);
+        write_map(w, "queries", req.queries);
+        write_map(w, "form", req.form);
+        w.EndObject();
+    }
+
+    w.EndArray();
+
+    string_map form{
+        { "requests", oss.str() },
+    };
+
+    return send_request(ix::HttpClient::kPost, "/batch", form, [&requests](const rapidjson::Value &data)
+    {
+        using rapidjson::get;
+
+        if (!data.IsArray() || data.Size() != requests.size())
+        {
+            LE() << "Mismatched batch response.";
+            return -1;
+        }
+
+        for (rapidjson::SizeType i = 0; i < data.Size(); i++)
+        {
+            const auto &sub = data[i];
+            auto &req = requests.at(i);
+            auto status = get<int>(sub, "status");
+            auto code = get<int>(sub, "code");
+
+            if ((status / 100) != 2 || code != 0 || !sub.HasMember("data"))
+            {
+                // 子请求失败
+                auto msg = get<std::string>(sub, "msg");
+                LE() << "Failed to" << req.verb << req.path << ":" << status << code << msg;
+                req.result = utils::make_int(status, code);
+            }
+            else
+            {
+                req.result = req.handler ? req.handler(sub["data"]) : 0;
+            }
+        }
+
+        return 0;
+    });
+}
+
+
 }       // namespace kaixin
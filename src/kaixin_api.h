@@ -17,26 +17,34 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include <ixwebsocket/IXWebSocketHttpHeaders.h>
 #include <rapidjson/document.h>
 
-#include "simple_timer.h"
+#include "call_context.h"
+#include "hmac_sha256.h"
+#include "noncopyable.h"
+#include "param_list.h"
+#include "response_cache.h"
+#include "single_flight.h"
+#include "token_refresher.h"
 #include "websocket_client.h"
 
 
 namespace kaixin {
 
 
-/// 全局配置参数。
-struct Config
+/*!
+ * \brief       登录凭据快照。
+ *
+ * 发布后不再修改：需要修改时复制一份，修改副本后再发布。读取者取得快照后不加锁使用，
+ * 令牌更新不影响正在进行的请求。
+ */
+struct credentials
 {
-    std::string organization;                   ///< 组织名
-    std::string application;                    ///< 应用名
-    std::string app_key;                        ///< APP KEY
-    std::string app_secret;                     ///< APP SECRET
-    std::string base_url;                       ///< 基础 URL
     std::string access_token;                   ///< 访问令牌
     std::string refresh_token;                  ///< 更新令牌
     std::string id_token;                       ///< 身份令牌
@@ -44,24 +52,154 @@ struct Config
     std::string email;                          ///< Email
     std::string agent_code;                     ///< 上级代理编号
     std::string secret;                         ///< 本地对称加密密钥
+    time_t access_token_expires_at = 0;         ///< 访问令牌过期时间
+    time_t refresh_token_expires_at = 0;        ///< 更新令牌过期时间
+    time_t id_token_expires_at = 0;             ///< 身份令牌过期时间
+    kaixin_user_status_t status = KAIXIN_INVALID_USER;  ///< 用户状态
+    kaixin_profile_t profile = {};              ///< 用户配置，字符串指向本快照，发布时设置
+};
+
+
+/*!
+ * \brief       上下文配置参数。
+ *
+ * 默认上下文（`kaixin_initialize`）与每个 `kaixin_context_t` 各有一份，各自保存应用参数、
+ * 登录凭据、缓存与下行通知；连接池、DNS 缓存与工作线程等由所有上下文共享。
+ * 异步任务持有配置的共享指针，上下文释放后，配置在已投递的任务完成后才销毁。
+ */
+struct Config : std::enable_shared_from_this<Config>
+{
+    std::string organization;                   ///< 组织名
+    std::string application;                    ///< 应用名
+    std::string app_key;                        ///< APP KEY
+    std::string app_secret;                     ///< APP SECRET
+    hmac_sha256 signing_key;                    ///< 已设置 APP SECRET 的签名上下文，每次签名复制一份
+    std::string base_url;                       ///< 基础 URL
+    bool persistent = false;                    ///< 是否在本地保存更新令牌，只有默认上下文保存
+    std::shared_ptr<const credentials> creds;   ///< 当前登录凭据，只能通过 `current_credentials` 与 `publish_credentials` 访问
+    std::mutex credentials_mutex;               ///< 串行化凭据的发布与注销
+    unsigned sign_out_epoch = 0;                ///< 注销次数，由 `credentials_mutex` 保护；注销前发出的登录或更新的结果不再发布
+
     std::string device_id;                      ///< 设备 ID
+    std::mutex data_mutex;                      ///< 保护设备 ID、最低版本号、素材与 Shopee 域名
     std::map<std::string, std::string> materials;       ///< 素材
-    std::unique_ptr<simple_timer> token_refresher;      ///< 定期更新令牌
+    kaixin_version_t lowest_version = { 0, 0, 0 };      ///< 应用最低版本号
     std::unique_ptr<websocket_client> notify;           ///< 下行通知对象
     std::map<kaixin_shopee_hosts_t, std::map<kaixin_shopee_hosts_by_sub_domain_t, std::map<std::string, std::string>>> shopee_hosts;    ///< Shopee 域名
-    time_t access_token_expires_at = 0;         ///< 访问令牌过期时间
-    time_t refresh_token_expires_at = 0;        ///< 更新令牌过期时间
-    time_t id_token_expires_at = 0;             ///< 身份令牌过期时间
+    response_cache cache;                       ///< 条件请求缓存
+    single_flight flights;                      ///< 合并并发的相同请求
+    std::function<int(const std::string &)> refresh_session;    ///< 用更新令牌换取新凭据（PATCH /session），只能通过 `refresh_credentials` 调用
+    std::unique_ptr<token_refresher> refresher; ///< 后台更新令牌；最先销毁，等待进行中的更新结束
 };
 
 
-/// 字符串到字符串的映射。
-using string_map = ix::WebSocketHttpHeaders;
+/// 默认上下文的配置，由 `kaixin_initialize` 创建。
+extern std::shared_ptr<Config> g_default_config;
+
+
+/*!
+ * \brief       获取当前线程使用的配置。
+ *
+ * \return      在 `config_scope` 内返回其指定的配置，否则返回默认上下文的配置；未初始化时返回空指针。
+ */
+Config *current_config();
+
+
+/*!
+ * \brief       在作用域内指定当前线程使用的配置，离开作用域时恢复。
+ *
+ * 上下文 API 在调用内部实现前设置；工作线程、定时器与下行通知的回调也在执行前设置。
+ */
+class config_scope : private noncopyable
+{
+public:
+    explicit config_scope(Config *config);
+    ~config_scope();
+
+private:
+    Config *saved_;
+    bool saved_active_;
+};
+
+
+
+/*!
+ * \brief       获取当前登录凭据。
+ *
+ * 原子地读取已发布的快照，不加锁，可以在任意线程中调用。
+ *
+ * \return      如果已登录，则返回凭据快照；否则返回空指针。
+ */
+std::shared_ptr<const credentials> current_credentials();
+
+
+/// 获取当前的注销次数。发送登录或更新请求前取得，发布结果时传给 `publish_credentials`。
+unsigned sign_out_epoch();
+
+
+/// 开始注销：注销次数加一，之后到达的、注销前发出的登录或更新结果都被丢弃。
+void begin_sign_out();
+
+
+/*!
+ * \brief       发布新的登录凭据，替换当前凭据。
+ *
+ * 如果请求发出后已经注销（`epoch` 不再是当前的注销次数），则丢弃新凭据。
+ *
+ * \param[in]   creds           新凭据；发布时设置其中的用户配置
+ * \param[in]   epoch           发出请求前的注销次数
+ * \param[in]   published       发布后、释放锁之前调用，例如安排后台更新，使其不会晚于注销生效
+ *
+ * \return      如果发布了新凭据，则返回 `true`；如果期间已注销，则返回 `false`。
+ */
+bool publish_credentials(std::shared_ptr<credentials> creds, unsigned epoch, const std::function<void()> &published);
+
+
+/*!
+ * \brief       复制当前登录凭据，修改后发布。
+ *
+ * 复制、修改与发布在同一把锁内完成，并发的修改不会相互覆盖。
+ *
+ * \param[in]   modify          修改函数；返回 `false` 表示没有修改，不发布
+ *
+ * \return      如果发布了新凭据，则返回 `true`；如果未登录或没有修改，则返回 `false`。
+ */
+bool update_credentials(const std::function<bool(credentials &)> &modify);
+
+
+/*!
+ * \brief       用更新令牌换取新凭据。
+ *
+ * 后台定时更新与请求被拒绝（401）后的更新都经由此函数：并发的调用合并为一次 PATCH /session，
+ * 其它调用者等待并共享结果。如果 `stale` 已被其它调用者替换，则不再更新，直接返回零。
+ *
+ * \param[in]   ctx             调用上下文；等待者被取消或超时时不再等待
+ * \param[in]   stale           调用者认为已失效的凭据
+ *
+ * \return      如果成功，则返回零；如果未登录，则返回 `EPERM`；否则返回更新请求的结果。
+ */
+int refresh_credentials(const call_context &ctx, const std::shared_ptr<const credentials> &stale);
+
+
+/// 请求参数表。
+using string_map = param_list;
 
 /// 响应数据处理函数类型。
 using response_data_handler = std::function<int(const rapidjson::Value &)>;
 
 
+/// 批量请求中的子请求。
+struct sub_request
+{
+    std::string verb;                           ///< 请求方法，全大写
+    std::string path;                           ///< 请求路径，以“/”开头
+    string_map queries;                         ///< 查询映射
+    string_map form;                            ///< 表单
+    response_data_handler handler;              ///< 响应处理函数
+    int result = -1;                            ///< 子请求结果，零表示成功
+};
+
+
 /*!
  * \brief       URL 编码。
  *
@@ -72,6 +210,17 @@ using response_data_handler = std::function<int(const rapidjson::Value &)>;
 std::string url_encode(const std::string &s);
 
 
+/*!
+ * \brief       URL 编码，追加到字符串末尾。
+ *
+ * 字母、数字与“-_.~”保持不变，其它字节编码为“%XX”（大写），与 `ix::HttpClient::urlEncode` 相同。
+ *
+ * \param[in,out] out      输出字符串
+ * \param[in]   s           要编码的字符串
+ */
+void url_encode(std::string &out, const std::string &s);
+
+
 /*!
  * \brief       根据查询映射生成表单字符串（application/x-www-form-urlencoded）。
  *
@@ -94,6 +243,36 @@ std::string make_form(const string_map &queries);
 std::string make_url(const std::string &base_url, const std::string &path, const string_map &queries);
 
 
+/// 一次遍历请求参数得到的编码结果。
+struct encoded_request
+{
+    std::string query;                          ///< 查询字符串，不含“?”
+    std::string form;                           ///< 表单字符串
+    size_t signature_pos = std::string::npos;   ///< 签名参数“s”在查询字符串中的插入位置，等于查询字符串的长度时追加到末尾；npos 表示查询中已有“s”
+};
+
+
+/*!
+ * \brief       一次遍历请求参数，生成查询字符串与表单字符串，同时把签名字符串逐段送入签名上下文。
+ *
+ * 签名字符串为请求方法 + 路径 + 排序后的参数名与参数值，不在内存中拼接。
+ * 三个参数表都已排序，按归并的方式遍历。参数名相同时，`queries` 优先于 `common`，
+ * `common` 优先于 `form`：被覆盖的参数不参与签名，但表单中的参数仍然全部写入表单字符串。
+ * 输出字符串的容量预先按参数长度分配。
+ *
+ * \param[in]   verb            请求方法
+ * \param[in]   path            路径
+ * \param[in]   common          公共查询参数
+ * \param[in]   queries         查询参数
+ * \param[in]   form            表单
+ * \param[in,out] signer        签名上下文，通常为 `Config::signing_key` 的副本
+ * \param[out]  out             编码结果；签名参数“s”的位置记录在 `signature_pos` 中
+ */
+void encode_request(const std::string &verb, const std::string &path, const string_map &common,
+                    const string_map &queries, const string_map &form, hmac_sha256 &signer,
+                    encoded_request &out);
+
+
 /*!
  * \brief       计算签名。
  *
@@ -117,7 +296,14 @@ std::string sign(const std::string &verb, const std::string &path, const string_
  * \param[in]   form            POST 表单，可以为空
  * \param[in]   handler         响应处理函数。
  *
- * \return      如果成功，则返回零；否则返回非零。
+ * 失败的请求按 `retry_policy` 重试；路径处于熔断期时不发送请求。整个调用（包括重试）受当前线程
+ * 调用选项中的截止时间与取消令牌约束，见 `call_context`。
+ *
+ * 服务端以 401 拒绝所附带的令牌时，先更新令牌（`refresh_credentials`），再重新签名并重发一次；
+ * 更新失败时返回原来的 401 错误。匿名请求与 /session 本身的请求不做此处理。
+ *
+ * \return      如果成功，则返回零；如果路径处于熔断期，则返回 `EAGAIN`；如果被取消，则返回
+ *              `ECANCELED`；如果超时，则返回 `ETIMEDOUT`；否则返回非零。
  */
 int send_request(const std::string &verb, const std::string &path, const string_map &queries,
                  const string_map &form, const response_data_handler &handler = {});
@@ -156,7 +342,46 @@ inline int send_request(const std::string &verb, const std::string &path,
 }
 
 
+/*!
+ * \brief       同步发送可缓存的 GET 请求。
+ *
+ * 如果调用者已保存上次解析的结果（`have_data`），则在缓存新鲜期内不发送请求；新鲜期过后发送条件请求，
+ * 服务端返回 304 时沿用已有结果，不调用响应处理函数。
+ *
+ * 相同路径与查询的并发调用只发送一次请求：只有第一个调用者的响应处理函数被调用，其它调用者
+ * 等待并返回同一结果。因此响应处理函数应把结果保存到共享状态中，并用 `Config::data_mutex` 保护。
+ *
+ * \param[in]   path            请求路径，以“/”开头
+ * \param[in]   queries         查询映射，可以为空
+ * \param[in]   have_data       调用者是否已保存上次解析的结果
+ * \param[in]   handler         响应处理函数。
+ *
+ * \return      如果成功，则返回零；否则返回非零。
+ */
+int send_cached_request(const std::string &path, const string_map &queries, bool have_data,
+                        const response_data_handler &handler);
+
+
+/*!
+ * \brief       将多个子请求合并为一次签名的 HTTP 请求（POST /batch）发送，并把每个子响应分发给
+ *              对应的响应处理函数。
+ *
+ * 请求体的 `requests` 字段为子请求数组，每项包含 `method`、`path`、`queries`、`form`；
+ * 响应的 `data` 为按相同顺序排列的子响应数组，每项包含 `status`、`code`、`msg`、`data`。
+ *
+ * \param[in,out] requests      子请求，完成后 `result` 为各子请求的结果
+ *
+ * \return      如果批量请求本身成功，则返回零；否则返回非零。
+ */
+int send_batch_request(std::vector<sub_request> &requests);
+
+
 }       // namespace kaixin
 
 
-extern kaixin::Config *g_config;
+/// 上下文句柄。
+struct kaixin_context_s
+{
+    std::shared_ptr<kaixin::Config> config;     ///< 上下文的配置
+};
+
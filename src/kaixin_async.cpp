@@ -0,0 +1,206 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        kaixin_async.cpp
+ * \brief       开心 C SDK 异步 API 源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "kaixin.h"
+
+#include <ixwebsocket/IXHttpClient.h>
+
+#include "call_context.h"
+#include "kaixin_api.h"
+#include "utils.h"
+#include "worker_pool.h"
+
+ // 纠正 EINVAL 被重定义为 WSAEINVAL 的问题。
+#ifdef KAIXIN_OS_WINDOWS
+#undef EINVAL
+#define EINVAL 22
+#endif
+
+
+// 投递任务。任务沿用调用线程的调用选项与上下文；选项中的超时在任务开始执行时才换算为
+// 截止时间，排队等待不占用超时，只有调用者明确设置的截止时间保持不变。
+// 任务持有上下文的配置，上下文在任务完成前释放时，配置在任务完成后销毁。
+// SDK 正在反初始化时工作线程池拒绝任务，返回 `ECANCELED`。
+template<typename Task>
+static inline int post_task(Task &&task)
+{
+    const auto options = kaixin::call_context::thread_options();
+    auto config = kaixin::current_config()->shared_from_this();
+
+    const bool posted = worker_pool::instance().post(
+        [options, config = std::move(config), task = std::forward<Task>(task)]
+    {
+        kaixin::config_scope config_scope(config.get());
+        kaixin::call_options_scope scope(options);
+        task();
+    });
+
+    return posted ? 0 : ECANCELED;
+}
+
+
+// 在工作线程中执行任务
+template<typename Callback, typename Task>
+static inline int post(Callback callback, Task &&task)
+{
+    if (kaixin::current_config() == nullptr || callback == nullptr)
+    {
+        return EINVAL;
+    }
+
+    return post_task(std::forward<Task>(task));
+}
+
+
+int kaixin_set_async_concurrency(int concurrency)
+{
+    if (concurrency < 1 || concurrency > static_cast<int>(worker_pool::MAX_THREAD_COUNT))
+    {
+        return EINVAL;
+    }
+
+    worker_pool::instance().set_thread_count(static_cast<size_t>(concurrency));
+    return 0;
+}
+
+
+int kaixin_sign_in_async(const char *username, const char *password,
+                         kaixin_result_callback_t callback, void *user_data)
+{
+    if (utils::is_empty(username) || password == nullptr)
+    {
+        return EINVAL;
+    }
+
+    return post(callback, [username = std::string(username), password = std::string(password),
+                callback, user_data]
+    {
+        callback(kaixin_sign_in(username.c_str(), password.c_str()), user_data);
+    });
+}
+
+
+int kaixin_sign_out_async(kaixin_result_callback_t callback, void *user_data)
+{
+    if (kaixin::current_config() == nullptr)
+    {
+        return EINVAL;
+    }
+
+    return post_task([callback, user_data]
+    {
+        auto r = kaixin_sign_out();
+
+        if (callback != nullptr)
+        {
+            callback(r, user_data);
+        }
+    });
+}
+
+
+int kaixin_get_device_id_async(kaixin_string_callback_t callback, void *user_data)
+{
+    return post(callback, [callback, user_data]
+    {
+        callback(kaixin_get_device_id(), user_data);
+    });
+}
+
+
+int kaixin_get_auth_async(kaixin_auth_callback_t callback, void *user_data)
+{
+    return post(callback, [callback, user_data]
+    {
+        callback(kaixin_get_auth(), user_data);
+    });
+}
+
+
+int kaixin_get_lowest_version_async(kaixin_version_callback_t callback, void *user_data)
+{
+    return post(callback, [callback, user_data]
+    {
+        callback(kaixin_get_lowest_version(), user_data);
+    });
+}
+
+
+int kaixin_get_material_async(const char *type, kaixin_string_callback_t callback, void *user_data)
+{
+    if (type == nullptr)
+    {
+        return EINVAL;
+    }
+
+    return post(callback, [type = std::string(type), callback, user_data]
+    {
+        callback(kaixin_get_material(type.c_str()), user_data);
+    });
+}
+
+
+int kaixin_get_shopee_host_async(const char *website, kaixin_shopee_hosts_t hosts,
+                                 kaixin_shopee_hosts_by_sub_domain_t sub,
+                                 kaixin_string_callback_t callback, void *user_data)
+{
+    if (website == nullptr)
+    {
+        return EINVAL;
+    }
+
+    return post(callback, [website = std::string(website), hosts, sub, callback, user_data]
+    {
+        callback(kaixin_get_shopee_host(website.c_str(), hosts, sub), user_data);
+    });
+}
+
+
+int kaixin_get_shopee_websites_async(kaixin_string_callback_t callback, void *user_data)
+{
+    return post(callback, [callback, user_data]
+    {
+        callback(kaixin_get_shopee_websites(), user_data);
+    });
+}
+
+
+int kaixin_get_web_url_async(kaixin_web_page_t page, kaixin_string_callback_t callback,
+                             void *user_data)
+{
+    return post(callback, [page, callback, user_data]
+    {
+        callback(kaixin_get_web_url(page), user_data);
+    });
+}
+
+
+int kaixin_log_async(const char *msg, kaixin_result_callback_t callback, void *user_data)
+{
+    if (kaixin::current_config() == nullptr || msg == nullptr)
+    {
+        return EINVAL;
+    }
+
+    return post_task([msg = std::string(msg), callback, user_data]
+    {
+        kaixin::string_map form{
+           { "msg", msg },
+        };
+        auto r = kaixin::send_request(ix::HttpClient::kPost, "/log", form);
+
+        if (callback != nullptr)
+        {
+            callback(r, user_data);
+        }
+    });
+}
@@ -0,0 +1,200 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        kaixin_context.cpp
+ * \brief       开心 C SDK 上下文 API 源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "kaixin.h"
+
+#include "kaixin_api.h"
+
+
+// 上下文的配置；`ctx` 为空时返回空指针，各函数按未初始化处理
+static inline kaixin::Config *config_of(const kaixin_context_t *ctx)
+{
+    return (ctx == nullptr) ? nullptr : ctx->config.get();
+}
+
+
+int kaixin_context_sign_in(kaixin_context_t *ctx, const char *username, const char *password)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_sign_in(username, password);
+}
+
+
+int kaixin_context_sign_out(kaixin_context_t *ctx)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_sign_out();
+}
+
+
+const kaixin_profile_t *kaixin_context_get_profile(kaixin_context_t *ctx)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_get_profile();
+}
+
+
+const char *kaixin_context_get_device_id(kaixin_context_t *ctx)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_get_device_id();
+}
+
+
+const kaixin_auth_t *kaixin_context_get_auth(kaixin_context_t *ctx)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_get_auth();
+}
+
+
+kaixin_version_t kaixin_context_get_lowest_version(kaixin_context_t *ctx)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_get_lowest_version();
+}
+
+
+const char *kaixin_context_get_material(kaixin_context_t *ctx, const char *type)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_get_material(type);
+}
+
+
+int kaixin_context_set_notification_callback(kaixin_context_t *ctx, kaixin_notification_callback_t func,
+                                             void *user_data)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_set_notification_callback(func, user_data);
+}
+
+
+const char *kaixin_context_get_shopee_host(kaixin_context_t *ctx, const char *website,
+                                           kaixin_shopee_hosts_t hosts,
+                                           kaixin_shopee_hosts_by_sub_domain_t sub)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_get_shopee_host(website, hosts, sub);
+}
+
+
+const char *kaixin_context_get_shopee_websites(kaixin_context_t *ctx)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_get_shopee_websites();
+}
+
+
+const char *kaixin_context_get_web_url(kaixin_context_t *ctx, kaixin_web_page_t page)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_get_web_url(page);
+}
+
+
+void kaixin_context_log(kaixin_context_t *ctx, const char *msg)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    kaixin_log(msg);
+}
+
+
+kaixin_batch_t *kaixin_context_batch_begin(kaixin_context_t *ctx)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_batch_begin();
+}
+
+
+// 异步 API：投递任务时记录当前上下文，任务在同一上下文中执行
+
+int kaixin_context_sign_in_async(kaixin_context_t *ctx, const char *username, const char *password,
+                                 kaixin_result_callback_t callback, void *user_data)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_sign_in_async(username, password, callback, user_data);
+}
+
+
+int kaixin_context_sign_out_async(kaixin_context_t *ctx, kaixin_result_callback_t callback,
+                                  void *user_data)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_sign_out_async(callback, user_data);
+}
+
+
+int kaixin_context_get_device_id_async(kaixin_context_t *ctx, kaixin_string_callback_t callback,
+                                       void *user_data)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_get_device_id_async(callback, user_data);
+}
+
+
+int kaixin_context_get_auth_async(kaixin_context_t *ctx, kaixin_auth_callback_t callback,
+                                  void *user_data)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_get_auth_async(callback, user_data);
+}
+
+
+int kaixin_context_get_lowest_version_async(kaixin_context_t *ctx, kaixin_version_callback_t callback,
+                                            void *user_data)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_get_lowest_version_async(callback, user_data);
+}
+
+
+int kaixin_context_get_material_async(kaixin_context_t *ctx, const char *type,
+                                      kaixin_string_callback_t callback, void *user_data)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_get_material_async(type, callback, user_data);
+}
+
+
+int kaixin_context_get_shopee_host_async(kaixin_context_t *ctx, const char *website,
+                                         kaixin_shopee_hosts_t hosts,
+                                         kaixin_shopee_hosts_by_sub_domain_t sub,
+                                         kaixin_string_callback_t callback, void *user_data)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_get_shopee_host_async(website, hosts, sub, callback, user_data);
+}
+
+
+int kaixin_context_get_shopee_websites_async(kaixin_context_t *ctx, kaixin_string_callback_t callback,
+                                             void *user_data)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_get_shopee_websites_async(callback, user_data);
+}
+
+
+int kaixin_context_get_web_url_async(kaixin_context_t *ctx, kaixin_web_page_t page,
+                                     kaixin_string_callback_t callback, void *user_data)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_get_web_url_async(page, callback, user_data);
+}
+
+
+int kaixin_context_log_async(kaixin_context_t *ctx, const char *msg, kaixin_result_callback_t callback,
+                             void *user_data)
+{
+    kaixin::config_scope scope(config_of(ctx));
+    return kaixin_log_async(msg, callback, user_data);
+}
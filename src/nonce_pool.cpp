@@ -0,0 +1,108 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        nonce_pool.cpp
+ * \brief       nonce_pool 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "nonce_pool.h"
+
+#include <atomic>
+#include <cstring>
+#include <random>
+
+#include <openssl/rand.h>
+
+#include "codec.h"
+#include "logger.h"
+#include "utils.h"
+
+#ifndef KAIXIN_OS_WINDOWS
+#include <pthread.h>
+#endif
+
+
+namespace kaixin {
+
+
+/// fork 代数，每次 fork 后在子进程中加一。
+static std::atomic<unsigned> g_fork_generation{ 0 };
+
+
+// 注册 fork 处理函数。Windows 没有 fork，不需要注册。
+static bool watch_fork()
+{
+#ifndef KAIXIN_OS_WINDOWS
+    pthread_atfork(nullptr, nullptr, []
+    {
+        g_fork_generation.fetch_add(1, std::memory_order_relaxed);
+    });
+#endif
+    return true;
+}
+
+
+nonce_pool &nonce_pool::local()
+{
+    static const bool watching = watch_fork();
+    (void)watching;
+
+    thread_local nonce_pool pool;
+    return pool;
+}
+
+
+nonce_pool::nonce_pool()
+    : buffer_{}
+    , pos_(sizeof(buffer_))
+    , generation_(0)
+{
+}
+
+
+void nonce_pool::generate(char *out)
+{
+    if (pos_ >= sizeof(buffer_) || generation_ != g_fork_generation.load(std::memory_order_relaxed))
+    {
+        refill();
+    }
+
+    codec::hex_encode(out, buffer_ + pos_, NONCE_BYTES);
+    pos_ += NONCE_BYTES;
+}
+
+
+std::string nonce_pool::generate()
+{
+    std::string nonce(NONCE_LENGTH, '\0');
+    generate(&nonce[0]);
+    return nonce;
+}
+
+
+void nonce_pool::refill()
+{
+    generation_ = g_fork_generation.load(std::memory_order_relaxed);
+    pos_ = 0;
+
+    if (RAND_bytes(buffer_, static_cast<int>(sizeof(buffer_))) != 1)
+    {
+        // 随机数生成器没有足够的熵，退回到系统随机数
+        LE() << "RAND_bytes failed.";
+        std::random_device device;
+
+        for (size_t i = 0; i < sizeof(buffer_); i += sizeof(unsigned))
+        {
+            const auto value = device();
+            memcpy(buffer_ + i, &value, sizeof(value));
+        }
+    }
+}
+
+
+}       // namespace kaixin
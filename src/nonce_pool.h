@@ -0,0 +1,72 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        nonce_pool.h
+ * \brief       nonce_pool 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+namespace kaixin {
+
+
+/*!
+ * \brief       请求随机数（z 参数、RG 命令）生成器。
+ *
+ * 每个线程一个实例，一次从 OpenSSL 的 CSPRNG（`RAND_bytes`）取出一批随机字节缓存起来，
+ * 之后逐个切出固定长度的随机数并编码为十六进制，不加锁、不分配内存。进程 fork 后，
+ * 子进程丢弃继承来的缓存重新获取，避免与父进程生成相同的随机数。
+ */
+class nonce_pool : private noncopyable
+{
+public:
+    /// 随机数的字节数。
+    static constexpr size_t NONCE_BYTES = 16;
+    /// 随机数的十六进制长度。
+    static constexpr size_t NONCE_LENGTH = NONCE_BYTES * 2;
+
+    /// 获取当前线程的生成器。
+    static nonce_pool &local();
+
+    /*!
+     * \brief       生成一个随机数。
+     *
+     * \param[out]  out         输出缓冲区，写入 `NONCE_LENGTH` 个十六进制字符，不添加结尾的 '\0'
+     */
+    void generate(char *out);
+
+    /*!
+     * \brief       生成一个随机数。
+     *
+     * \return      十六进制随机数，长度为 `NONCE_LENGTH`。
+     */
+    std::string generate();
+
+private:
+    nonce_pool();
+
+    // 重新填充缓存
+    void refill();
+
+private:
+    /// 每次获取的随机数个数。
+    static constexpr size_t BATCH = 128;
+
+    uint8_t buffer_[NONCE_BYTES * BATCH];       ///< 随机字节缓存
+    size_t pos_;                                ///< 下一个未用字节的位置
+    unsigned generation_;                       ///< 填充缓存时的 fork 代数
+};
+
+
+}       // namespace kaixin
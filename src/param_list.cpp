@@ -0,0 +1,124 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        param_list.cpp
+ * \brief       param_list 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "param_list.h"
+
+#include <algorithm>
+#include <iterator>
+
+
+namespace kaixin {
+
+
+// 只转换 ASCII 字母，与 C 区域设置下的 tolower 相同
+static inline unsigned char to_lower(char c)
+{
+    const auto u = static_cast<unsigned char>(c);
+    return (u >= 'A' && u <= 'Z') ? static_cast<unsigned char>(u + ('a' - 'A')) : u;
+}
+
+
+param_list::param_list(std::initializer_list<value_type> init)
+{
+    for (const auto &[key, value] : init)
+    {
+        emplace(key, value);
+    }
+}
+
+
+param_list::const_iterator param_list::find(std::string_view key) const
+{
+    const auto pos = lower_bound(key);
+
+    if (pos < size_ && !less(key, data()[pos].first))
+    {
+        return data() + pos;
+    }
+
+    return end();
+}
+
+
+void param_list::clear()
+{
+    if (heap_.empty())
+    {
+        // 释放参数值，避免复制对象时复制已删除的字符串
+        for (size_t i = 0; i < size_; i++)
+        {
+            inline_[i] = value_type();
+        }
+    }
+    else
+    {
+        heap_.clear();
+    }
+
+    size_ = 0;
+}
+
+
+bool param_list::less(std::string_view a, std::string_view b)
+{
+    const auto n = std::min(a.size(), b.size());
+
+    for (size_t i = 0; i < n; i++)
+    {
+        const auto ca = to_lower(a[i]);
+        const auto cb = to_lower(b[i]);
+
+        if (ca != cb)
+        {
+            return ca < cb;
+        }
+    }
+
+    return a.size() < b.size();
+}
+
+
+size_t param_list::lower_bound(std::string_view key) const
+{
+    // 参数很少，二分查找足够
+    auto iter = std::lower_bound(begin(), end(), key, [](const value_type &e, std::string_view k)
+    {
+        return less(e.first, k);
+    });
+
+    return static_cast<size_t>(iter - begin());
+}
+
+
+// 在指定位置腾出一个空位
+param_list::value_type &param_list::insert_at(size_t pos)
+{
+    if (heap_.empty() && size_ < INLINE_CAPACITY)
+    {
+        std::move_backward(inline_.begin() + pos, inline_.begin() + size_, inline_.begin() + size_ + 1);
+        size_++;
+        return inline_[pos];
+    }
+
+    if (heap_.empty())
+    {
+        // 内部存储已满，全部移到堆上
+        heap_.reserve(INLINE_CAPACITY * 2);
+        std::move(inline_.begin(), inline_.end(), std::back_inserter(heap_));
+    }
+
+    size_++;
+    return *heap_.emplace(heap_.begin() + pos);
+}
+
+
+}       // namespace kaixin
@@ -0,0 +1,108 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        param_list.h
+ * \brief       param_list 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include <array>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+namespace kaixin {
+
+
+/*!
+ * \brief       按参数名排序的请求参数表。
+ *
+ * 参数名不区分大小写，排序规则与 `ix::CaseInsensitiveLess` 相同，因此遍历顺序（以及签名）与
+ * 原先使用的 `ix::WebSocketHttpHeaders` 一致。与 `std::map` 的 `emplace` 一样，已有的参数名
+ * 不会被覆盖。
+ *
+ * 参数连续存放；不超过 `INLINE_CAPACITY` 个参数时存放在对象内部，不为节点分配内存。
+ */
+class param_list
+{
+public:
+    using value_type = std::pair<std::string, std::string>;
+    using const_iterator = const value_type *;
+
+    /// 对象内部可以存放的参数个数。
+    static constexpr size_t INLINE_CAPACITY = 8;
+
+    param_list() = default;
+    param_list(std::initializer_list<value_type> init);
+
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + size_; }
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+
+    /*!
+     * \brief       添加参数。
+     *
+     * \param[in]   key         参数名
+     * \param[in]   value       参数值
+     *
+     * \return      参数的位置，以及是否添加；如果参数名已存在，则不添加。
+     */
+    template<typename K, typename V>
+    std::pair<const_iterator, bool> emplace(K &&key, V &&value)
+    {
+        const auto pos = lower_bound(key);
+
+        if (pos < size_ && !less(key, data()[pos].first))
+        {
+            return { data() + pos, false };
+        }
+
+        auto &slot = insert_at(pos);
+        slot.first = std::forward<K>(key);
+        slot.second = std::forward<V>(value);
+        return { &slot, true };
+    }
+
+    /*!
+     * \brief       查找参数。
+     *
+     * \param[in]   key         参数名
+     *
+     * \return      参数的位置；如果没有找到，则返回 `end()`。
+     */
+    const_iterator find(std::string_view key) const;
+
+    /// 删除所有参数。
+    void clear();
+
+    /*!
+     * \brief       比较参数名，不区分大小写。
+     *
+     * \return      如果 `a` 排在 `b` 之前，则返回 `true`；否则返回 `false`。
+     */
+    static bool less(std::string_view a, std::string_view b);
+
+private:
+    const value_type *data() const { return heap_.empty() ? inline_.data() : heap_.data(); }
+    value_type *data() { return heap_.empty() ? inline_.data() : heap_.data(); }
+
+    size_t lower_bound(std::string_view key) const;
+    value_type &insert_at(size_t pos);
+
+private:
+    std::array<value_type, INLINE_CAPACITY> inline_;    ///< 参数不多时的存储
+    std::vector<value_type> heap_;                      ///< 参数超出内部存储时，全部移到这里
+    size_t size_ = 0;                                   ///< 参数个数
+};
+
+
+}       // namespace kaixin
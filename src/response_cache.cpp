@@ -0,0 +1,204 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        response_cache.cpp
+ * \brief       response_cache 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "response_cache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+
+namespace kaixin {
+
+
+// 从 Cache-Control 中分析新鲜期，以秒为单位。不允许保存时返回 -1；没有指定时返回 -2。
+static long long parse_max_age(const ix::WebSocketHttpHeaders &headers)
+{
+    auto iter = headers.find("Cache-Control");
+
+    if (iter == headers.end())
+    {
+        return -2;
+    }
+
+    auto value = iter->second;
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (value.find("no-store") != std::string::npos)
+    {
+        return -1;
+    }
+
+    if (value.find("no-cache") != std::string::npos)
+    {
+        return 0;
+    }
+
+    auto pos = value.find("max-age=");
+
+    if (pos == std::string::npos)
+    {
+        return -2;
+    }
+
+    auto max_age = std::strtoll(value.c_str() + pos + 8, nullptr, 10);
+
+    // 减去响应在中间缓存中已经停留的时间
+    iter = headers.find("Age");
+
+    if (iter != headers.end())
+    {
+        max_age -= std::strtoll(iter->second.c_str(), nullptr, 10);
+    }
+
+    return std::max(max_age, 0LL);
+}
+
+
+std::string response_cache::make_key(const std::string &verb, const std::string &path,
+                                     const param_list &queries)
+{
+    // 查询参数本身有序，直接拼接即为规范化形式
+    std::string key = verb;
+    key += ' ';
+    key += path;
+    char sep = '?';
+
+    for (const auto &[name, value] : queries)
+    {
+        key += sep;
+        key += name;
+        key += '=';
+        key += value;
+        sep = '&';
+    }
+
+    return key;
+}
+
+
+bool response_cache::is_fresh(const std::string &path, bool if_missing) const
+{
+    std::lock_guard lock(mutex_);
+    const auto now = clock::now();
+    bool found = false;
+
+    for (const auto &[key, e] : entries_)
+    {
+        if (e.path == path)
+        {
+            if (e.expires_at <= now)
+            {
+                return false;
+            }
+
+            found = true;
+        }
+    }
+
+    return found || if_missing;
+}
+
+
+bool response_cache::lookup(const std::string &key, ix::WebSocketHttpHeaders &headers) const
+{
+    std::lock_guard lock(mutex_);
+    auto iter = entries_.find(key);
+
+    if (iter == entries_.end())
+    {
+        return false;
+    }
+
+    const auto &e = iter->second;
+
+    if (e.expires_at > clock::now())
+    {
+        return true;
+    }
+
+    if (!e.etag.empty())
+    {
+        headers["If-None-Match"] = e.etag;
+    }
+
+    if (!e.last_modified.empty())
+    {
+        headers["If-Modified-Since"] = e.last_modified;
+    }
+
+    return false;
+}
+
+
+void response_cache::store(const std::string &key, const std::string &path,
+                           const ix::WebSocketHttpHeaders &headers, bool not_modified)
+{
+    std::lock_guard lock(mutex_);
+    auto max_age = parse_max_age(headers);
+
+    if (max_age == -1)
+    {
+        // no-store
+        entries_.erase(key);
+        return;
+    }
+
+    entry e;
+
+    if (not_modified)
+    {
+        auto iter = entries_.find(key);
+
+        if (iter != entries_.end())
+        {
+            e = iter->second;
+        }
+    }
+
+    e.path = path;
+    auto iter = headers.find("ETag");
+
+    if (iter != headers.end())
+    {
+        e.etag = iter->second;
+    }
+
+    iter = headers.find("Last-Modified");
+
+    if (iter != headers.end())
+    {
+        e.last_modified = iter->second;
+    }
+
+    if (e.etag.empty() && e.last_modified.empty() && max_age < 0)
+    {
+        // 既没有验证器也没有新鲜期，不可缓存
+        entries_.erase(key);
+        return;
+    }
+
+    // 没有指定新鲜期时，每次都需要重新验证
+    e.expires_at = clock::now() + std::chrono::seconds(std::max(max_age, 0LL));
+    entries_[key] = std::move(e);
+}
+
+
+void response_cache::clear()
+{
+    std::lock_guard lock(mutex_);
+    entries_.clear();
+}
+
+
+}       // namespace kaixin
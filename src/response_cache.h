@@ -0,0 +1,104 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        response_cache.h
+ * \brief       response_cache 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <ixwebsocket/IXWebSocketHttpHeaders.h>
+
+#include "param_list.h"
+
+
+namespace kaixin {
+
+
+/*!
+ * \brief       HTTP 条件请求缓存。
+ *
+ * 按“请求方法 + 路径 + 规范化查询”保存响应的验证器（ETag、Last-Modified）与 Cache-Control
+ * 新鲜期。缓存本身不保存响应体，解析后的结果由调用者保存（例如 `Config::materials`）。
+ * 每个上下文一份（`Config::cache`）。
+ */
+class response_cache : private noncopyable
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    response_cache() = default;
+
+    /*!
+     * \brief       生成缓存键。
+     *
+     * \param[in]   verb        请求方法
+     * \param[in]   path        路径
+     * \param[in]   queries     查询参数，不包括签名等公共参数
+     *
+     * \return      缓存键。
+     */
+    static std::string make_key(const std::string &verb, const std::string &path,
+                                const param_list &queries);
+
+    /*!
+     * \brief       判断路径下的缓存是否都在新鲜期内。
+     *
+     * \param[in]   path        路径
+     * \param[in]   if_missing  没有该路径的缓存时返回的值
+     *
+     * \return      如果都在新鲜期内，则返回 `true`；否则返回 `false`。
+     */
+    bool is_fresh(const std::string &path, bool if_missing) const;
+
+    /*!
+     * \brief       查找缓存，并添加条件请求头。
+     *
+     * \param[in]   key         缓存键
+     * \param[out]  headers     要添加 If-None-Match、If-Modified-Since 的请求头
+     *
+     * \return      如果缓存在新鲜期内，不需要发送请求，则返回 `true`；否则返回 `false`。
+     */
+    bool lookup(const std::string &key, ix::WebSocketHttpHeaders &headers) const;
+
+    /*!
+     * \brief       根据响应头保存或更新缓存。响应不可缓存时删除缓存。
+     *
+     * \param[in]   key             缓存键
+     * \param[in]   path            路径
+     * \param[in]   headers         响应头
+     * \param[in]   not_modified    是否为 304 响应；304 响应中没有的验证器沿用原值
+     */
+    void store(const std::string &key, const std::string &path, const ix::WebSocketHttpHeaders &headers,
+               bool not_modified);
+
+    /// 清空缓存。
+    void clear();
+
+private:
+    /// 缓存项。
+    struct entry
+    {
+        std::string path;                       ///< 路径
+        std::string etag;                       ///< ETag
+        std::string last_modified;              ///< Last-Modified
+        clock::time_point expires_at;           ///< 新鲜期截止时间
+    };
+
+    mutable std::mutex mutex_;
+    std::map<std::string, entry> entries_;
+};
+
+
+}       // namespace kaixin
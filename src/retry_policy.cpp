@@ -0,0 +1,260 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        retry_policy.cpp
+ * \brief       retry_policy 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "retry_policy.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <random>
+
+#include "http_transport.h"
+#include "kaixin.h"
+#include "utils.h"
+
+
+namespace kaixin {
+
+
+// 返回 [0, upper] 之间的随机整数，各线程独立，避免所有客户端同时重试
+static int64_t random_up_to(int64_t upper)
+{
+    static thread_local std::mt19937_64 engine(std::random_device{}());
+
+    if (upper <= 0)
+    {
+        return 0;
+    }
+
+    return std::uniform_int_distribution<int64_t>(0, upper)(engine);
+}
+
+
+// 请求是否确定没有被服务端处理，此时非幂等请求也可以重试
+static bool is_unprocessed(const ix::HttpResponse &resp)
+{
+    if (resp.errorCode != ix::HttpErrorCode::Ok)
+    {
+        return resp.errorCode == ix::HttpErrorCode::CannotConnect
+            || resp.errorCode == ix::HttpErrorCode::CannotCreateSocket;
+    }
+
+    return resp.statusCode == 408 || resp.statusCode == 429 || resp.statusCode == 503;
+}
+
+
+// 是否为服务端异常导致的失败，计入熔断
+static bool is_degraded(const ix::HttpResponse &resp)
+{
+    if (resp.errorCode != ix::HttpErrorCode::Ok)
+    {
+        // 调用者取消的请求和错误的 URL 与服务端无关
+        return resp.errorCode != ix::HttpErrorCode::Cancelled
+            && resp.errorCode != ix::HttpErrorCode::UrlMalformed;
+    }
+
+    return resp.statusCode == 429 || (resp.statusCode / 100) == 5;
+}
+
+
+// 分析 Retry-After，以毫秒为单位；没有时返回 -1
+static int64_t parse_retry_after(const ix::WebSocketHttpHeaders &headers)
+{
+    auto iter = headers.find("Retry-After");
+
+    if (iter == headers.end() || iter->second.empty())
+    {
+        return -1;
+    }
+
+    const auto &value = iter->second;
+
+    if (std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isdigit(c); }))
+    {
+        // 秒数
+        return std::strtoll(value.c_str(), nullptr, 10) * 1000;
+    }
+
+    // HTTP 日期
+    auto t = utils::parse_http_date(value);
+
+    if (t == 0)
+    {
+        return -1;
+    }
+
+    return std::max<int64_t>(t - kaixin_get_current_time(), 0) * 1000;
+}
+
+
+retry_policy &retry_policy::instance()
+{
+    static retry_policy policy;
+    return policy;
+}
+
+
+retry_options retry_policy::options() const
+{
+    std::lock_guard lock(mutex_);
+    return options_;
+}
+
+
+void retry_policy::set_options(const retry_options &options)
+{
+    std::lock_guard lock(mutex_);
+    options_ = options;
+    circuits_.clear();
+}
+
+
+std::string retry_policy::make_key(const std::string &verb, const std::string &path)
+{
+    // 同一路径的不同方法是不同的接口，例如登录与注销，不能互相熔断
+    return verb + ' ' + path;
+}
+
+
+bool retry_policy::allow(const std::string &verb, const std::string &path)
+{
+    std::lock_guard lock(mutex_);
+    auto iter = circuits_.find(make_key(verb, path));
+
+    if (iter == circuits_.end())
+    {
+        return true;
+    }
+
+    auto &c = iter->second;
+
+    if (clock::now() < c.open_until)
+    {
+        return false;
+    }
+
+    if (options_.failure_threshold <= 0 || c.failures < options_.failure_threshold)
+    {
+        return true;
+    }
+
+    // 熔断期满，只放行一个试探请求
+    if (c.probing)
+    {
+        return false;
+    }
+
+    c.probing = true;
+    return true;
+}
+
+
+void retry_policy::record(const std::string &verb, const std::string &path, const ix::HttpResponse &resp)
+{
+    const auto key = make_key(verb, path);
+    std::lock_guard lock(mutex_);
+
+    if (resp.errorCode == ix::HttpErrorCode::Cancelled || resp.errorCode == ix::HttpErrorCode::UrlMalformed)
+    {
+        // 结果与服务端状态无关，既不是成功也不是失败；取消的若是试探请求，放行下一个试探请求
+        auto iter = circuits_.find(key);
+
+        if (iter != circuits_.end())
+        {
+            iter->second.probing = false;
+        }
+
+        return;
+    }
+
+    if (!is_degraded(resp))
+    {
+        circuits_.erase(key);
+        return;
+    }
+
+    auto &c = circuits_[key];
+    const auto now = clock::now();
+    c.failures++;
+    c.probing = false;
+
+    if (options_.failure_threshold > 0 && c.failures >= options_.failure_threshold)
+    {
+        // 熔断时长加上最多 20% 的抖动，避免所有客户端同时恢复
+        const int64_t open_ms = options_.open_ms;
+        c.open_until = now + std::chrono::milliseconds(open_ms + random_up_to(open_ms / 5));
+    }
+
+    // 服务端要求稍后再试时，在此之前不再发送请求
+    const auto retry_after = parse_retry_after(resp.headers);
+
+    if (retry_after > 0)
+    {
+        c.open_until = std::max(c.open_until, now + std::chrono::milliseconds(retry_after));
+    }
+}
+
+
+bool retry_policy::next_delay(const std::string &verb, const ix::HttpResponse &resp, int attempt,
+                              std::chrono::milliseconds &delay) const
+{
+    retry_options options;
+
+    {
+        std::lock_guard lock(mutex_);
+        options = options_;
+    }
+
+    if (attempt >= options.max_attempts)
+    {
+        return false;
+    }
+
+    const bool retryable = is_unprocessed(resp)
+        || (http::is_idempotent(verb) && is_degraded(resp) && resp.statusCode != 500 && resp.statusCode != 501);
+
+    if (!retryable)
+    {
+        return false;
+    }
+
+    const auto retry_after = parse_retry_after(resp.headers);
+
+    if (retry_after >= 0)
+    {
+        if (retry_after > options.max_delay_ms)
+        {
+            // 要求等待的时间太长，不在本次调用中等待
+            return false;
+        }
+
+        delay = std::chrono::milliseconds(retry_after + random_up_to(options.base_delay_ms));
+        return true;
+    }
+
+    // 全抖动指数退避：[0, min(max, base * 2^(attempt - 1))]
+    const auto shift = std::min(attempt - 1, 20);
+    const auto ceiling = std::min<int64_t>(static_cast<int64_t>(options.base_delay_ms) << shift,
+                                           options.max_delay_ms);
+    delay = std::chrono::milliseconds(random_up_to(ceiling));
+    return true;
+}
+
+
+void retry_policy::clear()
+{
+    std::lock_guard lock(mutex_);
+    circuits_.clear();
+}
+
+
+}       // namespace kaixin
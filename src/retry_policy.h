@@ -0,0 +1,121 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        retry_policy.h
+ * \brief       retry_policy 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <ixwebsocket/IXHttp.h>
+
+
+namespace kaixin {
+
+
+/// 重试与熔断参数。
+struct retry_options
+{
+    int max_attempts = 3;                       ///< 最多尝试次数（包括首次请求），1 表示不重试
+    int base_delay_ms = 200;                    ///< 指数退避的基础时长，毫秒
+    int max_delay_ms = 5000;                    ///< 单次退避的最长时长，毫秒
+    int failure_threshold = 5;                  ///< 同一路径连续失败多少次后熔断，0 表示不熔断
+    int open_ms = 30000;                        ///< 熔断持续时长，毫秒
+};
+
+
+/*!
+ * \brief       请求重试策略与按路径的熔断器。
+ *
+ * 只有幂等请求（GET、HEAD、PUT、DELETE、OPTIONS）在网络错误或 502/503/504 时重试；
+ * 非幂等请求仅在请求确定未被处理时（无法连接、408、429、503）重试。
+ * 退避时长为带全抖动的指数退避，服务端给出 Retry-After 时以其为准。
+ *
+ * 同一请求方法与路径连续失败（网络错误、5xx、429）达到阈值后熔断，熔断期间请求直接失败；
+ * 熔断期满后放行一个试探请求，成功则恢复，失败则再次熔断。调用者取消的请求不计入结果。
+ */
+class retry_policy : private noncopyable
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    /// 获取全局重试策略。
+    static retry_policy &instance();
+
+    /// 获取当前参数。
+    retry_options options() const;
+
+    /*!
+     * \brief       设置参数，同时清空所有熔断状态。
+     *
+     * \param[in]   options     新参数
+     */
+    void set_options(const retry_options &options);
+
+    /*!
+     * \brief       判断是否允许发送请求。
+     *
+     * \param[in]   verb        请求方法
+     * \param[in]   path        路径
+     *
+     * \return      如果允许，则返回 `true`；如果处于熔断期，则返回 `false`。
+     */
+    bool allow(const std::string &verb, const std::string &path);
+
+    /*!
+     * \brief       记录请求结果，更新熔断状态。
+     *
+     * \param[in]   verb        请求方法
+     * \param[in]   path        路径
+     * \param[in]   resp        响应
+     */
+    void record(const std::string &verb, const std::string &path, const ix::HttpResponse &resp);
+
+    /*!
+     * \brief       判断失败的请求是否需要重试，并计算退避时长。
+     *
+     * \param[in]   verb        请求方法
+     * \param[in]   resp        本次响应
+     * \param[in]   attempt     已经尝试的次数，从 1 开始
+     * \param[out]  delay       重试前需要等待的时长
+     *
+     * \return      如果需要重试，则返回 `true`；否则返回 `false`。
+     */
+    bool next_delay(const std::string &verb, const ix::HttpResponse &resp, int attempt,
+                    std::chrono::milliseconds &delay) const;
+
+    /// 清空所有熔断状态。
+    void clear();
+
+private:
+    retry_policy() = default;
+
+    static std::string make_key(const std::string &verb, const std::string &path);
+
+private:
+    /// 请求方法与路径的熔断状态。
+    struct circuit
+    {
+        int failures = 0;                       ///< 连续失败次数
+        bool probing = false;                   ///< 是否有试探请求正在进行
+        clock::time_point open_until;           ///< 熔断截止时间
+    };
+
+    mutable std::mutex mutex_;
+    retry_options options_;
+    std::map<std::string, circuit> circuits_;   ///< 以“方法 路径”为键
+};
+
+
+}       // namespace kaixin
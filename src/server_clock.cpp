@@ -0,0 +1,102 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        server_clock.cpp
+ * \brief       server_clock 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "server_clock.h"
+
+#include <cstdlib>
+
+#include "utils.h"
+
+
+namespace kaixin {
+
+
+/// 指数加权平均中新样本的权重为 1/SMOOTHING。
+static constexpr int64_t SMOOTHING = 8;
+
+
+server_clock &server_clock::instance()
+{
+    static server_clock c;
+    return c;
+}
+
+
+server_clock::server_clock()
+    : offset_(UNSYNCHRONIZED)
+{
+}
+
+
+int64_t server_clock::steady_ms(clock::time_point t)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count();
+}
+
+
+int64_t server_clock::now_ms() const
+{
+    const auto offset = offset_.load(std::memory_order_relaxed);
+
+    if (offset == UNSYNCHRONIZED)
+    {
+        return utils::get_timestamp_ms();
+    }
+
+    return steady_ms(clock::now()) + offset;
+}
+
+
+bool server_clock::synchronized() const
+{
+    return offset_.load(std::memory_order_relaxed) != UNSYNCHRONIZED;
+}
+
+
+bool server_clock::sample(const std::string &date, clock::time_point sent, clock::time_point received)
+{
+    const auto seconds = utils::parse_http_date(date);
+
+    if (seconds == 0)
+    {
+        return false;
+    }
+
+    // 服务端在往返的中点生成 Date，Date 截断到秒，平均比实际时间早半秒
+    const auto rtt = steady_ms(received) - steady_ms(sent);
+    const auto midpoint = steady_ms(sent) + rtt / 2;
+    const auto measured = static_cast<int64_t>(seconds) * 1000 + 500 - midpoint;
+
+    std::lock_guard lock(mutex_);
+    auto offset = offset_.load(std::memory_order_relaxed);
+
+    if (offset != UNSYNCHRONIZED && rtt > STEP_THRESHOLD)
+    {
+        // 往返时间太长，误差可能超过阈值
+        return true;
+    }
+
+    if (offset == UNSYNCHRONIZED || std::llabs(measured - offset) > STEP_THRESHOLD)
+    {
+        offset = measured;
+    }
+    else
+    {
+        offset += (measured - offset) / SMOOTHING;
+    }
+
+    offset_.store(offset, std::memory_order_relaxed);
+    return true;
+}
+
+
+}       // namespace kaixin
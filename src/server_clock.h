@@ -0,0 +1,78 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        server_clock.h
+ * \brief       server_clock 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+
+namespace kaixin {
+
+
+/*!
+ * \brief       服务端时钟。
+ *
+ * 从每个响应的 Date 头估计服务端时间与本机单调时钟之间的偏移：按 NTP 的方法，认为 Date
+ * 对应请求发出与响应到达的中点；Date 只精确到秒，因此再加上半秒。各次估计按指数加权平均，
+ * 截断误差在多次采样中相互抵消；偏移突变超过 `STEP_THRESHOLD` 时（例如服务端时间调整）
+ * 直接采用新值。已同步后，往返时间超过 `STEP_THRESHOLD` 的样本误差太大，不再使用。
+ *
+ * 偏移以单调时钟为基准，本机调整系统时间不影响结果。同步之前使用本机时间。
+ */
+class server_clock : private noncopyable
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    /// 偏移突变与样本往返时间的阈值，以毫秒为单位。
+    static constexpr int64_t STEP_THRESHOLD = 2000;
+
+    /// 获取全局实例。
+    static server_clock &instance();
+
+    /// 当前服务端时间，UNIX 毫秒数。
+    int64_t now_ms() const;
+
+    /// 是否已经同步。
+    bool synchronized() const;
+
+    /*!
+     * \brief       用响应的 Date 头更新偏移。
+     *
+     * \param[in]   date        Date 头的值
+     * \param[in]   sent        请求发出的时间
+     * \param[in]   received    响应到达的时间
+     *
+     * \return      如果 Date 有效，则返回 `true`；否则返回 `false`。
+     */
+    bool sample(const std::string &date, clock::time_point sent, clock::time_point received);
+
+private:
+    server_clock();
+
+    static int64_t steady_ms(clock::time_point t);
+
+private:
+    /// 尚未同步时的偏移。
+    static constexpr int64_t UNSYNCHRONIZED = INT64_MIN;
+
+    std::mutex mutex_;                          ///< 保护偏移的更新
+    std::atomic<int64_t> offset_;               ///< 服务端时间减去单调时钟，以毫秒为单位
+};
+
+
+}       // namespace kaixin
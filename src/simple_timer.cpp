@@ -15,11 +15,12 @@
 #include <chrono>
 
 
-simple_timer::simple_timer()
-    : thread_(nullptr)
+simple_timer::simple_timer(kaixin::timer_wheel &wheel)
+    : wheel_(wheel)
+    , id_(0)
     , interval_(0)
-    , interrupted_(false)
     , singleshot_(false)
+    , active_(false)
 {
 }
 
@@ -32,50 +33,53 @@ simple_timer::~simple_timer()
 
 void simple_timer::start(int ms)
 {
-    if (thread_ != nullptr)
+    std::lock_guard lock(mutex_);
+
+    if (active_)
     {
         return;
     }
 
     interval_ = ms;
-    interrupted_ = false;
-    thread_ = new std::thread(&simple_timer::timer_proc, this);
+    active_ = true;
+    id_ = wheel_.schedule(std::chrono::milliseconds(interval_), [this] { on_timeout(); });
 }
 
 
 void simple_timer::stop()
 {
-    if (thread_ != nullptr)
-    {
-        interrupted_ = true;
-        thread_->join();
+    kaixin::timer_wheel::timer_id id;
 
-        delete thread_;
-        thread_ = nullptr;
+    {
+        std::lock_guard lock(mutex_);
+        active_ = false;
+        id = id_;
+        id_ = 0;
     }
+
+    // 不持有锁：取消时等待正在执行的回调，而回调返回前要加锁
+    wheel_.cancel(id);
 }
 
 
-void simple_timer::timer_proc()
+void simple_timer::on_timeout()
 {
-    std::chrono::milliseconds interval(interval_);
-    std::chrono::milliseconds a_while(std::min(100, interval_));
-    auto checkpoint = std::chrono::steady_clock::now() + interval;
-
-    while (!interrupted_)
-    {
-        std::this_thread::sleep_for(a_while);
+    callback_();
 
-        if (std::chrono::steady_clock::now() >= checkpoint)
-        {
-            callback_();
+    std::lock_guard lock(mutex_);
 
-            if (singleshot_)
-            {
-                break;
-            }
+    if (!active_)
+    {
+        // 回调执行期间被停止
+        return;
+    }
 
-            checkpoint = std::chrono::steady_clock::now() + interval;
-        }
+    if (singleshot_)
+    {
+        active_ = false;
+        id_ = 0;
+        return;
     }
+
+    id_ = wheel_.schedule(std::chrono::milliseconds(interval_), [this] { on_timeout(); });
 }
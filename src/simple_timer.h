@@ -13,23 +13,26 @@
 #pragma once
 #include "noncopyable.h"
 
-#include <atomic>
 #include <functional>
+#include <mutex>
 
-namespace std {
-class thread;
-}
+#include "event_loop.h"
 
 
 /*!
- * \brief       使用线程实现的简单计时器类。
+ * \brief       简单计时器类。
+ *
+ * 在事件循环的时间轮上实现，不再每个计时器一个线程。回调在事件循环线程中执行；周期计时器在回调
+ * 返回后重新计时。`stop` 返回后回调不会再被调用。
+ *
+ * 回调中不能阻塞，也不能等待可能正在停止本计时器的线程，耗时的工作应投递到 `worker_pool`。
  */
 class simple_timer : private noncopyable
 {
 public:
     using timeout_callback = std::function<void()>;
 
-    simple_timer();
+    explicit simple_timer(kaixin::timer_wheel &wheel = kaixin::event_loop::instance().timers());
     ~simple_timer();
 
     void set_timeout_callback(timeout_callback callback) { callback_ = callback; }
@@ -39,12 +42,14 @@ public:
     void stop();
 
 private:
-    void timer_proc();
+    void on_timeout();
 
 private:
-    std::thread *thread_;
+    kaixin::timer_wheel &wheel_;
+    std::mutex mutex_;
     timeout_callback callback_;
-    std::atomic_bool interrupted_;
+    kaixin::timer_wheel::timer_id id_;
     int interval_;
     bool singleshot_;
+    bool active_;
 };
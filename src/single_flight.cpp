@@ -0,0 +1,124 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        single_flight.cpp
+ * \brief       single_flight 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "single_flight.h"
+
+#include <cerrno>
+
+
+namespace kaixin {
+
+
+int single_flight::run(const std::string &key, const call_context &ctx, const std::function<int()> &fn)
+{
+    std::unique_lock lock(mutex_);
+    auto iter = calls_.find(key);
+
+    while (iter != calls_.end())
+    {
+        // 已有相同的请求正在进行，等待其完成
+        auto c = iter->second;
+        lock.unlock();
+
+        int result = 0;
+
+        if (wait(c, ctx, result))
+        {
+            return result;
+        }
+
+        if (ctx.is_done())
+        {
+            return ctx.is_cancelled() ? ECANCELED : ETIMEDOUT;
+        }
+
+        // 领头者被中断，重新竞争
+        lock.lock();
+        iter = calls_.find(key);
+    }
+
+    auto c = std::make_shared<call>();
+    calls_.emplace(key, c);
+    lock.unlock();
+
+    // 领头者结束时（包括 fn 抛出异常）移除请求并唤醒等待者
+    struct finisher
+    {
+        single_flight &self;
+        const std::string &key;
+        const std::shared_ptr<call> &c;
+
+        ~finisher()
+        {
+            {
+                std::lock_guard lock(self.mutex_);
+                self.calls_.erase(key);
+            }
+
+            {
+                std::lock_guard lock(c->mutex);
+                c->done = true;
+            }
+
+            c->cond.notify_all();
+        }
+    } guard{ *this, key, c };
+
+    const auto result = fn();
+
+    // 领头者自身被取消或超时导致的失败不交给等待者
+    std::lock_guard call_lock(c->mutex);
+    c->result = result;
+    c->shared = !(ctx.is_done() && (result == ECANCELED || result == ETIMEDOUT));
+    return result;
+}
+
+
+bool single_flight::wait(const std::shared_ptr<call> &c, const call_context &ctx, int &result)
+{
+    // 取消时唤醒等待者；取消回调在持有 c->mutex 时通知，不会错过
+    const auto &cancel = ctx.cancel();
+    const auto subscription = cancel ? cancel->subscribe([c]
+    {
+        std::lock_guard lock(c->mutex);
+        c->cond.notify_all();
+    }) : -1;
+
+    bool shared = false;
+
+    {
+        std::unique_lock lock(c->mutex);
+        const auto finished = [&c, &ctx] { return c->done || ctx.is_cancelled(); };
+
+        if (ctx.deadline() == call_context::clock::time_point::max())
+        {
+            c->cond.wait(lock, finished);
+        }
+        else
+        {
+            c->cond.wait_until(lock, ctx.deadline(), finished);
+        }
+
+        shared = c->done && c->shared;
+        result = c->result;
+    }
+
+    if (subscription >= 0)
+    {
+        cancel->unsubscribe(subscription);
+    }
+
+    return shared;
+}
+
+
+}       // namespace kaixin
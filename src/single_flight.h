@@ -0,0 +1,74 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        single_flight.h
+ * \brief       single_flight 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "call_context.h"
+
+
+namespace kaixin {
+
+
+/*!
+ * \brief       合并并发的相同请求。
+ *
+ * 同一个键同时只有一个调用者（领头者）真正执行请求；其它调用者等待领头者完成，
+ * 并直接使用其结果。请求的解析结果由响应处理函数保存在共享状态中（例如 `Config::materials`），
+ * 因此等待者只需要共享返回值。每个上下文一份（`Config::flights`）。
+ *
+ * 领头者自身被取消或超时、或者抛出异常时，结果与等待者无关：等待者被唤醒后重新竞争，
+ * 其中一个成为新的领头者重新执行请求。
+ */
+class single_flight : private noncopyable
+{
+public:
+    single_flight() = default;
+
+    /*!
+     * \brief       执行或等待请求。
+     *
+     * \param[in]   key         请求键，通常为“请求方法 + 路径 + 规范化查询”
+     * \param[in]   ctx         调用上下文；等待者被取消或超时时不再等待
+     * \param[in]   fn          执行请求的函数，只在领头者中调用
+     *
+     * \return      请求的返回值；调用者被取消时返回 `ECANCELED`，超时时返回 `ETIMEDOUT`。
+     */
+    int run(const std::string &key, const call_context &ctx, const std::function<int()> &fn);
+
+private:
+    /// 正在进行的请求。
+    struct call
+    {
+        std::mutex mutex;                       ///< 保护以下状态
+        std::condition_variable cond;           ///< 完成或等待者被取消时通知
+        int result = -1;                        ///< 返回值
+        bool shared = false;                    ///< 返回值是否可以交给等待者
+        bool done = false;                      ///< 是否已完成
+    };
+
+    // 等待请求完成。如果返回值可以共享，则返回 `true`
+    static bool wait(const std::shared_ptr<call> &c, const call_context &ctx, int &result);
+
+    std::mutex mutex_;                          ///< 保护 `calls_`
+    std::map<std::string, std::shared_ptr<call>> calls_;
+};
+
+
+}       // namespace kaixin
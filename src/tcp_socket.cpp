@@ -0,0 +1,58 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        tcp_socket.cpp
+ * \brief       tcp_socket 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "tcp_socket.h"
+
+#include "io_waiter.h"
+
+
+tcp_socket::tcp_socket(int fd)
+    : ix::Socket(fd)
+{
+}
+
+
+bool tcp_socket::wait(uint32_t events, const ix::CancellationRequest &cancelled)
+{
+    const auto wanted = (wanted_ != 0) ? wanted_ : events;
+    wanted_ = 0;
+
+    // 出错时仍然返回就绪：下一次收发得到具体的错误
+    return kaixin::io_waiter::wait_one(fd(), wanted, cancelled) != 0;
+}
+
+
+bool tcp_socket::write_all(const std::string &data, const ix::CancellationRequest &cancelled)
+{
+    size_t offset = 0;
+
+    while (offset < data.length())
+    {
+        if (cancelled && cancelled())
+        {
+            return false;
+        }
+
+        const auto ret = send(const_cast<char *>(data.data() + offset), data.length() - offset);
+
+        if (ret > 0)
+        {
+            offset += static_cast<size_t>(ret);
+        }
+        else if (ret == 0 || !isWaitNeeded() || !wait(kaixin::event_loop::WRITABLE, cancelled))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
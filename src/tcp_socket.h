@@ -0,0 +1,63 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        tcp_socket.h
+ * \brief       tcp_socket 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include <ixwebsocket/IXSocket.h>
+
+
+/*!
+ * \brief       已连接的非阻塞 TCP 套接字。
+ *
+ * ixwebsocket 的 `Socket` 在调用线程中轮询套接字；本类需要等待时改用 `kaixin::io_waiter`，
+ * 由事件循环检测就绪。`tls_socket` 在其上建立 TLS 会话。
+ */
+class tcp_socket : public ix::Socket
+{
+public:
+    /*!
+     * \brief       构造函数。
+     *
+     * \param[in]   fd          已连接的非阻塞套接字
+     */
+    explicit tcp_socket(int fd);
+
+    /// 获取套接字描述符，用于在 `kaixin::event_loop` 中注册。
+    int fd() const { return _sockfd; }
+
+    /*!
+     * \brief       `send` 或 `recv` 返回需要等待后，等待套接字就绪。
+     *
+     * \param[in]   events      原本要等待的事件，`kaixin::event_loop::READABLE` 或 `WRITABLE`；
+     *                          TLS 会话可能需要等待另一个方向
+     * \param[in]   cancelled   取消请求
+     *
+     * \return      如果就绪，则返回 `true`；如果被取消或套接字出错，则返回 `false`。
+     */
+    bool wait(uint32_t events, const ix::CancellationRequest &cancelled);
+
+    /*!
+     * \brief       发送全部数据，套接字不可写时等待。
+     *
+     * \param[in]   data        数据
+     * \param[in]   cancelled   取消请求
+     *
+     * \return      如果成功，则返回 `true`；否则返回 `false`。
+     */
+    bool write_all(const std::string &data, const ix::CancellationRequest &cancelled);
+
+protected:
+    /// 最近一次需要等待的 `send` 或 `recv` 实际等待的事件；为零时与调用的方向一致。
+    uint32_t wanted_ = 0;
+};
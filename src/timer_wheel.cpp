@@ -0,0 +1,320 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        timer_wheel.cpp
+ * \brief       timer_wheel 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "timer_wheel.h"
+
+#include <algorithm>
+#include <limits>
+
+
+namespace kaixin {
+
+
+timer_wheel::timer_wheel(now_function now, callback wake)
+    : now_(now ? std::move(now) : now_function(clock::now))
+    , wake_(std::move(wake))
+    , origin_(now_())
+{
+}
+
+
+timer_wheel::timer_id timer_wheel::schedule(std::chrono::milliseconds delay, callback cb)
+{
+    const auto at = now_() + std::max(delay, std::chrono::milliseconds::zero()) - origin_;
+    const auto expires = static_cast<uint64_t>(std::chrono::ceil<std::chrono::milliseconds>(at).count());
+
+    timer_id id;
+
+    {
+        std::lock_guard lock(mutex_);
+
+        if (callbacks_.empty())
+        {
+            // 没有定时器时驱动者可能已很久没有调用 poll，从当前时间开始计算层级
+            clear_slots();
+            current_ = std::max(current_, tick_of(now_()));
+        }
+
+        id = next_id_++;
+        callbacks_.emplace(id, std::move(cb));
+        place({ id, expires });
+    }
+
+    if (wake_)
+    {
+        wake_();
+    }
+
+    return id;
+}
+
+
+bool timer_wheel::cancel(timer_id id)
+{
+    if (id == 0)
+    {
+        return false;
+    }
+
+    std::unique_lock lock(mutex_);
+    const bool pending = (callbacks_.erase(id) > 0);
+
+    if (callbacks_.empty())
+    {
+        clear_slots();
+    }
+
+    // 等待正在执行的回调返回；在回调自身中取消时不等待
+    done_.wait(lock, [this, id]
+    {
+        return running_ != id || running_thread_ == std::this_thread::get_id();
+    });
+
+    return pending;
+}
+
+
+size_t timer_wheel::poll()
+{
+    std::unique_lock lock(mutex_);
+    std::vector<timer_id> due;
+    advance(tick_of(now_()), due);
+    return execute(lock, due);
+}
+
+
+timer_wheel::clock::time_point timer_wheel::next_expiry() const
+{
+    std::lock_guard lock(mutex_);
+
+    if (callbacks_.empty())
+    {
+        return clock::time_point::max();
+    }
+
+    const auto next = next_tick();
+    if (next == std::numeric_limits<uint64_t>::max())
+    {
+        return clock::time_point::max();
+    }
+
+    return origin_ + TICK * static_cast<int64_t>(next);
+}
+
+
+size_t timer_wheel::size() const
+{
+    std::lock_guard lock(mutex_);
+    return callbacks_.size();
+}
+
+
+void timer_wheel::clear()
+{
+    std::unique_lock lock(mutex_);
+    callbacks_.clear();
+    clear_slots();
+
+    done_.wait(lock, [this]
+    {
+        return running_ == 0 || running_thread_ == std::this_thread::get_id();
+    });
+}
+
+
+uint64_t timer_wheel::tick_of(clock::time_point t) const
+{
+    return static_cast<uint64_t>(std::chrono::floor<std::chrono::milliseconds>(t - origin_).count());
+}
+
+
+void timer_wheel::place(const entry &e)
+{
+    // 已过期的放入当前格；太远的先放在最高层的最远格
+    auto at = std::max(e.expires, current_);
+
+    if (at - current_ >= RANGE)
+    {
+        at = current_ + RANGE - 1;
+    }
+
+    const auto delta = at - current_;
+    int level = 0;
+
+    while (level < LEVELS - 1 && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1))))
+    {
+        level++;
+    }
+
+    const auto index = (at >> (SLOT_BITS * level)) & (SLOTS - 1);
+    slots_[level][index].push_back(e);
+    counts_[level]++;
+}
+
+
+void timer_wheel::cascade(int level, size_t index)
+{
+    auto entries = std::move(slots_[level][index]);
+    slots_[level][index].clear();
+    counts_[level] -= entries.size();
+
+    for (const auto &e : entries)
+    {
+        if (callbacks_.count(e.id) > 0)
+        {
+            place(e);
+        }
+    }
+}
+
+
+void timer_wheel::advance(uint64_t target, std::vector<timer_id> &due)
+{
+    if (callbacks_.empty())
+    {
+        current_ = std::max(current_, target + 1);
+        return;
+    }
+
+    while (current_ <= target)
+    {
+        auto &slot = slots_[0][current_ & (SLOTS - 1)];
+
+        for (const auto &e : slot)
+        {
+            if (callbacks_.count(e.id) > 0)
+            {
+                due.push_back(e.id);
+            }
+        }
+
+        counts_[0] -= slot.size();
+        slot.clear();
+
+        // 低层都为空时，直接跳到下一次重新分配
+        int empty = 0;
+
+        while (empty < LEVELS && counts_[empty] == 0)
+        {
+            empty++;
+        }
+
+        uint64_t next = current_ + 1;
+
+        if (empty == LEVELS)
+        {
+            next = target + 1;
+        }
+        else if (empty > 0)
+        {
+            const auto span = uint64_t(1) << (SLOT_BITS * empty);
+            next = std::min((current_ | (span - 1)) + 1, target + 1);
+        }
+
+        current_ = next;
+
+        // 从高层到低层重新分配
+        for (int level = LEVELS - 1; level > 0; level--)
+        {
+            const auto shift = SLOT_BITS * level;
+
+            if ((current_ & ((uint64_t(1) << shift) - 1)) == 0)
+            {
+                cascade(level, (current_ >> shift) & (SLOTS - 1));
+            }
+        }
+    }
+}
+
+
+uint64_t timer_wheel::next_tick() const
+{
+    auto next = std::numeric_limits<uint64_t>::max();
+
+    // 最低层：第一个非空格即到期时间
+    for (size_t i = 0; i < SLOTS && counts_[0] > 0; i++)
+    {
+        if (!slots_[0][(current_ + i) & (SLOTS - 1)].empty())
+        {
+            next = current_ + i;
+            break;
+        }
+    }
+
+    // 高层：第一个非空格开始重新分配的时间
+    for (int level = 1; level < LEVELS; level++)
+    {
+        const auto shift = SLOT_BITS * level;
+        const auto block = current_ >> shift;
+
+        for (uint64_t i = 1; i <= SLOTS && counts_[level] > 0; i++)
+        {
+            if (!slots_[level][(block + i) & (SLOTS - 1)].empty())
+            {
+                next = std::min(next, (block + i) << shift);
+                break;
+            }
+        }
+    }
+
+    return next;
+}
+
+
+void timer_wheel::clear_slots()
+{
+    for (int level = 0; level < LEVELS; level++)
+    {
+        for (auto &slot : slots_[level])
+        {
+            slot.clear();
+        }
+
+        counts_[level] = 0;
+    }
+}
+
+
+size_t timer_wheel::execute(std::unique_lock<std::mutex> &lock, const std::vector<timer_id> &due)
+{
+    size_t count = 0;
+
+    for (const auto id : due)
+    {
+        auto iter = callbacks_.find(id);
+
+        if (iter == callbacks_.end())
+        {
+            // 在前面的回调执行期间被取消
+            continue;
+        }
+
+        auto cb = std::move(iter->second);
+        callbacks_.erase(iter);
+        running_ = id;
+        running_thread_ = std::this_thread::get_id();
+        lock.unlock();
+
+        cb();
+        count++;
+
+        lock.lock();
+        running_ = 0;
+        running_thread_ = std::thread::id();
+        done_.notify_all();
+    }
+
+    return count;
+}
+
+
+}       // namespace kaixin
@@ -0,0 +1,157 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        timer_wheel.h
+ * \brief       timer_wheel 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+namespace kaixin {
+
+
+/*!
+ * \brief       分层时间轮。
+ *
+ * 时间以 1 毫秒为一格，4 层各 64 格，第 n 层每格跨 64^n 格；定时器按到期时间放入对应的层，
+ * 低层转完一圈时把上一层的一格重新分配到低层。添加、取消与到期都是常数时间。
+ *
+ * 本类不启动线程：驱动者（SDK 中为 `event_loop`）等待到 `next_expiry`，然后调用 `poll`
+ * 执行到期的回调；添加定时器时调用构造时给出的唤醒函数，使驱动者重新计算等待时间。
+ * 回调在驱动者的线程中执行，应当很快返回；耗时的工作投递到 `worker_pool`。
+ *
+ * 构造时可以注入时钟，测试中推进时钟后调用 `poll`，不需要真正等待。
+ */
+class timer_wheel : private noncopyable
+{
+public:
+    using clock = std::chrono::steady_clock;
+    using now_function = std::function<clock::time_point()>;
+    using callback = std::function<void()>;
+    using timer_id = uint64_t;
+
+    /// 每格的时长。
+    static constexpr auto TICK = std::chrono::milliseconds(1);
+
+    /*!
+     * \brief       构造函数。
+     *
+     * \param[in]   now         时钟；如果为空，则使用单调时钟
+     * \param[in]   wake        添加定时器后调用的唤醒函数，可以为空
+     */
+    explicit timer_wheel(now_function now = nullptr, callback wake = nullptr);
+
+    /*!
+     * \brief       添加单次定时器。周期定时器在回调中重新添加，见 `simple_timer`。
+     *
+     * \param[in]   delay       延迟，至少经过这么久才执行
+     * \param[in]   cb          回调函数
+     *
+     * \return      定时器 ID，非零。
+     */
+    timer_id schedule(std::chrono::milliseconds delay, callback cb);
+
+    /*!
+     * \brief       取消定时器。
+     *
+     * 如果回调正在其它线程中执行，则等待其返回，因此返回后回调不会再访问其捕获的对象；
+     * 在回调中取消自身时不等待。
+     *
+     * \param[in]   id          定时器 ID；零或已到期的 ID 被忽略
+     *
+     * \return      如果取消了尚未执行的定时器，则返回 `true`；否则返回 `false`。
+     */
+    bool cancel(timer_id id);
+
+    /*!
+     * \brief       执行已到期的定时器。由驱动者调用，不能并发调用。
+     *
+     * \return      执行的回调个数。
+     */
+    size_t poll();
+
+    /*!
+     * \brief       下一次需要调用 `poll` 的时间：最近的到期，或者高层的重新分配。
+     *
+     * \return      没有定时器时返回 `clock::time_point::max()`。
+     */
+    clock::time_point next_expiry() const;
+
+    /// 尚未执行的定时器个数。
+    size_t size() const;
+
+    /// 取消所有定时器，并像 `cancel` 一样等待正在其它线程中执行的回调返回。
+    void clear();
+
+private:
+    /// 层数。
+    static constexpr int LEVELS = 4;
+    /// 每层格数的位数。
+    static constexpr int SLOT_BITS = 6;
+    /// 每层格数。
+    static constexpr size_t SLOTS = size_t(1) << SLOT_BITS;
+    /// 能直接放入的最远格数，更远的先放在最高层，到时再重新分配。
+    static constexpr uint64_t RANGE = uint64_t(1) << (SLOT_BITS * LEVELS);
+
+    /// 时间轮中的定时器。回调保存在 `callbacks_` 中，取消时只删除回调，格中的记录到期时丢弃。
+    struct entry
+    {
+        timer_id id;                            ///< 定时器 ID
+        uint64_t expires;                       ///< 到期的格
+    };
+
+    // 时间对应的格
+    uint64_t tick_of(clock::time_point t) const;
+
+    // 放入对应的层与格
+    void place(const entry &e);
+
+    // 把第 level 层的第 index 格重新分配到低层
+    void cascade(int level, size_t index);
+
+    // 推进到 target 格（含），收集到期的定时器
+    void advance(uint64_t target, std::vector<timer_id> &due);
+
+    // 下一个需要处理的格：低层的到期或高层的重新分配
+    uint64_t next_tick() const;
+
+    // 清空所有格
+    void clear_slots();
+
+    // 执行到期的回调，执行期间不持有锁
+    size_t execute(std::unique_lock<std::mutex> &lock, const std::vector<timer_id> &due);
+
+private:
+    const now_function now_;
+    const callback wake_;
+    const clock::time_point origin_;            ///< 第 0 格的时间
+    mutable std::mutex mutex_;
+    std::condition_variable done_;              ///< 回调执行完毕
+    std::vector<entry> slots_[LEVELS][SLOTS];
+    size_t counts_[LEVELS] = {};                ///< 每层的记录数（包括已取消的）
+    std::unordered_map<timer_id, callback> callbacks_;  ///< 尚未执行的定时器
+    uint64_t current_ = 0;                      ///< 下一个要处理的格
+    timer_id next_id_ = 1;
+    timer_id running_ = 0;                      ///< 正在执行的定时器
+    std::thread::id running_thread_;            ///< 执行回调的线程
+};
+
+
+}       // namespace kaixin
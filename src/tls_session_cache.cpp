@@ -0,0 +1,264 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        tls_session_cache.cpp
+ * \brief       tls_session_cache 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "tls_session_cache.h"
+
+#include <ctime>
+
+#include <openssl/ssl.h>
+
+
+/// 每个主机最多保留的会话数。
+static constexpr size_t MAX_SESSIONS_PER_HOST = 4;
+/// 序列化格式版本。
+static constexpr uint8_t FORMAT_VERSION = 1;
+
+
+// 会话是否仍然有效
+static bool is_alive(const SSL_SESSION *session, time_t now)
+{
+    return SSL_SESSION_is_resumable(session)
+        && SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session) > now;
+}
+
+
+// 新会话回调：TLS 1.3 的票据在握手完成后才到达
+static int on_new_session(SSL *ssl, SSL_SESSION *session)
+{
+    const auto *host = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+
+    if (host == nullptr)
+    {
+        return 0;
+    }
+
+    // 返回 1 表示保留会话的引用
+    tls_session_cache::instance().put(host, session);
+    return 1;
+}
+
+
+static void append_uint(std::vector<uint8_t> &out, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+    {
+        out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+}
+
+
+static bool read_uint(const std::vector<uint8_t> &in, size_t &pos, int bytes, uint32_t &value)
+{
+    if (in.size() - pos < static_cast<size_t>(bytes))
+    {
+        return false;
+    }
+
+    value = 0;
+
+    for (int i = 0; i < bytes; i++)
+    {
+        value |= static_cast<uint32_t>(in[pos++]) << (i * 8);
+    }
+
+    return true;
+}
+
+
+tls_session_cache &tls_session_cache::instance()
+{
+    static tls_session_cache cache;
+    return cache;
+}
+
+
+tls_session_cache::~tls_session_cache()
+{
+    clear();
+}
+
+
+void tls_session_cache::attach(SSL_CTX *ctx)
+{
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(ctx, on_new_session);
+}
+
+
+SSL_SESSION *tls_session_cache::take(const std::string &host)
+{
+    std::lock_guard lock(mutex_);
+    evict_expired();
+
+    auto iter = sessions_.find(host);
+
+    if (iter == sessions_.end() || iter->second.empty())
+    {
+        return nullptr;
+    }
+
+    // 使用最新的会话
+    auto *session = iter->second.back();
+
+    if (SSL_SESSION_get_protocol_version(session) >= TLS1_3_VERSION)
+    {
+        iter->second.pop_back();
+    }
+    else
+    {
+        SSL_SESSION_up_ref(session);
+    }
+
+    return session;
+}
+
+
+void tls_session_cache::put(const std::string &host, SSL_SESSION *session)
+{
+    std::lock_guard lock(mutex_);
+    auto &sessions = sessions_[host];
+    sessions.push_back(session);
+
+    while (sessions.size() > MAX_SESSIONS_PER_HOST)
+    {
+        SSL_SESSION_free(sessions.front());
+        sessions.pop_front();
+    }
+}
+
+
+std::vector<uint8_t> tls_session_cache::serialize()
+{
+    std::lock_guard lock(mutex_);
+    evict_expired();
+
+    std::vector<uint8_t> out;
+    out.push_back(FORMAT_VERSION);
+
+    for (const auto &[host, sessions] : sessions_)
+    {
+        if (sessions.empty())
+        {
+            continue;
+        }
+
+        const auto length = i2d_SSL_SESSION(sessions.back(), nullptr);
+
+        if (length <= 0)
+        {
+            continue;
+        }
+
+        append_uint(out, static_cast<uint32_t>(host.length()), 2);
+        out.insert(out.end(), host.begin(), host.end());
+        append_uint(out, static_cast<uint32_t>(length), 4);
+
+        const auto offset = out.size();
+        out.resize(offset + static_cast<size_t>(length));
+        auto *p = out.data() + offset;
+        i2d_SSL_SESSION(sessions.back(), &p);
+    }
+
+    return out;
+}
+
+
+void tls_session_cache::deserialize(const std::vector<uint8_t> &data)
+{
+    if (data.empty() || data.front() != FORMAT_VERSION)
+    {
+        return;
+    }
+
+    const auto now = time(nullptr);
+    size_t pos = 1;
+
+    while (pos < data.size())
+    {
+        uint32_t host_length = 0;
+        uint32_t length = 0;
+
+        if (!read_uint(data, pos, 2, host_length) || data.size() - pos < host_length)
+        {
+            return;
+        }
+
+        std::string host(data.begin() + pos, data.begin() + pos + host_length);
+        pos += host_length;
+
+        if (!read_uint(data, pos, 4, length) || data.size() - pos < length)
+        {
+            return;
+        }
+
+        const auto *p = data.data() + pos;
+        auto *session = d2i_SSL_SESSION(nullptr, &p, static_cast<long>(length));
+        pos += length;
+
+        if (session == nullptr)
+        {
+            continue;
+        }
+
+        if (is_alive(session, now))
+        {
+            put(host, session);
+        }
+        else
+        {
+            SSL_SESSION_free(session);
+        }
+    }
+}
+
+
+void tls_session_cache::clear()
+{
+    std::lock_guard lock(mutex_);
+
+    for (auto &[host, sessions] : sessions_)
+    {
+        for (auto *session : sessions)
+        {
+            SSL_SESSION_free(session);
+        }
+    }
+
+    sessions_.clear();
+}
+
+
+void tls_session_cache::evict_expired()
+{
+    // 调用者已加锁
+    const auto now = time(nullptr);
+
+    for (auto iter = sessions_.begin(); iter != sessions_.end();)
+    {
+        auto &sessions = iter->second;
+
+        for (auto s = sessions.begin(); s != sessions.end();)
+        {
+            if (is_alive(*s, now))
+            {
+                ++s;
+            }
+            else
+            {
+                SSL_SESSION_free(*s);
+                s = sessions.erase(s);
+            }
+        }
+
+        iter = sessions.empty() ? sessions_.erase(iter) : std::next(iter);
+    }
+}
@@ -0,0 +1,85 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        tls_session_cache.h
+ * \brief       tls_session_cache 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+typedef struct ssl_ctx_st SSL_CTX;
+typedef struct ssl_session_st SSL_SESSION;
+
+
+/*!
+ * \brief       按主机缓存 TLS 会话，使新连接可以恢复会话，省去完整握手。
+ *
+ * TLS 1.3 的会话票据只使用一次：取出后即从缓存中删除，新连接握手后服务端会发送新的票据。
+ * TLS 1.2 的会话可以重复使用，取出后仍保留在缓存中。
+ */
+class tls_session_cache : private noncopyable
+{
+public:
+    /// 获取全局会话缓存。
+    static tls_session_cache &instance();
+
+    /*!
+     * \brief       在 TLS 上下文上启用客户端会话缓存，新会话自动存入本缓存。
+     *
+     * \param[in]   ctx         TLS 客户端上下文
+     */
+    void attach(SSL_CTX *ctx);
+
+    /*!
+     * \brief       取出主机的会话。
+     *
+     * \param[in]   host        主机名
+     *
+     * \return      会话，调用者须调用 `SSL_SESSION_free` 释放；如果没有可用的会话，则返回空指针。
+     */
+    SSL_SESSION *take(const std::string &host);
+
+    /*!
+     * \brief       保存会话。
+     *
+     * \param[in]   host        主机名
+     * \param[in]   session     会话，所有权转移给缓存
+     */
+    void put(const std::string &host, SSL_SESSION *session);
+
+    /// 把每个主机最新的会话序列化，用于持久化。
+    std::vector<uint8_t> serialize();
+
+    /*!
+     * \brief       加载序列化的会话，忽略已过期的会话。
+     *
+     * \param[in]   data        `serialize` 的结果
+     */
+    void deserialize(const std::vector<uint8_t> &data);
+
+    /// 清空缓存。
+    void clear();
+
+private:
+    tls_session_cache() = default;
+    ~tls_session_cache();
+
+    void evict_expired();
+
+private:
+    std::mutex mutex_;
+    std::map<std::string, std::deque<SSL_SESSION *>> sessions_;
+};
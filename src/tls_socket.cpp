@@ -0,0 +1,422 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        tls_socket.cpp
+ * \brief       tls_socket 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "tls_socket.h"
+
+#include <cerrno>
+#include <mutex>
+
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+#include "io_waiter.h"
+#include "logger.h"
+#include "tls_session_cache.h"
+#include "utils.h"
+
+#ifdef KAIXIN_OS_WINDOWS
+#define NOMINMAX
+#include <WinSock2.h>
+#include <wincrypt.h>
+#endif
+
+
+
+#ifdef KAIXIN_OS_WINDOWS
+// 把系统根证书存储中的证书加入 OpenSSL 证书存储
+static void load_system_roots(X509_STORE *store)
+{
+    auto system_store = CertOpenSystemStoreW(0, L"ROOT");
+
+    if (system_store == nullptr)
+    {
+        LW() << "Cannot open system certificate store.";
+        return;
+    }
+
+    PCCERT_CONTEXT cert = nullptr;
+
+    while ((cert = CertEnumCertificatesInStore(system_store, cert)) != nullptr)
+    {
+        const auto *data = static_cast<const unsigned char *>(cert->pbCertEncoded);
+        auto *x509 = d2i_X509(nullptr, &data, static_cast<long>(cert->cbCertEncoded));
+
+        if (x509 != nullptr)
+        {
+            X509_STORE_add_cert(store, x509);
+            X509_free(x509);
+        }
+    }
+
+    CertCloseStore(system_store, 0);
+}
+#endif
+
+
+// 进程共享的 TLS 客户端上下文
+static SSL_CTX *client_context()
+{
+    static SSL_CTX *ctx = nullptr;
+    static std::once_flag once;
+
+    std::call_once(once, []
+    {
+        ctx = SSL_CTX_new(TLS_client_method());
+
+        if (ctx == nullptr)
+        {
+            return;
+        }
+
+        SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+        SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER, nullptr);
+        SSL_CTX_set_mode(ctx, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+#ifdef KAIXIN_OS_WINDOWS
+        load_system_roots(SSL_CTX_get_cert_store(ctx));
+#else
+        SSL_CTX_set_default_verify_paths(ctx);
+#endif
+
+        static const unsigned char alpn[] = { 8, 'h', 't', 't', 'p', '/', '1', '.', '1' };
+        SSL_CTX_set_alpn_protos(ctx, alpn, sizeof(alpn));
+
+        // 客户端会话缓存，用于会话恢复
+        tls_session_cache::instance().attach(ctx);
+    });
+
+    return ctx;
+}
+
+
+// 使 `ix::Socket::isWaitNeeded` 返回 `true`
+static void set_would_block()
+{
+#ifdef KAIXIN_OS_WINDOWS
+    WSASetLastError(WSAEWOULDBLOCK);
+#else
+    errno = EWOULDBLOCK;
+#endif
+}
+
+
+// 使 `ix::Socket::isWaitNeeded` 返回 `false`，调用者按连接出错处理
+static void set_connection_reset()
+{
+#ifdef KAIXIN_OS_WINDOWS
+    WSASetLastError(WSAECONNRESET);
+#else
+    errno = ECONNRESET;
+#endif
+}
+
+
+// 获取 OpenSSL 错误信息
+static std::string ssl_error_string(SSL *ssl)
+{
+    const auto verify = SSL_get_verify_result(ssl);
+
+    if (verify != X509_V_OK)
+    {
+        return X509_verify_cert_error_string(verify);
+    }
+
+    char buffer[256] = { 0 };
+    ERR_error_string_n(ERR_get_error(), buffer, sizeof(buffer));
+    return buffer;
+}
+
+
+bool tls_socket::add_trusted_certificate(const std::string &pem)
+{
+    auto *ctx = client_context();
+
+    if (ctx == nullptr)
+    {
+        return false;
+    }
+
+    auto *bio = BIO_new_mem_buf(pem.data(), static_cast<int>(pem.length()));
+
+    if (bio == nullptr)
+    {
+        return false;
+    }
+
+    auto *cert = PEM_read_bio_X509(bio, nullptr, nullptr, nullptr);
+    BIO_free(bio);
+
+    if (cert == nullptr)
+    {
+        return false;
+    }
+
+    const bool ok = (X509_STORE_add_cert(SSL_CTX_get_cert_store(ctx), cert) == 1);
+    X509_free(cert);
+    return ok;
+}
+
+
+tls_socket::tls_socket(int fd, bool http2)
+    : tcp_socket(fd)
+    , ssl_(nullptr)
+    , http2_(http2)
+    , early_data_accepted_(false)
+{
+}
+
+
+tls_socket::~tls_socket()
+{
+    close();
+}
+
+
+bool tls_socket::handshake(const std::string &host, std::string &error,
+                           const ix::CancellationRequest &cancelled, const std::string &early_data)
+{
+    auto *ctx = client_context();
+    early_data_accepted_ = false;
+
+    if (ctx == nullptr)
+    {
+        error = "Cannot create TLS context";
+        return false;
+    }
+
+    ERR_clear_error();
+    ssl_ = SSL_new(ctx);
+
+    if (ssl_ == nullptr)
+    {
+        error = "Cannot create TLS session";
+        return false;
+    }
+
+    SSL_set_fd(ssl_, _sockfd);
+    SSL_set_tlsext_host_name(ssl_, host.c_str());
+    SSL_set1_host(ssl_, host.c_str());
+
+    if (http2_)
+    {
+        static const unsigned char alpn[] = {
+            2, 'h', '2',
+            8, 'h', 't', 't', 'p', '/', '1', '.', '1'
+        };
+        SSL_set_alpn_protos(ssl_, alpn, sizeof(alpn));
+    }
+
+    // 恢复上次的会话
+    bool send_early = false;
+    auto *session = tls_session_cache::instance().take(host);
+
+    if (session != nullptr)
+    {
+        send_early = !early_data.empty() && SSL_SESSION_get_max_early_data(session) >= early_data.length();
+        SSL_set_session(ssl_, session);
+        SSL_SESSION_free(session);
+    }
+
+    // 早期数据随 ClientHello 发送，不等待握手完成
+    size_t offset = 0;
+
+    while (send_early && offset < early_data.length())
+    {
+        if (cancelled && cancelled())
+        {
+            error = "Cancelled during TLS handshake";
+            return false;
+        }
+
+        size_t written = 0;
+        const auto ret = SSL_write_early_data(ssl_, early_data.data() + offset, early_data.length() - offset,
+                                              &written);
+
+        if (ret == 1)
+        {
+            offset += written;
+        }
+        else if (!wait_handshake(ret, error, cancelled))
+        {
+            return false;
+        }
+    }
+
+    while (true)
+    {
+        if (cancelled && cancelled())
+        {
+            error = "Cancelled during TLS handshake";
+            return false;
+        }
+
+        const auto ret = SSL_connect(ssl_);
+
+        if (ret == 1)
+        {
+            break;
+        }
+
+        if (!wait_handshake(ret, error, cancelled))
+        {
+            return false;
+        }
+    }
+
+    early_data_accepted_ = send_early && SSL_get_early_data_status(ssl_) == SSL_EARLY_DATA_ACCEPTED;
+
+    if (SSL_session_reused(ssl_))
+    {
+        LD() << "TLS session resumed for" << host << (early_data_accepted_ ? "with early data." : ".");
+    }
+
+    return true;
+}
+
+
+// 握手未完成时等待套接字就绪，由事件循环检测
+bool tls_socket::wait_handshake(int ret, std::string &error, const ix::CancellationRequest &cancelled)
+{
+    uint32_t events = 0;
+
+    switch (SSL_get_error(ssl_, ret))
+    {
+    case SSL_ERROR_WANT_READ:
+        events = kaixin::event_loop::READABLE;
+        break;
+
+    case SSL_ERROR_WANT_WRITE:
+        events = kaixin::event_loop::WRITABLE;
+        break;
+
+    default:
+        error = "TLS handshake failed: " + ssl_error_string(ssl_);
+        return false;
+    }
+
+    // 套接字出错时下一次 SSL_connect 返回具体的错误
+    if (kaixin::io_waiter::wait_one(fd(), events, cancelled) == 0)
+    {
+        error = (cancelled && cancelled()) ? "Cancelled during TLS handshake"
+                                           : "TLS handshake failed: cannot wait";
+        return false;
+    }
+
+    return true;
+}
+
+
+void tls_socket::set_wanted(int ret)
+{
+    wanted_ = (SSL_get_error(ssl_, ret) == SSL_ERROR_WANT_WRITE) ? kaixin::event_loop::WRITABLE
+                                                                : kaixin::event_loop::READABLE;
+}
+
+
+std::string tls_socket::alpn_protocol() const
+{
+    const unsigned char *data = nullptr;
+    unsigned int length = 0;
+
+    if (ssl_ != nullptr)
+    {
+        SSL_get0_alpn_selected(ssl_, &data, &length);
+    }
+
+    return (data == nullptr) ? std::string() : std::string(reinterpret_cast<const char *>(data), length);
+}
+
+
+void tls_socket::close()
+{
+    if (ssl_ != nullptr)
+    {
+        // 只标记为已关闭，不发送 close_notify。未关闭就释放时，OpenSSL 会把当前会话（TLS 1.3 中为
+        // 最新收到的票据）标记为不可恢复；出错的连接在出错时已被标记
+        SSL_set_quiet_shutdown(ssl_, 1);
+        SSL_shutdown(ssl_);
+        SSL_free(ssl_);
+        ssl_ = nullptr;
+    }
+
+    ix::Socket::close();
+}
+
+
+ssize_t tls_socket::send(char *buffer, size_t length)
+{
+    if (ssl_ == nullptr)
+    {
+        return -1;
+    }
+
+    ERR_clear_error();
+    const auto ret = SSL_write(ssl_, buffer, static_cast<int>(length));
+
+    if (ret > 0)
+    {
+        return ret;
+    }
+
+    switch (SSL_get_error(ssl_, ret))
+    {
+    case SSL_ERROR_WANT_READ:
+    case SSL_ERROR_WANT_WRITE:
+        set_wanted(ret);
+        set_would_block();
+        return -1;
+
+    case SSL_ERROR_ZERO_RETURN:
+        return 0;
+
+    default:
+        return -1;
+    }
+}
+
+
+ssize_t tls_socket::recv(void *buffer, size_t length)
+{
+    if (ssl_ == nullptr)
+    {
+        return -1;
+    }
+
+    ERR_clear_error();
+    const auto ret = SSL_read(ssl_, buffer, static_cast<int>(length));
+
+    if (ret > 0)
+    {
+        return ret;
+    }
+
+    switch (SSL_get_error(ssl_, ret))
+    {
+    case SSL_ERROR_WANT_READ:
+    case SSL_ERROR_WANT_WRITE:
+        set_wanted(ret);
+        set_would_block();
+        return -1;
+
+    case SSL_ERROR_ZERO_RETURN:
+        // 对端发送了 close_notify
+        return 0;
+
+    default:
+        // 包括对端未发送 close_notify 直接关闭连接：此时无法区分完整与被截断的数据，
+        // 以连接关闭为结束的响应体不能当作完整接收，按连接出错处理
+        set_connection_reset();
+        return -1;
+    }
+}
@@ -0,0 +1,86 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        tls_socket.h
+ * \brief       tls_socket 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include <string>
+
+#include "tcp_socket.h"
+
+typedef struct ssl_st SSL;
+
+
+/*!
+ * \brief       在已连接的套接字上建立 TLS 客户端会话。
+ *
+ * ixwebsocket 的 TLS 套接字只能自己解析域名并连接，无法使用 `dns_cache` 的结果与并行连接，
+ * 因此在连接建立后由本类完成握手。会校验服务端证书链与主机名，并设置 SNI；
+ * Windows 上信任系统“受信任的根证书颁发机构”存储中的证书。
+ *
+ * 握手时使用 `tls_session_cache` 中该主机的会话进行会话恢复；恢复的 TLS 1.3 会话允许早期数据时，
+ * 可以随握手一起发送请求（0-RTT）。握手与收发需要等待时由事件循环检测就绪。
+ */
+class tls_socket : public tcp_socket
+{
+public:
+    /*!
+     * \brief       构造函数。
+     *
+     * \param[in]   fd          已连接的非阻塞套接字
+     * \param[in]   http2       是否通过 ALPN 优先协商 HTTP/2
+     */
+    explicit tls_socket(int fd, bool http2 = false);
+    ~tls_socket() override;
+
+    /*!
+     * \brief       进行 TLS 握手。
+     *
+     * \param[in]   host        服务端主机名，用于 SNI 与证书校验
+     * \param[out]  error       出错时的错误信息
+     * \param[in]   cancelled   取消请求
+     * \param[in]   early_data  随握手发送的早期数据，可以为空。只应传入可以安全重放的请求
+     *
+     * \return      如果成功，则返回 `true`；否则返回 `false`。
+     */
+    bool handshake(const std::string &host, std::string &error, const ix::CancellationRequest &cancelled,
+                   const std::string &early_data = {});
+
+    /// 早期数据是否已被服务端接受。未被接受时，调用者需要在握手后重新发送。
+    bool early_data_accepted() const { return early_data_accepted_; }
+
+    /// 获取 ALPN 协商的协议，例如“h2”或“http/1.1”；没有协商时返回空字符串。
+    std::string alpn_protocol() const;
+
+
+    /*!
+     * \brief       额外信任一个根证书，例如测试与性能测试中本地服务端的自签名证书。
+     *
+     * \param[in]   pem         PEM 格式的证书
+     *
+     * \return      如果成功，则返回 `true`；否则返回 `false`。
+     */
+    static bool add_trusted_certificate(const std::string &pem);
+
+    void close() override;
+    ssize_t send(char *buffer, size_t length) override;
+    ssize_t recv(void *buffer, size_t length) override;
+
+private:
+    bool wait_handshake(int ret, std::string &error, const ix::CancellationRequest &cancelled);
+
+    // 收发需要等待时记录等待的方向
+    void set_wanted(int ret);
+
+private:
+    SSL *ssl_;
+    bool http2_;
+    bool early_data_accepted_;
+};
@@ -0,0 +1,209 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        token_refresher.cpp
+ * \brief       token_refresher 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "token_refresher.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "logger.h"
+#include "server_clock.h"
+#include "worker_pool.h"
+
+
+namespace kaixin {
+
+
+static std::mutex g_options_mutex;
+static refresh_options g_options;
+
+
+refresh_options token_refresher::options()
+{
+    std::lock_guard lock(g_options_mutex);
+    return g_options;
+}
+
+
+void token_refresher::set_options(const refresh_options &options)
+{
+    std::lock_guard lock(g_options_mutex);
+    g_options = options;
+}
+
+
+token_refresher::token_refresher(refresh_function refresh)
+    : refresh_(std::move(refresh))
+    , random_(std::random_device()())
+{
+}
+
+
+token_refresher::~token_refresher()
+{
+    timer_wheel::timer_id timer;
+
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+        generation_++;
+        timer = timer_;
+        timer_ = 0;
+    }
+
+    // 不持有锁：取消时等待正在执行的时间轮回调，而回调要加锁
+    event_loop::instance().timers().cancel(timer);
+
+    std::unique_lock lock(mutex_);
+    cond_.wait(lock, [this] { return running_ == 0; });
+}
+
+
+void token_refresher::schedule(time_t issued_at, time_t access_expires_at, time_t refresh_expires_at)
+{
+    const auto opts = options();
+    const int64_t lifetime = std::max<int64_t>(access_expires_at - issued_at, 0);
+    const int64_t window = std::min<int64_t>((opts.window_s > 0) ? opts.window_s : lifetime / 4, lifetime);
+    timer_wheel::timer_id previous;
+
+    {
+        std::lock_guard lock(mutex_);
+
+        // 随机提前的时间不超过提前窗口之外的有效期，不会早于签发时间
+        std::uniform_int_distribution<int64_t> jitter(0, std::min<int64_t>(opts.jitter_s, lifetime - window) * 1000);
+        const auto delay = until(access_expires_at - window) - std::chrono::milliseconds(jitter(random_));
+        refresh_expires_at_ = refresh_expires_at;
+        failures_ = 0;
+        generation_++;
+        previous = timer_;
+        arm(delay);
+    }
+
+    event_loop::instance().timers().cancel(previous);
+}
+
+
+void token_refresher::cancel()
+{
+    timer_wheel::timer_id timer;
+
+    {
+        std::lock_guard lock(mutex_);
+        generation_++;
+        timer = timer_;
+        timer_ = 0;
+    }
+
+    event_loop::instance().timers().cancel(timer);
+
+    // 与析构一样等待已投递或进行中的更新结束，之后不会再有更新发布新令牌或重新调度
+    std::unique_lock lock(mutex_);
+    cond_.wait(lock, [this] { return running_ == 0; });
+}
+
+
+void token_refresher::arm(std::chrono::milliseconds delay)
+{
+    timer_ = event_loop::instance().timers().schedule(delay, [this, generation = generation_]
+    {
+        on_timer(generation);
+    });
+}
+
+
+void token_refresher::on_timer(unsigned generation)
+{
+    {
+        std::lock_guard lock(mutex_);
+
+        if (stopping_ || generation != generation_)
+        {
+            return;
+        }
+
+        timer_ = 0;
+        running_++;
+    }
+
+    // 更新请求可能耗时数秒，不能占用事件循环线程；走后台通道，不会排在阻塞的用户请求之后
+    if (!worker_pool::instance().post([this, generation] { refresh(generation); },
+                                      worker_pool::lane::system))
+    {
+        // 工作线程池正在停止，放弃本次更新
+        std::lock_guard lock(mutex_);
+        running_--;
+        cond_.notify_all();
+    }
+}
+
+
+void token_refresher::refresh(unsigned generation)
+{
+    // 更新期间不持有锁：成功时更新函数会调用 `schedule`
+    const int r = refresh_();
+
+    std::lock_guard lock(mutex_);
+    running_--;
+    cond_.notify_all();
+
+    if (r == 0 || stopping_ || generation_ != generation)
+    {
+        // 成功，或者更新期间已重新调度或取消
+        return;
+    }
+
+    // 更新令牌被拒绝时重试也没有用
+    const auto status = static_cast<int>(static_cast<uint32_t>(r) >> 16);
+
+    if (status == 401 || status == 403)
+    {
+        LE() << "Refresh token rejected:" << status;
+        return;
+    }
+
+    const auto delay = backoff(++failures_);
+
+    if (static_cast<int64_t>(refresh_expires_at_) * 1000 <= server_clock::instance().now_ms() + delay.count())
+    {
+        LE() << "Token refresh failed and the refresh token is expiring:" << r;
+        return;
+    }
+
+    LW() << "Token refresh failed:" << r << "Retrying in" << delay.count() << "ms.";
+    arm(delay);
+}
+
+
+std::chrono::milliseconds token_refresher::until(time_t server_time)
+{
+    return std::chrono::milliseconds(static_cast<int64_t>(server_time) * 1000 - server_clock::instance().now_ms());
+}
+
+
+std::chrono::milliseconds token_refresher::backoff(int failures)
+{
+    // 带抖动的指数退避：[d/2, d]，d = base * 2^(failures - 1)，不超过 max
+    const auto opts = options();
+    int64_t delay = opts.base_delay_ms;
+
+    for (int i = 1; i < failures && delay < opts.max_delay_ms; i++)
+    {
+        delay *= 2;
+    }
+
+    delay = std::min<int64_t>(delay, opts.max_delay_ms);
+    std::uniform_int_distribution<int64_t> dist(delay / 2, delay);
+    return std::chrono::milliseconds(dist(random_));
+}
+
+
+}       // namespace kaixin
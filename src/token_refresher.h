@@ -0,0 +1,109 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        token_refresher.h
+ * \brief       token_refresher 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <random>
+
+#include "event_loop.h"
+
+
+namespace kaixin {
+
+
+/// 令牌更新参数。
+struct refresh_options
+{
+    int window_s = 0;                           ///< 在访问令牌过期前多少秒更新，0 表示令牌有效期的四分之一
+    int jitter_s = 60;                          ///< 在此基础上随机再提前的最长秒数
+    int base_delay_ms = 1000;                   ///< 更新失败后指数退避的基础时长，毫秒
+    int max_delay_ms = 60000;                   ///< 更新失败后单次退避的最长时长，毫秒
+};
+
+
+/*!
+ * \brief       后台令牌更新调度器。
+ *
+ * 登录或更新成功后用 `schedule` 安排下次更新：在访问令牌过期前的提前窗口内，再随机提前一段时间，
+ * 避免大量客户端同时更新。到期由事件循环的时间轮触发，更新请求投递到 `worker_pool` 的后台通道
+ * 执行，不占用事件循环线程，也不排在阻塞的用户请求之后；失败时按带抖动的指数退避重试，
+ * 访问令牌过期后继续重试，直到更新令牌过期。
+ *
+ * 新令牌以凭据快照的方式发布，更新期间其它线程的请求继续使用当前令牌，不会等待。
+ * 时间均为服务端时间。
+ */
+class token_refresher : private noncopyable
+{
+public:
+    /// 更新函数，在工作线程中调用；返回零表示成功，成功时应通过 `schedule` 安排下次更新。
+    using refresh_function = std::function<int()>;
+
+    /// 获取当前参数。
+    static refresh_options options();
+
+    /// 设置参数，之后的调度生效。
+    static void set_options(const refresh_options &options);
+
+    explicit token_refresher(refresh_function refresh);
+
+    /// 析构函数。取消已安排的更新，并等待进行中的更新结束。
+    ~token_refresher();
+
+    /*!
+     * \brief       安排下次更新。
+     *
+     * \param[in]   issued_at               令牌签发时间
+     * \param[in]   access_expires_at       访问令牌过期时间
+     * \param[in]   refresh_expires_at      更新令牌过期时间
+     */
+    void schedule(time_t issued_at, time_t access_expires_at, time_t refresh_expires_at);
+
+    /// 取消已安排的更新，并等待进行中的更新结束，例如注销时。不能在更新函数中调用。
+    void cancel();
+
+private:
+    // 在时间轮上安排 delay 后更新，调用者持有锁
+    void arm(std::chrono::milliseconds delay);
+
+    // 时间轮回调：把更新投递到工作线程
+    void on_timer(unsigned generation);
+
+    // 在工作线程中更新，失败时安排重试
+    void refresh(unsigned generation);
+
+    // 距服务端时间还有多久
+    static std::chrono::milliseconds until(time_t server_time);
+
+    // 计算第 failures 次失败后的退避时长
+    std::chrono::milliseconds backoff(int failures);
+
+private:
+    refresh_function refresh_;
+    std::mutex mutex_;
+    std::condition_variable cond_;              ///< 进行中的更新结束
+    std::mt19937 random_;                       ///< 抖动随机数
+    timer_wheel::timer_id timer_ = 0;           ///< 已安排的定时器
+    time_t refresh_expires_at_ = 0;             ///< 更新令牌过期时间，之后不再重试
+    unsigned generation_ = 0;                   ///< 每次调度或取消加一，用于丢弃过时的定时器与重试
+    int failures_ = 0;                          ///< 连续失败次数
+    int running_ = 0;                           ///< 已投递或进行中的更新个数
+    bool stopping_ = false;                     ///< 是否正在停止
+};
+
+
+}       // namespace kaixin
@@ -20,9 +20,10 @@
 
 #include <openssl/evp.h>
 #include <openssl/pem.h>
-#include <openssl/rand.h>
-#include <cppcodec/hex_lower.hpp>
 
+#include <cstring>
+
+#include "codec.h"
 #include "kaixin_api.h"
 
 
@@ -30,17 +31,71 @@
 namespace utils {
 
 
-std::string generate_random_hex_string(size_t length)
+std::string to_hex(const uint8_t *buffer, size_t length)
 {
-    std::unique_ptr<uint8_t[]> bytes(new uint8_t[length]);
-    RAND_pseudo_bytes(bytes.get(), static_cast<int>(length));
-    return to_hex(bytes.get(), length);
+    return codec::to_hex(buffer, length);
 }
 
 
-std::string to_hex(const uint8_t *buffer, size_t length)
+// 两位十进制数；不是数字时返回 -1
+static inline int parse_2digits(const char *p)
+{
+    if (p[0] < '0' || p[0] > '9' || p[1] < '0' || p[1] > '9')
+    {
+        return -1;
+    }
+
+    return (p[0] - '0') * 10 + (p[1] - '0');
+}
+
+
+// 公历日期到 1970-01-01 的天数，见 Howard Hinnant 的 days_from_civil
+static int64_t days_from_civil(int64_t y, unsigned m, unsigned d)
+{
+    y -= (m <= 2) ? 1 : 0;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const auto yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+
+time_t parse_http_date(const std::string &s)
 {
-    return cppcodec::hex_lower::encode(buffer, length);
+    // https://developer.mozilla.org/zh-CN/docs/Web/HTTP/Headers/Date
+    // 固定格式，按位置直接读取：“Sun, 06 Nov 1994 08:49:37 GMT”
+    static constexpr char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+    if (s.size() != 29 || s[3] != ',' || s[4] != ' ' || s[7] != ' ' || s[11] != ' ' || s[16] != ' '
+        || s[19] != ':' || s[22] != ':' || s.compare(25, 4, " GMT") != 0)
+    {
+        return 0;
+    }
+
+    const auto *p = s.c_str();
+    unsigned month = 0;
+
+    while (month < 12 && memcmp(months + month * 3, p + 8, 3) != 0)
+    {
+        month++;
+    }
+
+    const auto day = parse_2digits(p + 5);
+    const auto century = parse_2digits(p + 12);
+    const auto year = parse_2digits(p + 14);
+    const auto hour = parse_2digits(p + 17);
+    const auto minute = parse_2digits(p + 20);
+    const auto second = parse_2digits(p + 23);
+
+    if (month >= 12 || day < 1 || day > 31 || century < 0 || year < 0 || hour < 0 || hour > 23
+        || minute < 0 || minute > 59 || second < 0 || second > 60)
+    {
+        return 0;
+    }
+
+    const auto days = days_from_civil(century * 100 + year, month + 1, static_cast<unsigned>(day));
+    return static_cast<time_t>(days * 86400 + hour * 3600 + minute * 60 + second);
 }
 
 
@@ -76,7 +131,7 @@ const std::string &get_current_locale()
 
 std::string get_local_agent_code()
 {
-    if (g_config == nullptr)
+    if (kaixin::current_config() == nullptr)
     {
         return {};
     }
@@ -84,6 +139,10 @@ std::string get_local_agent_code()
 #ifdef KAIXIN_OS_WINDOWS
     auto icode = get_reg_type_value<std::string>("icode");
     auto vcode = get_reg_type_value<std::vector<uint8_t>>("vcode");
+#else
+    // 其它平台没有本地代理编号
+    std::string icode;
+    std::vector<uint8_t> vcode;
 #endif
 
     if (icode.empty() || vcode.empty())
@@ -181,12 +240,21 @@ std::wstring to_wide(const std::string &narrow)
 }
 
 
-static bool get_reg_value(HKEY root, const std::string &value_name, reg_value &value)
+// 当前上下文应用的注册表子键：SOFTWARE\组织名\应用名
+static std::wstring app_subkey()
 {
+    const auto *config = kaixin::current_config();
     std::wstring subkey(L"SOFTWARE\\");
-    subkey += to_wide(g_config->organization);
+    subkey += to_wide(config->organization);
     subkey += L"\\";
-    subkey += to_wide(g_config->application);
+    subkey += to_wide(config->application);
+    return subkey;
+}
+
+
+static bool get_reg_value(HKEY root, const std::string &value_name, reg_value &value)
+{
+    const auto subkey = app_subkey();
 
     auto wide_name = to_wide(value_name);
     DWORD dwType = 0;
@@ -238,10 +306,7 @@ reg_value get_reg_value(const std::string &value_name, const reg_value &default_
 
 bool set_reg_value(const std::string &value_name, const reg_value &value)
 {
-    std::wstring subkey(L"SOFTWARE\\");
-    subkey += to_wide(g_config->organization);
-    subkey += L"\\";
-    subkey += to_wide(g_config->application);
+    const auto subkey = app_subkey();
 
     auto wide_name = to_wide(value_name);
     DWORD dwType = 0;
@@ -288,10 +353,7 @@ bool set_reg_value(const std::string &value_name, const reg_value &value)
 
 bool delete_reg_value(const std::string &value_name)
 {
-    std::wstring subkey(L"SOFTWARE\\");
-    subkey += to_wide(g_config->organization);
-    subkey += L"\\";
-    subkey += to_wide(g_config->application);
+    const auto subkey = app_subkey();
 
     auto wide_name = to_wide(value_name);
     auto r = RegDeleteKeyValueW(HKEY_CURRENT_USER, subkey.c_str(), wide_name.c_str());
@@ -11,16 +11,25 @@
  *
  **************************************************************************************************/
 #pragma once
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <iterator>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #if defined(_WIN32) || defined(_WIN64) || defined(__WIN32__) || defined(__TOS_WIN__) || defined(__WINDOWS__)
 // Windows 平台
 #define KAIXIN_OS_WINDOWS
 #include <variant>
+#elif defined(__unix__) || defined(__APPLE__)
+// POSIX 平台：事件循环、连接与 DNS 缓存等可以编译和测试；不在本地保存令牌与 TLS 会话，
+// 设备指纹不含硬件信息。
+#define KAIXIN_OS_POSIX
 #else
-// 其它平台没测试过，暂不支持。
 #error "Unsupported platform."
 #endif
 
@@ -36,16 +45,6 @@
 namespace utils {
 
 
-/*!
- * \brief       生成随机二进制数据。
- *
- * \param[in]   length      要生成的数据长度，以字节为单位。
- *
- * \return      以十六进制字符串表示的二进制数据，长度为 lenght * 2。
- */
-std::string generate_random_hex_string(size_t length);
-
-
 /*!
  * \brief       将二进制数据转换为十六进制字符串。
  *
@@ -84,6 +83,16 @@ inline constexpr int64_t get_timestamp_ms()
 }
 
 
+/*!
+ * \brief       分析 HTTP 日期（IMF-fixdate），例如“Sun, 06 Nov 1994 08:49:37 GMT”。
+ *
+ * \param[in]   s           日期字符串
+ *
+ * \return      UNIX 时间；如果格式不正确，则返回零。
+ */
+time_t parse_http_date(const std::string &s);
+
+
 /*!
  * \brief       判断字符串是否为空。
  *
@@ -12,20 +12,39 @@
  **************************************************************************************************/
 #include "websocket_client.h"
 
+#include <algorithm>
 #include <chrono>
-#include <ixwebsocket/IXWebSocket.h>
+#include <deque>
+#include <ixwebsocket/IXHttpClient.h>
 #include <ixwebsocket/IXUrlParser.h>
 #include <rapidjson/ostreamwrapper.h>
 #include <rapidjson/writer.h>
 
+#include "json_arena.h"
 #include "kaixin_api.h"
 #include "kaixin_version.h"
 #include "logger.h"
+#include "nonce_pool.h"
 #include "rapidjsonhelpers.h"
+#include "server_clock.h"
 #include "simple_timer.h"
 #include "utils.h"
+#include "worker_pool.h"
 
 using std::placeholders::_1;
+using std::placeholders::_2;
+
+
+/// 尚未交给用户回调的通知。
+struct websocket_client::notification_queue
+{
+    std::mutex mutex;
+    std::deque<std::string> actions;            ///< 通知的动作，按收到的顺序
+    kaixin_notification_callback_t callback;
+    void *user_data;
+    bool delivering = false;                    ///< 是否已投递交付任务
+    bool closed = false;                        ///< 客户端已析构，不再交付
+};
 
 
 static std::string get_host(const std::string &url)
@@ -57,15 +76,18 @@ static inline void write_array(W &w, const K &key, const V &value)
 
 
 websocket_client::websocket_client(kaixin_notification_callback_t callback, void *user_data)
-    : ws_(nullptr)
-    , heartbeat_timer_(nullptr)
-    , restart_timer_(nullptr)
-    , callback_(callback)
-    , user_data_(user_data)
+    : heartbeat_timer_(nullptr)
+    , restart_timer_(0)
+    , tasks_(0)
+    , notifications_(std::make_shared<notification_queue>())
+    , stopping_(false)
+    , ctx_(kaixin::call_context::current_explicit())
+    , config_(kaixin::current_config())
     , seq_(0)
     , reg_seq_(-1)
     , dereg_seq_(-1)
     , registered_(false)
+    , aborted_(false)
 {
     assert(callback != nullptr);
 
@@ -76,53 +98,88 @@ websocket_client::websocket_client(kaixin_notification_callback_t callback, void
     handlers_.emplace("OS", std::bind(&websocket_client::on_flow_control, this, _1));
     handlers_.emplace("CR", std::bind(&websocket_client::on_life_cycle, this, _1));
 
-    create_socket();
+    notifications_->callback = callback;
+    notifications_->user_data = user_data;
+
+    LD() << "Creating socket.";
+    ws_ = kaixin::websocket_connection::create(get_host(config_->base_url), 8080, "/",
+                                               std::bind(&websocket_client::on_event, this, _1, _2));
+    ws_->start();
 }
 
 
 websocket_client::~websocket_client()
 {
-    if (registered_)
+    kaixin::timer_wheel::timer_id restart_timer;
+
+    {
+        std::lock_guard lock(tasks_mutex_);
+        stopping_ = true;
+        restart_timer = restart_timer_;
+    }
+
+    {
+        // 丢弃尚未交付的通知；正在执行的用户回调不等待，它可能正在注销通知
+        std::lock_guard lock(notifications_->mutex);
+        notifications_->closed = true;
+        notifications_->actions.clear();
+    }
+
+    // 不持有锁：取消时等待正在执行的时间轮回调，而回调投递任务时要加锁
+    kaixin::event_loop::instance().timers().cancel(restart_timer);
+
     {
-        // 注销下行通知
+        // 等待已投递的重连结束，之后不会再有任务重新启动连接
+        std::unique_lock lock(tasks_mutex_);
+        tasks_cond_.wait(lock, [this] { return tasks_ == 0; });
+    }
+
+    const auto ctx = kaixin::call_context::current();
+
+    if (registered_ && !ctx.is_done())
+    {
+        // 注销下行通知，最多等待 5 秒或直到调用截止时间
         LD() << "Deregistering notifications.";
+        std::unique_lock lock(mutex_);
         dereg_seq_ = del("/notification", {}, {}, { {"x-ca-websocket_api_type", "UNREGISTER"} });
 
-        using namespace std::chrono_literals;
-        std::unique_lock lock(mutex_);
-        cond_.wait_for(lock, 5s);
+        if (dereg_seq_ >= 0)
+        {
+            using namespace std::chrono_literals;
+            const auto until = std::min(kaixin::call_context::clock::now() + 5s, ctx.deadline());
+            cond_.wait_until(lock, until, [this] { return !registered_; });
+        }
     }
 
-    ws_->stop();
-    delete ws_;
-    delete heartbeat_timer_;
-    delete restart_timer_;
-}
-
+    {
+        // 先停止心跳，它在事件循环线程中直接使用套接字
+        std::lock_guard lock(mutex_);
+        delete heartbeat_timer_;
+        heartbeat_timer_ = nullptr;
+    }
 
-void websocket_client::create_socket()
-{
-    LD() << "Creating socket.";
-    delete ws_;
-    ws_ = new ix::WebSocket;
-    //ws_->setExtraHeaders({ {"User-Agent", "kaixin-native/" KAIXIN_VERSION_STRING } });
-    ws_->setUrl("ws://" + get_host(g_config->base_url) + ":8080/");
-    ws_->setOnMessageCallback(std::bind(&websocket_client::on_message_callback, this, _1));
-    ws_->start();
+    // 不持有 `mutex_`：停止时等待连接正在执行的回调返回，而回调要加锁
+    ws_->stop();
 }
 
 
-void websocket_client::on_message_callback(const ix::WebSocketMessagePtr &msg)
+// 连接成功与失败在工作线程中调用，其它事件在事件循环线程中调用，不能阻塞
+void websocket_client::on_event(kaixin::websocket_connection::event type, const std::string &data)
 {
+    using event = kaixin::websocket_connection::event;
     std::lock_guard lock(mutex_);
 
-    switch (msg->type)
+    switch (type)
     {
-    case ix::WebSocketMessageType::Open:
+    case event::open:
         {
             LD() << "Socket connected.";
-            delete restart_timer_;
-            restart_timer_ = nullptr;
+
+            if (registration_cancelled())
+            {
+                ws_->close();
+                break;
+            }
 
             // 命令字：RG
             // 含义：在API网关注册长连接，携带DeviceId
@@ -131,38 +188,41 @@ void websocket_client::on_message_callback(const ix::WebSocketMessagePtr &msg)
             // 格式：RG#DeviceId
             // 示例：RG#ffd3234343dae324342@12344133
             std::string rg("RG#");
-            rg += utils::generate_random_hex_string(16);
+            rg += kaixin::nonce_pool::local().generate();
             rg += "@";
-            rg += g_config->app_key;
+            rg += config_->app_key;
             LD() << rg;
-            ws_->sendText(rg);
+            ws_->send_text(rg);
         }
         break;
 
-    case ix::WebSocketMessageType::Close:
+    case event::close:
         LD() << "Socket disconnected.";
         delete heartbeat_timer_;
         heartbeat_timer_ = nullptr;
         break;
 
-    case ix::WebSocketMessageType::Message:
+    case event::message:
         {
-            auto cmd = msg->str.substr(0, 2);
+            auto cmd = data.substr(0, 2);
             auto iter = handlers_.find(cmd);
 
             if (iter != handlers_.end())
             {
-                iter->second(msg->str.substr(2));
+                iter->second(data.substr(2));
             }
             else
             {
-                handle_response(msg->str);
+                handle_response(data);
             }
         }
         break;
 
-    case ix::WebSocketMessageType::Error:
-        LE() << "Socket error:" << msg->errorInfo.http_status << msg->errorInfo.reason;
+    case event::error:
+        LE() << "Socket error:" << data;
+
+        // 注册前连接失败时，如果调用已被取消或超时，则不再重连
+        registration_cancelled();
         break;
     }
 }
@@ -183,9 +243,15 @@ void websocket_client::on_register_device_succeeded(const std::string_view &arg)
     // 开启心跳计时
     assert(heartbeat_timer_ == nullptr);
     heartbeat_timer_ = new simple_timer;
-    heartbeat_timer_->set_timeout_callback(std::bind(&websocket_client::heartbeat, this));
+    heartbeat_timer_->set_timeout_callback([this] { heartbeat(); });
     heartbeat_timer_->start(interval);
 
+    if (registration_cancelled())
+    {
+        ws_->close();
+        return;
+    }
+
     // 注册下行通知
     LI() << "Registering notifications.";
     reg_seq_ = post("/notification", {}, {}, { { "x-ca-websocket_api_type", "REGISTER" } });
@@ -219,7 +285,7 @@ void websocket_client::on_notify(const std::string_view &arg)
     // 命令类型：应答
     // 发送端：客户端
     // 没有其他参数，直接发送命令字
-    ws_->sendText("NO");
+    ws_->send_text("NO");
 
     // 命令字：NF
     // 含义：API网关发送下行通知请求
@@ -229,14 +295,16 @@ void websocket_client::on_notify(const std::string_view &arg)
     // 示例：NF#HELLO WORLD!
     if (arg.length() > 1)
     {
-        rapidjson::Document doc;
+        json_arena arena;
+        auto &doc = arena.document();
         doc.ParseInsitu(const_cast<char *>(arg.data() + 1));
 
         if (!doc.HasParseError() && doc.IsObject())
         {
-            kaixin_notification_arguments_t args;
-            rapidjson::get(args.action, doc, "action");
-            callback_(&args, user_data_);
+            // 用户的回调可能阻塞，不在事件循环线程中调用
+            const char *action = nullptr;
+            rapidjson::get(action, doc, "action");
+            notify(action != nullptr ? action : "");
         }
     }
 }
@@ -273,29 +341,87 @@ void websocket_client::heartbeat()
     // 命令类型：请求
     // 发送端：客户端
     // 没有其他参数，直接发送命令字
-    std::lock_guard lock(mutex_);
-    ws_->sendText("H1");
+    // 在事件循环线程中执行：发送不阻塞，也不等待 `mutex_`，心跳不会被其它回调推迟
+    ws_->send_text("H1");
 }
 
 
-std::string websocket_client::make_request(const std::string &verb, const std::string &path,
-                                           const ix::WebSocketHttpHeaders &queries,
-                                           const ix::WebSocketHttpHeaders &body,
-                                           const ix::WebSocketHttpHeaders &headers)
+void websocket_client::notify(std::string action)
 {
-    if (ws_ == nullptr || ws_->getReadyState() != ix::ReadyState::Open)
     {
-        create_socket();
+        std::lock_guard lock(notifications_->mutex);
+
+        if (notifications_->closed)
+        {
+            return;
+        }
+
+        notifications_->actions.push_back(std::move(action));
+
+        if (notifications_->delivering)
+        {
+            // 正在交付的任务会依次交付
+            return;
+        }
+
+        notifications_->delivering = true;
     }
 
-    auto now = utils::get_timestamp_ms();
+    const bool posted = worker_pool::instance().post([queue = notifications_]
+    {
+        deliver_notifications(queue);
+    });
+
+    if (!posted)
+    {
+        // 工作线程池正在停止，丢弃通知
+        std::lock_guard lock(notifications_->mutex);
+        notifications_->delivering = false;
+        notifications_->actions.clear();
+    }
+}
+
+
+// 注册完成前，判断调用是否已被取消或超时；如果是，则停止自动重连
+bool websocket_client::registration_cancelled()
+{
+    if (aborted_)
+    {
+        return true;
+    }
+
+    if (registered_ || !ctx_.is_done())
+    {
+        return false;
+    }
+
+    LW() << (ctx_.is_cancelled() ? "Notification registration cancelled."
+                                 : "Notification registration timed out.");
+    aborted_ = true;
+    ws_->disable_automatic_reconnection();
+    return true;
+}
+
+
+std::string websocket_client::make_request(const std::string &verb, const std::string &path,
+                                           const kaixin::param_list &queries,
+                                           const kaixin::param_list &body,
+                                           const ix::WebSocketHttpHeaders &headers)
+{
+    // 在创建者的上下文中签名，可能在工作线程或事件循环线程中调用
+    kaixin::config_scope scope(config_);
+    auto now = kaixin::server_clock::instance().now_ms();
+    const auto creds = kaixin::current_credentials();
+    const std::string empty;
+    const auto &access_token = creds ? creds->access_token : empty;
+    const auto &id_token = creds ? creds->id_token : empty;
     std::ostringstream oss;
     rapidjson::OStreamWrapper buffer(oss);
     rapidjson::Writer<rapidjson::OStreamWrapper> w(buffer);
     w.StartObject();
     {
         write(w, "method", verb);
-        write(w, "host", get_host(g_config->base_url));
+        write(w, "host", get_host(config_->base_url));
         write(w, "path", path);
 
         w.Key("querys");
@@ -303,10 +429,10 @@ std::string websocket_client::make_request(const std::string &verb, const std::s
         {
             // 设置公共参数：a、k、t、z
             auto params = queries;
-            params.emplace("a", g_config->access_token);
-            params.emplace("k", g_config->app_key);
+            params.emplace("a", access_token);
+            params.emplace("k", config_->app_key);
             params.emplace("t", std::to_string(now));
-            params.emplace("z", utils::generate_random_hex_string(16));
+            params.emplace("z", kaixin::nonce_pool::local().generate());
 
             // 签名
             params.emplace("s", kaixin::sign(verb, path, params, body));
@@ -332,7 +458,7 @@ std::string websocket_client::make_request(const std::string &verb, const std::s
             write_array(w, "x-ca-seq", std::to_string(seq_++));
 
             // 设置认证头
-            write(w, "authorization", "Bearer " + g_config->id_token);
+            write(w, "authorization", "Bearer " + id_token);
         }
         w.Key("isBase64");
         w.Int(0);
@@ -345,30 +471,29 @@ std::string websocket_client::make_request(const std::string &verb, const std::s
 }
 
 
-int websocket_client::post(const std::string &path, const ix::WebSocketHttpHeaders &queries,
-                           const ix::WebSocketHttpHeaders &body,
+int websocket_client::post(const std::string &path, const kaixin::param_list &queries,
+                           const kaixin::param_list &body,
                            const ix::WebSocketHttpHeaders &headers)
 {
     auto req = make_request(ix::HttpClient::kPost, path, queries, body, headers);
-    ws_->sendText(req);
-    return seq_ - 1;
+    return ws_->send_text(req) ? seq_ - 1 : -1;
 }
 
 
-int websocket_client::del(const std::string &path, const ix::WebSocketHttpHeaders &queries,
-                          const ix::WebSocketHttpHeaders &body,
+int websocket_client::del(const std::string &path, const kaixin::param_list &queries,
+                          const kaixin::param_list &body,
                           const ix::WebSocketHttpHeaders &headers)
 {
     auto req = make_request("DELETE", path, queries, body, headers);
-    ws_->sendText(req);
-    return seq_ - 1;
+    return ws_->send_text(req) ? seq_ - 1 : -1;
 }
 
 
 void websocket_client::handle_response(const std::string &json)
 {
     using rapidjson::get;
-    rapidjson::Document doc;
+    json_arena arena;
+    auto &doc = arena.document();
     doc.ParseInsitu(const_cast<char *>(json.c_str()));
 
     if (doc.HasParseError())
@@ -398,21 +523,91 @@ void websocket_client::handle_response(const std::string &json)
 }
 
 
+// 在工作线程中执行。不持有 `mutex_`：停止时等待连接正在执行的回调返回，而回调要加锁
 void websocket_client::restart()
 {
     LD() << "Restarting.";
     ws_->stop();
     ws_->start();
+
+    std::lock_guard lock(tasks_mutex_);
+    restart_timer_ = 0;
 }
 
 
+// 在连接的回调中调用，稍后重连；重连完成前再次调用时忽略
 void websocket_client::restart_later()
 {
-    if (restart_timer_ == nullptr)
+    std::lock_guard lock(tasks_mutex_);
+
+    if (stopping_ || restart_timer_ != 0)
     {
-        restart_timer_ = new simple_timer;
-        restart_timer_->set_timeout_callback(std::bind(&websocket_client::restart, this));
-        restart_timer_->set_single_shot(true);
-        restart_timer_->start(20);
+        return;
+    }
+
+    using namespace std::chrono_literals;
+    restart_timer_ = kaixin::event_loop::instance().timers().schedule(20ms, [this]
+    {
+        post_task([this] { restart(); });
+    });
+}
+
+
+void websocket_client::post_task(std::function<void()> task)
+{
+    {
+        std::lock_guard lock(tasks_mutex_);
+
+        if (stopping_)
+        {
+            return;
+        }
+
+        tasks_++;
+    }
+
+    // 走后台通道，不会排在阻塞的用户请求之后
+    const bool posted = worker_pool::instance().post([this, task = std::move(task)]
+    {
+        task();
+
+        std::lock_guard lock(tasks_mutex_);
+        tasks_--;
+        tasks_cond_.notify_all();
+    }, worker_pool::lane::system);
+
+    if (!posted)
+    {
+        // 工作线程池正在停止，丢弃任务
+        std::lock_guard lock(tasks_mutex_);
+        tasks_--;
+        tasks_cond_.notify_all();
+    }
+}
+
+
+// 在工作线程中执行，不引用客户端：回调中可以注销通知
+void websocket_client::deliver_notifications(const std::shared_ptr<notification_queue> &queue)
+{
+    while (true)
+    {
+        std::string action;
+
+        {
+            std::lock_guard lock(queue->mutex);
+
+            if (queue->closed || queue->actions.empty())
+            {
+                queue->delivering = false;
+                return;
+            }
+
+            action = std::move(queue->actions.front());
+            queue->actions.pop_front();
+        }
+
+        kaixin_notification_arguments_t args;
+        args.action = action.c_str();
+        queue->callback(&args, queue->user_data);
     }
 }
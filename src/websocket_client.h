@@ -15,14 +15,18 @@
 
 #include <functional>
 #include <map>
+#include <memory>
 #include <thread>
 #include <ixwebsocket/IXHttp.h>
-#include <ixwebsocket/IXWebSocketMessage.h>
 
+#include "call_context.h"
 #include "kaixin.h"
+#include "param_list.h"
+#include "timer_wheel.h"
+#include "websocket_connection.h"
 
-namespace ix {
-class WebSocket;
+namespace kaixin {
+struct Config;
 }
 
 class simple_timer;
@@ -30,6 +34,18 @@ class simple_timer;
 
 /*!
  * \brief       WebSocket 客户端类。
+ *
+ * 创建时记录调用者为本次调用明确设置的超时、截止时间与取消令牌，不使用默认超时。注册完成前，
+ * 如果调用被取消或超时，则不再发送注册命令，并停止自动重连；没有明确设置时一直重连，
+ * 直到注册成功。
+ *
+ * 连接是 `kaixin::websocket_connection`，套接字注册在事件循环中，消息在循环线程中处理；
+ * 处理时只持有 `mutex_`，不阻塞。用户的通知回调可能阻塞，按收到的顺序投递到 `worker_pool`
+ * 的用户通道依次执行；交付任务不引用本对象，回调中可以注销通知，析构时丢弃尚未交付的通知。
+ *
+ * 计时器回调在事件循环线程中执行。心跳直接在回调中发送：发送不阻塞，也不加 `mutex_`，不会被
+ * 其它回调推迟。重连要等待连接正在执行的回调返回，不能在事件循环线程或连接的回调中进行，
+ * 投递到 `worker_pool` 的后台通道。
  */
 class websocket_client : private noncopyable
 {
@@ -38,8 +54,9 @@ public:
     ~websocket_client();
 
 private:
-    void create_socket();
-    void on_message_callback(const ix::WebSocketMessagePtr &msg);
+    struct notification_queue;
+
+    void on_event(kaixin::websocket_connection::event type, const std::string &data);
 
     void on_register_device_succeeded(const std::string_view &arg);
     void on_register_device_failed(const std::string_view &arg);
@@ -50,32 +67,49 @@ private:
 
     void heartbeat();
 
+    // 把通知交给用户的回调，按收到的顺序在工作线程中调用
+    void notify(std::string action);
+
+    bool registration_cancelled();
+
     std::string make_request(const std::string &verb, const std::string &path,
-                             const ix::WebSocketHttpHeaders &queries,
-                             const ix::WebSocketHttpHeaders &body,
+                             const kaixin::param_list &queries,
+                             const kaixin::param_list &body,
                              const ix::WebSocketHttpHeaders &headers);
-    int post(const std::string &path, const ix::WebSocketHttpHeaders &queries,
-             const ix::WebSocketHttpHeaders &body, const ix::WebSocketHttpHeaders &headers);
-    int del(const std::string &path, const ix::WebSocketHttpHeaders &queries,
-            const ix::WebSocketHttpHeaders &body, const ix::WebSocketHttpHeaders &headers);
+    int post(const std::string &path, const kaixin::param_list &queries,
+             const kaixin::param_list &body, const ix::WebSocketHttpHeaders &headers);
+    int del(const std::string &path, const kaixin::param_list &queries,
+            const kaixin::param_list &body, const ix::WebSocketHttpHeaders &headers);
 
     void handle_response(const std::string &json);
 
     void restart();
     void restart_later();
 
+    // 把任务投递到工作线程的后台通道；正在析构时丢弃
+    void post_task(std::function<void()> task);
+
+    // 在工作线程中按顺序调用用户的通知回调，直到队列为空
+    static void deliver_notifications(const std::shared_ptr<notification_queue> &queue);
+
 private:
     using command_handler = std::function<void(const std::string_view &)>;
     std::map<std::string, command_handler> handlers_;
     std::mutex mutex_;
     std::condition_variable cond_;
-    ix::WebSocket *ws_;
+    std::shared_ptr<kaixin::websocket_connection> ws_;
     simple_timer *heartbeat_timer_;
-    simple_timer *restart_timer_;
-    kaixin_notification_callback_t callback_;
-    void *user_data_;
+    std::mutex tasks_mutex_;                    ///< 保护重连定时器、任务个数与析构标志；可以在持有 `mutex_` 时加锁，反之不行
+    std::condition_variable tasks_cond_;        ///< 已投递的任务结束
+    kaixin::timer_wheel::timer_id restart_timer_;   ///< 待执行或进行中的重连
+    int tasks_;                                 ///< 已投递、尚未结束的任务个数
+    std::shared_ptr<notification_queue> notifications_;     ///< 尚未交给用户回调的通知，与交付任务共享
+    bool stopping_;                             ///< 是否正在析构
+    kaixin::call_context ctx_;
+    kaixin::Config *config_;
     int seq_;
     int reg_seq_;
     int dereg_seq_;
     bool registered_;
+    bool aborted_;
 };
@@ -0,0 +1,806 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        websocket_connection.cpp
+ * \brief       websocket_connection 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "websocket_connection.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+
+#include "connection_pool.h"
+#include "logger.h"
+#include "tcp_socket.h"
+#include "worker_pool.h"
+
+
+namespace kaixin {
+
+
+/// 升级响应头的最大长度。
+static constexpr size_t MAX_HEADER_SIZE = 16 * 1024;
+
+/// 计算 `Sec-WebSocket-Accept` 时拼接在密钥之后的 GUID（RFC 6455）。
+static constexpr char WEBSOCKET_GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+/// 帧的操作码。
+enum opcode : uint8_t
+{
+    OP_CONTINUATION = 0x0,
+    OP_TEXT = 0x1,
+    OP_BINARY = 0x2,
+    OP_CLOSE = 0x8,
+    OP_PING = 0x9,
+    OP_PONG = 0xA,
+};
+
+/// 正常关闭的关闭帧负载：状态码 1000。
+static const std::string NORMAL_CLOSURE("\x03\xe8", 2);
+
+
+// 标准 Base64 编码，带填充
+static std::string base64_encode(const unsigned char *data, size_t length)
+{
+    std::string out(((length + 2) / 3) * 4 + 1, '\0');
+    const auto n = EVP_EncodeBlock(reinterpret_cast<unsigned char *>(out.data()), data,
+                                   static_cast<int>(length));
+    out.resize(static_cast<size_t>(n));
+    return out;
+}
+
+
+std::shared_ptr<websocket_connection> websocket_connection::create(const std::string &host, int port,
+                                                                   const std::string &path,
+                                                                   event_handler handler)
+{
+    return std::shared_ptr<websocket_connection>(
+        new websocket_connection(host, port, path, std::move(handler)));
+}
+
+
+websocket_connection::websocket_connection(const std::string &host, int port, const std::string &path,
+                                           event_handler handler)
+    : host_(host)
+    , port_(port)
+    , path_(path)
+    , handler_(std::move(handler))
+    , generation_(0)
+    , watch_(0)
+    , retry_timer_(0)
+    , retries_(0)
+    , delivering_(0)
+    , running_(false)
+    , auto_reconnect_(false)
+    , want_write_(false)
+{
+}
+
+
+websocket_connection::~websocket_connection()
+{
+    stop();
+}
+
+
+void websocket_connection::start()
+{
+    uint64_t generation = 0;
+
+    {
+        std::lock_guard lock(mutex_);
+
+        if (running_)
+        {
+            return;
+        }
+
+        running_ = true;
+        auto_reconnect_ = true;
+        retries_ = 0;
+        generation = generation_;
+    }
+
+    // 连接与握手会阻塞，在后台通道中执行
+    worker_pool::instance().post([self = shared_from_this(), generation]
+    {
+        self->connect(generation);
+    }, worker_pool::lane::system);
+}
+
+
+void websocket_connection::stop()
+{
+    event_loop::watch_id watch = 0;
+    std::unique_ptr<tcp_socket> socket;
+    timer_wheel::timer_id timer = 0;
+
+    {
+        std::lock_guard lock(mutex_);
+        ++generation_;
+        running_ = false;
+        auto_reconnect_ = false;
+
+        if (socket_)
+        {
+            // 尽量通知服务端正常关闭，不等待应答
+            send_frame(OP_CLOSE, NORMAL_CLOSURE);
+        }
+
+        socket = teardown(watch);
+        timer = retry_timer_;
+        retry_timer_ = 0;
+    }
+
+    // 不持有锁：取消与注销时等待正在执行的回调返回，而回调要加锁
+    event_loop::instance().timers().cancel(timer);
+    release(watch, std::move(socket));
+
+    std::unique_lock lock(mutex_);
+    delivered_.wait(lock, [this] { return delivering_ == 0; });
+}
+
+
+bool websocket_connection::send_text(const std::string &text)
+{
+    std::lock_guard lock(mutex_);
+
+    if (!socket_)
+    {
+        return false;
+    }
+
+    if (!send_frame(OP_TEXT, text))
+    {
+        // 连接已不可用，在循环线程中断开
+        std::weak_ptr<websocket_connection> weak = shared_from_this();
+        event_loop::instance().post([weak, generation = generation_.load()]
+        {
+            if (auto self = weak.lock())
+            {
+                self->disconnect(generation);
+            }
+        });
+        return false;
+    }
+
+    return true;
+}
+
+
+void websocket_connection::close()
+{
+    std::lock_guard lock(mutex_);
+
+    if (!socket_)
+    {
+        return;
+    }
+
+    send_frame(OP_CLOSE, NORMAL_CLOSURE);
+
+    // 回调可能持有调用者的锁，在循环线程中断开并通知
+    std::weak_ptr<websocket_connection> weak = shared_from_this();
+    event_loop::instance().post([weak, generation = generation_.load()]
+    {
+        if (auto self = weak.lock())
+        {
+            self->disconnect(generation);
+        }
+    });
+}
+
+
+void websocket_connection::disable_automatic_reconnection()
+{
+    std::lock_guard lock(mutex_);
+    auto_reconnect_ = false;
+}
+
+
+void websocket_connection::connect(uint64_t generation)
+{
+    if (generation_ != generation)
+    {
+        return;
+    }
+
+    const auto deadline = clock::now() + CONNECT_TIMEOUT;
+    const std::function<bool()> cancelled = [this, generation, deadline]
+    {
+        return generation_ != generation || clock::now() >= deadline;
+    };
+
+    std::string error;
+    std::string leftover;
+    bool reused = false;
+    bool early_data_accepted = false;
+    auto socket = connection_pool::instance().acquire(host_, port_, false, false, reused, error,
+                                                      cancelled, {}, early_data_accepted);
+
+    if (socket && !handshake(*socket, leftover, error, cancelled))
+    {
+        socket->close();
+        socket.reset();
+    }
+
+    if (!socket)
+    {
+        if (generation_ == generation)
+        {
+            deliver(generation, event::error, error);
+            schedule_retry(generation);
+        }
+
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+
+        if (generation_ != generation)
+        {
+            socket->close();
+            return;
+        }
+
+        // 新的连接作废上一个连接遗留的事件
+        generation = ++generation_;
+        socket_ = std::move(socket);
+        inbox_ = std::move(leftover);
+        retries_ = 0;
+    }
+
+    deliver(generation, event::open, {});
+
+    // 打开的回调之后才注册，循环线程中的消息不会先于打开事件
+    std::unique_lock lock(mutex_);
+
+    if (generation_ != generation || !socket_)
+    {
+        return;
+    }
+
+    std::weak_ptr<websocket_connection> weak = shared_from_this();
+    auto &loop = event_loop::instance();
+    want_write_ = !outbox_.empty();
+    watch_ = loop.add(socket_->fd(), event_loop::READABLE | (want_write_ ? event_loop::WRITABLE : 0),
+                      [weak, generation](uint32_t events)
+    {
+        if (auto self = weak.lock())
+        {
+            self->on_io(generation, events);
+        }
+    });
+
+    if (watch_ == 0)
+    {
+        event_loop::watch_id watch = 0;
+        auto closed = teardown(watch);
+        lock.unlock();
+        release(watch, std::move(closed));
+        deliver(generation, event::close, {});
+        schedule_retry(generation);
+        return;
+    }
+
+    if (!inbox_.empty())
+    {
+        // 握手时多读到的帧不会再触发可读
+        loop.post([weak, generation]
+        {
+            if (auto self = weak.lock())
+            {
+                self->on_io(generation, 0);
+            }
+        });
+    }
+}
+
+
+bool websocket_connection::handshake(tcp_socket &socket, std::string &leftover, std::string &error,
+                                     const std::function<bool()> &cancelled)
+{
+    unsigned char nonce[16];
+
+    if (RAND_bytes(nonce, sizeof(nonce)) != 1)
+    {
+        error = "Cannot generate WebSocket key";
+        return false;
+    }
+
+    const auto key = base64_encode(nonce, sizeof(nonce));
+    std::string req("GET ");
+    req += path_;
+    req += " HTTP/1.1\r\nHost: ";
+    req += host_;
+    req += ':';
+    req += std::to_string(port_);
+    req += "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: ";
+    req += key;
+    req += "\r\nSec-WebSocket-Version: 13\r\n\r\n";
+
+    if (!socket.write_all(req, cancelled))
+    {
+        error = "Cannot send WebSocket upgrade request";
+        return false;
+    }
+
+    std::string response;
+    std::array<char, 4096> buffer;
+    size_t end = 0;
+
+    while ((end = response.find("\r\n\r\n")) == std::string::npos)
+    {
+        if (response.length() > MAX_HEADER_SIZE)
+        {
+            error = "WebSocket upgrade response too large";
+            return false;
+        }
+
+        const auto n = socket.recv(buffer.data(), buffer.size());
+
+        if (n > 0)
+        {
+            response.append(buffer.data(), static_cast<size_t>(n));
+        }
+        else if (n == 0 || !ix::Socket::isWaitNeeded())
+        {
+            error = "Connection closed during WebSocket handshake";
+            return false;
+        }
+        else if (!socket.wait(event_loop::READABLE, cancelled))
+        {
+            error = "WebSocket handshake timed out";
+            return false;
+        }
+    }
+
+    leftover = response.substr(end + 4);
+    response.resize(end);
+
+    // 状态行
+    auto line_end = response.find("\r\n");
+    const auto status = response.substr(0, line_end);
+
+    if (status.compare(0, 12, "HTTP/1.1 101") != 0)
+    {
+        error = "WebSocket upgrade failed: " + status;
+        return false;
+    }
+
+    // 校验 Sec-WebSocket-Accept
+    unsigned char digest[SHA_DIGEST_LENGTH];
+    const auto accept_key = key + WEBSOCKET_GUID;
+    SHA1(reinterpret_cast<const unsigned char *>(accept_key.data()), accept_key.length(), digest);
+    const auto expected = base64_encode(digest, sizeof(digest));
+
+    while (line_end != std::string::npos)
+    {
+        const auto begin = line_end + 2;
+        line_end = response.find("\r\n", begin);
+        const auto line = response.substr(begin, line_end - begin);
+        const auto colon = line.find(':');
+
+        if (colon == std::string::npos)
+        {
+            continue;
+        }
+
+        auto name = line.substr(0, colon);
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+
+        if (name != "sec-websocket-accept")
+        {
+            continue;
+        }
+
+        auto value_begin = line.find_first_not_of(" \t", colon + 1);
+        auto value_end = line.find_last_not_of(" \t");
+
+        if (value_begin != std::string::npos
+            && line.compare(value_begin, value_end + 1 - value_begin, expected) == 0)
+        {
+            return true;
+        }
+
+        break;
+    }
+
+    error = "WebSocket upgrade failed: invalid Sec-WebSocket-Accept";
+    return false;
+}
+
+
+void websocket_connection::on_io(uint64_t generation, uint32_t events)
+{
+    std::array<char, 16 * 1024> buffer;
+    std::vector<std::string> messages;
+    event_loop::watch_id watch = 0;
+    std::unique_ptr<tcp_socket> closed;
+
+    {
+        std::lock_guard lock(mutex_);
+
+        if (generation_ != generation || !socket_)
+        {
+            return;
+        }
+
+        bool alive = true;
+
+        if (events & (event_loop::READABLE | event_loop::FAILED))
+        {
+            while (true)
+            {
+                const auto n = socket_->recv(buffer.data(), buffer.size());
+
+                if (n > 0)
+                {
+                    inbox_.append(buffer.data(), static_cast<size_t>(n));
+                    continue;
+                }
+
+                alive = (n < 0 && ix::Socket::isWaitNeeded());
+                break;
+            }
+        }
+
+        // 断开前收到的完整消息仍然交付；之后发送应答与写阻塞时未发完的数据
+        alive = parse_frames(messages) && alive;
+        alive = alive && flush();
+
+        if (!alive)
+        {
+            closed = teardown(watch);
+        }
+    }
+
+    for (const auto &message : messages)
+    {
+        deliver(generation, event::message, message);
+    }
+
+    if (closed)
+    {
+        release(watch, std::move(closed));
+        deliver(generation, event::close, {});
+        schedule_retry(generation);
+    }
+}
+
+
+void websocket_connection::disconnect(uint64_t generation)
+{
+    event_loop::watch_id watch = 0;
+    std::unique_ptr<tcp_socket> closed;
+
+    {
+        std::lock_guard lock(mutex_);
+
+        if (generation_ != generation || !socket_)
+        {
+            return;
+        }
+
+        closed = teardown(watch);
+    }
+
+    release(watch, std::move(closed));
+    deliver(generation, event::close, {});
+    schedule_retry(generation);
+}
+
+
+bool websocket_connection::parse_frames(std::vector<std::string> &messages)
+{
+    const auto *data = reinterpret_cast<const uint8_t *>(inbox_.data());
+    const auto size = inbox_.size();
+    size_t offset = 0;
+    bool alive = true;
+
+    while (alive && size - offset >= 2)
+    {
+        const auto *p = data + offset;
+        const bool fin = (p[0] & 0x80) != 0;
+        const auto op = static_cast<uint8_t>(p[0] & 0x0F);
+        const bool masked = (p[1] & 0x80) != 0;
+        uint64_t length = p[1] & 0x7F;
+        size_t header = 2;
+
+        if (length == 126)
+        {
+            if (size - offset < 4)
+            {
+                break;
+            }
+
+            length = (static_cast<uint64_t>(p[2]) << 8) | p[3];
+            header = 4;
+        }
+        else if (length == 127)
+        {
+            if (size - offset < 10)
+            {
+                break;
+            }
+
+            length = 0;
+
+            for (size_t i = 2; i < 10; i++)
+            {
+                length = (length << 8) | p[i];
+            }
+
+            header = 10;
+        }
+
+        if (length > MAX_MESSAGE_SIZE || fragments_.length() + length > MAX_MESSAGE_SIZE)
+        {
+            LE() << "WebSocket message too large:" << length;
+            return false;
+        }
+
+        const auto mask = p + header;
+        header += masked ? 4 : 0;
+
+        if (size - offset < header + length)
+        {
+            break;
+        }
+
+        std::string payload(reinterpret_cast<const char *>(p + header), static_cast<size_t>(length));
+        offset += header + static_cast<size_t>(length);
+
+        if (masked)
+        {
+            for (size_t i = 0; i < payload.length(); i++)
+            {
+                payload[i] = static_cast<char>(payload[i] ^ mask[i & 3]);
+            }
+        }
+
+        switch (op)
+        {
+        case OP_CONTINUATION:
+            fragments_ += payload;
+
+            if (fin)
+            {
+                messages.push_back(std::move(fragments_));
+                fragments_.clear();
+            }
+            break;
+
+        case OP_TEXT:
+        case OP_BINARY:
+            if (fin)
+            {
+                messages.push_back(std::move(payload));
+            }
+            else
+            {
+                fragments_ = std::move(payload);
+            }
+            break;
+
+        case OP_PING:
+            alive = send_frame(OP_PONG, payload);
+            break;
+
+        case OP_PONG:
+            break;
+
+        case OP_CLOSE:
+            // 回应关闭帧后断开
+            send_frame(OP_CLOSE, payload.substr(0, 2));
+            alive = false;
+            break;
+
+        default:
+            LE() << "Unknown WebSocket opcode:" << static_cast<int>(op);
+            alive = false;
+            break;
+        }
+    }
+
+    inbox_.erase(0, offset);
+    return alive;
+}
+
+
+bool websocket_connection::send_frame(uint8_t opcode, const std::string &payload)
+{
+    if (!socket_)
+    {
+        return false;
+    }
+
+    // 客户端发送的帧必须带掩码
+    std::array<uint8_t, 14> header;
+    size_t n = 0;
+    const uint64_t length = payload.length();
+    header[n++] = static_cast<uint8_t>(0x80 | opcode);
+
+    if (length < 126)
+    {
+        header[n++] = static_cast<uint8_t>(0x80 | length);
+    }
+    else if (length <= 0xFFFF)
+    {
+        header[n++] = 0x80 | 126;
+        header[n++] = static_cast<uint8_t>(length >> 8);
+        header[n++] = static_cast<uint8_t>(length);
+    }
+    else
+    {
+        header[n++] = 0x80 | 127;
+
+        for (int shift = 56; shift >= 0; shift -= 8)
+        {
+            header[n++] = static_cast<uint8_t>(length >> shift);
+        }
+    }
+
+    uint8_t *mask = header.data() + n;
+
+    if (RAND_bytes(mask, 4) != 1)
+    {
+        return false;
+    }
+
+    n += 4;
+
+    const auto start = outbox_.length() + n;
+    outbox_.append(reinterpret_cast<const char *>(header.data()), n);
+    outbox_.append(payload);
+
+    for (size_t i = 0; i < payload.length(); i++)
+    {
+        outbox_[start + i] = static_cast<char>(outbox_[start + i] ^ mask[i & 3]);
+    }
+
+    return flush();
+}
+
+
+bool websocket_connection::flush()
+{
+    size_t sent = 0;
+    bool alive = true;
+
+    while (sent < outbox_.length())
+    {
+        const auto n = socket_->send(outbox_.data() + sent, outbox_.length() - sent);
+
+        if (n > 0)
+        {
+            sent += static_cast<size_t>(n);
+            continue;
+        }
+
+        alive = (n < 0 && ix::Socket::isWaitNeeded());
+        break;
+    }
+
+    outbox_.erase(0, sent);
+
+    if (!alive)
+    {
+        return false;
+    }
+
+    const bool blocked = !outbox_.empty();
+
+    if (watch_ != 0 && blocked != want_write_)
+    {
+        // 写阻塞时等待可写，之后在事件循环中继续发送
+        want_write_ = blocked;
+        event_loop::instance().modify(watch_, event_loop::READABLE | (blocked ? event_loop::WRITABLE : 0));
+    }
+
+    return true;
+}
+
+
+std::unique_ptr<tcp_socket> websocket_connection::teardown(event_loop::watch_id &watch)
+{
+    watch = watch_;
+    watch_ = 0;
+    want_write_ = false;
+    inbox_.clear();
+    fragments_.clear();
+    outbox_.clear();
+    return std::move(socket_);
+}
+
+
+void websocket_connection::release(event_loop::watch_id watch, std::unique_ptr<tcp_socket> socket)
+{
+    // 注销后才关闭，注销前描述符不会被复用
+    event_loop::instance().remove(watch);
+
+    if (socket)
+    {
+        socket->close();
+    }
+}
+
+
+void websocket_connection::schedule_retry(uint64_t generation)
+{
+    std::lock_guard lock(mutex_);
+
+    if (generation_ != generation || !running_ || !auto_reconnect_ || retry_timer_ != 0)
+    {
+        return;
+    }
+
+    const auto delay = std::min<std::chrono::milliseconds>(MIN_RETRY_DELAY * (1 << std::min(retries_, 16)),
+                                                           MAX_RETRY_DELAY);
+    retries_++;
+
+    std::weak_ptr<websocket_connection> weak = shared_from_this();
+    retry_timer_ = event_loop::instance().timers().schedule(delay, [weak, generation]
+    {
+        auto self = weak.lock();
+
+        if (!self)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard lock(self->mutex_);
+            self->retry_timer_ = 0;
+
+            if (self->generation_ != generation || !self->running_ || !self->auto_reconnect_)
+            {
+                return;
+            }
+        }
+
+        worker_pool::instance().post([self, generation]
+        {
+            self->connect(generation);
+        }, worker_pool::lane::system);
+    });
+}
+
+
+void websocket_connection::deliver(uint64_t generation, event type, const std::string &data)
+{
+    {
+        std::lock_guard lock(mutex_);
+
+        if (generation_ != generation)
+        {
+            return;
+        }
+
+        delivering_++;
+    }
+
+    handler_(type, data);
+
+    {
+        std::lock_guard lock(mutex_);
+        delivering_--;
+    }
+
+    delivered_.notify_all();
+}
+
+
+}       // namespace kaixin
@@ -0,0 +1,169 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        websocket_connection.h
+ * \brief       websocket_connection 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "event_loop.h"
+
+class tcp_socket;
+
+
+namespace kaixin {
+
+
+/*!
+ * \brief       WebSocket 客户端连接，套接字注册在 `event_loop` 中。
+ *
+ * 连接与升级握手在 `worker_pool` 的后台通道中执行，等待通过 `io_waiter` 交给事件循环；
+ * 握手成功后套接字注册到事件循环，由循环线程接收与解析帧、回应 ping，写阻塞时在循环线程中
+ * 继续发送。连接断开或失败后按指数退避自动重连，直到 `stop` 或禁用自动重连。
+ *
+ * 事件回调不持有连接的锁，可以在回调中发送或关闭连接：`event::open` 与连接失败的 `event::error`
+ * 在工作线程中调用，其它事件在循环线程中调用，不能阻塞。`stop` 返回后不再调用回调。
+ */
+class websocket_connection : private noncopyable,
+                             public std::enable_shared_from_this<websocket_connection>
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    /// 连接事件。
+    enum class event
+    {
+        open,                                   ///< 握手成功
+        close,                                  ///< 连接断开
+        message,                                ///< 收到完整的消息，参数为消息内容
+        error,                                  ///< 连接或握手失败，参数为错误信息
+    };
+
+    using event_handler = std::function<void(event type, const std::string &data)>;
+
+    /// 连接与升级握手的超时。
+    static constexpr auto CONNECT_TIMEOUT = std::chrono::seconds(60);
+    /// 首次重连的等待时间，之后每次加倍。
+    static constexpr auto MIN_RETRY_DELAY = std::chrono::milliseconds(100);
+    /// 重连的最长等待时间。
+    static constexpr auto MAX_RETRY_DELAY = std::chrono::seconds(10);
+    /// 消息的最大长度，超过时断开连接。
+    static constexpr size_t MAX_MESSAGE_SIZE = 16 * 1024 * 1024;
+
+    /*!
+     * \brief       创建连接，尚未开始连接。
+     *
+     * \param[in]   host        主机名
+     * \param[in]   port        端口
+     * \param[in]   path        请求路径
+     * \param[in]   handler     事件回调函数
+     *
+     * \return      连接。
+     */
+    static std::shared_ptr<websocket_connection> create(const std::string &host, int port,
+                                                        const std::string &path, event_handler handler);
+
+    ~websocket_connection();
+
+    /// 开始连接，并启用自动重连。
+    void start();
+
+    /*!
+     * \brief       关闭连接，停止重连，等待正在执行的回调返回。不能在回调中调用。
+     */
+    void stop();
+
+    /*!
+     * \brief       发送文本消息。不阻塞：套接字写阻塞时在循环线程中继续发送。
+     *
+     * \param[in]   text        消息内容
+     *
+     * \return      如果连接已打开，则返回 `true`；否则返回 `false`。
+     */
+    bool send_text(const std::string &text);
+
+    /// 发送关闭帧并断开连接。启用自动重连时之后仍会重连。
+    void close();
+
+    /// 禁用自动重连，之后连接断开时不再重连，直到再次 `start`。
+    void disable_automatic_reconnection();
+
+private:
+    websocket_connection(const std::string &host, int port, const std::string &path,
+                         event_handler handler);
+
+    // 在工作线程中连接并握手
+    void connect(uint64_t generation);
+
+    // 发送升级请求并校验响应；响应之后已读到的数据放入 `leftover`
+    bool handshake(tcp_socket &socket, std::string &leftover, std::string &error,
+                   const std::function<bool()> &cancelled);
+
+    // 事件循环回调：接收并解析帧，发送写阻塞时未发完的数据
+    void on_io(uint64_t generation, uint32_t events);
+
+    // 在循环线程中断开连接
+    void disconnect(uint64_t generation);
+
+    // 解析 `inbox_` 中的完整帧，消息追加到 `messages`；协议错误或收到关闭帧时返回 `false`。
+    // 调用者持有锁
+    bool parse_frames(std::vector<std::string> &messages);
+
+    // 把帧加入待发送的数据并发送；调用者持有锁
+    bool send_frame(uint8_t opcode, const std::string &payload);
+
+    // 发送待发送的数据，并按是否写阻塞更新关心的事件；调用者持有锁。连接不再可用时返回 `false`
+    bool flush();
+
+    // 断开连接，返回要在注销后关闭的套接字与注册 ID；调用者持有锁
+    std::unique_ptr<tcp_socket> teardown(event_loop::watch_id &watch);
+
+    // 注销并关闭断开的套接字；调用者不能持有锁，注销时可能等待正在执行的回调
+    static void release(event_loop::watch_id watch, std::unique_ptr<tcp_socket> socket);
+
+    // 连接断开或失败后，启用自动重连时安排重连
+    void schedule_retry(uint64_t generation);
+
+    // 调用事件回调；`stop` 之后的事件被丢弃
+    void deliver(uint64_t generation, event type, const std::string &data);
+
+private:
+    const std::string host_;
+    const int port_;
+    const std::string path_;
+    const event_handler handler_;
+    std::mutex mutex_;
+    std::condition_variable delivered_;         ///< 回调返回
+    std::atomic<uint64_t> generation_;          ///< 每次 `stop` 或建立连接时加一，旧的连接任务、回调与事件随之作废
+    std::unique_ptr<tcp_socket> socket_;        ///< 已打开的连接；未连接时为空
+    event_loop::watch_id watch_;
+    timer_wheel::timer_id retry_timer_;
+    std::string inbox_;                         ///< 已接收、尚未解析的数据
+    std::string fragments_;                     ///< 分片消息已收到的部分
+    std::string outbox_;                        ///< 写阻塞时尚未发出的数据
+    int retries_;                               ///< 连续失败的次数
+    int delivering_;                            ///< 正在执行的回调个数
+    bool running_;                              ///< 是否已 `start`，尚未 `stop`
+    bool auto_reconnect_;
+    bool want_write_;                           ///< 是否已在事件循环中关心可写
+};
+
+
+}       // namespace kaixin
@@ -0,0 +1,175 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        worker_pool.cpp
+ * \brief       worker_pool 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "worker_pool.h"
+
+#include <cassert>
+
+
+worker_pool &worker_pool::instance()
+{
+    static worker_pool pool;
+    return pool;
+}
+
+
+worker_pool::worker_pool()
+    : thread_count_(DEFAULT_THREAD_COUNT)
+    , user_threads_(0)
+    , accepting_(false)
+    , stopping_(false)
+{
+}
+
+
+worker_pool::~worker_pool()
+{
+    stop();
+}
+
+
+void worker_pool::start()
+{
+    // 上次停止的线程已在 `stop` 中结束，之后才能清除停止标志
+    std::lock_guard control(control_mutex_);
+    std::lock_guard lock(mutex_);
+    stopping_ = false;
+    accepting_ = true;
+}
+
+
+void worker_pool::set_thread_count(size_t count)
+{
+    assert(count > 0 && count <= MAX_THREAD_COUNT);
+
+    {
+        std::lock_guard lock(mutex_);
+        thread_count_ = count;
+
+        if (!threads_.empty())
+        {
+            spawn_user_threads();
+        }
+    }
+
+    // 多余的线程醒来后退出
+    cond_.notify_all();
+}
+
+
+bool worker_pool::post(task t, lane l)
+{
+    {
+        std::lock_guard lock(mutex_);
+
+        if (!accepting_)
+        {
+            return false;
+        }
+
+        (l == lane::system ? system_tasks_ : tasks_).emplace_back(std::move(t));
+
+        if (threads_.empty())
+        {
+            threads_.emplace_back(&worker_pool::worker_proc, this, true);
+            spawn_user_threads();
+        }
+    }
+
+    if (l == lane::system)
+    {
+        // 后台线程可能不是被唤醒的那一个
+        cond_.notify_all();
+    }
+    else
+    {
+        cond_.notify_one();
+    }
+
+    return true;
+}
+
+
+void worker_pool::stop()
+{
+    std::lock_guard control(control_mutex_);
+    std::vector<std::thread> threads;
+
+    {
+        // 先停止接受：等待期间投递的任务被拒绝，不会再创建线程
+        std::lock_guard lock(mutex_);
+        accepting_ = false;
+        stopping_ = true;
+        user_threads_ = 0;
+        threads.swap(threads_);
+    }
+
+    cond_.notify_all();
+
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+}
+
+
+void worker_pool::worker_proc(bool system)
+{
+    while (true)
+    {
+        task t;
+
+        {
+            std::unique_lock lock(mutex_);
+            cond_.wait(lock, [this, system]
+            {
+                return stopping_ || !system_tasks_.empty()
+                    || (!system && (!tasks_.empty() || user_threads_ > thread_count_));
+            });
+
+            if (!system && user_threads_ > thread_count_)
+            {
+                // 线程数已减少，多余的线程退出
+                user_threads_--;
+                break;
+            }
+
+            // 后台任务优先；停止前先执行完剩余的任务
+            if (!system_tasks_.empty())
+            {
+                t = std::move(system_tasks_.front());
+                system_tasks_.pop_front();
+            }
+            else if (!system && !tasks_.empty())
+            {
+                t = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        t();
+    }
+}
+
+
+void worker_pool::spawn_user_threads()
+{
+    while (user_threads_ < thread_count_)
+    {
+        threads_.emplace_back(&worker_pool::worker_proc, this, false);
+        user_threads_++;
+    }
+}
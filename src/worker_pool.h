@@ -0,0 +1,104 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        worker_pool.h
+ * \brief       worker_pool 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-16
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/*!
+ * \brief       进程级工作线程池，执行异步 API 的任务。
+ *
+ * `start` 之后在第一次投递任务时启动线程。执行用户任务的线程数即异步请求的最大并发数，由
+ * `set_thread_count` 设置。所有任务共享 `connection_pool` 中的连接，因此并发的请求不会各自握手。
+ *
+ * 任务分两条通道：异步 API 的请求走 `lane::user`，并发数受线程数限制；SDK 的后台任务（令牌更新、
+ * 下行通知重连）走 `lane::system`，排在所有用户任务之前，另有一个只执行后台任务的线程，
+ * 用户任务阻塞再久也不会让后台任务等待。
+ *
+ * `stop` 先停止接受新任务，再等待工作线程结束；之后投递的任务被拒绝，直到再次调用 `start`。
+ */
+class worker_pool : private noncopyable
+{
+public:
+    using task = std::function<void()>;
+
+    /// 任务通道。
+    enum class lane
+    {
+        user,                                   ///< 异步 API 的请求
+        system,                                 ///< SDK 的后台任务，优先执行，不受用户线程数限制
+    };
+
+    /// 默认的用户线程数。
+    static constexpr size_t DEFAULT_THREAD_COUNT = 4;
+    /// 用户线程数的上限。
+    static constexpr size_t MAX_THREAD_COUNT = 64;
+
+    /// 获取全局工作线程池。
+    static worker_pool &instance();
+
+    /*!
+     * \brief       设置执行用户任务的线程数，立即生效：增加时启动新的线程，减少时多余的线程执行完
+     *              当前任务后退出。
+     *
+     * \param[in]   count       线程数，1 到 `MAX_THREAD_COUNT`
+     */
+    void set_thread_count(size_t count);
+
+    /*!
+     * \brief       开始接受任务。停止后再次调用时，等待上次的 `stop` 返回后才重新接受。
+     */
+    void start();
+
+    /*!
+     * \brief       投递任务。
+     *
+     * \param[in]   t           要执行的任务
+     * \param[in]   l           任务通道
+     * \return      如果已接受，则返回 true；如果未启动或正在停止，则返回 false，任务不会执行。
+     */
+    bool post(task t, lane l = lane::user);
+
+    /*!
+     * \brief       停止接受新任务，执行完所有已投递的任务，然后停止工作线程。不能在工作线程中调用。
+     */
+    void stop();
+
+private:
+    worker_pool();
+    ~worker_pool();
+
+    // system 为 true 时只执行后台任务
+    void worker_proc(bool system);
+
+    // 启动用户线程，直到达到设置的线程数；调用者持有锁
+    void spawn_user_threads();
+
+private:
+    std::mutex control_mutex_;                  ///< 串行化 `start` 与 `stop`，`stop` 等待线程结束期间持有
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<task> tasks_;                    ///< 用户任务
+    std::deque<task> system_tasks_;             ///< 后台任务，先于用户任务执行
+    std::vector<std::thread> threads_;          ///< 所有线程，包括已退出的多余用户线程，`stop` 时等待
+    size_t thread_count_;                       ///< 设置的用户线程数
+    size_t user_threads_;                       ///< 正在运行的用户线程数
+    bool accepting_;                            ///< 是否接受新任务
+    bool stopping_;                             ///< 工作线程执行完剩余的任务后退出
+};
@@ -0,0 +1,251 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        allocation_test.cpp
+ * \brief       稳定状态下请求不再增长堆内存的测试。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "buffer_pool.h"
+#include "connection_pool.h"
+#include "http_transport.h"
+#include "kaixin.h"
+#include "local_https_server.h"
+
+using kaixin::test::http_request;
+using kaixin::test::http_response;
+using kaixin::test::local_https_server;
+
+
+/// 算作大块分配的最小字节数，与接收缓冲区的初始容量相同。
+static constexpr size_t LARGE_ALLOCATION = 16 * 1024;
+/// 每个分配之前记录大小与是否计数的头部，保持 `max_align_t` 对齐。
+static constexpr size_t HEADER_SIZE = alignof(std::max_align_t);
+
+static std::atomic_bool g_tracking{ false };
+static std::atomic<int64_t> g_live_bytes{ 0 };
+static std::atomic<int64_t> g_large_allocations{ 0 };
+/// 本地服务端的连接线程不计数，只统计 SDK 一侧的分配。
+static thread_local bool t_ignored = false;
+
+
+struct allocation_header
+{
+    size_t size;
+    bool tracked;
+};
+
+static_assert(sizeof(allocation_header) <= HEADER_SIZE);
+
+
+void *operator new(size_t size)
+{
+    auto *block = static_cast<char *>(std::malloc(size + HEADER_SIZE));
+
+    if (block == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    auto *header = reinterpret_cast<allocation_header *>(block);
+    header->size = size;
+    header->tracked = g_tracking.load(std::memory_order_relaxed) && !t_ignored;
+
+    if (header->tracked)
+    {
+        g_live_bytes += static_cast<int64_t>(size);
+
+        if (size >= LARGE_ALLOCATION)
+        {
+            g_large_allocations++;
+        }
+    }
+
+    return block + HEADER_SIZE;
+}
+
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+
+void operator delete(void *ptr) noexcept
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+
+    auto *block = static_cast<char *>(ptr) - HEADER_SIZE;
+    const auto *header = reinterpret_cast<allocation_header *>(block);
+
+    if (header->tracked)
+    {
+        g_live_bytes -= static_cast<int64_t>(header->size);
+    }
+
+    std::free(block);
+}
+
+
+void operator delete[](void *ptr) noexcept
+{
+    operator delete(ptr);
+}
+
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+
+/// 统计作用域内 SDK 一侧的分配。
+class allocation_scope
+{
+public:
+    allocation_scope()
+    {
+        g_live_bytes = 0;
+        g_large_allocations = 0;
+        g_tracking = true;
+    }
+
+    ~allocation_scope() { g_tracking = false; }
+
+    /// 作用域内分配、尚未释放的字节数。
+    int64_t live_bytes() const { return g_live_bytes; }
+
+    /// 作用域内的大块分配次数。
+    int64_t large_allocations() const { return g_large_allocations; }
+};
+
+
+/// 返回比接收缓冲区初始容量更大的 `/web-url` 响应，让缓冲区是否复用可以观察到。
+static http_response web_url(const http_request &req)
+{
+    t_ignored = true;
+
+    http_response resp;
+    resp.headers.emplace_back("Content-Type", "application/json");
+
+    if (req.target.rfind("/web-url", 0) != 0)
+    {
+        resp.status = 404;
+        resp.body = R"({"code":404,"msg":"Not found."})";
+        return resp;
+    }
+
+    resp.body = R"({"code":0,"msg":")" + std::string(32 * 1024, 'x')
+        + R"(","data":"https://localhost/web/buy"})";
+    return resp;
+}
+
+
+// 稳定状态下收发请求复用连接与接收缓冲区，不再有大块分配，保留的内存不随请求数增长
+TEST(allocation_test, transport_reuses_receive_buffers)
+{
+    local_https_server server(web_url);
+    connection_pool::instance().clear();
+    buffer_pool::instance().clear();
+
+    auto args = std::make_shared<ix::HttpRequestArgs>();
+    args->url = server.url() + "/web-url?page=buy";
+    args->verb = "GET";
+
+    const auto get = [&args]
+    {
+        auto resp = http::request(args->url, args->verb, std::string(), args);
+        const bool ok = (resp->errorCode == ix::HttpErrorCode::Ok) && (resp->statusCode == 200);
+        buffer_pool::instance().release(std::move(resp->payload));
+        return ok;
+    };
+
+    // 预热：建立连接，缓冲区扩容到响应大小
+    for (int i = 0; i < 10; i++)
+    {
+        ASSERT_TRUE(get());
+    }
+
+    allocation_scope scope;
+
+    for (int i = 0; i < 100; i++)
+    {
+        ASSERT_TRUE(get());
+    }
+
+    const auto live = scope.live_bytes();
+
+    for (int i = 0; i < 200; i++)
+    {
+        ASSERT_TRUE(get());
+    }
+
+    EXPECT_EQ(scope.large_allocations(), 0);
+    EXPECT_LE(scope.live_bytes(), live + 1024);
+    EXPECT_EQ(server.stats().connections, 1u);
+    connection_pool::instance().clear();
+}
+
+
+// kaixin_get_web_url 的完整路径：签名、接收、原地解析，稳定状态下同样不增长
+TEST(allocation_test, web_url_loop_does_not_grow_heap)
+{
+    local_https_server server(web_url);
+    auto *ctx = kaixin_context_create("kaixin", "tests", "test-key", "test-secret", server.url().c_str());
+    ASSERT_NE(ctx, nullptr);
+
+    const auto get = [ctx]
+    {
+        const char *url = kaixin_context_get_web_url(ctx, KAIXIN_WEB_PAGE_BUY);
+        const bool ok = (url != nullptr) && (strcmp(url, "https://localhost/web/buy") == 0);
+        kaixin_free_string(url);
+        return ok;
+    };
+
+    for (int i = 0; i < 10; i++)
+    {
+        ASSERT_TRUE(get());
+    }
+
+    {
+        allocation_scope scope;
+
+        for (int i = 0; i < 100; i++)
+        {
+            ASSERT_TRUE(get());
+        }
+
+        const auto live = scope.live_bytes();
+
+        for (int i = 0; i < 200; i++)
+        {
+            ASSERT_TRUE(get());
+        }
+
+        EXPECT_EQ(scope.large_allocations(), 0);
+        EXPECT_LE(scope.live_bytes(), live + 1024);
+    }
+
+    kaixin_context_free(ctx);
+}
@@ -0,0 +1,247 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        codec_test.cpp
+ * \brief       codec 测试，按运行时选择的实现与标量参考实现逐字节对比。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "codec.h"
+#include "codec_reference.h"
+
+namespace reference = kaixin::test::codec_reference;
+
+
+/// 模糊测试的最大长度，覆盖各实现的整块与尾部。
+static constexpr size_t MAX_LENGTH = 300;
+/// 输入起始地址的最大偏移，覆盖不对齐的加载。
+static constexpr size_t MAX_OFFSET = 32;
+/// 输出缓冲区末尾的哨兵字节，检查越界写入。
+static constexpr char GUARD = '\x5a';
+
+
+class codec_test : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        SCOPED_TRACE(codec::implementation());
+        data_.resize(MAX_LENGTH + MAX_OFFSET);
+
+        for (auto &c : data_)
+        {
+            c = static_cast<uint8_t>(random_());
+        }
+    }
+
+    /// 以 URL 中常见的字符为主、夹杂保留字符与非 ASCII 字节的随机字符串。
+    std::string random_text(size_t length)
+    {
+        static constexpr char common[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_.~";
+        static constexpr char special[] = " !\"#$%&'()*+,/:;<=>?@[\\]^`{|}";
+        std::string s(length, '\0');
+
+        for (auto &c : s)
+        {
+            const auto r = random_() % 16;
+
+            if (r < 12)
+            {
+                c = common[random_() % (sizeof(common) - 1)];
+            }
+            else if (r < 15)
+            {
+                c = special[random_() % (sizeof(special) - 1)];
+            }
+            else
+            {
+                c = static_cast<char>(0x80 | (random_() & 0x7f));
+            }
+        }
+
+        return s;
+    }
+
+protected:
+    std::mt19937 random_{ 20261017 };
+    std::vector<uint8_t> data_;
+};
+
+
+TEST_F(codec_test, implementation_is_known)
+{
+    const std::set<std::string> names{ "avx2", "sse2", "neon", "scalar" };
+    EXPECT_EQ(names.count(codec::implementation()), 1u) << codec::implementation();
+}
+
+
+TEST_F(codec_test, hex_matches_reference)
+{
+    for (size_t offset = 0; offset < MAX_OFFSET; offset++)
+    {
+        for (size_t length = 0; length <= MAX_LENGTH; length++)
+        {
+            const auto *in = data_.data() + offset;
+            const auto expected = reference::hex_encode(in, length);
+
+            std::string out(length * 2 + 1, GUARD);
+            codec::hex_encode(&out[0], in, length);
+            ASSERT_EQ(out.back(), GUARD) << "length " << length << ", offset " << offset;
+            out.pop_back();
+            ASSERT_EQ(out, expected) << "length " << length << ", offset " << offset;
+
+            ASSERT_EQ(codec::to_hex(in, length), expected);
+        }
+    }
+}
+
+
+TEST_F(codec_test, hex_appends)
+{
+    std::string out = "prefix:";
+    codec::hex_encode(out, data_.data(), 40);
+    EXPECT_EQ(out, "prefix:" + reference::hex_encode(data_.data(), 40));
+}
+
+
+TEST_F(codec_test, base64url_matches_reference)
+{
+    for (size_t offset = 0; offset < MAX_OFFSET; offset++)
+    {
+        for (size_t length = 0; length <= MAX_LENGTH; length++)
+        {
+            const auto *in = data_.data() + offset;
+            const auto expected = reference::base64url_encode(in, length);
+
+            std::string out = "prefix:";
+            codec::base64url_encode(out, in, length);
+            ASSERT_EQ(out, "prefix:" + expected) << "length " << length << ", offset " << offset;
+        }
+    }
+}
+
+
+TEST_F(codec_test, base64url_round_trips)
+{
+    for (size_t length = 0; length <= MAX_LENGTH; length++)
+    {
+        const std::string original(data_.begin(), data_.begin() + static_cast<ptrdiff_t>(length));
+        const auto encoded = codec::base64url_encode(original);
+
+        std::string decoded;
+        ASSERT_TRUE(codec::base64url_decode(encoded, decoded)) << encoded;
+        ASSERT_EQ(decoded, original);
+
+        std::vector<uint8_t> bytes;
+        ASSERT_TRUE(codec::base64url_decode(encoded, bytes));
+        ASSERT_EQ(std::string(bytes.begin(), bytes.end()), original);
+
+        std::string expected;
+        ASSERT_TRUE(reference::base64url_decode(encoded, expected));
+        ASSERT_EQ(decoded, expected);
+    }
+}
+
+
+// RFC 4648 第 10 节的测试向量，以及 URL 字母表特有的两个字符
+TEST_F(codec_test, base64url_known_vectors)
+{
+    const std::pair<std::string, std::string> vectors[] = {
+        { "", "" },
+        { "f", "Zg" },
+        { "fo", "Zm8" },
+        { "foo", "Zm9v" },
+        { "foob", "Zm9vYg" },
+        { "fooba", "Zm9vYmE" },
+        { "foobar", "Zm9vYmFy" },
+        { "\xfb\xff", "-_8" },
+    };
+
+    for (const auto &[plain, encoded] : vectors)
+    {
+        EXPECT_EQ(codec::base64url_encode(plain), encoded);
+
+        std::string decoded;
+        EXPECT_TRUE(codec::base64url_decode(encoded, decoded));
+        EXPECT_EQ(decoded, plain);
+    }
+}
+
+
+TEST_F(codec_test, base64url_rejects_malformed_input)
+{
+    uint8_t out[MAX_LENGTH];
+
+    // 长度除以 4 余 1 的编码不可能存在
+    for (size_t length = 1; length <= 41; length += 4)
+    {
+        const std::string encoded(length, 'A');
+        EXPECT_EQ(codec::base64url_decode(encoded.data(), encoded.size(), out), codec::npos) << length;
+    }
+
+    // 标准 Base64 的字符、填充与其它非法字节出现在整块或尾部的任意位置
+    const auto valid = codec::base64url_encode(std::string(20, 'k'));
+    ASSERT_EQ(valid.size() % 4, 3u);
+
+    for (const char bad : { '+', '/', '=', ' ', '.', '\0', '\x80', '\xff' })
+    {
+        for (size_t i = 0; i < valid.size(); i++)
+        {
+            auto encoded = valid;
+            encoded[i] = bad;
+            EXPECT_EQ(codec::base64url_decode(encoded.data(), encoded.size(), out), codec::npos)
+                << "byte " << static_cast<int>(static_cast<unsigned char>(bad)) << " at " << i;
+        }
+    }
+
+    std::string decoded = "stale";
+    EXPECT_FALSE(codec::base64url_decode(std::string("Zm9v!"), decoded));
+    EXPECT_TRUE(decoded.empty());
+}
+
+
+TEST_F(codec_test, url_encode_matches_reference)
+{
+    const auto text = random_text(MAX_LENGTH + MAX_OFFSET);
+
+    for (size_t offset = 0; offset < MAX_OFFSET; offset++)
+    {
+        for (size_t length = 0; length <= MAX_LENGTH; length++)
+        {
+            const auto expected = reference::url_encode(text.substr(offset, length));
+
+            std::string out = "prefix:";
+            codec::url_encode(out, text.data() + offset, length);
+            ASSERT_EQ(out, "prefix:" + expected) << "length " << length << ", offset " << offset;
+        }
+    }
+}
+
+
+// 需要编码的字符出现在长段不变字符的每个位置，覆盖向量扫描提前结束的各种情况
+TEST_F(codec_test, url_encode_finds_every_reserved_position)
+{
+    for (const char c : { ' ', '%', '/', '\x7f', '\x80', '\xff' })
+    {
+        for (size_t i = 0; i < 70; i++)
+        {
+            std::string s(70, 'a');
+            s[i] = c;
+
+            std::string out;
+            codec::url_encode(out, s.data(), s.size());
+            ASSERT_EQ(out, reference::url_encode(s)) << "position " << i;
+        }
+    }
+}
@@ -0,0 +1,257 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        dns_cache_test.cpp
+ * \brief       dns_cache 类测试，使用替换的解析函数，不需要网络。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "connection_pool.h"
+#include "dns_cache.h"
+#include "http_transport.h"
+#include "local_https_server.h"
+#include "utils.h"
+
+#ifdef KAIXIN_OS_WINDOWS
+#include <WinSock2.h>
+#else
+#include <sys/socket.h>
+#endif
+
+using namespace std::chrono_literals;
+
+
+static dns_address make_address(int family, uint8_t last)
+{
+    dns_address address;
+    address.family = family;
+
+    if (family == AF_INET)
+    {
+        address.bytes[0] = 127;
+        address.bytes[3] = last;
+    }
+    else
+    {
+        address.bytes[15] = last;
+    }
+
+    return address;
+}
+
+
+class dns_cache_test : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        dns_cache::instance().set_resolver([this](const std::string &host, std::vector<dns_address> &addresses,
+                                                  std::chrono::seconds &ttl)
+        {
+            calls_++;
+            std::this_thread::sleep_for(delay_.load());
+
+            if (failing_ || host == "unknown.test")
+            {
+                return false;
+            }
+
+            addresses = addresses_;
+            ttl = 5s;
+            return true;
+        });
+        before_ = dns_cache::instance().stats();
+    }
+
+    void TearDown() override
+    {
+        dns_cache::instance().stop();
+        dns_cache::instance().set_resolver(nullptr);
+    }
+
+    bool resolve(const std::string &host, std::vector<dns_address> &addresses)
+    {
+        std::string error;
+        return dns_cache::instance().resolve(host, addresses, error, nullptr);
+    }
+
+    dns_cache::statistics delta() const
+    {
+        const auto s = dns_cache::instance().stats();
+        dns_cache::statistics d;
+        d.hits = s.hits - before_.hits;
+        d.misses = s.misses - before_.misses;
+        d.refreshes = s.refreshes - before_.refreshes;
+        d.failures = s.failures - before_.failures;
+        return d;
+    }
+
+protected:
+    std::vector<dns_address> addresses_{ make_address(AF_INET, 1) };
+    std::atomic<std::chrono::milliseconds> delay_{ 0ms };
+    std::atomic_int calls_{ 0 };
+    std::atomic_bool failing_{ false };
+    dns_cache::statistics before_;
+};
+
+
+TEST_F(dns_cache_test, caches_results)
+{
+    std::vector<dns_address> addresses;
+    ASSERT_TRUE(resolve("api.test", addresses));
+    ASSERT_TRUE(resolve("api.test", addresses));
+
+    ASSERT_EQ(addresses.size(), 1u);
+    EXPECT_EQ(addresses[0].family, AF_INET);
+    EXPECT_EQ(addresses[0].bytes[3], 1);
+    EXPECT_EQ(calls_, 1);
+    EXPECT_EQ(delta().misses, 1u);
+    EXPECT_EQ(delta().hits, 1u);
+}
+
+
+TEST_F(dns_cache_test, concurrent_lookups_share_one_resolve)
+{
+    delay_ = 50ms;
+    std::vector<std::thread> threads;
+    std::atomic_int succeeded{ 0 };
+
+    for (int i = 0; i < 8; i++)
+    {
+        threads.emplace_back([this, &succeeded]
+        {
+            std::vector<dns_address> addresses;
+            succeeded += resolve("api.test", addresses) ? 1 : 0;
+        });
+    }
+
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+
+    EXPECT_EQ(succeeded, 8);
+    EXPECT_EQ(calls_, 1);
+}
+
+
+// 保持解析函数返回的第一个地址族在前，两个地址族交替排列
+TEST_F(dns_cache_test, interleaves_address_families)
+{
+    addresses_ = {
+        make_address(AF_INET6, 3), make_address(AF_INET6, 4), make_address(AF_INET6, 5),
+        make_address(AF_INET, 1), make_address(AF_INET, 2),
+    };
+
+    std::vector<dns_address> addresses;
+    ASSERT_TRUE(resolve("api.test", addresses));
+    ASSERT_EQ(addresses.size(), 5u);
+
+    const int families[] = { AF_INET6, AF_INET, AF_INET6, AF_INET, AF_INET6 };
+    const uint8_t order[] = { 3, 1, 4, 2, 5 };
+
+    for (size_t i = 0; i < addresses.size(); i++)
+    {
+        EXPECT_EQ(addresses[i].family, families[i]) << i;
+        EXPECT_EQ(addresses[i].family == AF_INET ? addresses[i].bytes[3] : addresses[i].bytes[15], order[i]) << i;
+    }
+}
+
+
+TEST_F(dns_cache_test, reports_failures)
+{
+    std::vector<dns_address> addresses;
+    std::string error;
+    EXPECT_FALSE(dns_cache::instance().resolve("unknown.test", addresses, error, nullptr));
+    EXPECT_NE(error.find("unknown.test"), std::string::npos);
+    EXPECT_EQ(delta().failures, 1u);
+}
+
+
+TEST_F(dns_cache_test, cancelled_wait_returns_early)
+{
+    delay_ = 500ms;
+    std::vector<dns_address> addresses;
+    std::string error;
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic_bool cancel{ false };
+    std::thread canceller([&cancel] { std::this_thread::sleep_for(50ms); cancel = true; });
+
+    EXPECT_FALSE(dns_cache::instance().resolve("api.test", addresses, error, [&cancel] { return cancel.load(); }));
+    canceller.join();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 400ms);
+    EXPECT_FALSE(error.empty());
+}
+
+
+// 最短 TTL 为 5 秒：4 秒后在后台刷新，过期后解析失败时继续使用旧结果
+TEST_F(dns_cache_test, refreshes_before_expiry_and_keeps_stale_results)
+{
+    std::vector<dns_address> addresses;
+    ASSERT_TRUE(resolve("api.test", addresses));
+
+    std::this_thread::sleep_for(4100ms);
+    ASSERT_TRUE(resolve("api.test", addresses));
+    EXPECT_EQ(delta().refreshes, 1u);
+
+    for (int i = 0; i < 100 && calls_ < 2; i++)
+    {
+        std::this_thread::sleep_for(10ms);
+    }
+
+    EXPECT_EQ(calls_, 2);
+
+    // 刷新后的结果再过 5 秒过期
+    failing_ = true;
+    std::this_thread::sleep_for(5100ms);
+    addresses.clear();
+    ASSERT_TRUE(resolve("api.test", addresses));
+    ASSERT_EQ(addresses.size(), 1u);
+    EXPECT_EQ(addresses[0].bytes[3], 1);
+    EXPECT_EQ(delta().failures, 1u);
+}
+
+
+// 第一个地址不可达时，并行连接使用下一个地址，不等待连接超时
+TEST_F(dns_cache_test, races_connections_across_addresses)
+{
+    kaixin::test::local_https_server server([](const kaixin::test::http_request &)
+    {
+        kaixin::test::http_response resp;
+        resp.body = "{}";
+        return resp;
+    });
+
+    // 192.0.2.1 属于 TEST-NET-1，不会有应答
+    dns_address unreachable;
+    unreachable.family = AF_INET;
+    unreachable.bytes[0] = 192;
+    unreachable.bytes[2] = 2;
+    unreachable.bytes[3] = 1;
+    addresses_ = { unreachable, make_address(AF_INET, 1) };
+    connection_pool::instance().clear();
+
+    auto args = std::make_shared<ix::HttpRequestArgs>();
+    args->url = server.url();
+    args->verb = "GET";
+    args->connectTimeout = 10;
+    args->transferTimeout = 10;
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto resp = http::request(args->url, args->verb, std::string(), args);
+    ASSERT_EQ(resp->errorCode, ix::HttpErrorCode::Ok) << resp->errorMsg;
+    EXPECT_EQ(resp->statusCode, 200);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 2s);
+    EXPECT_EQ(calls_, 1);
+    connection_pool::instance().clear();
+}
@@ -0,0 +1,161 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        hmac_sha256_test.cpp
+ * \brief       hmac_sha256 类与请求签名测试，与 OpenSSL 的一次性 HMAC() 对比。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+#include "codec.h"
+#include "hmac_sha256.h"
+#include "kaixin_api.h"
+
+using kaixin::hmac_sha256;
+
+
+// OpenSSL 一次性计算的 HMAC-SHA256，十六进制
+static std::string one_shot(const std::string &key, const std::string &message)
+{
+    uint8_t digest[EVP_MAX_MD_SIZE];
+    unsigned int length = sizeof(digest);
+    HMAC(EVP_sha256(), key.data(), static_cast<int>(key.size()),
+         reinterpret_cast<const uint8_t *>(message.data()), message.size(), digest, &length);
+    return codec::to_hex(digest, length);
+}
+
+
+static std::string finish(hmac_sha256 &signer)
+{
+    uint8_t digest[hmac_sha256::DIGEST_LENGTH];
+    signer.final(digest);
+    return codec::to_hex(digest, sizeof(digest));
+}
+
+
+static std::string random_string(std::mt19937 &random, size_t length)
+{
+    std::string s(length, '\0');
+
+    for (auto &c : s)
+    {
+        c = static_cast<char>(random());
+    }
+
+    return s;
+}
+
+
+// RFC 4231 测试用例 1、2 与 6（密钥长于块大小）
+TEST(hmac_sha256_test, rfc4231_vectors)
+{
+    hmac_sha256 case1(std::string(20, '\x0b'));
+    case1.update("Hi There");
+    EXPECT_EQ(finish(case1), "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7");
+
+    hmac_sha256 case2("Jefe");
+    case2.update("what do ya want for nothing?");
+    EXPECT_EQ(finish(case2), "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+
+    hmac_sha256 case6(std::string(131, '\xaa'));
+    case6.update("Test Using Larger Than Block-Size Key - Hash Key First");
+    EXPECT_EQ(finish(case6), "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54");
+}
+
+
+// 密钥长度跨过块大小（64 字节），消息长度跨过多个块
+TEST(hmac_sha256_test, matches_one_shot_hmac)
+{
+    std::mt19937 random(20261017);
+
+    for (size_t key_length = 0; key_length <= 130; key_length++)
+    {
+        const auto key = random_string(random, key_length);
+        const auto message = random_string(random, random() % 300);
+
+        hmac_sha256 signer(key);
+        signer.update(message);
+        ASSERT_EQ(finish(signer), one_shot(key, message)) << "key length " << key_length;
+    }
+}
+
+
+// 消息任意分段送入，结果与一次送入相同
+TEST(hmac_sha256_test, streaming_matches_one_shot_hmac)
+{
+    std::mt19937 random(20261017);
+    const auto key = random_string(random, 32);
+    const auto message = random_string(random, 1000);
+    const auto expected = one_shot(key, message);
+
+    for (int round = 0; round < 100; round++)
+    {
+        hmac_sha256 signer(key);
+        size_t pos = 0;
+
+        while (pos < message.size())
+        {
+            const auto length = std::min<size_t>(random() % 80, message.size() - pos);
+            signer.update(message.data() + pos, length);
+            pos += length;
+        }
+
+        ASSERT_EQ(finish(signer), expected) << "round " << round;
+    }
+}
+
+
+// 已设置密钥的对象复制后各自独立，原对象可以反复复制
+TEST(hmac_sha256_test, copies_are_independent)
+{
+    const hmac_sha256 keyed("app-secret");
+
+    auto first = keyed;
+    first.update("first message");
+    auto second = keyed;
+    second.update("second message");
+
+    EXPECT_EQ(finish(first), one_shot("app-secret", "first message"));
+    EXPECT_EQ(finish(second), one_shot("app-secret", "second message"));
+
+    hmac_sha256 empty;
+    EXPECT_EQ(finish(empty), one_shot(std::string(), std::string()));
+}
+
+
+// 逐段签名与引入 hmac_sha256 之前的做法相同：对“方法 + 路径 + 按名称排序的参数名与值”一次性 HMAC
+TEST(hmac_sha256_test, sign_matches_one_shot_hmac_of_canonical_string)
+{
+    auto config = std::make_shared<kaixin::Config>();
+    config->app_secret = "test-secret";
+    config->signing_key = hmac_sha256(config->app_secret);
+    kaixin::config_scope scope(config.get());
+
+    const kaixin::string_map queries{
+        { "locale", "zh_CN" },
+        { "agent_code", "A0001" },
+        { "page", "buy" },
+    };
+    const kaixin::string_map form{
+        { "username", "tester" },
+        { "nonce", "5f2c9a0e71b3d4a6" },
+    };
+
+    EXPECT_EQ(kaixin::sign("POST", "/sign-in", queries, form),
+              one_shot("test-secret", "POST/sign-inagent_codeA0001localezh_CNnonce5f2c9a0e71b3d4a6"
+                                      "pagebuyusernametester"));
+    EXPECT_EQ(kaixin::sign("GET", "/web-url", {}, {}), one_shot("test-secret", "GET/web-url"));
+}
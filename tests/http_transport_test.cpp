@@ -0,0 +1,102 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        http_transport_test.cpp
+ * \brief       HTTP/1.1 传输测试，使用本地 HTTPS 服务端。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+#include "buffer_pool.h"
+#include "connection_pool.h"
+#include "http_transport.h"
+#include "local_https_server.h"
+
+using kaixin::test::http_request;
+using kaixin::test::http_response;
+using kaixin::test::local_https_server;
+
+
+class http_transport_test : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        connection_pool::instance().clear();
+    }
+
+    void TearDown() override
+    {
+        connection_pool::instance().clear();
+    }
+
+    // 发送请求，返回错误码
+    ix::HttpErrorCode send(const std::string &verb, const std::string &path)
+    {
+        auto args = std::make_shared<ix::HttpRequestArgs>();
+        args->url = server_.url() + path;
+        args->verb = verb;
+
+        auto resp = http::request(args->url, verb, (verb == "GET") ? std::string() : "a=1", args);
+        buffer_pool::instance().release(std::move(resp->payload));
+        return resp->errorCode;
+    }
+
+    std::atomic_int dropped_{ 0 };
+    local_https_server server_{ [this](const http_request &req)
+    {
+        http_response resp;
+
+        if (req.target == "/drop")
+        {
+            // 收到请求后不响应，直接断开
+            dropped_++;
+            resp.status = 0;
+        }
+
+        return resp;
+    } };
+};
+
+
+// 非幂等请求同样复用空闲连接
+TEST_F(http_transport_test, reuses_connections_for_non_idempotent_requests)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        ASSERT_EQ(send("POST", "/log"), ix::HttpErrorCode::Ok);
+        ASSERT_EQ(send("PATCH", "/session"), ix::HttpErrorCode::Ok);
+    }
+
+    EXPECT_EQ(server_.stats().connections, 1u);
+    EXPECT_EQ(server_.stats().requests, 6u);
+}
+
+
+// 复用的连接在响应前断开时，非幂等请求返回错误，不会重发
+TEST_F(http_transport_test, does_not_resend_non_idempotent_requests)
+{
+    ASSERT_EQ(send("GET", "/"), ix::HttpErrorCode::Ok);
+
+    EXPECT_NE(send("POST", "/drop"), ix::HttpErrorCode::Ok);
+    EXPECT_EQ(dropped_, 1);
+    EXPECT_EQ(server_.stats().connections, 1u);
+}
+
+
+// 复用的连接在响应前断开时，幂等请求换一个新建的连接重发一次
+TEST_F(http_transport_test, resends_idempotent_requests_on_a_new_connection)
+{
+    ASSERT_EQ(send("GET", "/"), ix::HttpErrorCode::Ok);
+
+    EXPECT_NE(send("GET", "/drop"), ix::HttpErrorCode::Ok);
+    EXPECT_EQ(dropped_, 2);
+    EXPECT_EQ(server_.stats().connections, 2u);
+}
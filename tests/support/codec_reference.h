@@ -0,0 +1,153 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        codec_reference.h
+ * \brief       编解码的标量参考实现，供测试与性能测试对比。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+
+namespace kaixin {
+namespace test {
+
+
+/*!
+ * \brief       逐字节的参考实现，与引入 `codec` 之前的 `utils::to_hex`、cppcodec 与
+ *              `kaixin::url_encode` 输出相同。
+ */
+namespace codec_reference {
+
+
+/// Base64Url 字母表。
+static constexpr char BASE64URL_ALPHABET[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+
+/// 十六进制编码（小写）。
+inline std::string hex_encode(const uint8_t *data, size_t length)
+{
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(length * 2);
+
+    for (size_t i = 0; i < length; i++)
+    {
+        out += digits[data[i] >> 4];
+        out += digits[data[i] & 0x0f];
+    }
+
+    return out;
+}
+
+
+/// Base64Url 编码（不补“=”），每次取 6 位。
+inline std::string base64url_encode(const uint8_t *data, size_t length)
+{
+    std::string out;
+    uint32_t bits = 0;
+    int count = 0;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        bits = (bits << 8) | data[i];
+        count += 8;
+
+        while (count >= 6)
+        {
+            count -= 6;
+            out += BASE64URL_ALPHABET[(bits >> count) & 0x3f];
+        }
+    }
+
+    if (count > 0)
+    {
+        out += BASE64URL_ALPHABET[(bits << (6 - count)) & 0x3f];
+    }
+
+    return out;
+}
+
+
+/*!
+ * \brief       Base64Url 解码（不补“=”）。
+ *
+ * \param[in]   encoded     编码后的字符串
+ * \param[out]  out         解码后的数据
+ *
+ * \return      如果含有非法字符或长度不正确，则返回 `false`。
+ */
+inline bool base64url_decode(const std::string &encoded, std::string &out)
+{
+    out.clear();
+
+    if (encoded.size() % 4 == 1)
+    {
+        return false;
+    }
+
+    uint32_t bits = 0;
+    int count = 0;
+
+    for (const auto c : encoded)
+    {
+        const auto *p = (c == '\0') ? nullptr : std::strchr(BASE64URL_ALPHABET, c);
+
+        if (p == nullptr)
+        {
+            return false;
+        }
+
+        bits = (bits << 6) | static_cast<uint32_t>(p - BASE64URL_ALPHABET);
+        count += 6;
+
+        if (count >= 8)
+        {
+            count -= 8;
+            out += static_cast<char>((bits >> count) & 0xff);
+        }
+    }
+
+    return true;
+}
+
+
+/// URL 编码：字母、数字与“-_.~”保持不变，其它字节编码为“%XX”（大写）。
+inline std::string url_encode(const std::string &s)
+{
+    static constexpr char digits[] = "0123456789ABCDEF";
+    std::string out;
+
+    for (const auto ch : s)
+    {
+        const auto c = static_cast<unsigned char>(ch);
+
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+            || c == '-' || c == '_' || c == '.' || c == '~')
+        {
+            out += ch;
+        }
+        else
+        {
+            out += '%';
+            out += digits[c >> 4];
+            out += digits[c & 0x0f];
+        }
+    }
+
+    return out;
+}
+
+
+}       // namespace codec_reference
+}       // namespace test
+}       // namespace kaixin
@@ -0,0 +1,191 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        kaixin_stand_in.cpp
+ * \brief       开心服务端本地替身源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "kaixin_stand_in.h"
+
+#include <cstdlib>
+
+#include <rapidjson/document.h>
+
+
+namespace kaixin {
+namespace test {
+
+
+// 解码 application/x-www-form-urlencoded 中的一个值
+static std::string form_decode(const std::string &encoded)
+{
+    std::string decoded;
+    decoded.reserve(encoded.size());
+
+    for (size_t i = 0; i < encoded.size(); i++)
+    {
+        const auto c = encoded[i];
+
+        if (c == '+')
+        {
+            decoded += ' ';
+        }
+        else if (c == '%' && i + 2 < encoded.size())
+        {
+            const char hex[3] = { encoded[i + 1], encoded[i + 2], '\0' };
+            decoded += static_cast<char>(std::strtoul(hex, nullptr, 16));
+            i += 2;
+        }
+        else
+        {
+            decoded += c;
+        }
+    }
+
+    return decoded;
+}
+
+
+// 从表单中取得指定字段
+static std::string form_value(const std::string &form, const std::string &name)
+{
+    for (size_t pos = 0; pos < form.size();)
+    {
+        auto end = form.find('&', pos);
+
+        if (end == std::string::npos)
+        {
+            end = form.size();
+        }
+
+        const auto eq = form.find('=', pos);
+
+        if (eq != std::string::npos && eq < end && eq - pos == name.size() && form.compare(pos, eq - pos, name) == 0)
+        {
+            return form_decode(form.substr(eq + 1, end - eq - 1));
+        }
+
+        pos = end + 1;
+    }
+
+    return {};
+}
+
+
+// 处理一个资源请求，返回状态码与 `data` 的 JSON 文本；资源不存在时返回 404 与空字符串
+static int handle_resource(const std::string &method, const std::string &path, std::string &data)
+{
+    if (method == "GET" && path == "/lowest-version")
+    {
+        data = R"({"major":1,"minor":3,"patch":0})";
+    }
+    else if (method == "GET" && path == "/materials")
+    {
+        data = R"([{"type":"notice","text":"Welcome"},{"type":"help","text":"https://localhost/help"}])";
+    }
+    else if (method == "GET" && path == "/shopee-hosts")
+    {
+        const std::string sub = R"({"buyer":{"sg":"shopee.sg"},"seller":{"sg":"seller.shopee.sg"},"cdn":{"sg":"cf.shopee.sg"}})";
+        data = R"({"global":)" + sub + R"(,"china":)" + sub + "}";
+    }
+    else if (method == "POST" && path == "/device-id")
+    {
+        data = R"("stand-in-device")";
+    }
+    else if (method == "GET" && path == "/auth")
+    {
+        data = R"({"secret":"stand-in-secret","auth":[{"module":"core","edition":1,"count":1,"time":4102444800}]})";
+    }
+    else
+    {
+        return 404;
+    }
+
+    return 200;
+}
+
+
+// 去掉目标中的查询部分
+static std::string path_of(const std::string &target)
+{
+    return target.substr(0, target.find('?'));
+}
+
+
+// 批量请求：逐个处理子请求，按相同顺序返回子响应
+static int handle_batch(const http_request &req, std::string &data)
+{
+    rapidjson::Document requests;
+    requests.Parse(form_value(req.body, "requests").c_str());
+
+    if (requests.HasParseError() || !requests.IsArray())
+    {
+        return 400;
+    }
+
+    data = "[";
+
+    for (const auto &sub : requests.GetArray())
+    {
+        if (!sub.IsObject() || !sub.HasMember("method") || !sub["method"].IsString()
+            || !sub.HasMember("path") || !sub["path"].IsString())
+        {
+            return 400;
+        }
+
+        std::string sub_data;
+        const auto status = handle_resource(sub["method"].GetString(), sub["path"].GetString(), sub_data);
+
+        if (data.size() > 1)
+        {
+            data += ',';
+        }
+
+        data += R"({"status":)" + std::to_string(status);
+
+        if (status == 200)
+        {
+            data += R"(,"code":0,"msg":"","data":)" + sub_data + "}";
+        }
+        else
+        {
+            data += R"(,"code":)" + std::to_string(status) + R"(,"msg":"Not found"})";
+        }
+    }
+
+    data += ']';
+    return 200;
+}
+
+
+http_response kaixin_stand_in(const http_request &req)
+{
+    const auto path = path_of(req.target);
+    std::string data;
+    const auto status = (req.method == "POST" && path == "/batch")
+        ? handle_batch(req, data) : handle_resource(req.method, path, data);
+
+    http_response resp;
+    resp.status = status;
+    resp.headers.emplace_back("Content-Type", "application/json");
+
+    if (status == 200)
+    {
+        resp.body = R"({"code":0,"msg":"","data":)" + data + "}";
+    }
+    else
+    {
+        resp.body = R"({"code":)" + std::to_string(status) + R"(,"msg":"Error"})";
+    }
+
+    return resp;
+}
+
+
+}       // namespace test
+}       // namespace kaixin
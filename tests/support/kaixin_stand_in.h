@@ -0,0 +1,37 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        kaixin_stand_in.h
+ * \brief       开心服务端本地替身头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "local_https_server.h"
+
+
+namespace kaixin {
+namespace test {
+
+
+/*!
+ * \brief       开心服务端的本地替身，作为 `local_https_server` 的请求处理函数。
+ *
+ * 实现启动时请求的资源（`/lowest-version`、`/materials`、`/shopee-hosts`、`/device-id`、`/auth`），
+ * 以及批量请求（POST /batch）的服务端参考实现：表单的 `requests` 字段为子请求数组，每项包含
+ * `method`、`path`、`queries`、`form`；响应的 `data` 为按相同顺序排列的子响应数组，每项包含
+ * `status`、`code`、`msg`、`data`。不验证签名与令牌。
+ *
+ * \param[in]   req         请求
+ *
+ * \return      响应。
+ */
+http_response kaixin_stand_in(const http_request &req);
+
+
+}       // namespace test
+}       // namespace kaixin
@@ -0,0 +1,826 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        local_https_server.cpp
+ * \brief       local_https_server 类源文件。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include "local_https_server.h"
+
+#include <algorithm>
+#include <cctype>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <stdexcept>
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+#include <zlib.h>
+
+#ifdef KAIXIN_HAS_HTTP2
+#include <nghttp2/nghttp2.h>
+#endif
+
+#include <ixwebsocket/IXNetSystem.h>
+
+#include "tls_socket.h"
+#include "utils.h"
+
+#ifdef KAIXIN_OS_WINDOWS
+#define NOMINMAX
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#define poll WSAPoll
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+
+namespace kaixin {
+namespace test {
+
+
+#ifdef KAIXIN_OS_WINDOWS
+static void close_socket(int fd) { closesocket(fd); }
+static void shutdown_socket(int fd) { shutdown(fd, SD_BOTH); }
+#else
+static void close_socket(int fd) { ::close(fd); }
+static void shutdown_socket(int fd) { shutdown(fd, SHUT_RDWR); }
+#endif
+
+
+/// 进程内生成的 localhost 自签名证书与私钥。
+struct identity
+{
+    EVP_PKEY *key = nullptr;
+    X509 *cert = nullptr;
+    std::string pem;                            ///< 证书的 PEM 格式
+};
+
+
+// 生成 P-256 私钥与有效期一天的自签名证书，主体与备用名称为 localhost
+static const identity &server_identity()
+{
+    static const identity id = []
+    {
+        identity result;
+        auto *kctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+
+        if (kctx == nullptr || EVP_PKEY_keygen_init(kctx) != 1
+            || EVP_PKEY_CTX_set_ec_paramgen_curve_nid(kctx, NID_X9_62_prime256v1) != 1
+            || EVP_PKEY_keygen(kctx, &result.key) != 1)
+        {
+            throw std::runtime_error("Failed to generate the server key.");
+        }
+
+        EVP_PKEY_CTX_free(kctx);
+
+        auto *cert = X509_new();
+        X509_set_version(cert, 2);
+        ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+        X509_gmtime_adj(X509_getm_notBefore(cert), -3600);
+        X509_gmtime_adj(X509_getm_notAfter(cert), 86400);
+        X509_set_pubkey(cert, result.key);
+
+        auto *name = X509_get_subject_name(cert);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                                   reinterpret_cast<const unsigned char *>("localhost"), -1, -1, 0);
+        X509_set_issuer_name(cert, name);
+
+        X509V3_CTX v3;
+        X509V3_set_ctx_nodb(&v3);
+        X509V3_set_ctx(&v3, cert, cert, nullptr, nullptr, 0);
+
+        for (const auto &[nid, value] : { std::make_pair(NID_basic_constraints, "critical,CA:TRUE"),
+                                          std::make_pair(NID_subject_alt_name, "DNS:localhost,IP:127.0.0.1") })
+        {
+            auto *ext = X509V3_EXT_conf_nid(nullptr, &v3, nid, value);
+            X509_add_ext(cert, ext, -1);
+            X509_EXTENSION_free(ext);
+        }
+
+        if (X509_sign(cert, result.key, EVP_sha256()) == 0)
+        {
+            throw std::runtime_error("Failed to sign the server certificate.");
+        }
+
+        auto *bio = BIO_new(BIO_s_mem());
+        PEM_write_bio_X509(bio, cert);
+        char *data = nullptr;
+        const auto length = BIO_get_mem_data(bio, &data);
+        result.pem.assign(data, static_cast<size_t>(length));
+        BIO_free(bio);
+
+        result.cert = cert;
+        return result;
+    }();
+
+    return id;
+}
+
+
+local_https_server::local_https_server(handler h, const server_options &options)
+    : handler_(std::move(h))
+    , options_(options)
+    , ctx_(nullptr)
+    , listener_(-1)
+    , port_(0)
+    , stopping_(false)
+{
+    ix::initNetSystem();
+
+#ifndef KAIXIN_OS_WINDOWS
+    // 客户端先关闭连接时，向其写入（如 close_notify）不应终止进程
+    signal(SIGPIPE, SIG_IGN);
+#endif
+
+    const auto &id = server_identity();
+    tls_socket::add_trusted_certificate(id.pem);
+
+    ctx_ = SSL_CTX_new(TLS_server_method());
+    SSL_CTX_set_min_proto_version(ctx_, TLS1_2_VERSION);
+    SSL_CTX_use_certificate(ctx_, id.cert);
+    SSL_CTX_use_PrivateKey(ctx_, id.key);
+
+    if (options_.early_data)
+    {
+        // 本地替身不需要防重放，无状态票据也可以接受早期数据
+        SSL_CTX_set_max_early_data(ctx_, 16384);
+        SSL_CTX_set_options(ctx_, SSL_OP_NO_ANTI_REPLAY);
+    }
+
+    if (options_.http2)
+    {
+#ifdef KAIXIN_HAS_HTTP2
+        // 客户端提供 h2 时选择 h2，否则不确认 ALPN，使用 HTTP/1.1
+        SSL_CTX_set_alpn_select_cb(ctx_, [](SSL *, const unsigned char **out, unsigned char *outlen,
+                                            const unsigned char *in, unsigned int inlen, void *)
+        {
+            for (unsigned int i = 0; i < inlen; i += 1 + in[i])
+            {
+                if (in[i] == 2 && i + 2 < inlen && in[i + 1] == 'h' && in[i + 2] == '2')
+                {
+                    *out = in + i + 1;
+                    *outlen = 2;
+                    return SSL_TLSEXT_ERR_OK;
+                }
+            }
+
+            return SSL_TLSEXT_ERR_NOACK;
+        }, nullptr);
+#else
+        throw std::runtime_error("HTTP/2 requires KAIXIN_HAS_HTTP2.");
+#endif
+    }
+
+    listener_ = static_cast<int>(socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(addr);
+
+    if (listener_ < 0
+        || bind(listener_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0
+        || listen(listener_, 128) != 0
+        || getsockname(listener_, reinterpret_cast<sockaddr *>(&addr), &length) != 0)
+    {
+        throw std::runtime_error("Failed to listen on the loopback interface.");
+    }
+
+    port_ = ntohs(addr.sin_port);
+    acceptor_ = std::thread(&local_https_server::accept_proc, this);
+}
+
+
+local_https_server::~local_https_server()
+{
+    stopping_ = true;
+
+    // 关闭监听套接字使 accept 返回
+    shutdown_socket(listener_);
+    close_socket(listener_);
+    acceptor_.join();
+
+    std::vector<std::thread> threads;
+
+    {
+        std::lock_guard lock(mutex_);
+
+        for (auto &[fd, t] : connections_)
+        {
+            shutdown_socket(fd);
+            threads.push_back(std::move(t));
+        }
+    }
+
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+
+    join_finished();
+    SSL_CTX_free(ctx_);
+}
+
+
+std::string local_https_server::url() const
+{
+    return "https://localhost:" + std::to_string(port_);
+}
+
+
+local_https_server::statistics local_https_server::stats() const
+{
+    std::lock_guard lock(mutex_);
+    return stats_;
+}
+
+
+std::string local_https_server::gzip(const std::string &data)
+{
+    z_stream zs = {};
+    deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+
+    std::string out(deflateBound(&zs, static_cast<uLong>(data.size())), '\0');
+    zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+    zs.avail_in = static_cast<uInt>(data.size());
+    zs.next_out = reinterpret_cast<Bytef *>(&out[0]);
+    zs.avail_out = static_cast<uInt>(out.size());
+    deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return out;
+}
+
+
+void local_https_server::accept_proc()
+{
+    while (!stopping_)
+    {
+        const auto fd = static_cast<int>(accept(listener_, nullptr, nullptr));
+
+        if (fd < 0)
+        {
+            continue;
+        }
+
+        if (stopping_)
+        {
+            close_socket(fd);
+            break;
+        }
+
+        // 与客户端一致，禁用 Nagle 算法，避免握手与响应被延迟确认拖慢
+        int nodelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char *>(&nodelay), sizeof(nodelay));
+
+        join_finished();
+
+        // 持有锁创建线程，连接线程结束时才能找到自己
+        std::lock_guard lock(mutex_);
+        connections_.emplace(fd, std::thread(&local_https_server::serve, this, fd));
+    }
+}
+
+
+// 回收已结束的连接线程
+void local_https_server::join_finished()
+{
+    std::vector<std::thread> finished;
+
+    {
+        std::lock_guard lock(mutex_);
+        finished.swap(finished_);
+    }
+
+    for (auto &t : finished)
+    {
+        // 析构时已取走的线程在这里为空
+        if (t.joinable())
+        {
+            t.join();
+        }
+    }
+}
+
+
+// 解析一个完整的请求头；数据不够时返回 `false`
+static bool parse_head(const std::string &in, http_request &req, size_t &head_length, size_t &body_length)
+{
+    const auto end = in.find("\r\n\r\n");
+
+    if (end == std::string::npos)
+    {
+        return false;
+    }
+
+    head_length = end + 4;
+    const auto line_end = in.find("\r\n");
+    const auto sp1 = in.find(' ');
+    const auto sp2 = in.find(' ', sp1 + 1);
+    req.method = in.substr(0, sp1);
+    req.target = in.substr(sp1 + 1, sp2 - sp1 - 1);
+    req.headers.clear();
+
+    for (auto pos = line_end + 2; pos < end;)
+    {
+        const auto eol = in.find("\r\n", pos);
+        const auto colon = in.find(':', pos);
+
+        if (colon != std::string::npos && colon < eol)
+        {
+            auto name = in.substr(pos, colon - pos);
+
+            for (auto &c : name)
+            {
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+
+            auto value_start = colon + 1;
+
+            while (value_start < eol && in[value_start] == ' ')
+            {
+                value_start++;
+            }
+
+            req.headers[name] = in.substr(value_start, eol - value_start);
+        }
+
+        pos = eol + 2;
+    }
+
+    const auto iter = req.headers.find("content-length");
+    body_length = (iter != req.headers.end()) ? std::strtoul(iter->second.c_str(), nullptr, 10) : 0;
+    return true;
+}
+
+
+// 当前时间的 HTTP 日期，SDK 用响应的 Date 头校正服务端时间
+static std::string http_date()
+{
+    static const char *const days[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+    static const char *const months[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                          "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+    const auto now = std::time(nullptr);
+    std::tm tm = {};
+#ifdef KAIXIN_OS_WINDOWS
+    gmtime_s(&tm, &now);
+#else
+    gmtime_r(&now, &tm);
+#endif
+
+    char date[32];
+    std::snprintf(date, sizeof(date), "%s, %02d %s %04d %02d:%02d:%02d GMT", days[tm.tm_wday], tm.tm_mday,
+                  months[tm.tm_mon], tm.tm_year + 1900, tm.tm_hour, tm.tm_min, tm.tm_sec);
+    return date;
+}
+
+
+static bool write_all(SSL *ssl, const std::string &data)
+{
+    size_t offset = 0;
+
+    while (offset < data.size())
+    {
+        size_t written = 0;
+
+        if (SSL_write_ex(ssl, data.data() + offset, data.size() - offset, &written) != 1)
+        {
+            return false;
+        }
+
+        offset += written;
+    }
+
+    return true;
+}
+
+
+void local_https_server::count_request()
+{
+    std::lock_guard lock(mutex_);
+    stats_.requests++;
+}
+
+
+#ifdef KAIXIN_HAS_HTTP2
+
+/// HTTP/2 连接的状态。
+struct h2_connection
+{
+    using clock = std::chrono::steady_clock;
+
+    /// 延迟到期后发送的响应。
+    struct pending
+    {
+        clock::time_point ready;                ///< 发送时间
+        int32_t stream_id;                      ///< 流 ID
+        http_response resp;                     ///< 响应
+    };
+
+    /// 正在发送的响应体。
+    struct body
+    {
+        std::string data;                       ///< 响应体
+        size_t offset = 0;                      ///< 已发送的长度
+    };
+
+    nghttp2_session *session = nullptr;
+    std::map<int32_t, http_request> requests;   ///< 正在接收的请求
+    std::vector<pending> responses;             ///< 等待发送的响应
+    std::map<int32_t, body> bodies;             ///< 正在发送的响应体
+    std::vector<int32_t> completed;             ///< 刚接收完的请求
+};
+
+
+static int on_begin_headers(nghttp2_session *, const nghttp2_frame *frame, void *user_data)
+{
+    auto *conn = static_cast<h2_connection *>(user_data);
+
+    if (frame->hd.type == NGHTTP2_HEADERS && frame->headers.cat == NGHTTP2_HCAT_REQUEST)
+    {
+        conn->requests[frame->hd.stream_id] = {};
+    }
+
+    return 0;
+}
+
+
+static int on_header(nghttp2_session *, const nghttp2_frame *frame, const uint8_t *name, size_t namelen,
+                     const uint8_t *value, size_t valuelen, uint8_t, void *user_data)
+{
+    auto *conn = static_cast<h2_connection *>(user_data);
+    auto iter = conn->requests.find(frame->hd.stream_id);
+
+    if (iter == conn->requests.end())
+    {
+        return 0;
+    }
+
+    auto &req = iter->second;
+    const std::string n(reinterpret_cast<const char *>(name), namelen);
+    std::string v(reinterpret_cast<const char *>(value), valuelen);
+
+    if (n == ":method")
+    {
+        req.method = std::move(v);
+    }
+    else if (n == ":path")
+    {
+        req.target = std::move(v);
+    }
+    else if (n[0] != ':')
+    {
+        // HTTP/2 的头名称已是小写
+        req.headers[n] = std::move(v);
+    }
+
+    return 0;
+}
+
+
+static int on_data_chunk(nghttp2_session *, uint8_t, int32_t stream_id, const uint8_t *data, size_t len,
+                         void *user_data)
+{
+    auto *conn = static_cast<h2_connection *>(user_data);
+    auto iter = conn->requests.find(stream_id);
+
+    if (iter != conn->requests.end())
+    {
+        iter->second.body.append(reinterpret_cast<const char *>(data), len);
+    }
+
+    return 0;
+}
+
+
+static int on_frame_recv(nghttp2_session *, const nghttp2_frame *frame, void *user_data)
+{
+    auto *conn = static_cast<h2_connection *>(user_data);
+
+    if ((frame->hd.type == NGHTTP2_HEADERS || frame->hd.type == NGHTTP2_DATA)
+        && (frame->hd.flags & NGHTTP2_FLAG_END_STREAM) != 0
+        && conn->requests.count(frame->hd.stream_id) != 0)
+    {
+        conn->completed.push_back(frame->hd.stream_id);
+    }
+
+    return 0;
+}
+
+
+static int on_stream_close(nghttp2_session *, int32_t stream_id, uint32_t, void *user_data)
+{
+    auto *conn = static_cast<h2_connection *>(user_data);
+    conn->requests.erase(stream_id);
+    conn->bodies.erase(stream_id);
+    return 0;
+}
+
+
+static ssize_t read_body(nghttp2_session *, int32_t, uint8_t *buf, size_t length, uint32_t *data_flags,
+                         nghttp2_data_source *source, void *)
+{
+    auto *b = static_cast<h2_connection::body *>(source->ptr);
+    const auto n = std::min(length, b->data.size() - b->offset);
+    std::copy_n(b->data.data() + b->offset, n, buf);
+    b->offset += n;
+
+    if (b->offset == b->data.size())
+    {
+        *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+    }
+
+    return static_cast<ssize_t>(n);
+}
+
+
+// 提交响应，并把响应体交给数据源
+static void submit_response(h2_connection &conn, int32_t stream_id, const http_response &resp)
+{
+    std::vector<std::pair<std::string, std::string>> headers{
+        { ":status", std::to_string(resp.status) },
+        { "date", http_date() },
+        { "content-length", std::to_string(resp.body.size()) },
+    };
+
+    for (const auto &[name, value] : resp.headers)
+    {
+        auto lower = name;
+
+        for (auto &c : lower)
+        {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+
+        headers.emplace_back(std::move(lower), value);
+    }
+
+    std::vector<nghttp2_nv> nva;
+
+    for (auto &[name, value] : headers)
+    {
+        nva.push_back({ reinterpret_cast<uint8_t *>(&name[0]), reinterpret_cast<uint8_t *>(&value[0]),
+                        name.size(), value.size(), NGHTTP2_NV_FLAG_NONE });
+    }
+
+    auto &b = conn.bodies[stream_id];
+    b.data = resp.body;
+    b.offset = 0;
+
+    nghttp2_data_provider provider;
+    provider.source.ptr = &b;
+    provider.read_callback = read_body;
+    nghttp2_submit_response(conn.session, stream_id, nva.data(), nva.size(), &provider);
+}
+
+
+void local_https_server::serve_http2(SSL *ssl, int fd)
+{
+    using clock = h2_connection::clock;
+    h2_connection conn;
+
+    nghttp2_session_callbacks *callbacks = nullptr;
+    nghttp2_session_callbacks_new(&callbacks);
+    nghttp2_session_callbacks_set_on_begin_headers_callback(callbacks, on_begin_headers);
+    nghttp2_session_callbacks_set_on_header_callback(callbacks, on_header);
+    nghttp2_session_callbacks_set_on_data_chunk_recv_callback(callbacks, on_data_chunk);
+    nghttp2_session_callbacks_set_on_frame_recv_callback(callbacks, on_frame_recv);
+    nghttp2_session_callbacks_set_on_stream_close_callback(callbacks, on_stream_close);
+    nghttp2_session_server_new(&conn.session, callbacks, &conn);
+    nghttp2_session_callbacks_del(callbacks);
+
+    const nghttp2_settings_entry settings[] = {
+        { NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, 256 },
+    };
+    nghttp2_submit_settings(conn.session, NGHTTP2_FLAG_NONE, settings, 1);
+
+    char buffer[16384];
+    bool ok = true;
+
+    while (ok && !stopping_)
+    {
+        // 处理接收完的请求，响应在各自的延迟到期后发送
+        for (auto id : conn.completed)
+        {
+            auto resp = handler_(conn.requests[id]);
+            conn.responses.push_back({ clock::now() + options_.delay, id, std::move(resp) });
+        }
+
+        conn.completed.clear();
+        const auto now = clock::now();
+        auto next = clock::time_point::max();
+
+        for (auto iter = conn.responses.begin(); iter != conn.responses.end();)
+        {
+            if (iter->ready <= now)
+            {
+                submit_response(conn, iter->stream_id, iter->resp);
+                count_request();
+                iter = conn.responses.erase(iter);
+            }
+            else
+            {
+                next = std::min(next, iter->ready);
+                ++iter;
+            }
+        }
+
+        // 发送所有待发送的帧
+        const uint8_t *data = nullptr;
+        ssize_t length = 0;
+
+        while (ok && (length = nghttp2_session_mem_send(conn.session, &data)) > 0)
+        {
+            ok = write_all(ssl, std::string(reinterpret_cast<const char *>(data), static_cast<size_t>(length)));
+        }
+
+        if (!ok || length < 0 || (!nghttp2_session_want_read(conn.session) && conn.responses.empty()))
+        {
+            break;
+        }
+
+        // 等待数据或下一个响应的发送时间
+        if (SSL_pending(ssl) == 0)
+        {
+            int timeout = 100;
+
+            if (next != clock::time_point::max())
+            {
+                const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next - clock::now());
+                timeout = static_cast<int>(std::clamp<int64_t>(wait.count(), 0, timeout));
+            }
+
+            pollfd p = {};
+            p.fd = fd;
+            p.events = POLLIN;
+
+            if (poll(&p, 1, timeout) <= 0)
+            {
+                continue;
+            }
+        }
+
+        size_t n = 0;
+        ok = SSL_read_ex(ssl, buffer, sizeof(buffer), &n) == 1
+            && nghttp2_session_mem_recv(conn.session, reinterpret_cast<const uint8_t *>(buffer), n) >= 0;
+    }
+
+    nghttp2_session_del(conn.session);
+}
+
+#else
+
+void local_https_server::serve_http2(SSL *, int)
+{
+}
+
+#endif
+
+
+void local_https_server::serve(int fd)
+{
+    auto *ssl = SSL_new(ctx_);
+    SSL_set_fd(ssl, fd);
+    std::string in;
+    char buffer[16384];
+    bool ok = true;
+
+    if (options_.early_data)
+    {
+        // 先读早期数据，其中是第一个请求
+        while (true)
+        {
+            size_t n = 0;
+            const auto r = SSL_read_early_data(ssl, buffer, sizeof(buffer), &n);
+
+            if (r == SSL_READ_EARLY_DATA_ERROR)
+            {
+                ok = false;
+                break;
+            }
+
+            in.append(buffer, n);
+
+            if (r == SSL_READ_EARLY_DATA_FINISH)
+            {
+                break;
+            }
+        }
+    }
+
+    ok = ok && SSL_accept(ssl) == 1;
+
+    const unsigned char *alpn = nullptr;
+    unsigned int alpn_length = 0;
+
+    if (ok)
+    {
+        SSL_get0_alpn_selected(ssl, &alpn, &alpn_length);
+
+        std::lock_guard lock(mutex_);
+        stats_.connections++;
+        stats_.resumed += SSL_session_reused(ssl) ? 1 : 0;
+        stats_.early_data += (SSL_get_early_data_status(ssl) == SSL_EARLY_DATA_ACCEPTED) ? 1 : 0;
+        stats_.http2 += (alpn_length == 2) ? 1 : 0;
+    }
+
+    if (ok && alpn_length == 2)
+    {
+        serve_http2(ssl, fd);
+        ok = false;
+    }
+
+    while (ok && !stopping_)
+    {
+        http_request req;
+        size_t head_length = 0;
+        size_t body_length = 0;
+
+        while (!parse_head(in, req, head_length, body_length) || in.size() < head_length + body_length)
+        {
+            size_t n = 0;
+
+            if (SSL_read_ex(ssl, buffer, sizeof(buffer), &n) != 1)
+            {
+                ok = false;
+                break;
+            }
+
+            in.append(buffer, n);
+        }
+
+        if (!ok)
+        {
+            break;
+        }
+
+        req.body = in.substr(head_length, body_length);
+        in.erase(0, head_length + body_length);
+
+        if (options_.delay.count() > 0)
+        {
+            std::this_thread::sleep_for(options_.delay);
+        }
+
+        const auto resp = handler_(req);
+
+        if (resp.status == 0)
+        {
+            // 模拟服务端收到请求后、响应前断开
+            count_request();
+            break;
+        }
+
+        std::string out = "HTTP/1.1 " + std::to_string(resp.status) + " Status\r\n";
+
+        for (const auto &[name, value] : resp.headers)
+        {
+            out += name + ": " + value + "\r\n";
+        }
+
+        out += "Date: " + http_date() + "\r\n";
+        out += "Content-Length: " + std::to_string(resp.body.size()) + "\r\n\r\n";
+        out += resp.body;
+
+        count_request();
+        const auto conn = req.headers.find("connection");
+        ok = write_all(ssl, out) && (conn == req.headers.end() || conn->second != "close");
+    }
+
+    // 发送 close_notify，客户端据此区分正常关闭与截断
+    SSL_shutdown(ssl);
+    SSL_free(ssl);
+    ERR_clear_error();
+
+    // 持有锁关闭，析构函数不会关闭已被复用的描述符
+    std::lock_guard lock(mutex_);
+    auto iter = connections_.find(fd);
+
+    if (iter != connections_.end())
+    {
+        finished_.push_back(std::move(iter->second));
+        connections_.erase(iter);
+    }
+
+    close_socket(fd);
+}
+
+
+}       // namespace test
+}       // namespace kaixin
@@ -0,0 +1,128 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        local_https_server.h
+ * \brief       local_https_server 类头文件。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#pragma once
+#include "noncopyable.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+typedef struct ssl_ctx_st SSL_CTX;
+typedef struct ssl_st SSL;
+
+
+namespace kaixin {
+namespace test {
+
+
+/// 本地服务端收到的请求。
+struct http_request
+{
+    std::string method;                         ///< 请求方法
+    std::string target;                         ///< 路径与查询
+    std::map<std::string, std::string> headers; ///< 请求头，名称为小写
+    std::string body;                           ///< 请求体
+};
+
+
+/// 本地服务端返回的响应。
+struct http_response
+{
+    int status = 200;                           ///< 状态码；为零时不返回响应，直接关闭连接（只用于 HTTP/1.1）
+    std::vector<std::pair<std::string, std::string>> headers;  ///< 附加的响应头，不含 Date 与 Content-Length
+    std::string body;                           ///< 响应体
+};
+
+
+/// 本地服务端参数。
+struct server_options
+{
+    bool early_data = false;                    ///< 是否接受 TLS 1.3 早期数据（0-RTT）
+    bool http2 = false;                         ///< 是否通过 ALPN 接受 HTTP/2，需要以 `KAIXIN_HAS_HTTP2` 编译
+    std::chrono::milliseconds delay{ 0 };       ///< 每个响应前的延迟，模拟网络往返
+};
+
+
+/*!
+ * \brief       测试与性能测试使用的本地 HTTPS 服务端。
+ *
+ * 在 127.0.0.1 的随机端口上监听，使用进程内生成的 localhost 自签名证书，构造时让 SDK 信任该证书
+ * （`tls_socket::add_trusted_certificate`）。每个连接一个线程，支持长连接、会话票据恢复与可选的
+ * 早期数据。HTTP/1.1 只处理带 Content-Length 的请求体，响应总是带 Date 与 Content-Length。
+ *
+ * 启用 HTTP/2 时，同一连接上的流并发处理：每个请求的延迟各自计时，不会阻塞其它流。
+ */
+class local_https_server : private noncopyable
+{
+public:
+    /// 请求处理函数，在连接线程中调用。
+    using handler = std::function<http_response(const http_request &)>;
+
+    /// 统计数据。
+    struct statistics
+    {
+        uint64_t connections = 0;               ///< 完成握手的连接数
+        uint64_t resumed = 0;                   ///< 其中恢复会话的连接数
+        uint64_t early_data = 0;                ///< 其中接受了早期数据的连接数
+        uint64_t http2 = 0;                     ///< 其中使用 HTTP/2 的连接数
+        uint64_t requests = 0;                  ///< 处理的请求数
+    };
+
+    explicit local_https_server(handler h, const server_options &options = {});
+
+    /// 析构函数。关闭所有连接并等待连接线程结束。
+    ~local_https_server();
+
+    /// 监听端口。
+    int port() const { return port_; }
+
+    /// 基础 URL，例如“https://localhost:12345”。
+    std::string url() const;
+
+    /// 获取统计数据。
+    statistics stats() const;
+
+    /// 用 gzip 压缩数据，用于返回压缩的响应。
+    static std::string gzip(const std::string &data);
+
+private:
+    void accept_proc();
+    void serve(int fd);
+    void serve_http2(SSL *ssl, int fd);
+    void count_request();
+    void join_finished();
+
+private:
+    const handler handler_;
+    const server_options options_;
+    SSL_CTX *ctx_;
+    int listener_;
+    int port_;
+    std::atomic_bool stopping_;
+    std::thread acceptor_;
+    mutable std::mutex mutex_;
+    std::map<int, std::thread> connections_;   ///< 进行中的连接与其线程
+    std::vector<std::thread> finished_;         ///< 已结束、尚未回收的连接线程
+    statistics stats_;
+};
+
+
+}       // namespace test
+}       // namespace kaixin
@@ -0,0 +1,362 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        timer_wheel_test.cpp
+ * \brief       timer_wheel 类测试，使用注入的时钟，不需要真正等待。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "timer_wheel.h"
+
+using namespace std::chrono_literals;
+using kaixin::timer_wheel;
+
+
+class timer_wheel_test : public testing::Test
+{
+protected:
+    /// 推进时钟后执行到期的定时器。
+    size_t advance(std::chrono::milliseconds duration)
+    {
+        now_ += duration;
+        return wheel_.poll();
+    }
+
+    /// 像驱动者一样每次等到 `next_expiry` 再执行，直到没有定时器。返回调用 `poll` 的次数。
+    size_t run_all()
+    {
+        size_t polls = 0;
+
+        for (auto next = wheel_.next_expiry(); next != timer_wheel::clock::time_point::max();
+             next = wheel_.next_expiry())
+        {
+            now_ = std::max(now_, next);
+            wheel_.poll();
+            polls++;
+        }
+
+        return polls;
+    }
+
+    /// 从开始到现在经过的毫秒数。
+    int64_t elapsed() const
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(now_ - start_).count();
+    }
+
+protected:
+    const timer_wheel::clock::time_point start_ = timer_wheel::clock::time_point() + 1h;
+    timer_wheel::clock::time_point now_ = start_;
+    std::atomic_int wakes_{ 0 };
+    timer_wheel wheel_{ [this] { return now_; }, [this] { wakes_++; } };
+};
+
+
+TEST_F(timer_wheel_test, fires_at_deadline)
+{
+    int fired = 0;
+    wheel_.schedule(10ms, [&] { fired++; });
+    EXPECT_EQ(wakes_, 1);
+    EXPECT_EQ(wheel_.size(), 1u);
+    EXPECT_EQ(wheel_.next_expiry(), start_ + 10ms);
+
+    EXPECT_EQ(advance(9ms), 0u);
+    EXPECT_EQ(fired, 0);
+    EXPECT_EQ(advance(1ms), 1u);
+    EXPECT_EQ(fired, 1);
+
+    EXPECT_EQ(wheel_.size(), 0u);
+    EXPECT_EQ(wheel_.next_expiry(), timer_wheel::clock::time_point::max());
+}
+
+
+// 跨过每一层的边界（64、64^2、64^3 格）以及超出时间轮范围的定时器，逐级重新分配后准时到期
+TEST_F(timer_wheel_test, cascades_across_levels)
+{
+    const int64_t delays[] = {
+        0, 1, 63, 64, 65, 100, 4095, 4096, 4097, 5000, 262143, 262144, 262145, 300000,
+        16777215, 16777216, 16777217, 20000000, 40000000,
+    };
+    std::map<int64_t, int64_t> fired_at;
+
+    for (const auto delay : delays)
+    {
+        wheel_.schedule(std::chrono::milliseconds(delay), [this, delay, &fired_at]
+        {
+            fired_at[delay] = elapsed();
+        });
+    }
+
+    const auto polls = run_all();
+    ASSERT_EQ(fired_at.size(), std::size(delays));
+
+    for (const auto delay : delays)
+    {
+        EXPECT_EQ(fired_at[delay], delay);
+    }
+
+    // 只在到期与重新分配时唤醒，不逐格推进
+    EXPECT_LT(polls, 200u);
+}
+
+
+// 一次推进很久时，期间到期的定时器在同一次 poll 中按到期顺序执行
+TEST_F(timer_wheel_test, long_jump_fires_in_order)
+{
+    std::vector<int64_t> order;
+
+    for (const int64_t delay : { 300000, 70, 5000, 1, 262144 })
+    {
+        wheel_.schedule(std::chrono::milliseconds(delay), [delay, &order] { order.push_back(delay); });
+    }
+
+    wheel_.schedule(2h, [] { FAIL() << "Fired too early."; });
+
+    EXPECT_EQ(advance(10min), 5u);
+    EXPECT_EQ(order, (std::vector<int64_t>{ 1, 70, 5000, 262144, 300000 }));
+    EXPECT_EQ(wheel_.size(), 1u);
+}
+
+
+// 随机的延迟与推进步长：不会提前执行；按 next_expiry 推进时恰好在到期时执行
+TEST_F(timer_wheel_test, random_delays)
+{
+    std::mt19937 random(20261017);
+    std::uniform_int_distribution<int64_t> delay_of(0, 20000000);
+    std::uniform_int_distribution<int64_t> step_of(1, 500000);
+    std::vector<std::pair<int64_t, int64_t>> fired;    // 到期时间与执行时间
+
+    for (int i = 0; i < 500; i++)
+    {
+        const auto deadline = elapsed() + delay_of(random);
+        wheel_.schedule(std::chrono::milliseconds(deadline - elapsed()), [this, deadline, &fired]
+        {
+            fired.emplace_back(deadline, elapsed());
+        });
+
+        // 一半时间随机推进，一半时间按 next_expiry 推进
+        if (i % 2 == 0)
+        {
+            advance(std::chrono::milliseconds(step_of(random)));
+        }
+    }
+
+    const auto stepping = elapsed();
+
+    while (wheel_.size() > 0)
+    {
+        const auto next = wheel_.next_expiry();
+        ASSERT_NE(next, timer_wheel::clock::time_point::max());
+        ASSERT_GE(next, now_ - 1ms);
+        now_ = std::max(now_, next);
+        wheel_.poll();
+    }
+
+    ASSERT_EQ(fired.size(), 500u);
+
+    for (const auto &[deadline, at] : fired)
+    {
+        if (deadline > stepping)
+        {
+            EXPECT_EQ(at, deadline);
+        }
+        else
+        {
+            EXPECT_GE(at, deadline);
+        }
+    }
+}
+
+
+TEST_F(timer_wheel_test, cancel_pending_timer)
+{
+    int fired = 0;
+    const auto id = wheel_.schedule(50ms, [&] { fired++; });
+    wheel_.schedule(60ms, [&] { fired += 10; });
+
+    EXPECT_TRUE(wheel_.cancel(id));
+    EXPECT_FALSE(wheel_.cancel(id));
+    EXPECT_FALSE(wheel_.cancel(0));
+    EXPECT_EQ(wheel_.size(), 1u);
+
+    EXPECT_EQ(advance(100ms), 1u);
+    EXPECT_EQ(fired, 10);
+}
+
+
+// 回调执行期间在其它线程中取消：等待回调返回后才返回，之后回调不会再访问其捕获的对象
+TEST_F(timer_wheel_test, cancel_waits_for_running_callback)
+{
+    std::promise<void> entered;
+    std::promise<void> release;
+    std::atomic_bool finished{ false };
+
+    const auto id = wheel_.schedule(10ms, [&]
+    {
+        entered.set_value();
+        release.get_future().wait();
+        finished = true;
+    });
+
+    now_ += 10ms;
+    std::thread driver([this] { wheel_.poll(); });
+    entered.get_future().wait();
+
+    std::atomic_bool returned{ false };
+    bool pending = true;
+    std::thread canceller([&]
+    {
+        pending = wheel_.cancel(id);
+        EXPECT_TRUE(finished);
+        returned = true;
+    });
+
+    std::this_thread::sleep_for(50ms);
+    EXPECT_FALSE(returned);
+
+    release.set_value();
+    canceller.join();
+    driver.join();
+
+    EXPECT_TRUE(returned);
+    EXPECT_FALSE(pending);
+}
+
+
+// 清空时同样等待正在执行的回调返回，尚未执行的不再执行
+TEST_F(timer_wheel_test, clear_waits_for_running_callback)
+{
+    std::promise<void> entered;
+    std::promise<void> release;
+    std::atomic_bool finished{ false };
+    int later = 0;
+
+    wheel_.schedule(10ms, [&]
+    {
+        entered.set_value();
+        release.get_future().wait();
+        finished = true;
+    });
+    wheel_.schedule(20ms, [&] { later++; });
+
+    now_ += 10ms;
+    std::thread driver([this] { wheel_.poll(); });
+    entered.get_future().wait();
+
+    std::atomic_bool returned{ false };
+    std::thread clearer([&]
+    {
+        wheel_.clear();
+        EXPECT_TRUE(finished);
+        returned = true;
+    });
+
+    std::this_thread::sleep_for(50ms);
+    EXPECT_FALSE(returned);
+
+    release.set_value();
+    clearer.join();
+    driver.join();
+
+    EXPECT_TRUE(returned);
+    EXPECT_EQ(wheel_.size(), 0u);
+    EXPECT_EQ(advance(10ms), 0u);
+    EXPECT_EQ(later, 0);
+}
+
+
+// 回调中取消自身不等待（否则会死锁），取消同一格中尚未执行的定时器则后者不再执行
+TEST_F(timer_wheel_test, cancel_from_callback)
+{
+    timer_wheel::timer_id self = 0;
+    timer_wheel::timer_id other = 0;
+    std::vector<std::string> log;
+
+    self = wheel_.schedule(10ms, [&]
+    {
+        log.push_back("self");
+        EXPECT_FALSE(wheel_.cancel(self));
+        EXPECT_TRUE(wheel_.cancel(other));
+    });
+    other = wheel_.schedule(10ms, [&] { log.push_back("other"); });
+
+    EXPECT_EQ(advance(10ms), 1u);
+    EXPECT_EQ(log, std::vector<std::string>{ "self" });
+    EXPECT_EQ(wheel_.size(), 0u);
+}
+
+
+// 周期定时器在回调中重新添加自身；添加的定时器不在本次 poll 中执行
+TEST_F(timer_wheel_test, reschedule_from_callback)
+{
+    std::vector<int64_t> fired_at;
+    std::function<void()> tick = [&]
+    {
+        fired_at.push_back(elapsed());
+
+        if (fired_at.size() < 5)
+        {
+            wheel_.schedule(100ms, tick);
+        }
+    };
+
+    wheel_.schedule(100ms, tick);
+
+    for (int i = 0; i < 10; i++)
+    {
+        advance(50ms);
+    }
+
+    EXPECT_EQ(fired_at, (std::vector<int64_t>{ 100, 200, 300, 400, 500 }));
+    EXPECT_EQ(wheel_.size(), 0u);
+
+    // 立即到期的定时器留到下一次 poll，回调中不断添加也不会使 poll 无法返回
+    int immediate = 0;
+    std::function<void()> again = [&]
+    {
+        immediate++;
+        wheel_.schedule(0ms, again);
+    };
+
+    wheel_.schedule(0ms, again);
+    EXPECT_EQ(advance(1ms), 1u);
+    EXPECT_EQ(immediate, 1);
+    EXPECT_EQ(advance(1ms), 1u);
+    EXPECT_EQ(immediate, 2);
+    EXPECT_EQ(wheel_.size(), 1u);
+
+    wheel_.clear();
+    EXPECT_EQ(wheel_.size(), 0u);
+    EXPECT_EQ(advance(1ms), 0u);
+}
+
+
+// 长时间没有定时器后再添加，从当前时间开始计算
+TEST_F(timer_wheel_test, schedule_after_idle)
+{
+    advance(30min);
+
+    int fired = 0;
+    wheel_.schedule(20ms, [&] { fired++; });
+    EXPECT_EQ(wheel_.next_expiry(), now_ + 20ms);
+    EXPECT_EQ(advance(19ms), 0u);
+    EXPECT_EQ(advance(1ms), 1u);
+    EXPECT_EQ(fired, 1);
+}
@@ -0,0 +1,388 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        websocket_connection_test.cpp
+ * \brief       websocket_connection 类测试，使用本地的 WebSocket 服务端。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+
+#include "utils.h"
+#include "websocket_connection.h"
+#include "worker_pool.h"
+
+#ifdef KAIXIN_OS_WINDOWS
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace std::chrono_literals;
+using event = kaixin::websocket_connection::event;
+
+
+#ifdef KAIXIN_OS_WINDOWS
+static void close_socket(int fd) { closesocket(fd); }
+#else
+static void close_socket(int fd) { ::close(fd); }
+#endif
+
+
+/*!
+ * \brief       本地 WebSocket 服务端，依次处理连接。
+ *
+ * 收到文本消息时先发送 ping，再把消息分两片原样返回；收到 "bye" 时发送关闭帧并断开。
+ */
+class echo_server
+{
+public:
+    echo_server()
+    {
+        listener_ = static_cast<int>(socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(addr);
+        bind(listener_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        listen(listener_, 16);
+        getsockname(listener_, reinterpret_cast<sockaddr *>(&addr), &length);
+        port_ = ntohs(addr.sin_port);
+        thread_ = std::thread(&echo_server::run, this);
+    }
+
+    ~echo_server()
+    {
+        stopping_ = true;
+        shutdown(listener_, 2);
+        close_socket(listener_);
+        thread_.join();
+    }
+
+    int port() const { return port_; }
+    int accepted() const { return accepted_; }
+    int pongs() const { return pongs_; }
+
+private:
+    void run()
+    {
+        while (!stopping_)
+        {
+            const auto fd = static_cast<int>(accept(listener_, nullptr, nullptr));
+
+            if (fd < 0)
+            {
+                continue;
+            }
+
+            accepted_++;
+            serve(fd);
+            close_socket(fd);
+        }
+    }
+
+    void serve(int fd)
+    {
+        std::string request;
+        char ch = 0;
+
+        while (request.find("\r\n\r\n") == std::string::npos && recv(fd, &ch, 1, 0) == 1)
+        {
+            request += ch;
+        }
+
+        const auto begin = request.find("Sec-WebSocket-Key: ") + 19;
+        const auto key = request.substr(begin, request.find("\r\n", begin) - begin)
+            + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+        unsigned char digest[SHA_DIGEST_LENGTH];
+        SHA1(reinterpret_cast<const unsigned char *>(key.data()), key.size(), digest);
+        unsigned char accept[64] = {};
+        EVP_EncodeBlock(accept, digest, sizeof(digest));
+
+        write(fd, "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                  "Sec-WebSocket-Accept: " + std::string(reinterpret_cast<char *>(accept)) + "\r\n\r\n");
+
+        uint8_t opcode = 0;
+        std::string payload;
+
+        while (read_frame(fd, opcode, payload))
+        {
+            if (opcode == 0xA)
+            {
+                pongs_++;
+            }
+            else if (opcode == 0x8 || payload == "bye")
+            {
+                write(fd, frame(0x88, "\x03\xe8"));
+                return;
+            }
+            else if (opcode == 0x1)
+            {
+                const auto half = payload.size() / 2;
+                write(fd, frame(0x89, "ping") + frame(0x01, payload.substr(0, half))
+                          + frame(0x80, payload.substr(half)));
+            }
+        }
+    }
+
+    static bool read_exact(int fd, char *data, size_t length)
+    {
+        while (length > 0)
+        {
+            const auto n = recv(fd, data, static_cast<int>(length), 0);
+
+            if (n <= 0)
+            {
+                return false;
+            }
+
+            data += n;
+            length -= static_cast<size_t>(n);
+        }
+
+        return true;
+    }
+
+    // 客户端的帧都带掩码
+    static bool read_frame(int fd, uint8_t &opcode, std::string &payload)
+    {
+        uint8_t header[2];
+
+        if (!read_exact(fd, reinterpret_cast<char *>(header), 2))
+        {
+            return false;
+        }
+
+        opcode = header[0] & 0x0F;
+        uint64_t length = header[1] & 0x7F;
+        const size_t extra = (length == 126) ? 2 : (length == 127) ? 8 : 0;
+        uint8_t ext[8];
+
+        if (!read_exact(fd, reinterpret_cast<char *>(ext), extra))
+        {
+            return false;
+        }
+
+        if (extra > 0)
+        {
+            length = 0;
+
+            for (size_t i = 0; i < extra; i++)
+            {
+                length = (length << 8) | ext[i];
+            }
+        }
+
+        uint8_t mask[4];
+        payload.resize(static_cast<size_t>(length));
+
+        if (!read_exact(fd, reinterpret_cast<char *>(mask), 4) || !read_exact(fd, payload.data(), payload.size()))
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < payload.size(); i++)
+        {
+            payload[i] = static_cast<char>(payload[i] ^ mask[i & 3]);
+        }
+
+        return true;
+    }
+
+    // 服务端的帧不带掩码
+    static std::string frame(uint8_t first, const std::string &payload)
+    {
+        std::string out(1, static_cast<char>(first));
+
+        if (payload.size() < 126)
+        {
+            out += static_cast<char>(payload.size());
+        }
+        else
+        {
+            out += static_cast<char>(127);
+
+            for (int shift = 56; shift >= 0; shift -= 8)
+            {
+                out += static_cast<char>(static_cast<uint64_t>(payload.size()) >> shift);
+            }
+        }
+
+        return out + payload;
+    }
+
+    static void write(int fd, const std::string &data)
+    {
+        send(fd, data.data(), static_cast<int>(data.size()), 0);
+    }
+
+private:
+    int listener_ = -1;
+    int port_ = 0;
+    std::thread thread_;
+    std::atomic_bool stopping_{ false };
+    std::atomic_int accepted_{ 0 };
+    std::atomic_int pongs_{ 0 };
+};
+
+
+/// 记录连接事件。
+class event_recorder
+{
+public:
+    void operator()(event type, const std::string &data)
+    {
+        std::lock_guard lock(mutex_);
+        events_.emplace_back(type, data);
+        cond_.notify_all();
+    }
+
+    // 等待下一个事件，超时时返回 `false`
+    bool next(event &type, std::string &data)
+    {
+        std::unique_lock lock(mutex_);
+
+        if (!cond_.wait_for(lock, 5s, [this] { return !events_.empty(); }))
+        {
+            return false;
+        }
+
+        type = events_.front().first;
+        data = events_.front().second;
+        events_.pop_front();
+        return true;
+    }
+
+    size_t pending()
+    {
+        std::lock_guard lock(mutex_);
+        return events_.size();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<std::pair<event, std::string>> events_;
+};
+
+
+class websocket_connection_test : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        worker_pool::instance().start();
+        ws_ = kaixin::websocket_connection::create("127.0.0.1", server_.port(), "/",
+                                                   [this](event type, const std::string &data)
+        {
+            recorder_(type, data);
+        });
+    }
+
+    void TearDown() override
+    {
+        ws_->stop();
+        worker_pool::instance().stop();
+    }
+
+    void expect_event(event expected, const std::string &expected_data = {})
+    {
+        event type = event::error;
+        std::string data;
+        ASSERT_TRUE(recorder_.next(type, data));
+        EXPECT_EQ(type, expected) << data;
+
+        if (!expected_data.empty())
+        {
+            EXPECT_EQ(data, expected_data);
+        }
+    }
+
+    echo_server server_;
+    event_recorder recorder_;
+    std::shared_ptr<kaixin::websocket_connection> ws_;
+};
+
+
+// 分片的消息合并后交付，服务端的 ping 自动得到应答
+TEST_F(websocket_connection_test, receives_fragmented_messages_and_answers_pings)
+{
+    ws_->start();
+    expect_event(event::open);
+
+    ASSERT_TRUE(ws_->send_text("hello"));
+    expect_event(event::message, "hello");
+
+    // 超过 64 KiB，使用 64 位长度
+    const std::string large(100 * 1024, 'x');
+    ASSERT_TRUE(ws_->send_text(large));
+    expect_event(event::message, large);
+
+    // 第一次的应答先于第二条消息发出，服务端返回第二条消息前已经收到
+    EXPECT_GE(server_.pongs(), 1);
+}
+
+
+// 服务端断开后自动重连
+TEST_F(websocket_connection_test, reconnects_after_server_closes)
+{
+    ws_->start();
+    expect_event(event::open);
+
+    ASSERT_TRUE(ws_->send_text("bye"));
+    expect_event(event::close);
+    expect_event(event::open);
+    EXPECT_EQ(server_.accepted(), 2);
+}
+
+
+// 禁用自动重连后主动关闭，不再重连
+TEST_F(websocket_connection_test, close_without_reconnection)
+{
+    ws_->start();
+    expect_event(event::open);
+
+    ws_->disable_automatic_reconnection();
+    ws_->close();
+    expect_event(event::close);
+    EXPECT_FALSE(ws_->send_text("hello"));
+
+    std::this_thread::sleep_for(300ms);
+    EXPECT_EQ(recorder_.pending(), 0u);
+    EXPECT_EQ(server_.accepted(), 1);
+}
+
+
+// `stop` 返回后不再调用回调，可以再次启动
+TEST_F(websocket_connection_test, stop_discards_later_events)
+{
+    ws_->start();
+    expect_event(event::open);
+
+    ws_->stop();
+    EXPECT_FALSE(ws_->send_text("hello"));
+    std::this_thread::sleep_for(300ms);
+    EXPECT_EQ(recorder_.pending(), 0u);
+
+    ws_->start();
+    expect_event(event::open);
+    ASSERT_TRUE(ws_->send_text("again"));
+    expect_event(event::message, "again");
+}
@@ -0,0 +1,204 @@
+﻿/*! ***********************************************************************************************
+ *
+ * \file        worker_pool_test.cpp
+ * \brief       worker_pool 类测试。
+ *
+ * \version     0.1
+ * \date        2026-10-17
+ *
+ * \author      Roy QIU <karoyqiu@gmail.com>
+ * \copyright   © 2026 开心网络。
+ *
+ **************************************************************************************************/
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "worker_pool.h"
+
+using namespace std::chrono_literals;
+
+
+class worker_pool_test : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        worker_pool::instance().start();
+    }
+
+    void TearDown() override
+    {
+        worker_pool::instance().stop();
+        worker_pool::instance().set_thread_count(worker_pool::DEFAULT_THREAD_COUNT);
+    }
+};
+
+
+TEST_F(worker_pool_test, runs_posted_tasks_before_stop)
+{
+    std::atomic_int done{ 0 };
+
+    for (int i = 0; i < 100; i++)
+    {
+        ASSERT_TRUE(worker_pool::instance().post([&done] { done++; }));
+    }
+
+    worker_pool::instance().stop();
+    EXPECT_EQ(done, 100);
+    EXPECT_FALSE(worker_pool::instance().post([] { FAIL() << "Ran after stop."; }));
+}
+
+
+// 等待线程结束期间投递的任务被拒绝，不会重新创建线程让 `stop` 无法返回
+TEST_F(worker_pool_test, rejects_tasks_while_stopping)
+{
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::atomic_bool started{ false };
+
+    ASSERT_TRUE(worker_pool::instance().post([&started, released]
+    {
+        started = true;
+        released.wait();
+    }));
+
+    while (!started)
+    {
+        std::this_thread::yield();
+    }
+
+    auto stopped = std::async(std::launch::async, [] { worker_pool::instance().stop(); });
+    std::atomic_int late{ 0 };
+
+    // 直到 `stop` 开始等待
+    while (worker_pool::instance().post([&late] { late++; }))
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    release.set_value();
+    ASSERT_EQ(stopped.wait_for(10s), std::future_status::ready);
+
+    // 开始停止前接受的任务仍然执行，之后的全部被拒绝
+    const int accepted = late;
+    EXPECT_FALSE(worker_pool::instance().post([&late] { late++; }));
+    std::this_thread::sleep_for(10ms);
+    EXPECT_EQ(late, accepted);
+}
+
+
+TEST_F(worker_pool_test, restarts_after_stop)
+{
+    worker_pool::instance().stop();
+    worker_pool::instance().start();
+
+    std::promise<void> ran;
+    ASSERT_TRUE(worker_pool::instance().post([&ran] { ran.set_value(); }));
+    EXPECT_EQ(ran.get_future().wait_for(10s), std::future_status::ready);
+}
+
+
+// 所有用户线程都被阻塞、用户任务排队时，后台任务仍然立即执行
+TEST_F(worker_pool_test, system_lane_is_not_starved)
+{
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::atomic_int blocked{ 0 };
+
+    for (int i = 0; i < 16; i++)
+    {
+        ASSERT_TRUE(worker_pool::instance().post([&blocked, released]
+        {
+            blocked++;
+            released.wait();
+        }));
+    }
+
+    std::promise<void> ran;
+    ASSERT_TRUE(worker_pool::instance().post([&ran] { ran.set_value(); }, worker_pool::lane::system));
+    EXPECT_EQ(ran.get_future().wait_for(10s), std::future_status::ready);
+    EXPECT_LT(blocked, 16);
+
+    release.set_value();
+}
+
+
+// 并发执行的用户任务数等于设置的线程数，增加后排队的任务立即开始，减少后多余的线程退出
+TEST_F(worker_pool_test, runs_as_many_user_tasks_as_threads)
+{
+    std::mutex mutex;
+    std::condition_variable cond;
+    int running = 0;
+    int peak = 0;
+    bool released = false;
+
+    auto blocking_task = [&]
+    {
+        std::unique_lock lock(mutex);
+        peak = std::max(peak, ++running);
+        cond.notify_all();
+        cond.wait(lock, [&] { return released; });
+        running--;
+    };
+
+    auto wait_running = [&](int n)
+    {
+        std::unique_lock lock(mutex);
+        return cond.wait_for(lock, 10s, [&] { return running == n; });
+    };
+
+    worker_pool::instance().set_thread_count(2);
+
+    for (int i = 0; i < 6; i++)
+    {
+        ASSERT_TRUE(worker_pool::instance().post(blocking_task));
+    }
+
+    ASSERT_TRUE(wait_running(2));
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(peak, 2);
+
+    worker_pool::instance().set_thread_count(5);
+    ASSERT_TRUE(wait_running(5));
+
+    {
+        std::lock_guard lock(mutex);
+        released = true;
+        cond.notify_all();
+    }
+
+    ASSERT_TRUE(wait_running(0));
+
+    // 减少到一个线程后，任务逐个执行
+    worker_pool::instance().set_thread_count(1);
+    peak = 0;
+
+    {
+        std::lock_guard lock(mutex);
+        released = false;
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        ASSERT_TRUE(worker_pool::instance().post(blocking_task));
+    }
+
+    ASSERT_TRUE(wait_running(1));
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(peak, 1);
+
+    {
+        std::lock_guard lock(mutex);
+        released = true;
+        cond.notify_all();
+    }
+
+    ASSERT_TRUE(wait_running(0));
+}